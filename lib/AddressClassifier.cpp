@@ -0,0 +1,151 @@
+#include "AddressClassifier.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define ADDRESS_CLASSIFIER_SIMD 1
+#endif
+#endif
+
+namespace {
+
+using Level = NetworkUtils::SimdLevel;
+
+struct Range {
+    Prefix prefix;
+    uint32_t classes;
+};
+
+constexpr Range kStandardRanges[] = {
+    {"10.0.0.0/8"_cidr, AddressClassifier::kPrivate},
+    {"172.16.0.0/12"_cidr, AddressClassifier::kPrivate},
+    {"192.168.0.0/16"_cidr, AddressClassifier::kPrivate},
+    {"127.0.0.0/8"_cidr, AddressClassifier::kLoopback},
+    {"169.254.0.0/16"_cidr, AddressClassifier::kLinkLocal},
+    {"100.64.0.0/10"_cidr, AddressClassifier::kCgnat},
+    {"224.0.0.0/4"_cidr, AddressClassifier::kMulticast},
+    {"0.0.0.0/8"_cidr, AddressClassifier::kReserved},
+    {"240.0.0.0/4"_cidr, AddressClassifier::kReserved},
+};
+
+#if defined(ADDRESS_CLASSIFIER_SIMD)
+
+// Each entry's network, mask and bits are broadcast once per block of
+// addresses; a block is several registers so the broadcasts are amortized
+// and the compares of different registers overlap
+
+__attribute__((target("ssse3"))) size_t classify_sse(const uint32_t* addresses, size_t count, uint32_t* out,
+                                                     const uint32_t* networks, const uint32_t* masks,
+                                                     const uint32_t* classes, size_t entries) {
+    constexpr size_t kBlock = 16;
+    size_t i = 0;
+    for (; i + kBlock <= count; i += kBlock) {
+        __m128i a[4], acc[4];
+        for (size_t r = 0; r < 4; ++r) {
+            a[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(addresses + i + 4 * r));
+            acc[r] = _mm_setzero_si128();
+        }
+        for (size_t e = 0; e < entries; ++e) {
+            __m128i network = _mm_set1_epi32(static_cast<int>(networks[e]));
+            __m128i mask = _mm_set1_epi32(static_cast<int>(masks[e]));
+            __m128i bits = _mm_set1_epi32(static_cast<int>(classes[e]));
+            for (size_t r = 0; r < 4; ++r) {
+                __m128i hit = _mm_cmpeq_epi32(_mm_and_si128(a[r], mask), network);
+                acc[r] = _mm_or_si128(acc[r], _mm_and_si128(hit, bits));
+            }
+        }
+        for (size_t r = 0; r < 4; ++r) _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4 * r), acc[r]);
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) size_t classify_avx2(const uint32_t* addresses, size_t count, uint32_t* out,
+                                                     const uint32_t* networks, const uint32_t* masks,
+                                                     const uint32_t* classes, size_t entries) {
+    constexpr size_t kBlock = 32;
+    size_t i = 0;
+    for (; i + kBlock <= count; i += kBlock) {
+        __m256i a[4], acc[4];
+        for (size_t r = 0; r < 4; ++r) {
+            a[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(addresses + i + 8 * r));
+            acc[r] = _mm256_setzero_si256();
+        }
+        for (size_t e = 0; e < entries; ++e) {
+            __m256i network = _mm256_set1_epi32(static_cast<int>(networks[e]));
+            __m256i mask = _mm256_set1_epi32(static_cast<int>(masks[e]));
+            __m256i bits = _mm256_set1_epi32(static_cast<int>(classes[e]));
+            for (size_t r = 0; r < 4; ++r) {
+                __m256i hit = _mm256_cmpeq_epi32(_mm256_and_si256(a[r], mask), network);
+                acc[r] = _mm256_or_si256(acc[r], _mm256_and_si256(hit, bits));
+            }
+        }
+        for (size_t r = 0; r < 4; ++r) _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8 * r), acc[r]);
+    }
+    return i;
+}
+
+#endif // ADDRESS_CLASSIFIER_SIMD
+
+} // namespace
+
+AddressClassifier::AddressClassifier() {
+    for (const Range& range : kStandardRanges) add_range(range.prefix, range.classes);
+}
+
+// ============ Building ============
+
+bool AddressClassifier::add_range(const Prefix& prefix, uint32_t classes) {
+    if (classes == 0) return false;
+    uint32_t network = prefix.network().to_uint32();
+    uint32_t mask = prefix.mask().to_uint32();
+    for (size_t i = 0; i < networks_.size(); ++i) {
+        if (networks_[i] == network && masks_[i] == mask) {
+            classes_[i] |= classes;
+            return true;
+        }
+    }
+    networks_.push_back(network);
+    masks_.push_back(mask);
+    classes_.push_back(classes);
+    return true;
+}
+
+bool AddressClassifier::add_range(std::string_view cidr, uint32_t classes) {
+    auto prefix = Prefix::parse(cidr);
+    return prefix && add_range(*prefix, classes);
+}
+
+void AddressClassifier::clear() {
+    networks_.clear();
+    masks_.clear();
+    classes_.clear();
+}
+
+// ============ Classification ============
+
+uint32_t AddressClassifier::classify(IPv4Address address) const {
+    uint32_t ip = address.to_uint32();
+    uint32_t result = 0;
+    // Branch-free, like the kernels: every entry is tested
+    for (size_t e = 0; e < networks_.size(); ++e) result |= classes_[e] & (0u - ((ip & masks_[e]) == networks_[e]));
+    return result;
+}
+
+void AddressClassifier::classify_batch(std::span<const uint32_t> addresses, std::span<uint32_t> classes,
+                                       NetworkUtils::SimdLevel level) const {
+    size_t count = std::min(addresses.size(), classes.size());
+    size_t done = 0;
+    level = std::min(level, NetworkUtils::detect_simd_level());
+#if defined(ADDRESS_CLASSIFIER_SIMD)
+    if (level == Level::AVX2) {
+        done = classify_avx2(addresses.data(), count, classes.data(), networks_.data(), masks_.data(),
+                             classes_.data(), networks_.size());
+    } else if (level == Level::SSSE3) {
+        done = classify_sse(addresses.data(), count, classes.data(), networks_.data(), masks_.data(),
+                            classes_.data(), networks_.size());
+    }
+#endif
+    for (size_t i = done; i < count; ++i) classes[i] = classify(IPv4Address(addresses[i]));
+}
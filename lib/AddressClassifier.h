@@ -0,0 +1,107 @@
+#pragma once
+
+#include "IpAddress.h"
+#include "NetworkUtils.h"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class AddressClassifier
+ * @brief Tags IPv4 addresses with a bitmask of address classes.
+ *
+ * The table is a flat list of (network, mask, class bits) entries. A batch
+ * tests every address against every entry with SIMD compares, 8 addresses
+ * per AVX2 instruction, and ORs the bits of each entry that matches, so a
+ * class query is one pass over the addresses with no parsing and no
+ * per-range branches. Cost grows with the number of entries; for thousands
+ * of prefixes use PrefixTable instead.
+ *
+ * A default-constructed classifier holds the standard ranges below; more
+ * ranges, with the standard classes or with user bits from kFirstUserClass
+ * up, can be added with add_range().
+ *
+ * Example:
+ *   AddressClassifier classifier;
+ *   classifier.add_range("203.0.113.0/24"_cidr, AddressClassifier::kFirstUserClass);
+ *   classifier.classify_batch(peers, classes);
+ *   if (classes[i] & AddressClassifier::kPrivate) ...
+ */
+class AddressClassifier {
+public:
+    // ============ Classes ============
+
+    static constexpr uint32_t kPrivate = 1u << 0;    ///< RFC 1918: 10/8, 172.16/12, 192.168/16
+    static constexpr uint32_t kLoopback = 1u << 1;   ///< 127/8
+    static constexpr uint32_t kLinkLocal = 1u << 2;  ///< 169.254/16
+    static constexpr uint32_t kCgnat = 1u << 3;      ///< RFC 6598 shared address space: 100.64/10
+    static constexpr uint32_t kMulticast = 1u << 4;  ///< 224/4
+    static constexpr uint32_t kReserved = 1u << 5;   ///< 0/8 and 240/4 (includes 255.255.255.255)
+
+    /// Lowest bit not used by the standard classes
+    static constexpr uint32_t kFirstUserClass = 1u << 8;
+
+    /**
+     * Classifier with the standard ranges.
+     */
+    AddressClassifier();
+
+    // ============ Building ============
+
+    /**
+     * Add a range. Adding a prefix that is already present ORs the bits
+     * into its entry.
+     *
+     * @param prefix The range
+     * @param classes Bits to set for addresses in the range (non-zero)
+     * @return false if classes is 0
+     */
+    bool add_range(const Prefix& prefix, uint32_t classes);
+
+    /**
+     * Add a range from CIDR text.
+     * Example: add_range("198.51.100.0/24", kFirstUserClass << 1)
+     *
+     * @param cidr "address/length"; host bits must be zero
+     * @param classes Bits to set for addresses in the range (non-zero)
+     * @return false if the text is malformed or classes is 0
+     */
+    bool add_range(std::string_view cidr, uint32_t classes);
+
+    /**
+     * Remove every range, including the standard ones.
+     */
+    void clear();
+
+    /// Number of (prefix, classes) entries
+    size_t size() const { return networks_.size(); }
+
+    // ============ Classification ============
+
+    /**
+     * Classes of one address.
+     * Example: 10.1.2.3 → kPrivate, 8.8.8.8 → 0
+     *
+     * @param address IPv4 address
+     * @return OR of the bits of every range containing the address
+     */
+    uint32_t classify(IPv4Address address) const;
+
+    /**
+     * Classes of many addresses in one pass.
+     *
+     * @param addresses IPv4 addresses (0xC0A80101 for 192.168.1.1)
+     * @param classes Receives each address's bitmask; must be at least as long as addresses
+     * @param level Highest instruction set to use
+     */
+    void classify_batch(std::span<const uint32_t> addresses, std::span<uint32_t> classes,
+                        NetworkUtils::SimdLevel level = NetworkUtils::SimdLevel::AVX2) const;
+
+private:
+    // Structure of arrays, so a kernel broadcasts entry i from three loads
+    std::vector<uint32_t> networks_;
+    std::vector<uint32_t> masks_;
+    std::vector<uint32_t> classes_;
+};
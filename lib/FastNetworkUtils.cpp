@@ -0,0 +1,390 @@
+#include "FastNetworkUtils.h"
+#include "IpAddress.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+using IPv4Text = FastNetworkUtils::IPv4Text;
+
+// Decimal text of every octet, so formatting is a copy per octet instead of
+// divisions and data-dependent branches
+struct OctetText {
+    char digits[4];
+    uint8_t length;
+};
+
+constexpr std::array<OctetText, 256> kOctetText = [] {
+    std::array<OctetText, 256> table{};
+    for (uint32_t v = 0; v < 256; ++v) {
+        OctetText& t = table[v];
+        if (v >= 100) t.digits[t.length++] = static_cast<char>('0' + v / 100);
+        if (v >= 10) t.digits[t.length++] = static_cast<char>('0' + v / 10 % 10);
+        t.digits[t.length++] = static_cast<char>('0' + v % 10);
+    }
+    return table;
+}();
+
+// Hostname character classes; a label's classes are ORed as it is scanned
+// and checked once at its end
+constexpr uint8_t kHostDigit = 1;
+constexpr uint8_t kHostLetter = 2;
+constexpr uint8_t kHostHyphen = 4;
+constexpr uint8_t kHostDot = 8;
+constexpr uint8_t kHostOther = 16;  // Not allowed in a hostname
+
+constexpr std::array<uint8_t, 256> kHostClass = [] {
+    std::array<uint8_t, 256> table{};
+    table.fill(kHostOther);
+    for (int c = '0'; c <= '9'; ++c) table[c] = kHostDigit;
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = kHostLetter;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = kHostLetter;
+    table['-'] = kHostHyphen;
+    table['.'] = kHostDot;
+    return table;
+}();
+
+constexpr size_t kLabelMax = 63;
+
+IPv4Text format(uint32_t ip) {
+    IPv4Text text;
+    text.length = static_cast<uint8_t>(FastNetworkUtils::uint32_to_ipv4(ip, text.chars));
+    return text;
+}
+
+// Parse the address into its prefix and format `op(prefix)`; empty text if
+// the address or prefix length is invalid
+template<typename Op>
+IPv4Text subnet_text(std::string_view ip_str, uint8_t prefix, Op&& op) {
+    auto ip = FastNetworkUtils::ipv4_to_uint32(ip_str);
+    if (!ip || prefix > 32) return {};
+    return format(op(Prefix(IPv4Address(*ip), prefix)).to_uint32());
+}
+
+using IPv6Text = FastNetworkUtils::IPv6Text;
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Where "::" goes for each mask of zero groups (bit i set when group i is
+// zero): the longest run of at least two, the first on a tie; start 8 if none
+struct ZeroRun {
+    uint8_t start;
+    uint8_t length;
+};
+
+constexpr std::array<ZeroRun, 256> kZeroRun = [] {
+    std::array<ZeroRun, 256> table{};
+    for (unsigned mask = 0; mask < 256; ++mask) {
+        ZeroRun best{8, 1};
+        for (unsigned i = 0; i < 8;) {
+            unsigned end = i;
+            while (end < 8 && (mask >> end & 1)) ++end;
+            if (end - i > best.length) best = {static_cast<uint8_t>(i), static_cast<uint8_t>(end - i)};
+            i = end == i ? i + 1 : end;
+        }
+        table[mask] = best.start == 8 ? ZeroRun{8, 0} : best;
+    }
+    return table;
+}();
+
+// Two lowercase hex digits per byte, packed as they sit in memory
+constexpr std::array<uint16_t, 256> kHexPair = [] {
+    std::array<uint16_t, 256> table{};
+    for (unsigned v = 0; v < 256; ++v) {
+        auto first = static_cast<uint16_t>(kHexDigits[v >> 4]), second = static_cast<uint16_t>(kHexDigits[v & 0xF]);
+        table[v] = std::endian::native == std::endian::little ? first | second << 8 : first << 8 | second;
+    }
+    return table;
+}();
+
+// Write a group without leading zeros: all 4 digits are built in a register
+// and stored at once, the pointer advances by the significant ones; the
+// caller leaves 3 bytes of slack
+char* write_group(char* p, uint16_t g) {
+    uint32_t high = kHexPair[g >> 8], low = kHexPair[g & 0xFF];
+    int skip = std::countl_zero(static_cast<uint16_t>(g | 1)) / 4;  // "0" keeps one digit
+    uint32_t digits;
+    if constexpr (std::endian::native == std::endian::little) {
+        digits = (high | low << 16) >> (8 * skip);
+    } else {
+        digits = (high << 16 | low) << (8 * skip);
+    }
+    std::memcpy(p, &digits, 4);
+    return p + 4 - skip;
+}
+
+// RFC 5952 text into out (at least kIPv6TextMax + 4 bytes); returns the length
+size_t format_ipv6(const IPv6Address& address, char* out) {
+    char* p = out;
+    if (address.is_v4_mapped()) {
+        std::memcpy(p, "::ffff:", 7);
+        p += 7;
+        return 7 + FastNetworkUtils::uint32_to_ipv4(address.to_v4().to_uint32(), {p, FastNetworkUtils::kIPv4TextMax});
+    }
+
+    unsigned zeros = 0;
+    for (unsigned i = 0; i < 8; ++i) zeros |= unsigned{address.group(i) == 0} << i;
+    ZeroRun run = kZeroRun[zeros];
+
+    for (unsigned i = 0; i < run.start && i < 8; ++i) {
+        p = write_group(p, address.group(i));
+        *p++ = ':';
+    }
+    unsigned next = run.start + run.length;
+    if (run.start < 8) {
+        // "::" replaces the run; a group before it already wrote one colon
+        if (run.start == 0) *p++ = ':';
+        *p++ = ':';
+    } else {
+        --p;  // No run: drop the colon after the last group
+    }
+    for (unsigned i = next; i < 8; ++i) {
+        p = write_group(p, address.group(i));
+        if (i < 7) *p++ = ':';
+    }
+    return static_cast<size_t>(p - out);
+}
+
+IPv6Text format6(const IPv6Address& address) {
+    char buffer[FastNetworkUtils::kIPv6TextMax + 4];
+    IPv6Text text;
+    text.length = static_cast<uint8_t>(format_ipv6(address, buffer));
+    std::memcpy(text.chars.data(), buffer, text.length);
+    return text;
+}
+
+} // namespace
+
+// ============ IPv4 Address Validation & Conversion ============
+
+std::optional<uint32_t> FastNetworkUtils::ipv4_to_uint32(std::string_view ip_str) {
+    const char* p = ip_str.data();
+    const char* end = p + ip_str.size();
+    uint32_t value = 0;
+    for (int octet = 0; octet < 4; ++octet) {
+        if (octet > 0) {
+            if (p == end || *p != '.') return std::nullopt;
+            ++p;
+        }
+        uint32_t n = 0;
+        auto [next, ec] = std::from_chars(p, end, n);
+        // from_chars takes no sign, so "-1" fails here; cap the digit count
+        // so "0000001" is not an octet
+        if (ec != std::errc{} || next - p > 3 || n > 255) return std::nullopt;
+        value = (value << 8) | n;
+        p = next;
+    }
+    if (p != end) return std::nullopt;
+    return value;
+}
+
+size_t FastNetworkUtils::uint32_to_ipv4(uint32_t ip_int, std::span<char> out) {
+    // Each octet copies 4 bytes (digits plus slack) and advances by its
+    // length; the slack is overwritten by the next dot or left past the end
+    char buffer[kIPv4TextMax + 1];
+    char* p = buffer;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        const OctetText& t = kOctetText[(ip_int >> shift) & 0xFF];
+        std::memcpy(p, t.digits, 4);
+        p += t.length;
+        if (shift > 0) *p++ = '.';
+    }
+    auto length = static_cast<size_t>(p - buffer);
+    if (out.size() < length) return 0;
+    std::copy(buffer, p, out.begin());
+    if (out.size() > length) out[length] = '\0';
+    return length;
+}
+
+FastNetworkUtils::IPv4Text FastNetworkUtils::uint32_to_ipv4(uint32_t ip_int) {
+    return format(ip_int);
+}
+
+FastNetworkUtils::BinaryOctet FastNetworkUtils::octet_to_binary(uint8_t octet) {
+    BinaryOctet text;
+    for (int i = 0; i < 8; ++i) text.chars[i] = (octet >> (7 - i)) & 1 ? '1' : '0';
+    text.length = 8;
+    return text;
+}
+
+// ============ Subnet Calculations ============
+
+FastNetworkUtils::IPv4Text FastNetworkUtils::cidr_to_subnet_mask(uint8_t prefix) {
+    if (prefix > 32) return {};
+    return format(prefix_to_mask(prefix));
+}
+
+std::optional<uint8_t> FastNetworkUtils::subnet_mask_to_cidr(std::string_view mask) {
+    auto value = ipv4_to_uint32(mask);
+    if (!value) return std::nullopt;
+    return mask_to_prefix(*value);
+}
+
+FastNetworkUtils::IPv4Text FastNetworkUtils::get_network_address(std::string_view ip_str, uint8_t prefix) {
+    return subnet_text(ip_str, prefix, [](const Prefix& p) { return p.network(); });
+}
+
+FastNetworkUtils::IPv4Text FastNetworkUtils::get_broadcast_address(std::string_view ip_str, uint8_t prefix) {
+    return subnet_text(ip_str, prefix, [](const Prefix& p) { return p.broadcast(); });
+}
+
+FastNetworkUtils::IPv4Text FastNetworkUtils::get_first_host(std::string_view ip_str, uint8_t prefix) {
+    return subnet_text(ip_str, prefix, [](const Prefix& p) { return p.first_host(); });
+}
+
+FastNetworkUtils::IPv4Text FastNetworkUtils::get_last_host(std::string_view ip_str, uint8_t prefix) {
+    return subnet_text(ip_str, prefix, [](const Prefix& p) { return p.last_host(); });
+}
+
+bool FastNetworkUtils::is_in_subnet(std::string_view ip_str, std::string_view network_str, uint8_t prefix) {
+    auto ip = ipv4_to_uint32(ip_str);
+    auto network = ipv4_to_uint32(network_str);
+    if (!ip || !network || prefix > 32) return false;
+    return Prefix(IPv4Address(*network), prefix).contains(IPv4Address(*ip));
+}
+
+FastNetworkUtils::SubnetText FastNetworkUtils::analyze_subnet(std::string_view ip_str, uint8_t prefix) {
+    auto ip = ipv4_to_uint32(ip_str);
+    if (!ip || prefix > 32) return {};
+    auto info = Prefix(IPv4Address(*ip), prefix).analyze();
+    return {format(info.network.to_uint32()), format(info.first_host.to_uint32()),
+            format(info.last_host.to_uint32()), format(info.broadcast.to_uint32())};
+}
+
+// ============ Classification ============
+
+bool FastNetworkUtils::is_private_ip(std::string_view ip_str) {
+    auto ip = ipv4_to_uint32(ip_str);
+    if (!ip) return false;
+    return (*ip & 0xFF000000) == 0x0A000000 ||  // 10.0.0.0/8
+           (*ip & 0xFFF00000) == 0xAC100000 ||  // 172.16.0.0/12
+           (*ip & 0xFFFF0000) == 0xC0A80000 ||  // 192.168.0.0/16
+           (*ip & 0xFF000000) == 0x7F000000 ||  // 127.0.0.0/8
+           (*ip & 0xFFFF0000) == 0xA9FE0000;    // 169.254.0.0/16
+}
+
+bool FastNetworkUtils::is_reserved_ip(std::string_view ip_str) {
+    auto ip = ipv4_to_uint32(ip_str);
+    if (!ip) return false;
+    // 240.0.0.0/4 includes 255.255.255.255
+    return (*ip & 0xFF000000) == 0 || (*ip & 0xF0000000) == 0xF0000000;
+}
+
+// ============ IPv6 Address Handling ============
+
+std::optional<FastNetworkUtils::IPv6Bytes> FastNetworkUtils::ipv6_to_bytes(std::string_view ip_str) {
+    auto address = IPv6Address::parse(ip_str);
+    if (!address) return std::nullopt;
+    return address->to_bytes();
+}
+
+size_t FastNetworkUtils::bytes_to_ipv6(const IPv6Bytes& bytes, std::span<char> out) {
+    char buffer[kIPv6TextMax + 4];
+    size_t length = format_ipv6(IPv6Address::from_bytes(bytes), buffer);
+    if (out.size() < length) return 0;
+    std::copy(buffer, buffer + length, out.begin());
+    if (out.size() > length) out[length] = '\0';
+    return length;
+}
+
+FastNetworkUtils::IPv6Text FastNetworkUtils::bytes_to_ipv6(const IPv6Bytes& bytes) {
+    return format6(IPv6Address::from_bytes(bytes));
+}
+
+FastNetworkUtils::IPv6Text FastNetworkUtils::compress_ipv6(std::string_view ip_str) {
+    auto address = IPv6Address::parse(ip_str);
+    if (!address) return {};
+    return format6(*address);
+}
+
+FastNetworkUtils::IPv6Text FastNetworkUtils::expand_ipv6(std::string_view ip_str) {
+    auto address = IPv6Address::parse(ip_str);
+    if (!address) return {};
+    IPv6Text text;
+    char* p = text.chars.data();
+    for (unsigned i = 0; i < 8; ++i) {
+        uint16_t g = address->group(i);
+        for (int shift = 12; shift >= 0; shift -= 4) *p++ = kHexDigits[(g >> shift) & 0xF];
+        if (i < 7) *p++ = ':';
+    }
+    text.length = static_cast<uint8_t>(kIPv6TextMax);
+    return text;
+}
+
+FastNetworkUtils::IPv6Text FastNetworkUtils::get_network_address_v6(std::string_view ip_str, uint8_t prefix) {
+    auto address = IPv6Address::parse(ip_str);
+    if (!address || prefix > 128) return {};
+    return format6(IPv6Prefix(*address, prefix).network());
+}
+
+bool FastNetworkUtils::is_in_subnet_v6(std::string_view ip_str, std::string_view network_str, uint8_t prefix) {
+    auto address = IPv6Address::parse(ip_str);
+    auto network = IPv6Address::parse(network_str);
+    if (!address || !network || prefix > 128) return false;
+    return IPv6Prefix(*network, prefix).contains(*address);
+}
+
+FastNetworkUtils::SubnetText6 FastNetworkUtils::analyze_subnet_v6(std::string_view ip_str, uint8_t prefix) {
+    auto address = IPv6Address::parse(ip_str);
+    if (!address || prefix > 128) return {};
+    auto info = IPv6Prefix(*address, prefix).analyze();
+    return {format6(info.network), format6(info.first_host), format6(info.last_host)};
+}
+
+// ============ DNS & FQDN Handling ============
+
+FastNetworkUtils::HostnameLabels FastNetworkUtils::parse_fqdn(std::string_view fqdn) {
+    // One object for every return, so it is built in place; starts is
+    // deliberately left uninitialized until the name is known to be valid
+    HostnameLabels labels;
+    if (fqdn.empty() || fqdn.size() > kHostnameMax) return labels;
+
+    const auto* text = reinterpret_cast<const unsigned char*>(fqdn.data());
+    size_t count = 0;
+    size_t start = 0;
+    uint8_t classes = 0;
+    bool valid = true;
+    // A label is checked when it closes, at each dot and at the end. A failed
+    // check only clears `valid`, so the scan never leaves the loop early and
+    // the text between dots costs one table load and one OR per character
+    auto close = [&](size_t end) {
+        size_t length = end - start;
+        // length - 1 wraps for an empty label, before text[end - 1] is read
+        valid &= length - 1 < kLabelMax && !(classes & kHostOther) && text[start] != '-' && text[end - 1] != '-';
+        // Only invalid names (empty labels) can have more labels than fit
+        labels.starts[std::min(count++, kMaxLabels)] = static_cast<uint8_t>(start);
+        start = end + 1;
+    };
+    for (size_t i = 0; i < fqdn.size(); ++i) {
+        uint8_t c = kHostClass[text[i]];
+        if (c == kHostDot) {
+            close(i);
+            classes = 0;
+        } else {
+            classes |= c;
+        }
+    }
+    close(fqdn.size());
+    // All digits in the last label would make dotted IPv4 text a hostname
+    valid &= classes != kHostDigit;
+
+    if (valid) {
+        labels.name = fqdn;
+        labels.starts[count] = static_cast<uint8_t>(fqdn.size() + 1);
+        labels.count = static_cast<uint8_t>(count);
+    }
+    return labels;
+}
+
+std::string_view FastNetworkUtils::get_tld(std::string_view fqdn) {
+    auto labels = parse_fqdn(fqdn);
+    return labels.empty() ? std::string_view{} : labels[labels.size() - 1];
+}
+
+std::string_view FastNetworkUtils::get_domain(std::string_view fqdn) {
+    auto labels = parse_fqdn(fqdn);
+    return labels.size() < 2 ? std::string_view{} : labels[labels.size() - 2];
+}
@@ -0,0 +1,413 @@
+#pragma once
+
+#include "IpAddress.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+/**
+ * @struct FixedText
+ * @brief Fixed-capacity, NUL-terminated text returned by value.
+ *
+ * Lives entirely in the object (a std::array), so returning one never
+ * allocates. Compares equal to any string_view with the same characters.
+ */
+template<size_t Capacity>
+struct FixedText {
+    std::array<char, Capacity + 1> chars{};
+    uint8_t length = 0;
+
+    std::string_view view() const { return {chars.data(), length}; }
+    const char* c_str() const { return chars.data(); }
+    bool empty() const { return length == 0; }
+    size_t size() const { return length; }
+
+    friend bool operator==(const FixedText& a, std::string_view b) { return a.view() == b; }
+};
+
+/**
+ * @class FastNetworkUtils
+ * @brief Allocation-free counterpart of NetworkUtils.
+ *
+ * Same functions and results as NetworkUtils, but inputs are
+ * std::string_view, numbers are read with std::from_chars, and text results
+ * are written into a caller-provided buffer or returned as FixedText. Nothing
+ * here touches the heap, so it is safe on per-packet and log-ingest paths.
+ *
+ * Example:
+ *   std::string_view field = line.substr(0, line.find(' '));
+ *   auto ip = FastNetworkUtils::ipv4_to_uint32(field);             // 0xC0A80164
+ *   auto net = FastNetworkUtils::get_network_address(field, 24);   // "192.168.1.0"
+ *   std::fputs(net.c_str(), out);
+ */
+class FastNetworkUtils {
+public:
+    /// Longest dotted quad: "255.255.255.255"
+    static constexpr size_t kIPv4TextMax = 15;
+
+    /// Longest canonical IPv6 text: 8 groups of 4 digits
+    static constexpr size_t kIPv6TextMax = 39;
+
+    /// Longest hostname text (RFC 1035 allows 255 octets on the wire)
+    static constexpr size_t kHostnameMax = 253;
+
+    /// Most labels a hostname can have: "a.a.a…" at kHostnameMax characters
+    static constexpr size_t kMaxLabels = (kHostnameMax + 1) / 2;
+
+    using IPv4Text = FixedText<kIPv4TextMax>;
+    using IPv6Text = FixedText<kIPv6TextMax>;
+    using BinaryOctet = FixedText<8>;
+
+    /// IPv6 address in network byte order
+    using IPv6Bytes = IPv6Address::Bytes;
+
+    /// analyze_subnet() result, one FixedText per address
+    struct SubnetText {
+        IPv4Text network;
+        IPv4Text first_host;
+        IPv4Text last_host;
+        IPv4Text broadcast;
+    };
+
+    /// analyze_subnet_v6() result; IPv6 has no broadcast, every address is a host
+    struct SubnetText6 {
+        IPv6Text network;
+        IPv6Text first_host;
+        IPv6Text last_host;
+    };
+
+    /**
+     * parse_fqdn() result: where each label starts in the parsed text. Views
+     * that text, so it is only valid as long as the text is.
+     */
+    struct HostnameLabels {
+        std::string_view name;
+        // Label i is [starts[i], starts[i + 1] - 1); starts[count] is one past
+        // the end, where a final dot would follow. Entries past count are
+        // not initialized.
+        std::array<uint8_t, kMaxLabels + 1> starts;
+        uint8_t count = 0;
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        std::string_view operator[](size_t i) const {
+            return name.substr(starts[i], static_cast<size_t>(starts[i + 1] - starts[i] - 1));
+        }
+    };
+
+    // ============ IPv4 Address Validation & Conversion ============
+
+    /**
+     * Validate IPv4 dotted decimal: exactly 4 octets of 1-3 digits, each 0-255.
+     *
+     * @param ip_str The IPv4 address text
+     * @return true if valid, false otherwise
+     */
+    static bool is_valid_ipv4(std::string_view ip_str) { return ipv4_to_uint32(ip_str).has_value(); }
+
+    /**
+     * Parse dotted decimal IPv4 text.
+     * Example: "192.168.1.100" → 0xC0A80164
+     *
+     * @param ip_str Dotted decimal IPv4 address
+     * @return 32-bit integer representation, or std::nullopt if invalid
+     */
+    static std::optional<uint32_t> ipv4_to_uint32(std::string_view ip_str);
+
+    /**
+     * Format an IPv4 address into a caller buffer (NUL-terminated when there
+     * is room for it).
+     *
+     * @param ip_int 32-bit integer representation
+     * @param out Destination, at least kIPv4TextMax characters
+     * @return Characters written (excluding NUL), or 0 if out is too small
+     */
+    static size_t uint32_to_ipv4(uint32_t ip_int, std::span<char> out);
+
+    /**
+     * Format an IPv4 address.
+     * Example: 0xC0A80164 → "192.168.1.100"
+     *
+     * @param ip_int 32-bit integer representation
+     * @return Dotted decimal text
+     */
+    static IPv4Text uint32_to_ipv4(uint32_t ip_int);
+
+    /**
+     * Convert an octet to 8 binary digits.
+     * Example: 192 → "11000000"
+     *
+     * @param octet Value 0-255
+     * @return 8-character binary text
+     */
+    static BinaryOctet octet_to_binary(uint8_t octet);
+
+    // ============ Subnet Calculations ============
+
+    /**
+     * Subnet mask for a prefix length.
+     * Example: 26 → 0xFFFFFFC0
+     *
+     * @param prefix CIDR prefix length (0-32; larger values give all ones)
+     * @return The mask as an integer
+     */
+    static constexpr uint32_t prefix_to_mask(uint8_t prefix) {
+        return prefix == 0 ? 0 : prefix >= 32 ? 0xFFFFFFFFu : 0xFFFFFFFFu << (32 - prefix);
+    }
+
+    /**
+     * Prefix length of a contiguous subnet mask.
+     * Example: 0xFFFFFFC0 → 26, 0xFFFF00FF → nullopt
+     *
+     * @param mask Subnet mask as an integer
+     * @return CIDR prefix (0-32), or std::nullopt if the ones are not contiguous
+     */
+    static constexpr std::optional<uint8_t> mask_to_prefix(uint32_t mask) {
+        uint32_t inverted = ~mask;
+        if (inverted & (inverted + 1)) return std::nullopt;  // Host part must be 0...01...1
+        return static_cast<uint8_t>(std::countl_one(mask));
+    }
+
+    /**
+     * Dotted decimal subnet mask for a prefix length.
+     * Example: 24 → "255.255.255.0"
+     *
+     * @param prefix CIDR prefix length (0-32)
+     * @return Mask text, or empty if prefix > 32
+     */
+    static IPv4Text cidr_to_subnet_mask(uint8_t prefix);
+
+    /**
+     * Prefix length of a dotted decimal subnet mask.
+     * Example: "255.255.255.192" → 26
+     *
+     * @param mask Dotted decimal subnet mask
+     * @return CIDR prefix (0-32), or std::nullopt if malformed or not contiguous
+     */
+    static std::optional<uint8_t> subnet_mask_to_cidr(std::string_view mask);
+
+    /**
+     * Network address (all host bits zero).
+     * Example: ("192.168.1.100", 24) → "192.168.1.0"
+     *
+     * @param ip_str IPv4 address text
+     * @param prefix CIDR prefix length (0-32)
+     * @return Network address text, or empty if invalid
+     */
+    static IPv4Text get_network_address(std::string_view ip_str, uint8_t prefix);
+
+    /**
+     * Broadcast address (all host bits one).
+     * Example: ("192.168.1.0", 24) → "192.168.1.255"
+     *
+     * @param ip_str IPv4 address text
+     * @param prefix CIDR prefix length (0-32)
+     * @return Broadcast address text, or empty if invalid
+     */
+    static IPv4Text get_broadcast_address(std::string_view ip_str, uint8_t prefix);
+
+    /**
+     * First usable host: network + 1, the network itself for /31 (RFC 3021)
+     * and the address itself for /32.
+     *
+     * @param ip_str IPv4 address text
+     * @param prefix CIDR prefix length (0-32)
+     * @return First host text, or empty if invalid
+     */
+    static IPv4Text get_first_host(std::string_view ip_str, uint8_t prefix);
+
+    /**
+     * Last usable host: broadcast - 1, the broadcast itself for /31 and the
+     * address itself for /32.
+     *
+     * @param ip_str IPv4 address text
+     * @param prefix CIDR prefix length (0-32)
+     * @return Last host text, or empty if invalid
+     */
+    static IPv4Text get_last_host(std::string_view ip_str, uint8_t prefix);
+
+    /**
+     * Number of usable hosts: 2^(32 - prefix) - 2, 2 for /31, 0 for /32.
+     *
+     * @param prefix CIDR prefix length
+     * @return Number of usable hosts, or 0 for invalid input
+     */
+    static constexpr uint32_t count_usable_hosts(uint8_t prefix) {
+        if (prefix >= 32) return 0;
+        if (prefix == 31) return 2;
+        return static_cast<uint32_t>((uint64_t{1} << (32 - prefix)) - 2);
+    }
+
+    /**
+     * Check if an address is inside network/prefix.
+     *
+     * @param ip_str The IPv4 address text
+     * @param network_str The network address text
+     * @param prefix CIDR prefix length (0-32)
+     * @return true if the address is in the subnet, false otherwise or if invalid
+     */
+    static bool is_in_subnet(std::string_view ip_str, std::string_view network_str, uint8_t prefix);
+
+    /**
+     * Network, first host, last host and broadcast in one parse.
+     * Example: ("192.168.100.50", 26) →
+     *   ("192.168.100.0", "192.168.100.1", "192.168.100.62", "192.168.100.63")
+     *
+     * @param ip_str IPv4 address text
+     * @param prefix CIDR prefix length (0-32)
+     * @return The four addresses, all empty if invalid
+     */
+    static SubnetText analyze_subnet(std::string_view ip_str, uint8_t prefix);
+
+    // ============ Classification ============
+
+    /**
+     * Private, loopback or link-local (10/8, 172.16/12, 192.168/16, 127/8, 169.254/16).
+     *
+     * @param ip_str IPv4 address text
+     * @return true if private, false otherwise or if invalid
+     */
+    static bool is_private_ip(std::string_view ip_str);
+
+    /**
+     * Reserved: 0.0.0.0/8, 240.0.0.0/4 and the limited broadcast address.
+     *
+     * @param ip_str IPv4 address text
+     * @return true if reserved, false otherwise or if invalid
+     */
+    static bool is_reserved_ip(std::string_view ip_str);
+
+    // ============ IPv6 Address Handling ============
+
+    /**
+     * Validate IPv6 text (RFC 4291, including IPv4-mapped forms).
+     * Valid: "2001:db8:85a3::8a2e:370:7334", "::1", "::ffff:192.0.2.1"
+     * Invalid: "gggg::1", "::1::2"
+     *
+     * @param ip_str The IPv6 address text
+     * @return true if valid, false otherwise
+     */
+    static bool is_valid_ipv6(std::string_view ip_str) { return IPv6Address::parse(ip_str).has_value(); }
+
+    /**
+     * Parse IPv6 text into its 16 bytes.
+     * Example: "2001:db8::1" → {0x20, 0x01, 0x0d, 0xb8, 0, ..., 0, 0x01}
+     *
+     * @param ip_str IPv6 address text
+     * @return Bytes in network order, or std::nullopt if invalid
+     */
+    static std::optional<IPv6Bytes> ipv6_to_bytes(std::string_view ip_str);
+
+    /**
+     * Format an IPv6 address in RFC 5952 canonical form: lowercase, no
+     * leading zeros, the longest run of two or more zero groups (the first
+     * on a tie) as "::", and IPv4-mapped addresses as "::ffff:a.b.c.d".
+     *
+     * @param bytes Address in network order
+     * @param out Destination, at least kIPv6TextMax characters
+     * @return Characters written (excluding NUL), or 0 if out is too small
+     */
+    static size_t bytes_to_ipv6(const IPv6Bytes& bytes, std::span<char> out);
+
+    /**
+     * Format an IPv6 address in RFC 5952 canonical form.
+     * Example: 2001:0db8:0000:0000:0000:0000:0000:0001 → "2001:db8::1"
+     *
+     * @param bytes Address in network order
+     * @return Canonical text
+     */
+    static IPv6Text bytes_to_ipv6(const IPv6Bytes& bytes);
+
+    /**
+     * Canonical (RFC 5952) form of any valid IPv6 text.
+     * Example: "2001:0DB8:0:0:1:0:0:1" → "2001:db8::1:0:0:1"
+     *
+     * @param ip_str IPv6 address text
+     * @return Canonical text, or empty if invalid
+     */
+    static IPv6Text compress_ipv6(std::string_view ip_str);
+
+    /**
+     * Full form: 8 groups of 4 lowercase hex digits.
+     * Example: "2001:db8::1" → "2001:0db8:0000:0000:0000:0000:0000:0001"
+     *
+     * @param ip_str IPv6 address text
+     * @return Expanded text, or empty if invalid
+     */
+    static IPv6Text expand_ipv6(std::string_view ip_str);
+
+    /**
+     * IPv6 network address (host bits zero), in canonical form.
+     * Example: ("2001:db8:1:2::3", 48) → "2001:db8:1::"
+     *
+     * @param ip_str IPv6 address text
+     * @param prefix Prefix length (0-128)
+     * @return Network address text, or empty if invalid
+     */
+    static IPv6Text get_network_address_v6(std::string_view ip_str, uint8_t prefix);
+
+    /**
+     * Check if an IPv6 address is inside network/prefix.
+     *
+     * @param ip_str The IPv6 address text
+     * @param network_str The network address text
+     * @param prefix Prefix length (0-128)
+     * @return true if the address is in the subnet, false otherwise or if invalid
+     */
+    static bool is_in_subnet_v6(std::string_view ip_str, std::string_view network_str, uint8_t prefix);
+
+    /**
+     * Network, first and last address of an IPv6 prefix in one parse.
+     * Example: ("2001:db8::1", 64) → ("2001:db8::", "2001:db8::", "2001:db8::ffff:ffff:ffff:ffff")
+     *
+     * @param ip_str IPv6 address text
+     * @param prefix Prefix length (0-128)
+     * @return The three addresses, all empty if invalid
+     */
+    static SubnetText6 analyze_subnet_v6(std::string_view ip_str, uint8_t prefix);
+
+    // ============ DNS & FQDN Handling ============
+
+    /**
+     * Validate a hostname by the rules of NetworkUtils::is_valid_hostname:
+     * labels of 1-63 letters, digits and hyphens, not starting or ending
+     * with a hyphen, at most 253 characters in all, and a last label that is
+     * not all digits (so "256.1.1.1" is rejected).
+     *
+     * @param hostname The hostname text, without a trailing dot
+     * @return true if valid
+     */
+    static bool is_valid_hostname(std::string_view hostname) { return !parse_fqdn(hostname).empty(); }
+
+    /**
+     * Validate and split a hostname in one pass over the text.
+     * Example: "game.example.com" → labels[0] == "game", labels.size() == 3
+     *
+     * @param fqdn The hostname text
+     * @return Label positions, empty if the hostname is invalid
+     */
+    static HostnameLabels parse_fqdn(std::string_view fqdn);
+
+    /**
+     * Last label.
+     * Example: "game.example.com" → "com"
+     *
+     * @param fqdn The hostname text
+     * @return View into fqdn, or empty if invalid
+     */
+    static std::string_view get_tld(std::string_view fqdn);
+
+    /**
+     * Second-to-last label. Does not know about multi-label public suffixes:
+     * "game.example.co.uk" → "co".
+     * Example: "game.example.com" → "example"
+     *
+     * @param fqdn The hostname text
+     * @return View into fqdn, or empty if invalid or a single label
+     */
+    static std::string_view get_domain(std::string_view fqdn);
+};
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+/**
+ * @file IpAddress.h
+ * @brief Trivially copyable address and prefix value types with constexpr math.
+ *
+ * IPv4Address wraps a uint32_t, IPv6Address two uint64_t halves, and
+ * BasicPrefix<Address> a masked network plus a length. Everything the
+ * string-based NetworkUtils subnet functions compute (mask, network,
+ * broadcast, host range, containment) is a constexpr integer operation
+ * here, so rule tables can be built at compile time:
+ *
+ *   constexpr Prefix kRfc1918[] = {"10.0.0.0/8"_cidr, "172.16.0.0/12"_cidr, "192.168.0.0/16"_cidr};
+ *   static_assert(kRfc1918[1].contains("172.20.0.1"_ipv4));
+ */
+
+class IPv4Address {
+public:
+    static constexpr unsigned kBits = 32;
+
+    constexpr IPv4Address() = default;
+    constexpr explicit IPv4Address(uint32_t value) : value_(value) {}
+    constexpr IPv4Address(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : value_((uint32_t{a} << 24) | (uint32_t{b} << 16) | (uint32_t{c} << 8) | d) {}
+
+    /**
+     * Parse dotted decimal, with the same rules as NetworkUtils::is_valid_ipv4.
+     * Example: "192.168.1.100" → 0xC0A80164
+     *
+     * @param text Dotted decimal IPv4 address
+     * @return The address, or std::nullopt if invalid
+     */
+    static constexpr std::optional<IPv4Address> parse(std::string_view text) {
+        uint32_t value = 0;
+        size_t pos = 0;
+        for (int octet = 0; octet < 4; ++octet) {
+            if (octet > 0) {
+                if (pos >= text.size() || text[pos] != '.') return std::nullopt;
+                ++pos;
+            }
+            uint32_t n = 0;
+            size_t digits = 0;
+            for (; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++pos, ++digits) {
+                n = n * 10 + static_cast<uint32_t>(text[pos] - '0');
+                if (digits == 3) return std::nullopt;
+            }
+            if (digits == 0 || n > 255) return std::nullopt;
+            value = (value << 8) | n;
+        }
+        if (pos != text.size()) return std::nullopt;
+        return IPv4Address(value);
+    }
+
+    /**
+     * Subnet mask of a prefix length.
+     * Example: 26 → 255.255.255.192
+     *
+     * @param length Prefix length (values above 32 give all ones)
+     * @return The mask
+     */
+    static constexpr IPv4Address mask(unsigned length) {
+        return IPv4Address(length == 0 ? 0 : length >= 32 ? 0xFFFFFFFFu : 0xFFFFFFFFu << (32 - length));
+    }
+
+    constexpr uint32_t to_uint32() const { return value_; }
+
+    /// Octet `i`, 0 being the most significant ("192" in 192.168.1.1)
+    constexpr uint8_t octet(unsigned i) const { return static_cast<uint8_t>(value_ >> (24 - 8 * i)); }
+
+    constexpr IPv4Address operator&(IPv4Address o) const { return IPv4Address(value_ & o.value_); }
+    constexpr IPv4Address operator|(IPv4Address o) const { return IPv4Address(value_ | o.value_); }
+    constexpr IPv4Address operator~() const { return IPv4Address(~value_); }
+
+    /// Address `n` after this one, wrapping at 255.255.255.255
+    constexpr IPv4Address operator+(uint32_t n) const { return IPv4Address(value_ + n); }
+    constexpr IPv4Address operator-(uint32_t n) const { return IPv4Address(value_ - n); }
+
+    constexpr auto operator<=>(const IPv4Address&) const = default;
+
+private:
+    uint32_t value_ = 0;
+};
+
+class IPv6Address {
+public:
+    static constexpr unsigned kBits = 128;
+    using Bytes = std::array<uint8_t, 16>;
+
+    /// Longest accepted text: "ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255"
+    static constexpr size_t kTextMax = 45;
+
+    constexpr IPv6Address() = default;
+    constexpr IPv6Address(uint64_t high, uint64_t low) : high_(high), low_(low) {}
+
+    /**
+     * Address from its 16 bytes in network order.
+     *
+     * @param bytes Address bytes, most significant first
+     * @return The address
+     */
+    static constexpr IPv6Address from_bytes(const Bytes& bytes) {
+        auto halves = std::bit_cast<std::array<uint64_t, 2>>(bytes);
+        return {to_big_endian(halves[0]), to_big_endian(halves[1])};
+    }
+
+    /**
+     * Parse RFC 4291 text: up to 8 hex groups, at most one "::", optionally
+     * a dotted quad in place of the last two groups. No heap, no branch per
+     * character.
+     * Example: "2001:db8::1", "::ffff:192.0.2.1"
+     *
+     * @param text IPv6 address text (no zone index, no brackets)
+     * @return The address, or std::nullopt if invalid
+     */
+    static constexpr std::optional<IPv6Address> parse(std::string_view text) {
+        const size_t n = text.size();
+        if (n < 2 || n > kTextMax) return std::nullopt;
+        // Padded copy, so every group can read 4 characters
+        std::array<char, kPaddedText> buffer{};
+        for (size_t i = 0; i < n; ++i) buffer[i] = text[i];
+
+        // Find every colon up front, 8 bytes at a time, then walk the fields
+        // between them with countr_zero: group starts no longer wait on the
+        // previous group's digits, and no branch depends on a group's length
+        auto words = std::bit_cast<std::array<uint64_t, kPaddedText / 8>>(buffer);
+        uint64_t colons = 0;
+        for (size_t word = 0; word < words.size(); ++word) {
+            uint64_t x = words[word];
+            if constexpr (std::endian::native == std::endian::big) x = std::byteswap(x);
+            x ^= 0x3A3A3A3A3A3A3A3AULL;  // ':' bytes become zero
+            uint64_t nonzero = ((x & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | x;
+            uint64_t zero_bytes = (~nonzero & 0x8080808080808080ULL) >> 7;
+            colons |= (zero_bytes * 0x0102040810204080ULL) >> 56 << (word * 8);
+        }
+
+        // At most one "::", and a colon may only start or end the text as part of it
+        uint64_t doubles = colons & (colons >> 1);
+        if (doubles & (doubles - 1)) return std::nullopt;
+        if ((colons & 1) && !(doubles & 1)) return std::nullopt;
+        if ((colons >> (n - 1) & 1) && !(doubles >> (n - 2) & 1)) return std::nullopt;
+
+        // Groups accumulate at the low end; the ones after "::" move into
+        // place at the end
+        IPv6Address value;
+        size_t count = 0;
+        constexpr size_t kNoGap = 9;
+        size_t gap = kNoGap;  // Group index where "::" expands
+        uint64_t ends = colons | (uint64_t{1} << n);
+        for (size_t start = 0; ends; ends &= ends - 1) {
+            auto end = static_cast<size_t>(std::countr_zero(ends));
+            size_t length = end - start;
+            if (length == 0) {
+                // The empty fields around "::" (one, two at either end)
+                gap = count;
+                start = end + 1;
+                continue;
+            }
+            // Characters past the field (colon or padding) are not digits;
+            // only the ones inside it must be, and the rest are shifted out
+            int d0 = hex_value(buffer[start]), d1 = hex_value(buffer[start + 1]);
+            int d2 = hex_value(buffer[start + 2]), d3 = hex_value(buffer[start + 3]);
+            unsigned non_digits = unsigned{d0 < 0} | unsigned{d1 < 0} << 1 | unsigned{d2 < 0} << 2 | unsigned{d3 < 0} << 3;
+            bool bad = length > 4 || (non_digits & ((1u << length) - 1)) != 0;
+            if (bad) {
+                // Only the last field may be a dotted quad, filling two groups
+                if ((ends & (ends - 1)) != 0) return std::nullopt;
+                auto v4 = IPv4Address::parse(text.substr(start));
+                if (!v4 || count > 6) return std::nullopt;
+                value = (value << 32) | IPv6Address(0, v4->to_uint32());
+                count += 2;
+                break;
+            }
+            if (count == 8) return std::nullopt;
+            unsigned group = static_cast<unsigned>(d0 & 0xF) << 12 | static_cast<unsigned>(d1 & 0xF) << 8 |
+                             static_cast<unsigned>(d2 & 0xF) << 4 | static_cast<unsigned>(d3 & 0xF);
+            value = (value << 16) | IPv6Address(0, group >> (16 - 4 * length));
+            ++count;
+            start = end + 1;
+        }
+        if (gap == kNoGap ? count != 8 : count > 7) return std::nullopt;
+        if (gap == kNoGap) return value;
+        auto tail_bits = static_cast<unsigned>(16 * (count - gap));
+        IPv6Address tail = value & ~(~IPv6Address() << tail_bits);
+        return (value >> tail_bits) << static_cast<unsigned>(16 * (8 - gap)) | tail;
+    }
+
+    /**
+     * The IPv4-mapped address ::ffff:a.b.c.d.
+     *
+     * @param v4 IPv4 address
+     * @return The mapped IPv6 address
+     */
+    static constexpr IPv6Address mapped(IPv4Address v4) { return {0, 0x0000FFFF00000000ULL | v4.to_uint32()}; }
+
+    /**
+     * Mask of a prefix length.
+     *
+     * @param length Prefix length (values above 128 give all ones)
+     * @return The mask
+     */
+    static constexpr IPv6Address mask(unsigned length) {
+        if (length == 0) return {};
+        if (length <= 64) return {~uint64_t{0} << (64 - length), 0};
+        if (length >= 128) return {~uint64_t{0}, ~uint64_t{0}};
+        return {~uint64_t{0}, ~uint64_t{0} << (128 - length)};
+    }
+
+    constexpr Bytes to_bytes() const {
+        return std::bit_cast<Bytes>(std::array<uint64_t, 2>{to_big_endian(high_), to_big_endian(low_)});
+    }
+
+    constexpr uint64_t high() const { return high_; }
+    constexpr uint64_t low() const { return low_; }
+
+    /// 16-bit group `i`, 0 being the most significant ("2001" in 2001:db8::1)
+    constexpr uint16_t group(unsigned i) const {
+        return static_cast<uint16_t>((i < 4 ? high_ : low_) >> (48 - 16 * (i % 4)));
+    }
+
+    /// True for ::ffff:a.b.c.d
+    constexpr bool is_v4_mapped() const { return high_ == 0 && (low_ >> 32) == 0xFFFF; }
+
+    /// The embedded IPv4 address of a mapped address
+    constexpr IPv4Address to_v4() const { return IPv4Address(static_cast<uint32_t>(low_)); }
+
+    constexpr IPv6Address operator&(IPv6Address o) const { return {high_ & o.high_, low_ & o.low_}; }
+    constexpr IPv6Address operator|(IPv6Address o) const { return {high_ | o.high_, low_ | o.low_}; }
+    constexpr IPv6Address operator~() const { return {~high_, ~low_}; }
+
+    /// Shifts by 0-128 bits (128 gives zero)
+    constexpr IPv6Address operator<<(unsigned bits) const {
+        if (bits == 0) return *this;
+        if (bits >= 128) return {};
+        if (bits >= 64) return {low_ << (bits - 64), 0};
+        return {(high_ << bits) | (low_ >> (64 - bits)), low_ << bits};
+    }
+    constexpr IPv6Address operator>>(unsigned bits) const {
+        if (bits == 0) return *this;
+        if (bits >= 128) return {};
+        if (bits >= 64) return {0, high_ >> (bits - 64)};
+        return {high_ >> bits, (low_ >> bits) | (high_ << (64 - bits))};
+    }
+
+    /// Address `n` after this one, carrying into the high half
+    constexpr IPv6Address operator+(uint64_t n) const {
+        uint64_t low = low_ + n;
+        return {high_ + (low < low_), low};
+    }
+    constexpr IPv6Address operator-(uint64_t n) const {
+        uint64_t low = low_ - n;
+        return {high_ - (low > low_), low};
+    }
+
+    constexpr auto operator<=>(const IPv6Address&) const = default;
+
+private:
+    // Text plus room for a 4-character read at the last position
+    static constexpr size_t kPaddedText = 48;
+
+    // Hex digit value of every byte, -1 for non-digits: a load instead of
+    // a digit/letter branch that mispredicts on most characters
+    static constexpr std::array<int8_t, 256> kHexValue = [] {
+        std::array<int8_t, 256> table{};
+        for (int c = 0; c < 256; ++c) {
+            table[c] = c >= '0' && c <= '9' ? static_cast<int8_t>(c - '0')
+                     : c >= 'a' && c <= 'f' ? static_cast<int8_t>(c - 'a' + 10)
+                     : c >= 'A' && c <= 'F' ? static_cast<int8_t>(c - 'A' + 10)
+                     : int8_t{-1};
+        }
+        return table;
+    }();
+
+    static constexpr int hex_value(char c) { return kHexValue[static_cast<unsigned char>(c)]; }
+
+    // Byte order swap between a half and its 8 bytes in network order
+    static constexpr uint64_t to_big_endian(uint64_t v) {
+        if constexpr (std::endian::native == std::endian::little) return std::byteswap(v);
+        return v;
+    }
+
+    uint64_t high_ = 0;
+    uint64_t low_ = 0;
+};
+
+/**
+ * @brief Network, host range and broadcast of a prefix, as integers.
+ *
+ * Same fields as NetworkUtils::SubnetInfo. For IPv6, `broadcast` is the
+ * last address of the prefix.
+ */
+template<typename Address>
+struct BasicSubnetInfo {
+    Address network;
+    Address first_host;
+    Address last_host;
+    Address broadcast;
+
+    constexpr bool operator==(const BasicSubnetInfo&) const = default;
+};
+
+/**
+ * @class BasicPrefix
+ * @brief A CIDR prefix: network address (host bits always zero) and length.
+ */
+template<typename Address>
+class BasicPrefix {
+public:
+    static constexpr unsigned kBits = Address::kBits;
+
+    constexpr BasicPrefix() = default;
+
+    /**
+     * Prefix of `length` bits containing `address`; host bits are cleared.
+     * Example: (192.168.1.100, 24) → 192.168.1.0/24
+     */
+    constexpr BasicPrefix(Address address, unsigned length)
+        : network_(address & Address::mask(length)), length_(static_cast<uint8_t>(std::min(length, kBits))) {}
+
+    /**
+     * Parse "address/length". A bare address is a host prefix (/32, /128).
+     *
+     * @param text CIDR text, host bits must be zero
+     * @return The prefix, or std::nullopt if malformed or host bits are set
+     */
+    static constexpr std::optional<BasicPrefix> parse(std::string_view text) {
+        size_t slash = text.find('/');
+        auto address = Address::parse(text.substr(0, slash));
+        if (!address) return std::nullopt;
+        unsigned length = kBits;
+        if (slash != std::string_view::npos) {
+            std::string_view digits = text.substr(slash + 1);
+            if (digits.empty() || digits.size() > 3) return std::nullopt;
+            length = 0;
+            for (char c : digits) {
+                if (c < '0' || c > '9') return std::nullopt;
+                length = length * 10 + static_cast<unsigned>(c - '0');
+            }
+            if (length > kBits) return std::nullopt;
+        }
+        BasicPrefix prefix(*address, length);
+        if (prefix.network_ != *address) return std::nullopt;
+        return prefix;
+    }
+
+    constexpr Address network() const { return network_; }
+    constexpr unsigned length() const { return length_; }
+    constexpr Address mask() const { return Address::mask(length_); }
+
+    /// Last address of the prefix (all host bits set)
+    constexpr Address broadcast() const { return network_ | ~mask(); }
+
+    /**
+     * First usable host. IPv4: network + 1, except /31 (RFC 3021) and /32
+     * where every address is usable. IPv6 has no broadcast, so all
+     * addresses are usable and this is the network address.
+     */
+    constexpr Address first_host() const {
+        if constexpr (kBits == 32) {
+            if (length_ >= 31) return network_;
+            return network_ + 1;
+        } else {
+            return network_;
+        }
+    }
+
+    /// Last usable host: broadcast - 1 for IPv4 up to /30, else the last address
+    constexpr Address last_host() const {
+        if constexpr (kBits == 32) {
+            if (length_ >= 31) return broadcast();
+            return broadcast() - 1;
+        } else {
+            return broadcast();
+        }
+    }
+
+    /// Usable IPv4 hosts: 2^(32 - length) - 2, 2 for /31, 0 for /32
+    /// (as FastNetworkUtils::count_usable_hosts)
+    constexpr uint64_t host_count() const
+        requires(kBits == 32)
+    {
+        if (length_ >= 31) return length_ == 31 ? 2 : 0;
+        return (uint64_t{1} << (32 - length_)) - 2;
+    }
+
+    constexpr BasicSubnetInfo<Address> analyze() const {
+        return {network_, first_host(), last_host(), broadcast()};
+    }
+
+    constexpr bool contains(Address address) const { return (address & mask()) == network_; }
+
+    /// True if `other` lies entirely inside this prefix
+    constexpr bool contains(const BasicPrefix& other) const {
+        return other.length_ >= length_ && contains(other.network_);
+    }
+
+    /// Ordered by network, then shorter prefixes first
+    constexpr auto operator<=>(const BasicPrefix&) const = default;
+
+private:
+    Address network_{};
+    uint8_t length_ = 0;
+};
+
+using Prefix = BasicPrefix<IPv4Address>;
+using IPv6Prefix = BasicPrefix<IPv6Address>;
+using SubnetInfo4 = BasicSubnetInfo<IPv4Address>;
+
+/**
+ * Compile-time literals; a malformed literal is a compile error.
+ * Example: "10.0.0.1"_ipv4, "10.0.0.0/8"_cidr, "2001:db8::1"_ipv6, "2001:db8::/32"_cidr6
+ */
+inline namespace address_literals {
+
+consteval IPv4Address operator""_ipv4(const char* text, size_t length) {
+    auto address = IPv4Address::parse({text, length});
+    if (!address) throw "invalid IPv4 literal";
+    return *address;
+}
+
+consteval Prefix operator""_cidr(const char* text, size_t length) {
+    auto prefix = Prefix::parse({text, length});
+    if (!prefix) throw "invalid CIDR literal (malformed, or host bits set)";
+    return *prefix;
+}
+
+consteval IPv6Address operator""_ipv6(const char* text, size_t length) {
+    auto address = IPv6Address::parse({text, length});
+    if (!address) throw "invalid IPv6 literal";
+    return *address;
+}
+
+consteval IPv6Prefix operator""_cidr6(const char* text, size_t length) {
+    auto prefix = IPv6Prefix::parse({text, length});
+    if (!prefix) throw "invalid IPv6 CIDR literal (malformed, or host bits set)";
+    return *prefix;
+}
+
+} // namespace address_literals
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
+#include <span>
 #include <cstdint>
 #include <optional>
 
@@ -58,6 +61,46 @@ public:
      */
     static std::string octet_to_binary(uint8_t octet);
 
+    // ============ Batch Conversion ============
+
+    /// Instruction set used by the batch conversions (lower levels are for testing)
+    enum class SimdLevel { Scalar, SSSE3, AVX2 };
+
+    /**
+     * Best batch kernel this CPU can run.
+     *
+     * @return AVX2, SSSE3 or Scalar
+     */
+    static SimdLevel detect_simd_level();
+
+    /**
+     * Convert many dotted decimal strings at once, with the same rules as
+     * is_valid_ipv4 (4 octets of 1-3 digits, each 0-255). Strings are
+     * validated and converted with SIMD shuffles; the CPU is checked at
+     * runtime and older ones use the scalar parser.
+     * Example: {"192.168.1.100", "10.0.0.1", "bad"} → {0xC0A80164, 0x0A000001, 0}, {true, true, false}
+     *
+     * @param ips Dotted decimal strings
+     * @param values Receives each address, or 0 if invalid; must be at least as long as ips
+     * @param valid Receives whether each string was a valid address; must be at least as long as ips
+     * @param level Highest instruction set to use
+     * @return Number of valid addresses
+     */
+    static size_t ipv4_to_uint32_batch(std::span<const std::string_view> ips, std::span<uint32_t> values,
+                                       std::span<bool> valid, SimdLevel level = SimdLevel::AVX2);
+
+    /**
+     * Format many addresses at once into fixed 16-byte, NUL-terminated slots.
+     * Example: {0xC0A80164} → {"192.168.1.100\0\0\0"}
+     *
+     * @param ips 32-bit addresses
+     * @param out Receives one NUL-padded string per address; must be at least as long as ips
+     * @param lengths If not empty, receives each string's length
+     * @param level Highest instruction set to use
+     */
+    static void uint32_to_ipv4_batch(std::span<const uint32_t> ips, std::span<std::array<char, 16>> out,
+                                     std::span<uint8_t> lengths = {}, SimdLevel level = SimdLevel::AVX2);
+
     // ============ Subnet Calculations ============
 
     /**
@@ -0,0 +1,316 @@
+#include "NetworkUtils.h"
+#include "FastNetworkUtils.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define NETWORK_UTILS_SIMD 1
+#endif
+#endif
+
+// ============ Batch Conversion ============
+//
+// Parsing: a dotted quad of 7-15 characters is loaded into one 16-byte
+// register. The positions of its dots (plus a bit at the end of the string)
+// form a mask that identifies the octet lengths; a multiplicative hash of
+// the mask selects a precomputed shuffle that right-aligns each octet's
+// digits into its own 4-byte lane, where maddubs/madd with weights
+// 100, 10, 1 turn them into the octet values. The stored mask is compared
+// against the real one, so any malformed layout (wrong dot count, empty or
+// over-long octet) is rejected.
+//
+// Formatting: octets are split into hundreds, tens and ones with
+// multiply-shift divisions, laid out as fixed "ddd.ddd.ddd.ddd", and a
+// shuffle chosen by the four digit counts drops the leading zeros.
+
+namespace {
+
+// Lengths of the four octets, 1-3 each: 81 layouts
+template<typename Fn>
+constexpr void for_each_layout(Fn&& fn) {
+    for (int a = 1; a <= 3; ++a)
+        for (int b = 1; b <= 3; ++b)
+            for (int c = 1; c <= 3; ++c)
+                for (int d = 1; d <= 3; ++d) fn(std::array<int, 4>{a, b, c, d});
+}
+
+struct ParsePattern {
+    uint8_t shuffle[16];
+    uint16_t mask;  // Dot positions plus the end bit; 0 = unused slot
+};
+
+constexpr uint32_t kLayoutHash = 0x00CF7800;
+
+constexpr size_t layout_slot(uint32_t mask) { return static_cast<uint32_t>(mask * kLayoutHash) >> 24; }
+
+constexpr std::array<ParsePattern, 256> kParsePatterns = [] {
+    std::array<ParsePattern, 256> table{};
+    for_each_layout([&](std::array<int, 4> lengths) {
+        ParsePattern p{};
+        for (auto& b : p.shuffle) b = 0x80;
+        uint32_t mask = 0;
+        int pos = 0;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < lengths[i]; ++j) p.shuffle[4 * i + 3 - lengths[i] + j] = static_cast<uint8_t>(pos + j);
+            pos += lengths[i];
+            mask |= 1u << pos;  // The dot after the octet, or the end of the string
+            ++pos;
+        }
+        p.mask = static_cast<uint16_t>(mask);
+        ParsePattern& slot = table[layout_slot(mask)];
+        if (slot.mask != 0) throw "layout hash collision";  // Fails constant evaluation
+        slot = p;
+    });
+    return table;
+}();
+
+// Digits an octet prints as, minus one
+constexpr std::array<uint8_t, 256> kDigitsMinusOne = [] {
+    std::array<uint8_t, 256> table{};
+    for (int v = 0; v < 256; ++v) table[v] = static_cast<uint8_t>((v >= 10) + (v >= 100));
+    return table;
+}();
+
+struct FormatPattern {
+    uint8_t shuffle[16];
+    uint8_t length;
+};
+
+// Indexed by the digit counts as base-3 digits; selects from "ddd.ddd.ddd.ddd"
+constexpr std::array<FormatPattern, 81> kFormatPatterns = [] {
+    std::array<FormatPattern, 81> table{};
+    for_each_layout([&](std::array<int, 4> lengths) {
+        FormatPattern p{};
+        for (auto& b : p.shuffle) b = 0x80;
+        int out = 0;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 3 - lengths[i]; j < 3; ++j) p.shuffle[out++] = static_cast<uint8_t>(4 * i + j);
+            if (i < 3) p.shuffle[out++] = static_cast<uint8_t>(4 * i + 3);
+        }
+        p.length = static_cast<uint8_t>(out);
+        table[(lengths[0] - 1) * 27 + (lengths[1] - 1) * 9 + (lengths[2] - 1) * 3 + (lengths[3] - 1)] = p;
+    });
+    return table;
+}();
+
+size_t format_index(uint32_t ip) {
+    return kDigitsMinusOne[ip >> 24] * 27u + kDigitsMinusOne[(ip >> 16) & 0xFF] * 9u +
+           kDigitsMinusOne[(ip >> 8) & 0xFF] * 3u + kDigitsMinusOne[ip & 0xFF];
+}
+
+bool parse_scalar(std::string_view ip, uint32_t& value) {
+    auto parsed = FastNetworkUtils::ipv4_to_uint32(ip);
+    value = parsed.value_or(0);
+    return parsed.has_value();
+}
+
+void format_scalar(uint32_t ip, std::array<char, 16>& out, uint8_t& length) {
+    out.fill('\0');
+    length = static_cast<uint8_t>(FastNetworkUtils::uint32_to_ipv4(ip, out));
+}
+
+#if defined(NETWORK_UTILS_SIMD)
+
+// The string, zero-padded to 16 bytes; caller checked 7 <= size <= 15
+__attribute__((target("ssse3"))) inline __m128i load_padded(std::string_view ip) {
+    alignas(16) char buffer[16] = {};
+    std::memcpy(buffer, ip.data(), ip.size());
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(buffer));
+}
+
+// Validate and convert one zero-padded string in the low 128 bits
+__attribute__((target("ssse3"))) inline bool parse_ssse3(__m128i input, size_t length, uint32_t& value) {
+    const __m128i digits = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    const __m128i is_dot = _mm_cmpeq_epi8(input, _mm_set1_epi8('.'));
+    uint32_t in_string = (1u << length) - 1;
+    uint32_t dots = static_cast<uint32_t>(_mm_movemask_epi8(is_dot)) & in_string;
+    uint32_t valid_chars = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(is_digit, is_dot)));
+    uint32_t mask = dots | (1u << length);
+    const ParsePattern& pattern = kParsePatterns[layout_slot(mask)];
+    if ((valid_chars & in_string) != in_string || pattern.mask != mask) return false;
+
+    const __m128i aligned = _mm_shuffle_epi8(digits, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.shuffle)));
+    const __m128i pairs = _mm_maddubs_epi16(aligned, _mm_set1_epi32(0x00010A64));  // 100, 10, 1, 0
+    const __m128i octets = _mm_madd_epi16(pairs, _mm_set1_epi16(1));
+    if (_mm_movemask_epi8(_mm_cmpgt_epi32(octets, _mm_set1_epi32(255)))) return false;
+    const __m128i packed = _mm_shuffle_epi8(octets, _mm_setr_epi8(12, 8, 4, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    value = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+    return true;
+}
+
+// Hundreds, tens and ones of each octet as bytes of "ddd.ddd.ddd.ddd"
+// (16-bit lane i of `octets` holds octet i)
+__attribute__((target("ssse3"))) inline __m128i fixed_width_ssse3(__m128i octets) {
+    const __m128i hundreds = _mm_srli_epi16(_mm_mullo_epi16(octets, _mm_set1_epi16(41)), 12);  // x / 100 for x < 1024
+    const __m128i rest = _mm_sub_epi16(octets, _mm_mullo_epi16(hundreds, _mm_set1_epi16(100)));
+    const __m128i tens = _mm_srli_epi16(_mm_mullo_epi16(rest, _mm_set1_epi16(205)), 11);  // x / 10 for x < 1029
+    const __m128i ones = _mm_sub_epi16(rest, _mm_mullo_epi16(tens, _mm_set1_epi16(10)));
+    const __m128i ht = _mm_or_si128(hundreds, _mm_slli_epi16(tens, 8));
+    const __m128i ud = _mm_or_si128(ones, _mm_set1_epi16('.' << 8));
+    return _mm_add_epi8(_mm_unpacklo_epi16(ht, ud), _mm_set1_epi32(0x00303030));  // '0' on the digits
+}
+
+__attribute__((target("ssse3"))) inline __m128i octet_lanes(uint32_t ip) {
+    // Octet 0 (the top byte) into 16-bit lane 0
+    return _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(__builtin_bswap32(ip))), _mm_setzero_si128());
+}
+
+__attribute__((target("ssse3"))) void format_ssse3(uint32_t ip, std::array<char, 16>& out, uint8_t& length) {
+    const FormatPattern& pattern = kFormatPatterns[format_index(ip)];
+    const __m128i text = _mm_shuffle_epi8(fixed_width_ssse3(octet_lanes(ip)),
+                                          _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.shuffle)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data()), text);
+    length = pattern.length;
+}
+
+__attribute__((target("ssse3"))) size_t parse_batch_ssse3(std::span<const std::string_view> ips, uint32_t* values,
+                                                          bool* valid) {
+    size_t count = 0;
+    for (size_t i = 0; i < ips.size(); ++i) {
+        size_t length = ips[i].size();
+        uint32_t value = 0;
+        bool ok = length >= 7 && length <= 15 && parse_ssse3(load_padded(ips[i]), length, value);
+        values[i] = ok ? value : 0;
+        valid[i] = ok;
+        count += ok;
+    }
+    return count;
+}
+
+// Two strings per iteration, one per 128-bit lane; vpshufb and the
+// multiply-adds never cross lanes, so each lane is the SSSE3 kernel
+__attribute__((target("avx2"))) size_t parse_batch_avx2(std::span<const std::string_view> ips, uint32_t* values,
+                                                        bool* valid) {
+    const __m256i zero_char = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i dot = _mm256_set1_epi8('.');
+    const __m256i weights = _mm256_set1_epi32(0x00010A64);
+    const __m256i ones16 = _mm256_set1_epi16(1);
+    const __m256i max_octet = _mm256_set1_epi32(255);
+    const __m256i pack = _mm256_setr_epi8(12, 8, 4, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                          12, 8, 4, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 2 <= ips.size(); i += 2) {
+        size_t len0 = ips[i].size(), len1 = ips[i + 1].size();
+        bool sized0 = len0 >= 7 && len0 <= 15, sized1 = len1 >= 7 && len1 <= 15;
+        alignas(32) char buffer[32] = {};
+        if (sized0) std::memcpy(buffer, ips[i].data(), len0);
+        if (sized1) std::memcpy(buffer + 16, ips[i + 1].data(), len1);
+        const __m256i input = _mm256_load_si256(reinterpret_cast<const __m256i*>(buffer));
+
+        const __m256i digits = _mm256_sub_epi8(input, zero_char);
+        const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, nine), digits);
+        const __m256i is_dot = _mm256_cmpeq_epi8(input, dot);
+        auto dots = static_cast<uint32_t>(_mm256_movemask_epi8(is_dot));
+        auto chars = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_dot)));
+
+        uint32_t in0 = sized0 ? (1u << len0) - 1 : 0, in1 = sized1 ? (1u << len1) - 1 : 0;
+        uint32_t mask0 = ((dots & 0xFFFF) & in0) | (1u << (sized0 ? len0 : 0));
+        uint32_t mask1 = ((dots >> 16) & in1) | (1u << (sized1 ? len1 : 0));
+        const ParsePattern& p0 = kParsePatterns[layout_slot(mask0)];
+        const ParsePattern& p1 = kParsePatterns[layout_slot(mask1)];
+        bool ok0 = sized0 && ((chars & 0xFFFF) & in0) == in0 && p0.mask == mask0;
+        bool ok1 = sized1 && ((chars >> 16) & in1) == in1 && p1.mask == mask1;
+
+        const __m256i shuffle = _mm256_loadu2_m128i(reinterpret_cast<const __m128i*>(p1.shuffle),
+                                                    reinterpret_cast<const __m128i*>(p0.shuffle));
+        const __m256i octets = _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_shuffle_epi8(digits, shuffle), weights), ones16);
+        auto too_big = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi32(octets, max_octet)));
+        ok0 = ok0 && (too_big & 0xFFFF) == 0;
+        ok1 = ok1 && (too_big >> 16) == 0;
+
+        const __m256i packed = _mm256_shuffle_epi8(octets, pack);
+        values[i] = ok0 ? static_cast<uint32_t>(_mm256_extract_epi32(packed, 0)) : 0;
+        values[i + 1] = ok1 ? static_cast<uint32_t>(_mm256_extract_epi32(packed, 4)) : 0;
+        valid[i] = ok0;
+        valid[i + 1] = ok1;
+        count += ok0 + ok1;
+    }
+    return count + parse_batch_ssse3(ips.subspan(i), values + i, valid + i);
+}
+
+__attribute__((target("avx2"))) void format_batch_avx2(std::span<const uint32_t> ips, std::array<char, 16>* out,
+                                                       uint8_t* lengths) {
+    size_t i = 0;
+    for (; i + 2 <= ips.size(); i += 2) {
+        const FormatPattern& p0 = kFormatPatterns[format_index(ips[i])];
+        const FormatPattern& p1 = kFormatPatterns[format_index(ips[i + 1])];
+        const __m256i octets = _mm256_cvtepu8_epi16(
+            _mm_unpacklo_epi32(_mm_cvtsi32_si128(static_cast<int>(__builtin_bswap32(ips[i]))),
+                               _mm_cvtsi32_si128(static_cast<int>(__builtin_bswap32(ips[i + 1])))));
+        // octets: lanes 0-3 = address i, lanes 4-7 = address i + 1 (both in
+        // the low 128 bits); move the second address to the high lane
+        const __m256i split = _mm256_permute4x64_epi64(octets, 0b01010000);
+        const __m256i hundreds = _mm256_srli_epi16(_mm256_mullo_epi16(split, _mm256_set1_epi16(41)), 12);
+        const __m256i rest = _mm256_sub_epi16(split, _mm256_mullo_epi16(hundreds, _mm256_set1_epi16(100)));
+        const __m256i tens = _mm256_srli_epi16(_mm256_mullo_epi16(rest, _mm256_set1_epi16(205)), 11);
+        const __m256i units = _mm256_sub_epi16(rest, _mm256_mullo_epi16(tens, _mm256_set1_epi16(10)));
+        const __m256i ht = _mm256_or_si256(hundreds, _mm256_slli_epi16(tens, 8));
+        const __m256i ud = _mm256_or_si256(units, _mm256_set1_epi16('.' << 8));
+        const __m256i fixed = _mm256_add_epi8(_mm256_unpacklo_epi16(ht, ud), _mm256_set1_epi32(0x00303030));
+        const __m256i shuffle = _mm256_loadu2_m128i(reinterpret_cast<const __m128i*>(p1.shuffle),
+                                                    reinterpret_cast<const __m128i*>(p0.shuffle));
+        const __m256i text = _mm256_shuffle_epi8(fixed, shuffle);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out[i].data()), _mm256_castsi256_si128(text));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out[i + 1].data()), _mm256_extracti128_si256(text, 1));
+        if (lengths) {
+            lengths[i] = p0.length;
+            lengths[i + 1] = p1.length;
+        }
+    }
+    uint8_t ignored;
+    for (; i < ips.size(); ++i) format_ssse3(ips[i], out[i], lengths ? lengths[i] : ignored);
+}
+
+#endif // NETWORK_UTILS_SIMD
+
+} // namespace
+
+NetworkUtils::SimdLevel NetworkUtils::detect_simd_level() {
+#if defined(NETWORK_UTILS_SIMD)
+    static const SimdLevel level = __builtin_cpu_supports("avx2")    ? SimdLevel::AVX2
+                                   : __builtin_cpu_supports("ssse3") ? SimdLevel::SSSE3
+                                                                     : SimdLevel::Scalar;
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+size_t NetworkUtils::ipv4_to_uint32_batch(std::span<const std::string_view> ips, std::span<uint32_t> values,
+                                          std::span<bool> valid, SimdLevel level) {
+    ips = ips.first(std::min({ips.size(), values.size(), valid.size()}));
+    level = std::min(level, detect_simd_level());
+#if defined(NETWORK_UTILS_SIMD)
+    if (level == SimdLevel::AVX2) return parse_batch_avx2(ips, values.data(), valid.data());
+    if (level == SimdLevel::SSSE3) return parse_batch_ssse3(ips, values.data(), valid.data());
+#endif
+    size_t count = 0;
+    for (size_t i = 0; i < ips.size(); ++i) {
+        valid[i] = parse_scalar(ips[i], values[i]);
+        count += valid[i];
+    }
+    return count;
+}
+
+void NetworkUtils::uint32_to_ipv4_batch(std::span<const uint32_t> ips, std::span<std::array<char, 16>> out,
+                                        std::span<uint8_t> lengths, SimdLevel level) {
+    ips = ips.first(std::min(ips.size(), out.size()));
+    uint8_t* length_out = lengths.size() >= ips.size() ? lengths.data() : nullptr;
+    level = std::min(level, detect_simd_level());
+#if defined(NETWORK_UTILS_SIMD)
+    if (level == SimdLevel::AVX2) return format_batch_avx2(ips, out.data(), length_out);
+    if (level == SimdLevel::SSSE3) {
+        uint8_t ignored;
+        for (size_t i = 0; i < ips.size(); ++i) format_ssse3(ips[i], out[i], length_out ? length_out[i] : ignored);
+        return;
+    }
+#endif
+    uint8_t ignored;
+    for (size_t i = 0; i < ips.size(); ++i) format_scalar(ips[i], out[i], length_out ? length_out[i] : ignored);
+}
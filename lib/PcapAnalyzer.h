@@ -0,0 +1,185 @@
+#pragma once
+
+#include "PcapReader.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pcap {
+
+// Per-protocol packet counters, cheap to keep one per thread and merge
+struct ProtocolStats {
+    uint64_t totalPackets = 0;
+    uint64_t totalBytes = 0;
+    uint64_t ethernet = 0;
+    uint64_t ipv4 = 0;
+    uint64_t ipv6 = 0;
+    uint64_t arp = 0;
+    uint64_t tcp = 0;
+    uint64_t udp = 0;
+    uint64_t icmp = 0;
+
+    void add(const Packet& packet, size_t bytes) {
+        ++totalPackets;
+        totalBytes += bytes;
+        ethernet += packet.isPacketOfType(Ethernet);
+        ipv4 += packet.isPacketOfType(IPv4);
+        ipv6 += packet.isPacketOfType(IPv6);
+        arp += packet.isPacketOfType(ARP);
+        tcp += packet.isPacketOfType(TCP);
+        udp += packet.isPacketOfType(UDP);
+        icmp += packet.isPacketOfType(ICMP);
+    }
+
+    ProtocolStats& operator+=(const ProtocolStats& other) {
+        totalPackets += other.totalPackets;
+        totalBytes += other.totalBytes;
+        ethernet += other.ethernet;
+        ipv4 += other.ipv4;
+        ipv6 += other.ipv6;
+        arp += other.arp;
+        tcp += other.tcp;
+        udp += other.udp;
+        icmp += other.icmp;
+        return *this;
+    }
+};
+
+struct ParallelOptions {
+    unsigned threads = 0;           // 0 = std::thread::hardware_concurrency()
+    size_t batchSize = 4096;        // Records handed to a worker at a time
+    size_t maxQueuedBatches = 0;    // 0 = 4 per worker; bounds the index memory
+};
+
+namespace detail {
+
+// Bounded multi-consumer queue of record batches
+class BatchQueue {
+private:
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::deque<std::vector<RawPacketView>> batches_;
+    size_t capacity_;
+    bool closed_ = false;
+
+public:
+    explicit BatchQueue(size_t capacity) : capacity_(capacity) {}
+
+    void push(std::vector<RawPacketView>&& batch) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [&] { return batches_.size() < capacity_; });
+        batches_.push_back(std::move(batch));
+        notEmpty_.notify_one();
+    }
+
+    bool pop(std::vector<RawPacketView>& batch) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [&] { return !batches_.empty() || closed_; });
+        if (batches_.empty()) return false;
+        batch = std::move(batches_.front());
+        batches_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+    }
+};
+
+} // namespace detail
+
+// Analyze a capture on several threads.
+//
+// The calling thread memory-maps the file and walks it once to find record
+// boundaries, handing batches of RawPacketViews to the workers. Each worker
+// parses its records into its own Stats and the per-thread results are
+// merged into `result` once every worker is done.
+//
+// Stats must be default constructible and provide operator+=. onPacket is
+// called as onPacket(Stats&, const Packet&, const RawPacketView&) from the
+// worker threads, concurrently, and must not throw. Records are not
+// delivered in file order.
+//
+// Falls back to a single-threaded pass when the file cannot be mapped.
+// Returns false if the file cannot be opened.
+template<typename Stats, typename Fn>
+bool analyzeParallel(const std::string& filename, Stats& result, Fn onPacket,
+                     const ParallelOptions& options = {}) {
+    std::unique_ptr<IFileReaderDevice> reader(IFileReaderDevice::getReader(filename, ReadMode::MemoryMapped));
+    if (!reader || !reader->open()) return false;
+
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    size_t batchSize = std::max<size_t>(1, options.batchSize);
+
+    if (threads == 1 || reader->getReadMode() != ReadMode::MemoryMapped) {
+        // Views into a stream reader's scratch buffer do not outlive the next
+        // read, so they cannot be handed to other threads
+        Stats local;
+        RawPacketView view;
+        while (reader->getNextPacket(view)) {
+            onPacket(local, Packet(view), view);
+        }
+        result += local;
+        return true;
+    }
+
+    detail::BatchQueue queue(options.maxQueuedBatches ? options.maxQueuedBatches : 4 * threads);
+    std::vector<Stats> perThread(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            // Accumulate on the worker's own stack; writing straight into
+            // perThread[t] would false-share cache lines with the neighbours
+            Stats local;
+            std::vector<RawPacketView> batch;
+            while (queue.pop(batch)) {
+                for (const RawPacketView& view : batch) {
+                    onPacket(local, Packet(view), view);
+                }
+            }
+            perThread[t] = std::move(local);
+        });
+    }
+
+    std::vector<RawPacketView> batch;
+    batch.reserve(batchSize);
+    RawPacketView view;
+    while (reader->getNextPacket(view)) {
+        batch.push_back(view);
+        if (batch.size() == batchSize) {
+            queue.push(std::move(batch));
+            batch = std::vector<RawPacketView>();
+            batch.reserve(batchSize);
+        }
+    }
+    if (!batch.empty()) queue.push(std::move(batch));
+    queue.close();
+
+    for (auto& worker : workers) worker.join();
+    for (const auto& stats : perThread) result += stats;
+    return true;
+}
+
+// Convenience overload: per-protocol counters for the whole capture
+inline bool analyzeParallel(const std::string& filename, ProtocolStats& result,
+                            const ParallelOptions& options = {}) {
+    return analyzeParallel(filename, result, [](ProtocolStats& stats, const Packet& packet, const RawPacketView& view) {
+        stats.add(packet, view.getDataLen());
+    }, options);
+}
+
+} // namespace pcap
@@ -0,0 +1,314 @@
+#pragma once
+
+#include "PcapReader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#define PCAP_CLASSIFY_X86 1
+#endif
+
+namespace pcap {
+
+// One bit per protocol isPacketOfType() can report
+using ProtocolMask = uint8_t;
+
+enum ProtocolBit : ProtocolMask {
+    MaskEthernet = 1 << 0,
+    MaskIPv4 = 1 << 1,
+    MaskIPv6 = 1 << 2,
+    MaskARP = 1 << 3,
+    MaskTCP = 1 << 4,
+    MaskUDP = 1 << 5,
+    MaskICMP = 1 << 6
+};
+
+inline ProtocolMask protocolBit(ProtocolType type) {
+    switch (type) {
+        case Ethernet: return MaskEthernet;
+        case IPv4: return MaskIPv4;
+        case IPv6: return MaskIPv6;
+        case ARP: return MaskARP;
+        case TCP: return MaskTCP;
+        case UDP: return MaskUDP;
+        case ICMP: return MaskICMP;
+        default: return 0;
+    }
+}
+
+// Mask-based equivalent of Packet::isPacketOfType()
+inline bool isMaskOfType(ProtocolMask mask, ProtocolType type) {
+    return (mask & protocolBit(type)) != 0;
+}
+
+inline ProtocolMask protocolMaskOf(const Packet& packet) {
+    ProtocolMask mask = 0;
+    for (ProtocolType type : {Ethernet, IPv4, IPv6, ARP, TCP, UDP, ICMP}) {
+        if (packet.isPacketOfType(type)) mask |= protocolBit(type);
+    }
+    return mask;
+}
+
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+// Best kernel this CPU can run
+inline SimdLevel detectSimdLevel() {
+#if defined(PCAP_CLASSIFY_X86) && (defined(__GNUC__) || defined(__clang__))
+    static const SimdLevel level = __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE2;
+    return level;
+#elif defined(PCAP_CLASSIFY_X86)
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+namespace detail {
+
+// Structure-of-arrays staging for one chunk of packets. Every field is a
+// 16-bit lane so the kernels can compare 8 (SSE2) or 16 (AVX2) packets at once.
+struct ClassifyLanes {
+    static constexpr size_t kChunk = 256;
+
+    alignas(32) uint16_t len[kChunk];        // Captured length, saturated to 0xFFFF
+    alignas(32) uint16_t etherType[kChunk];  // Bytes 12-13
+    alignas(32) uint16_t l4Offset[kChunk];   // 14 + IPv4 IHL * 4
+    alignas(32) uint16_t ipv4Proto[kChunk];  // Byte 23: IPv4 protocol
+    alignas(32) uint16_t ipv6Next[kChunk];   // Byte 20: IPv6 next header
+    alignas(32) uint16_t eligible[kChunk];   // 0xFFFF for plain Ethernet lanes, 0 for the slow path
+};
+
+// Untagged Ethernet frames take the vector path; everything else (other link
+// types, VLAN tags) is re-parsed by Packet so the flags stay identical
+template<typename PacketT>
+inline void gatherLanes(const PacketT* packets, size_t count, ClassifyLanes& lanes) {
+    constexpr size_t kHeaderBytes = 24;  // Through the IPv4 protocol byte
+    uint8_t padded[kHeaderBytes];
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* d = packets[i].getData();
+        size_t len = packets[i].getDataLen();
+        if (len < kHeaderBytes) {
+            // Short frames read zeros past the end; the length bounds in the
+            // kernels reject whatever those zeros would otherwise imply
+            std::memset(padded, 0, sizeof(padded));
+            if (len) std::memcpy(padded, d, len);
+            d = padded;
+        }
+        bool ethernet = packets[i].linkType == 1;
+        uint16_t et = ethernet ? loadBE16(d + 12) : 0;
+        lanes.len[i] = static_cast<uint16_t>(len > 0xFFFF ? 0xFFFF : len);
+        lanes.etherType[i] = et;
+        lanes.l4Offset[i] = static_cast<uint16_t>(14 + (d[14] & 0x0F) * 4);
+        lanes.ipv4Proto[i] = d[23];
+        lanes.ipv6Next[i] = d[20];
+        lanes.eligible[i] = (ethernet && et != 0x8100) ? 0xFFFF : 0;
+    }
+}
+
+// IPv6 next headers that start an extension header chain
+inline bool isIPv6Extension(uint16_t nextHeader) {
+    return nextHeader == 0 || nextHeader == 43 || nextHeader == 44 || nextHeader == 51 || nextHeader == 60;
+}
+
+// Reference lane math for [from, count); the vector kernels compute the same
+// thing eight or sixteen lanes at a time
+inline void classifyLanesScalar(const ClassifyLanes& l, size_t from, size_t count, ProtocolMask* out) {
+    for (size_t i = from; i < count; ++i) {
+        uint16_t len = l.len[i];
+        uint16_t et = l.etherType[i];
+        bool eth = len >= 14 && (et == 0x0800 || et == 0x0806 || et == 0x86DD || et == 0x8035);
+        bool v4 = eth && et == 0x0800 && len >= 34;
+        bool v6 = eth && et == 0x86DD && len >= 54;
+        uint16_t off = l.l4Offset[i];
+        uint16_t p = l.ipv4Proto[i];
+        uint16_t nh = l.ipv6Next[i];
+
+        ProtocolMask m = 0;
+        if (eth) m |= MaskEthernet;
+        if (v4) m |= MaskIPv4;
+        if (v6) m |= MaskIPv6;
+        if (eth && et == 0x0806) m |= MaskARP;
+        if ((v4 && p == 6 && off + 20 <= len) || (v6 && nh == 6 && len >= 74)) m |= MaskTCP;
+        if ((v4 && p == 17 && off + 8 <= len) || (v6 && nh == 17 && len >= 62)) m |= MaskUDP;
+        if ((v4 && p == 1) || (v6 && nh == 58 && len > 54)) m |= MaskICMP;
+        out[i] = m;
+    }
+}
+
+#if defined(PCAP_CLASSIFY_X86)
+
+// Unsigned 16-bit a <= b, which SSE2 lacks: saturating a - b is zero
+inline __m128i le16(__m128i a, __m128i b) {
+    return _mm_cmpeq_epi16(_mm_subs_epu16(a, b), _mm_setzero_si128());
+}
+
+// Pack eight 16-bit lane masks (0 or 0xFFFF) into bytes holding `bit`
+inline __m128i select8(__m128i laneMask16, ProtocolMask bit) {
+    return _mm_and_si128(laneMask16, _mm_set1_epi16(bit));
+}
+
+// Also finishes the tail the AVX2 kernel leaves behind
+inline size_t classifyLanesSSE2(const ClassifyLanes& l, size_t from, size_t count, ProtocolMask* out) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = from;
+    for (; i + 8 <= count; i += 8) {
+        __m128i len = _mm_load_si128(reinterpret_cast<const __m128i*>(l.len + i));
+        __m128i et = _mm_load_si128(reinterpret_cast<const __m128i*>(l.etherType + i));
+        __m128i off = _mm_load_si128(reinterpret_cast<const __m128i*>(l.l4Offset + i));
+        __m128i p = _mm_load_si128(reinterpret_cast<const __m128i*>(l.ipv4Proto + i));
+        __m128i nh = _mm_load_si128(reinterpret_cast<const __m128i*>(l.ipv6Next + i));
+
+        __m128i isV4Type = _mm_cmpeq_epi16(et, _mm_set1_epi16(0x0800));
+        __m128i isArpType = _mm_cmpeq_epi16(et, _mm_set1_epi16(0x0806));
+        __m128i isV6Type = _mm_cmpeq_epi16(et, _mm_set1_epi16(static_cast<short>(0x86DD)));
+        __m128i isRarpType = _mm_cmpeq_epi16(et, _mm_set1_epi16(static_cast<short>(0x8035)));
+        __m128i eth = _mm_and_si128(le16(_mm_set1_epi16(14), len),
+                                    _mm_or_si128(_mm_or_si128(isV4Type, isArpType), _mm_or_si128(isV6Type, isRarpType)));
+        __m128i v4 = _mm_and_si128(_mm_and_si128(eth, isV4Type), le16(_mm_set1_epi16(34), len));
+        __m128i v6 = _mm_and_si128(_mm_and_si128(eth, isV6Type), le16(_mm_set1_epi16(54), len));
+
+        __m128i tcp = _mm_or_si128(
+            _mm_and_si128(_mm_and_si128(v4, _mm_cmpeq_epi16(p, _mm_set1_epi16(6))),
+                          le16(_mm_add_epi16(off, _mm_set1_epi16(20)), len)),
+            _mm_and_si128(_mm_and_si128(v6, _mm_cmpeq_epi16(nh, _mm_set1_epi16(6))),
+                          le16(_mm_set1_epi16(74), len)));
+        __m128i udp = _mm_or_si128(
+            _mm_and_si128(_mm_and_si128(v4, _mm_cmpeq_epi16(p, _mm_set1_epi16(17))),
+                          le16(_mm_add_epi16(off, _mm_set1_epi16(8)), len)),
+            _mm_and_si128(_mm_and_si128(v6, _mm_cmpeq_epi16(nh, _mm_set1_epi16(17))),
+                          le16(_mm_set1_epi16(62), len)));
+        __m128i icmp = _mm_or_si128(
+            _mm_and_si128(v4, _mm_cmpeq_epi16(p, _mm_set1_epi16(1))),
+            _mm_and_si128(_mm_and_si128(v6, _mm_cmpeq_epi16(nh, _mm_set1_epi16(58))),
+                          le16(_mm_set1_epi16(55), len)));
+
+        __m128i m = _mm_or_si128(_mm_or_si128(select8(eth, MaskEthernet), select8(v4, MaskIPv4)),
+                                 _mm_or_si128(select8(v6, MaskIPv6), select8(_mm_and_si128(eth, isArpType), MaskARP)));
+        m = _mm_or_si128(m, _mm_or_si128(_mm_or_si128(select8(tcp, MaskTCP), select8(udp, MaskUDP)),
+                                         select8(icmp, MaskICMP)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(m, zero));
+    }
+    return i;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+
+__attribute__((target("avx2"))) inline __m256i le16x16(__m256i a, __m256i b) {
+    return _mm256_cmpeq_epi16(_mm256_subs_epu16(a, b), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2"))) inline __m256i select16(__m256i laneMask16, ProtocolMask bit) {
+    return _mm256_and_si256(laneMask16, _mm256_set1_epi16(bit));
+}
+
+__attribute__((target("avx2"))) inline size_t classifyLanesAVX2(const ClassifyLanes& l, size_t from,
+                                                                  size_t count, ProtocolMask* out) {
+    size_t i = from;
+    for (; i + 16 <= count; i += 16) {
+        __m256i len = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.len + i));
+        __m256i et = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.etherType + i));
+        __m256i off = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.l4Offset + i));
+        __m256i p = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.ipv4Proto + i));
+        __m256i nh = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.ipv6Next + i));
+
+        __m256i isV4Type = _mm256_cmpeq_epi16(et, _mm256_set1_epi16(0x0800));
+        __m256i isArpType = _mm256_cmpeq_epi16(et, _mm256_set1_epi16(0x0806));
+        __m256i isV6Type = _mm256_cmpeq_epi16(et, _mm256_set1_epi16(static_cast<short>(0x86DD)));
+        __m256i isRarpType = _mm256_cmpeq_epi16(et, _mm256_set1_epi16(static_cast<short>(0x8035)));
+        __m256i eth = _mm256_and_si256(le16x16(_mm256_set1_epi16(14), len),
+                                       _mm256_or_si256(_mm256_or_si256(isV4Type, isArpType),
+                                                       _mm256_or_si256(isV6Type, isRarpType)));
+        __m256i v4 = _mm256_and_si256(_mm256_and_si256(eth, isV4Type), le16x16(_mm256_set1_epi16(34), len));
+        __m256i v6 = _mm256_and_si256(_mm256_and_si256(eth, isV6Type), le16x16(_mm256_set1_epi16(54), len));
+
+        __m256i tcp = _mm256_or_si256(
+            _mm256_and_si256(_mm256_and_si256(v4, _mm256_cmpeq_epi16(p, _mm256_set1_epi16(6))),
+                             le16x16(_mm256_add_epi16(off, _mm256_set1_epi16(20)), len)),
+            _mm256_and_si256(_mm256_and_si256(v6, _mm256_cmpeq_epi16(nh, _mm256_set1_epi16(6))),
+                             le16x16(_mm256_set1_epi16(74), len)));
+        __m256i udp = _mm256_or_si256(
+            _mm256_and_si256(_mm256_and_si256(v4, _mm256_cmpeq_epi16(p, _mm256_set1_epi16(17))),
+                             le16x16(_mm256_add_epi16(off, _mm256_set1_epi16(8)), len)),
+            _mm256_and_si256(_mm256_and_si256(v6, _mm256_cmpeq_epi16(nh, _mm256_set1_epi16(17))),
+                             le16x16(_mm256_set1_epi16(62), len)));
+        __m256i icmp = _mm256_or_si256(
+            _mm256_and_si256(v4, _mm256_cmpeq_epi16(p, _mm256_set1_epi16(1))),
+            _mm256_and_si256(_mm256_and_si256(v6, _mm256_cmpeq_epi16(nh, _mm256_set1_epi16(58))),
+                             le16x16(_mm256_set1_epi16(55), len)));
+
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(select16(eth, MaskEthernet), select16(v4, MaskIPv4)),
+            _mm256_or_si256(select16(v6, MaskIPv6), select16(_mm256_and_si256(eth, isArpType), MaskARP)));
+        m = _mm256_or_si256(m, _mm256_or_si256(_mm256_or_si256(select16(tcp, MaskTCP), select16(udp, MaskUDP)),
+                                               select16(icmp, MaskICMP)));
+        // Narrow 16 x u16 to 16 x u8: pack within lanes, then fix the lane order
+        __m256i packed = _mm256_packus_epi16(m, _mm256_setzero_si256());
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(packed));
+    }
+    return i;
+}
+
+#endif // __GNUC__ || __clang__
+#endif // PCAP_CLASSIFY_X86
+
+template<typename PacketT>
+inline void classifyBatchImpl(std::span<const PacketT> packets, std::span<ProtocolMask> masks, SimdLevel level) {
+    size_t total = std::min(packets.size(), masks.size());
+    SimdLevel supported = detectSimdLevel();
+    if (static_cast<int>(level) > static_cast<int>(supported)) level = supported;
+
+    ClassifyLanes lanes;
+    for (size_t base = 0; base < total; base += ClassifyLanes::kChunk) {
+        size_t count = std::min(ClassifyLanes::kChunk, total - base);
+        const PacketT* chunk = packets.data() + base;
+        ProtocolMask* out = masks.data() + base;
+        gatherLanes(chunk, count, lanes);
+
+        size_t done = 0;
+#if defined(PCAP_CLASSIFY_X86)
+#if defined(__GNUC__) || defined(__clang__)
+        if (level == SimdLevel::AVX2) done = classifyLanesAVX2(lanes, done, count, out);
+#endif
+        if (level != SimdLevel::Scalar) done = classifyLanesSSE2(lanes, done, count, out);
+#endif
+        classifyLanesScalar(lanes, done, count, out);
+
+        // Slow path: VLAN tags, non-Ethernet link types, IPv6 extension headers
+        for (size_t i = 0; i < count; ++i) {
+            bool ipv6Chain = (out[i] & MaskIPv6) && isIPv6Extension(lanes.ipv6Next[i]);
+            if (!lanes.eligible[i] || ipv6Chain) {
+                if constexpr (std::is_same_v<PacketT, RawPacket>) {
+                    out[i] = protocolMaskOf(Packet(&chunk[i]));
+                } else {
+                    out[i] = protocolMaskOf(Packet(chunk[i]));
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+// Classify a batch of packets at once. masks[i] gets the protocol bits of
+// packets[i], exactly matching Packet(&packets[i]).isPacketOfType(...).
+// Plain Ethernet frames are decoded with SSE2/AVX2 compares over a
+// structure-of-arrays copy of their header fields; VLAN-tagged frames,
+// Linux cooked captures and IPv6 extension header chains fall back to
+// Packet. `level` caps the instruction set (mainly for testing).
+inline void classifyBatch(std::span<const RawPacket> packets, std::span<ProtocolMask> masks,
+                          SimdLevel level = SimdLevel::AVX2) {
+    detail::classifyBatchImpl(packets, masks, level);
+}
+
+inline void classifyBatch(std::span<const RawPacketView> packets, std::span<ProtocolMask> masks,
+                          SimdLevel level = SimdLevel::AVX2) {
+    detail::classifyBatchImpl(packets, masks, level);
+}
+
+} // namespace pcap
@@ -0,0 +1,733 @@
+#pragma once
+
+#include "PcapReader.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace pcap {
+
+// ============ Columnar packet metadata ============
+//
+// Decoded header fields of every packet in a capture, stored column by
+// column in row groups of a fixed size. Each column chunk is encoded on its
+// own with whichever of plain, run-length, dictionary (bit-packed indices)
+// or delta (zigzag varints) comes out smallest, so constant columns such as
+// the link type shrink to a few bytes and timestamps to one or two bytes per
+// row. The footer records where every chunk lives, so a scan reads and
+// decodes only the columns it asks for.
+//
+// File layout (host byte order, like the capture index sidecar):
+//   header   magic "PCOL", version, row group size, column count
+//   chunks   per row group, per column: encoding byte + encoded values
+//   footer   per row group: rows, min/max timestamp, per column offset + size
+//   trailer  footer offset, magic
+
+using Address16 = std::array<uint8_t, 16>;
+
+enum class Column : uint8_t {
+    Timestamp,   // Microseconds since the epoch
+    LinkType,
+    L3Protocol,  // EtherType: 0x0800 IPv4, 0x86DD IPv6, 0x0806 ARP, 0 unknown
+    L4Protocol,  // IP protocol / next header: 6 TCP, 17 UDP, 1 ICMP, 58 ICMPv6
+    SrcAddr,     // IPv4 in the last 4 bytes, as in FlowKey
+    DstAddr,
+    SrcPort,
+    DstPort,
+    Length,      // Captured bytes
+    IPLength,    // IPv4 total length, or 40 + IPv6 payload length
+    TTL,         // TTL / hop limit
+    TCPFlags,
+    IPFlags,     // PacketRow::DontFragment | MoreFragments | NonFirstFragment
+    Count
+};
+
+using ColumnMask = uint32_t;
+
+constexpr ColumnMask columnBit(Column c) { return ColumnMask{1} << static_cast<unsigned>(c); }
+constexpr ColumnMask kAllColumns = (ColumnMask{1} << static_cast<unsigned>(Column::Count)) - 1;
+
+// One packet's worth of exported fields
+struct PacketRow {
+    static constexpr uint8_t DontFragment = 0x01;
+    static constexpr uint8_t MoreFragments = 0x02;
+    static constexpr uint8_t NonFirstFragment = 0x04;
+
+    uint64_t timestampUsec = 0;
+    uint32_t linkType = 1;
+    uint16_t l3Protocol = 0;
+    uint8_t l4Protocol = 0;
+    Address16 srcAddr{};
+    Address16 dstAddr{};
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    uint32_t length = 0;
+    uint16_t ipLength = 0;
+    uint8_t ttl = 0;
+    uint8_t tcpFlags = 0;
+    uint8_t ipFlags = 0;
+
+    bool operator==(const PacketRow&) const = default;
+
+    static PacketRow fromPacket(const Packet& packet, uint64_t timestampUsec, size_t capturedBytes,
+                                uint32_t linkType) {
+        PacketRow row;
+        row.timestampUsec = timestampUsec;
+        row.linkType = linkType;
+        row.length = static_cast<uint32_t>(capturedBytes);
+        if (const IPv4View* ip = packet.getLayerOfType<IPv4View>()) {
+            row.l3Protocol = 0x0800;
+            row.l4Protocol = ip->protocol();
+            std::memcpy(row.srcAddr.data() + 12, ip->getData() + 12, 4);
+            std::memcpy(row.dstAddr.data() + 12, ip->getData() + 16, 4);
+            row.ipLength = ip->totalLength();
+            row.ttl = ip->ttl();
+            row.ipFlags = static_cast<uint8_t>((ip->dontFragment() ? DontFragment : 0) |
+                                               (ip->moreFragments() ? MoreFragments : 0) |
+                                               (ip->fragmentOffset() != 0 ? NonFirstFragment : 0));
+        } else if (const IPv6View* ip6 = packet.getLayerOfType<IPv6View>()) {
+            row.l3Protocol = 0x86DD;
+            row.l4Protocol = ip6->nextHeader();
+            std::memcpy(row.srcAddr.data(), ip6->srcAddress(), 16);
+            std::memcpy(row.dstAddr.data(), ip6->dstAddress(), 16);
+            row.ipLength = static_cast<uint16_t>(40 + ip6->payloadLength());
+            row.ttl = ip6->hopLimit();
+        } else if (packet.isPacketOfType(ARP)) {
+            row.l3Protocol = 0x0806;
+        } else if (const EthernetView* eth = packet.getLayerOfType<EthernetView>()) {
+            row.l3Protocol = eth->etherType();
+        }
+
+        // Packet follows IPv6 extension headers, so trust its transport layer
+        if (const TCPView* tcp = packet.getLayerOfType<TCPView>()) {
+            row.l4Protocol = 6;
+            row.srcPort = tcp->srcPort();
+            row.dstPort = tcp->dstPort();
+            row.tcpFlags = tcp->flags();
+        } else if (const UDPView* udp = packet.getLayerOfType<UDPView>()) {
+            row.l4Protocol = 17;
+            row.srcPort = udp->srcPort();
+            row.dstPort = udp->dstPort();
+        } else if (packet.isPacketOfType(ICMP) && row.l3Protocol == 0x86DD) {
+            row.l4Protocol = 58;
+        }
+        return row;
+    }
+
+    static PacketRow fromPacket(const RawPacketView& view) {
+        return fromPacket(Packet(view), static_cast<uint64_t>(view.timestamp_sec) * 1000000 + view.timestamp_usec,
+                          view.length, view.linkType);
+    }
+
+    static PacketRow fromPacket(const RawPacket& raw) {
+        return fromPacket(Packet(&raw), static_cast<uint64_t>(raw.timestamp_sec) * 1000000 + raw.timestamp_usec,
+                          raw.getDataLen(), raw.linkType);
+    }
+};
+
+// Rows of one row group, one vector per column. Columns left out of a read
+// stay empty.
+struct ColumnBatch {
+    std::vector<uint64_t> timestampUsec;
+    std::vector<uint32_t> linkType;
+    std::vector<uint16_t> l3Protocol;
+    std::vector<uint8_t> l4Protocol;
+    std::vector<Address16> srcAddr;
+    std::vector<Address16> dstAddr;
+    std::vector<uint16_t> srcPort;
+    std::vector<uint16_t> dstPort;
+    std::vector<uint32_t> length;
+    std::vector<uint16_t> ipLength;
+    std::vector<uint8_t> ttl;
+    std::vector<uint8_t> tcpFlags;
+    std::vector<uint8_t> ipFlags;
+    size_t rows = 0;
+
+    // Call fn(Column, std::vector<T>&) for every column, in Column order
+    template<typename Fn>
+    void forEachColumn(Fn&& fn) {
+        fn(Column::Timestamp, timestampUsec);
+        fn(Column::LinkType, linkType);
+        fn(Column::L3Protocol, l3Protocol);
+        fn(Column::L4Protocol, l4Protocol);
+        fn(Column::SrcAddr, srcAddr);
+        fn(Column::DstAddr, dstAddr);
+        fn(Column::SrcPort, srcPort);
+        fn(Column::DstPort, dstPort);
+        fn(Column::Length, length);
+        fn(Column::IPLength, ipLength);
+        fn(Column::TTL, ttl);
+        fn(Column::TCPFlags, tcpFlags);
+        fn(Column::IPFlags, ipFlags);
+    }
+
+    void clear() {
+        forEachColumn([](Column, auto& values) { values.clear(); });
+        rows = 0;
+    }
+
+    void append(const PacketRow& row) {
+        timestampUsec.push_back(row.timestampUsec);
+        linkType.push_back(row.linkType);
+        l3Protocol.push_back(row.l3Protocol);
+        l4Protocol.push_back(row.l4Protocol);
+        srcAddr.push_back(row.srcAddr);
+        dstAddr.push_back(row.dstAddr);
+        srcPort.push_back(row.srcPort);
+        dstPort.push_back(row.dstPort);
+        length.push_back(row.length);
+        ipLength.push_back(row.ipLength);
+        ttl.push_back(row.ttl);
+        tcpFlags.push_back(row.tcpFlags);
+        ipFlags.push_back(row.ipFlags);
+        ++rows;
+    }
+
+    // Reassemble a row; only meaningful when every column was read
+    PacketRow row(size_t i) const {
+        return {timestampUsec[i], linkType[i], l3Protocol[i], l4Protocol[i], srcAddr[i], dstAddr[i],
+                srcPort[i],       dstPort[i],  length[i],     ipLength[i],   ttl[i],     tcpFlags[i],
+                ipFlags[i]};
+    }
+};
+
+namespace detail {
+
+enum class ColumnEncoding : uint8_t { Plain, RLE, Dictionary, Delta };
+
+struct Address16Hash {
+    size_t operator()(const Address16& a) const {
+        uint64_t w[2];
+        std::memcpy(w, a.data(), 16);
+        return static_cast<size_t>((w[0] * 0x9E3779B97F4A7C15ULL) ^ (w[1] + (w[1] >> 29)) * 0xBF58476D1CE4E5B9ULL);
+    }
+};
+
+inline void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+// Bounds-checked cursor over an encoded chunk
+struct ChunkCursor {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    bool varint(uint64_t& v) {
+        v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (p == end) return false;
+            uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    template<typename T>
+    bool value(T& v) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+};
+
+template<typename T>
+void putValue(std::vector<uint8_t>& out, const T& v) {
+    const auto* b = reinterpret_cast<const uint8_t*>(&v);
+    out.insert(out.end(), b, b + sizeof(T));
+}
+
+template<typename T>
+void encodePlain(const std::vector<T>& values, std::vector<uint8_t>& out) {
+    const auto* b = reinterpret_cast<const uint8_t*>(values.data());
+    out.insert(out.end(), b, b + values.size() * sizeof(T));
+}
+
+inline size_t varintSize(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+inline uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ (~(delta >> 63) + 1);
+}
+
+template<typename T>
+size_t rleSize(const std::vector<T>& values) {
+    size_t size = 0;
+    for (size_t i = 0; i < values.size();) {
+        size_t j = i + 1;
+        while (j < values.size() && values[j] == values[i]) ++j;
+        size += varintSize(j - i) + sizeof(T);
+        i = j;
+    }
+    return size;
+}
+
+template<typename T>
+void encodeRLE(const std::vector<T>& values, std::vector<uint8_t>& out) {
+    for (size_t i = 0; i < values.size();) {
+        size_t j = i + 1;
+        while (j < values.size() && values[j] == values[i]) ++j;
+        putVarint(out, j - i);
+        putValue(out, values[i]);
+        i = j;
+    }
+}
+
+// Distinct values in first-seen order and each row's index into them. Gives
+// up (returns false) past `maxEntries` distinct values.
+template<typename T>
+bool buildDictionary(const std::vector<T>& values, size_t maxEntries, std::vector<T>& dictionary,
+                     std::vector<uint32_t>& indices) {
+    dictionary.clear();
+    indices.clear();
+    indices.reserve(values.size());
+    if constexpr (std::is_integral_v<T> && sizeof(T) <= 2) {
+        // Small value space: a direct lookup table beats hashing
+        std::vector<int32_t> ids(size_t{1} << (8 * sizeof(T)), -1);
+        for (T v : values) {
+            int32_t& id = ids[v];
+            if (id < 0) {
+                if (dictionary.size() == maxEntries) return false;
+                id = static_cast<int32_t>(dictionary.size());
+                dictionary.push_back(v);
+            }
+            indices.push_back(static_cast<uint32_t>(id));
+        }
+    } else {
+        using Hash = std::conditional_t<std::is_same_v<T, Address16>, Address16Hash, std::hash<T>>;
+        std::unordered_map<T, uint32_t, Hash> ids;
+        for (const T& v : values) {
+            auto [it, inserted] = ids.try_emplace(v, static_cast<uint32_t>(dictionary.size()));
+            if (inserted) {
+                if (dictionary.size() == maxEntries) return false;
+                dictionary.push_back(v);
+            }
+            indices.push_back(it->second);
+        }
+    }
+    return true;
+}
+
+inline unsigned indexWidth(size_t dictionarySize) {
+    unsigned width = 0;
+    while ((size_t{1} << width) < dictionarySize) ++width;
+    return width;
+}
+
+template<typename T>
+size_t dictionarySize(const std::vector<T>& dictionary, size_t rows) {
+    return varintSize(dictionary.size()) + dictionary.size() * sizeof(T) + 1 +
+           (rows * indexWidth(dictionary.size()) + 7) / 8;
+}
+
+// Dictionary of distinct values, then indices bit-packed LSB first at the
+// narrowest width
+template<typename T>
+void encodeDictionary(const std::vector<T>& dictionary, const std::vector<uint32_t>& indices,
+                      std::vector<uint8_t>& out) {
+    unsigned width = indexWidth(dictionary.size());
+    putVarint(out, dictionary.size());
+    encodePlain(dictionary, out);
+    out.push_back(static_cast<uint8_t>(width));
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    for (uint32_t index : indices) {
+        acc |= static_cast<uint64_t>(index) << bits;
+        bits += width;
+        while (bits >= 8) {
+            out.push_back(static_cast<uint8_t>(acc));
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits > 0) out.push_back(static_cast<uint8_t>(acc));
+}
+
+// Zigzag varint differences from 0 (wrapping, so any unsigned width works)
+template<typename T>
+size_t deltaSize(const std::vector<T>& values) {
+    size_t size = 0;
+    uint64_t prev = 0;
+    for (const T& v : values) {
+        size += varintSize(zigzag(static_cast<uint64_t>(v) - prev));
+        prev = static_cast<uint64_t>(v);
+    }
+    return size;
+}
+
+template<typename T>
+void encodeDelta(const std::vector<T>& values, std::vector<uint8_t>& out) {
+    uint64_t prev = 0;
+    for (const T& v : values) {
+        putVarint(out, zigzag(static_cast<uint64_t>(v) - prev));
+        prev = static_cast<uint64_t>(v);
+    }
+}
+
+// Size every encoding cheaply, then write only the smallest. The dictionary
+// is abandoned as soon as its values alone outgrow the best size so far.
+template<typename T>
+void encodeColumn(const std::vector<T>& values, std::vector<uint8_t>& out) {
+    ColumnEncoding best = ColumnEncoding::Plain;
+    size_t bestSize = values.size() * sizeof(T);
+    auto consider = [&](ColumnEncoding encoding, size_t size) {
+        if (size < bestSize) {
+            best = encoding;
+            bestSize = size;
+        }
+    };
+    consider(ColumnEncoding::RLE, rleSize(values));
+    if constexpr (std::is_integral_v<T>) consider(ColumnEncoding::Delta, deltaSize(values));
+
+    std::vector<T> dictionary;
+    std::vector<uint32_t> indices;
+    size_t maxEntries = std::min<size_t>(65536, bestSize / sizeof(T));
+    if (buildDictionary(values, maxEntries, dictionary, indices)) {
+        consider(ColumnEncoding::Dictionary, dictionarySize(dictionary, values.size()));
+    }
+
+    out.reserve(out.size() + 1 + bestSize);
+    out.push_back(static_cast<uint8_t>(best));
+    switch (best) {
+        case ColumnEncoding::Plain: encodePlain(values, out); break;
+        case ColumnEncoding::RLE: encodeRLE(values, out); break;
+        case ColumnEncoding::Dictionary: encodeDictionary(dictionary, indices, out); break;
+        case ColumnEncoding::Delta:
+            if constexpr (std::is_integral_v<T>) encodeDelta(values, out);
+            break;
+    }
+}
+
+template<typename T>
+bool decodeColumn(const uint8_t* data, size_t size, size_t rows, std::vector<T>& out) {
+    ChunkCursor in{data, data + size};
+    uint8_t encoding;
+    if (!in.value(encoding)) return false;
+    out.resize(rows);
+    switch (static_cast<ColumnEncoding>(encoding)) {
+        case ColumnEncoding::Plain:
+            if (static_cast<size_t>(in.end - in.p) != rows * sizeof(T)) return false;
+            std::memcpy(out.data(), in.p, rows * sizeof(T));
+            return true;
+
+        case ColumnEncoding::RLE:
+            for (size_t i = 0; i < rows;) {
+                uint64_t run;
+                T v;
+                if (!in.varint(run) || !in.value(v) || run == 0 || run > rows - i) return false;
+                std::fill_n(out.begin() + static_cast<std::ptrdiff_t>(i), run, v);
+                i += run;
+            }
+            return true;
+
+        case ColumnEncoding::Dictionary: {
+            uint64_t count;
+            uint8_t width;
+            if (!in.varint(count) || count == 0 || count > 65536 ||
+                static_cast<size_t>(in.end - in.p) < count * sizeof(T)) {
+                return false;
+            }
+            std::vector<T> dictionary(count);
+            std::memcpy(dictionary.data(), in.p, count * sizeof(T));
+            in.p += count * sizeof(T);
+            if (!in.value(width) || width > 16 ||
+                static_cast<size_t>(in.end - in.p) < (rows * width + 7) / 8) {
+                return false;
+            }
+            uint64_t acc = 0;
+            unsigned bits = 0;
+            uint32_t mask = (uint32_t{1} << width) - 1;
+            for (size_t i = 0; i < rows; ++i) {
+                while (bits < width) {
+                    acc |= static_cast<uint64_t>(*in.p++) << bits;
+                    bits += 8;
+                }
+                uint32_t index = static_cast<uint32_t>(acc) & mask;
+                acc >>= width;
+                bits -= width;
+                if (index >= count) return false;
+                out[i] = dictionary[index];
+            }
+            return true;
+        }
+
+        case ColumnEncoding::Delta:
+            if constexpr (std::is_integral_v<T>) {
+                uint64_t prev = 0;
+                for (size_t i = 0; i < rows; ++i) {
+                    uint64_t z;
+                    if (!in.varint(z)) return false;
+                    prev += (z >> 1) ^ (~(z & 1) + 1);  // Undo zigzag
+                    out[i] = static_cast<T>(prev);
+                }
+                return true;
+            }
+            return false;
+    }
+    return false;
+}
+
+} // namespace detail
+
+// Streams PacketRows into a columnar file, one row group at a time
+class ColumnarWriter {
+public:
+    struct Options {
+        uint32_t rowGroupSize = 65536;
+    };
+
+    static constexpr uint32_t kMagic = 0x4C4F4350;  // "PCOL"
+    static constexpr uint32_t kVersion = 1;
+
+private:
+    struct ChunkLocation {
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    struct GroupInfo {
+        uint32_t rows;
+        uint64_t minTimestampUsec;
+        uint64_t maxTimestampUsec;
+        std::array<ChunkLocation, static_cast<size_t>(Column::Count)> chunks;
+    };
+
+    Options options_;
+    OutputFile file_;
+    ColumnBatch batch_;
+    std::vector<GroupInfo> groups_;
+    std::vector<uint8_t> buffer_;
+    uint64_t offset_ = 0;
+    uint64_t rowsWritten_ = 0;
+    bool failed_ = false;
+
+    bool writeBuffer() {
+        OutputFile::Segment segment{buffer_.data(), buffer_.size()};
+        if (!file_.write(&segment, 1)) failed_ = true;
+        offset_ += buffer_.size();
+        buffer_.clear();
+        return !failed_;
+    }
+
+    bool flushGroup() {
+        if (batch_.rows == 0) return true;
+        GroupInfo group{};
+        group.rows = static_cast<uint32_t>(batch_.rows);
+        auto [lo, hi] = std::minmax_element(batch_.timestampUsec.begin(), batch_.timestampUsec.end());
+        group.minTimestampUsec = *lo;
+        group.maxTimestampUsec = *hi;
+        batch_.forEachColumn([&](Column c, const auto& values) {
+            size_t start = buffer_.size();
+            detail::encodeColumn(values, buffer_);
+            group.chunks[static_cast<size_t>(c)] = {offset_ + start, static_cast<uint32_t>(buffer_.size() - start)};
+        });
+        groups_.push_back(group);
+        rowsWritten_ += batch_.rows;
+        batch_.clear();
+        return writeBuffer();
+    }
+
+public:
+    ColumnarWriter() = default;
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    bool open(const std::string& path) { return open(path, Options{}); }
+
+    bool open(const std::string& path, Options options) {
+        options_ = options;
+        if (options_.rowGroupSize == 0) options_.rowGroupSize = 1;
+        groups_.clear();
+        batch_.clear();
+        offset_ = rowsWritten_ = 0;
+        failed_ = false;
+        if (!file_.open(path)) return false;
+        detail::putValue(buffer_, kMagic);
+        detail::putValue(buffer_, kVersion);
+        detail::putValue(buffer_, options_.rowGroupSize);
+        detail::putValue(buffer_, static_cast<uint32_t>(Column::Count));
+        return writeBuffer();
+    }
+
+    bool append(const PacketRow& row) {
+        if (!file_.isOpen() || failed_) return false;
+        batch_.append(row);
+        return batch_.rows < options_.rowGroupSize || flushGroup();
+    }
+
+    bool writePacket(const RawPacketView& view) { return append(PacketRow::fromPacket(view)); }
+    bool writePacket(const RawPacket& raw) { return append(PacketRow::fromPacket(raw)); }
+
+    // Write the last row group and the footer. False if any write failed.
+    bool close() {
+        if (!file_.isOpen()) return false;
+        flushGroup();
+        uint64_t footerOffset = offset_;
+        detail::putValue(buffer_, static_cast<uint32_t>(groups_.size()));
+        for (const auto& g : groups_) {
+            detail::putValue(buffer_, g.rows);
+            detail::putValue(buffer_, g.minTimestampUsec);
+            detail::putValue(buffer_, g.maxTimestampUsec);
+            for (const auto& chunk : g.chunks) {
+                detail::putValue(buffer_, chunk.offset);
+                detail::putValue(buffer_, chunk.size);
+            }
+        }
+        detail::putValue(buffer_, footerOffset);
+        detail::putValue(buffer_, kMagic);
+        writeBuffer();
+        file_.close();
+        return !failed_;
+    }
+
+    uint64_t getRowsWritten() const { return rowsWritten_ + batch_.rows; }
+
+    ~ColumnarWriter() {
+        if (file_.isOpen()) close();
+    }
+};
+
+// Memory-mapped reader for files written by ColumnarWriter
+class ColumnarReader {
+public:
+    struct RowGroup {
+        uint32_t rows;
+        uint64_t minTimestampUsec;
+        uint64_t maxTimestampUsec;
+        std::array<uint64_t, static_cast<size_t>(Column::Count)> offsets;
+        std::array<uint32_t, static_cast<size_t>(Column::Count)> sizes;
+    };
+
+private:
+    MappedFile file_;
+    std::vector<RowGroup> groups_;
+    uint32_t rowGroupSize_ = 0;
+    uint64_t rows_ = 0;
+
+public:
+    // Map the file and check its header, trailer and footer
+    bool open(const std::string& path) {
+        close();
+        if (!file_.open(path)) return false;
+        const uint8_t* data = file_.data();
+        size_t size = file_.size();
+        detail::ChunkCursor header{data, data + size};
+        uint32_t magic = 0, version = 0, columns = 0;
+        if (!header.value(magic) || magic != ColumnarWriter::kMagic || !header.value(version) ||
+            version != ColumnarWriter::kVersion || !header.value(rowGroupSize_) || !header.value(columns) ||
+            columns != static_cast<uint32_t>(Column::Count) || size < 16 + 12) {
+            close();
+            return false;
+        }
+
+        uint64_t footerOffset;
+        uint32_t trailerMagic;
+        std::memcpy(&footerOffset, data + size - 12, 8);
+        std::memcpy(&trailerMagic, data + size - 4, 4);
+        if (trailerMagic != ColumnarWriter::kMagic || footerOffset < 16 || footerOffset > size - 12) {
+            close();
+            return false;
+        }
+        detail::ChunkCursor footer{data + footerOffset, data + size - 12};
+        uint32_t count = 0;
+        if (!footer.value(count)) {
+            close();
+            return false;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            RowGroup g;
+            bool ok = footer.value(g.rows) && footer.value(g.minTimestampUsec) && footer.value(g.maxTimestampUsec);
+            for (size_t c = 0; ok && c < g.offsets.size(); ++c) {
+                ok = footer.value(g.offsets[c]) && footer.value(g.sizes[c]) && g.offsets[c] <= footerOffset &&
+                     g.sizes[c] <= footerOffset - g.offsets[c];
+            }
+            if (!ok) {
+                close();
+                return false;
+            }
+            rows_ += g.rows;
+            groups_.push_back(g);
+        }
+        return true;
+    }
+
+    void close() {
+        file_.close();
+        groups_.clear();
+        rows_ = 0;
+    }
+
+    bool isOpen() const { return file_.isOpen(); }
+    uint64_t rowCount() const { return rows_; }
+    uint32_t rowGroupSize() const { return rowGroupSize_; }
+    size_t rowGroupCount() const { return groups_.size(); }
+    const RowGroup& rowGroup(size_t g) const { return groups_[g]; }
+
+    // Decode the chosen columns of row group `g` into `out`; the others are
+    // left empty. False on a corrupt chunk.
+    bool readRowGroup(size_t g, ColumnBatch& out, ColumnMask columns = kAllColumns) const {
+        if (g >= groups_.size()) return false;
+        const RowGroup& group = groups_[g];
+        out.clear();
+        bool ok = true;
+        out.forEachColumn([&](Column c, auto& values) {
+            size_t i = static_cast<size_t>(c);
+            if (ok && (columns & columnBit(c))) {
+                ok = detail::decodeColumn(file_.data() + group.offsets[i], group.sizes[i], group.rows, values);
+            }
+        });
+        out.rows = group.rows;
+        return ok;
+    }
+
+    // Call fn(const ColumnBatch&) for every row group whose time range meets
+    // [fromUsec, toUsec]. False if a chunk failed to decode.
+    template<typename Fn>
+    bool scan(ColumnMask columns, Fn&& fn, uint64_t fromUsec = 0, uint64_t toUsec = UINT64_MAX) const {
+        ColumnBatch batch;
+        for (size_t g = 0; g < groups_.size(); ++g) {
+            if (groups_[g].maxTimestampUsec < fromUsec || groups_[g].minTimestampUsec > toUsec) continue;
+            if (!readRowGroup(g, batch, columns)) return false;
+            fn(static_cast<const ColumnBatch&>(batch));
+        }
+        return true;
+    }
+};
+
+// Export every record of a capture. Returns the number of rows written, or
+// nullopt if either file could not be opened or written.
+inline std::optional<uint64_t> exportColumnar(const std::string& capturePath, const std::string& outputPath,
+                                              ColumnarWriter::Options options = {}) {
+    std::unique_ptr<IFileReaderDevice> reader(IFileReaderDevice::getReader(capturePath, ReadMode::MemoryMapped));
+    if (!reader || !reader->open()) return std::nullopt;
+    ColumnarWriter writer;
+    if (!writer.open(outputPath, options)) return std::nullopt;
+    RawPacketView view;
+    while (reader->getNextPacket(view)) {
+        if (!writer.writePacket(view)) return std::nullopt;
+    }
+    uint64_t rows = writer.getRowsWritten();
+    if (!writer.close()) return std::nullopt;
+    return rows;
+}
+
+} // namespace pcap
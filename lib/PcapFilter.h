@@ -0,0 +1,518 @@
+#pragma once
+
+#include "IpAddress.h"
+#include "PcapClassify.h"
+#include "PcapReader.h"
+
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pcap {
+
+// Header fields a filter program can test, decoded straight from the record
+// bytes with the same rules as Packet::parsePacket()
+struct FilterFields {
+    ProtocolMask mask = 0;
+    uint8_t ipVersion = 0;              // 4, 6 or 0
+    const uint8_t* srcAddress = nullptr;  // 4 or 16 bytes, network order
+    const uint8_t* dstAddress = nullptr;
+    bool hasPorts = false;              // TCP or UDP
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    uint32_t length = 0;                // Captured length
+
+    static FilterFields decode(const uint8_t* data, size_t len, uint32_t linkType) {
+        FilterFields f;
+        f.length = static_cast<uint32_t>(len);
+        if (!data || len < 14) return f;
+
+        size_t offset = 0;
+        uint16_t etherType = 0;
+        if (linkType == 1) {
+            etherType = detail::loadBE16(data + 12);
+            if (etherType != 0x0800 && etherType != 0x0806 && etherType != 0x86DD && etherType != 0x8100 &&
+                etherType != 0x8035) {
+                return f;
+            }
+            f.mask |= MaskEthernet;
+            offset = 14;
+            while (etherType == 0x8100 && offset + 4 <= len) {
+                etherType = detail::loadBE16(data + offset + 2);
+                offset += 4;
+            }
+        } else if (linkType == 113) {
+            if (len < 16) return f;
+            etherType = detail::loadBE16(data + 14);
+            offset = 16;
+        } else {
+            return f;
+        }
+
+        uint8_t transport = 0;
+        if (etherType == 0x0800 && offset + 20 <= len) {
+            f.mask |= MaskIPv4;
+            f.ipVersion = 4;
+            f.srcAddress = data + offset + 12;
+            f.dstAddress = data + offset + 16;
+            transport = data[offset + 9];
+            offset += (data[offset] & 0x0F) * 4;
+            if (transport == 1) f.mask |= MaskICMP;
+        } else if (etherType == 0x86DD && offset + 40 <= len) {
+            f.mask |= MaskIPv6;
+            f.ipVersion = 6;
+            f.srcAddress = data + offset + 8;
+            f.dstAddress = data + offset + 24;
+            uint8_t next = data[offset + 6];
+            offset += 40;
+            while (offset < len) {
+                if (next == 0 || next == 43 || next == 44 || next == 51 || next == 60) {
+                    if (offset + 2 > len) break;
+                    uint8_t extLen = data[offset + 1];
+                    next = data[offset];
+                    offset += (extLen + 1) * 8;
+                    continue;
+                }
+                if (next == 58) f.mask |= MaskICMP;
+                transport = next;
+                break;
+            }
+        } else if (etherType == 0x0806) {
+            f.mask |= MaskARP;
+            return f;
+        }
+
+        if (transport == 6 && offset + 20 <= len) {
+            f.mask |= MaskTCP;
+        } else if (transport == 17 && offset + 8 <= len) {
+            f.mask |= MaskUDP;
+        } else {
+            return f;
+        }
+        f.hasPorts = true;
+        f.srcPort = detail::loadBE16(data + offset);
+        f.dstPort = detail::loadBE16(data + offset + 2);
+        return f;
+    }
+};
+
+enum class FilterOp : uint8_t {
+    Proto,      // All bits of `arg` set in the protocol mask
+    Host,       // Address equals pool[arg] (with prefix = full length)
+    Net,        // Address within pool[arg] / prefix
+    Port,       // TCP/UDP port == arg
+    PortRange,  // TCP/UDP port within [arg & 0xFFFF, arg >> 16]
+    Less,       // Captured length <= arg
+    Greater     // Captured length >= arg
+};
+
+enum class FilterDir : uint8_t { Either, Src, Dst };
+
+// One test with BPF-style conditional jumps. Targets are instruction
+// indices, or kAccept / kReject to end the program.
+struct FilterInstruction {
+    FilterOp op;
+    FilterDir dir;
+    uint8_t prefix;      // Host/Net: bits compared
+    uint8_t family;      // Host/Net: address length, 4 or 16
+    uint32_t arg;        // Protocol mask, pool index, port(s) or length
+    uint16_t jumpTrue;
+    uint16_t jumpFalse;
+
+    static constexpr uint16_t kAccept = 0xFFFF;
+    static constexpr uint16_t kReject = 0xFFFE;
+};
+
+// pcap-filter style expression compiled once into a flat program, e.g.
+//   udp and dst port 9999 and net 10.0.0.0/8
+//   tcp portrange 8000-8100 or (ip6 and not icmp6)
+//
+// Primitives: ether, ip, ip6, arp, tcp, udp, icmp, icmp6,
+// [src|dst] host ADDR, [src|dst] net ADDR/LEN, [src|dst] port N,
+// [src|dst] portrange A-B, less N, greater N. A protocol directly followed
+// by a port primitive restricts it ("tcp dst port 80"); ip and ip6 restrict
+// host and net the same way ("ip src host 10.0.0.1", "ip6 net 2001:db8::/32").
+// Combine with and/&&, or/||, not/! and parentheses. As in pcap-filter,
+// "not" binds tightest and "and"/"or" have equal precedence, left to right.
+//
+// Addresses are IPv4 dotted quads or IPv6 text; `port` matches TCP and UDP
+// only; `less`/`greater` compare the captured length.
+class PacketFilter {
+private:
+    std::vector<FilterInstruction> code_;
+    std::vector<std::array<uint8_t, 16>> addresses_;
+    std::string expression_;
+
+    static bool prefixMatch(const uint8_t* a, const uint8_t* b, uint8_t bits) {
+        size_t bytes = bits / 8;
+        if (std::memcmp(a, b, bytes) != 0) return false;
+        uint8_t rest = bits % 8;
+        if (rest == 0) return true;
+        auto mask = static_cast<uint8_t>(0xFF << (8 - rest));
+        return (a[bytes] & mask) == (b[bytes] & mask);
+    }
+
+    bool test(const FilterInstruction& in, const FilterFields& f) const {
+        switch (in.op) {
+            case FilterOp::Proto:
+                return (f.mask & in.arg) == in.arg;
+            case FilterOp::Host:
+            case FilterOp::Net: {
+                if (in.family == 4 ? f.ipVersion != 4 : f.ipVersion != 6) return false;
+                const uint8_t* want = addresses_[in.arg].data();
+                bool src = in.dir != FilterDir::Dst && prefixMatch(f.srcAddress, want, in.prefix);
+                bool dst = in.dir != FilterDir::Src && prefixMatch(f.dstAddress, want, in.prefix);
+                return src || dst;
+            }
+            case FilterOp::Port:
+            case FilterOp::PortRange: {
+                if (!f.hasPorts) return false;
+                uint16_t lo = static_cast<uint16_t>(in.arg);
+                uint16_t hi = in.op == FilterOp::Port ? lo : static_cast<uint16_t>(in.arg >> 16);
+                bool src = in.dir != FilterDir::Dst && f.srcPort >= lo && f.srcPort <= hi;
+                bool dst = in.dir != FilterDir::Src && f.dstPort >= lo && f.dstPort <= hi;
+                return src || dst;
+            }
+            case FilterOp::Less:
+                return f.length <= in.arg;
+            case FilterOp::Greater:
+                return f.length >= in.arg;
+        }
+        return false;
+    }
+
+    class Compiler;
+
+public:
+    // Compile `expression`. On a syntax error returns std::nullopt and, if
+    // `error` is given, a message naming the offending token.
+    static std::optional<PacketFilter> compile(std::string_view expression, std::string* error = nullptr);
+
+    bool matches(const uint8_t* data, size_t len, uint32_t linkType) const {
+        if (code_.empty()) return true;  // Empty expression accepts everything
+        FilterFields fields = FilterFields::decode(data, len, linkType);
+        uint16_t pc = 0;
+        for (;;) {
+            const FilterInstruction& in = code_[pc];
+            pc = test(in, fields) ? in.jumpTrue : in.jumpFalse;
+            if (pc == FilterInstruction::kAccept) return true;
+            if (pc == FilterInstruction::kReject) return false;
+        }
+    }
+
+    bool matches(const RawPacketView& packet) const {
+        return matches(packet.data, packet.length, packet.linkType);
+    }
+
+    bool matches(const RawPacket& packet) const {
+        return matches(packet.getData(), packet.getDataLen(), packet.linkType);
+    }
+
+    // Lets a filter be passed straight to IFileReaderDevice::setFilter()
+    bool operator()(const RawPacketView& packet) const { return matches(packet); }
+
+    const std::vector<FilterInstruction>& program() const { return code_; }
+    const std::string& expression() const { return expression_; }
+};
+
+// Recursive-descent parser that emits code directly, patching jump targets
+// the way short-circuit boolean expressions are compiled: every subexpression
+// leaves lists of "jump if true" / "jump if false" slots to fill in later.
+class PacketFilter::Compiler {
+private:
+    struct Exits {
+        std::vector<uint32_t> onTrue;   // Encoded as index * 2 + (0 = jumpTrue, 1 = jumpFalse)
+        std::vector<uint32_t> onFalse;
+    };
+
+    PacketFilter& filter_;
+    std::string_view text_;
+    size_t pos_ = 0;
+    std::string token_;
+    size_t tokenPos_ = 0;
+    std::string error_;
+
+    void next() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+        tokenPos_ = pos_;
+        token_.clear();
+        if (pos_ >= text_.size()) return;
+        char c = text_[pos_];
+        if (c == '(' || c == ')' || c == '!') {
+            token_ = c;
+            ++pos_;
+            return;
+        }
+        if ((c == '&' || c == '|') && pos_ + 1 < text_.size() && text_[pos_ + 1] == c) {
+            token_.assign(2, c);
+            pos_ += 2;
+            return;
+        }
+        while (pos_ < text_.size()) {
+            char w = text_[pos_];
+            if (!std::isalnum(static_cast<unsigned char>(w)) && w != '.' && w != ':' && w != '/' && w != '-' &&
+                w != '_') {
+                break;
+            }
+            token_ += static_cast<char>(std::tolower(static_cast<unsigned char>(w)));
+            ++pos_;
+        }
+        if (token_.empty()) {
+            token_ = c;  // Unknown character: let the parser report it
+            ++pos_;
+        }
+    }
+
+    bool fail(const std::string& message) {
+        if (error_.empty()) {
+            error_ = message + (token_.empty() ? " at end of expression"
+                                               : " at '" + token_ + "' (offset " + std::to_string(tokenPos_) + ")");
+        }
+        return false;
+    }
+
+    Exits emit(FilterOp op, FilterDir dir, uint32_t arg, uint8_t family = 0, uint8_t prefix = 0) {
+        auto index = static_cast<uint32_t>(filter_.code_.size());
+        filter_.code_.push_back({op, dir, prefix, family, arg, 0, 0});
+        return {{index * 2}, {index * 2 + 1}};
+    }
+
+    void patch(const std::vector<uint32_t>& slots, uint16_t target) {
+        for (uint32_t slot : slots) {
+            FilterInstruction& in = filter_.code_[slot / 2];
+            (slot & 1 ? in.jumpFalse : in.jumpTrue) = target;
+        }
+    }
+
+    uint16_t here() const { return static_cast<uint16_t>(filter_.code_.size()); }
+
+    static Exits conjoin(Exits a, Exits b) {
+        // Caller already patched a.onTrue to the start of b
+        b.onFalse.insert(b.onFalse.end(), a.onFalse.begin(), a.onFalse.end());
+        return b;
+    }
+
+    bool parseNumber(uint32_t& out, uint32_t max) {
+        auto result = std::from_chars(token_.data(), token_.data() + token_.size(), out);
+        if (result.ec != std::errc() || result.ptr != token_.data() + token_.size() || out > max) {
+            return fail("expected a number up to " + std::to_string(max));
+        }
+        return true;
+    }
+
+    // ADDR or ADDR/LEN into the address pool. Addresses are read by
+    // IpAddress.h, so the filter takes the same syntax as the library.
+    bool parseAddress(bool allowPrefix, uint32_t& index, uint8_t& family, uint8_t& prefix) {
+        std::string_view text = token_;
+        size_t slash = text.find('/');
+        if (slash != std::string_view::npos && !allowPrefix) return fail("unexpected prefix length");
+        std::optional<uint32_t> length;
+        if (slash != std::string_view::npos) {
+            uint32_t value = 0;
+            std::string_view digits = text.substr(slash + 1);
+            auto result = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+            if (digits.empty() || result.ec != std::errc() || result.ptr != digits.data() + digits.size()) {
+                return fail("bad prefix length");
+            }
+            length = value;
+        }
+
+        std::string_view addr = text.substr(0, slash);
+        std::array<uint8_t, 16> bytes{};
+        bool hostBits;
+        if (auto v4 = IPv4Address::parse(addr)) {
+            family = 4;
+            if (length && *length > IPv4Address::kBits) return fail("prefix length too long");
+            prefix = static_cast<uint8_t>(length.value_or(IPv4Address::kBits));
+            hostBits = Prefix(*v4, prefix).network() != *v4;
+            uint32_t value = v4->to_uint32();
+            for (int i = 0; i < 4; ++i) bytes[i] = static_cast<uint8_t>(value >> (24 - 8 * i));
+        } else if (auto v6 = IPv6Address::parse(addr)) {
+            family = 16;
+            if (length && *length > IPv6Address::kBits) return fail("prefix length too long");
+            prefix = static_cast<uint8_t>(length.value_or(IPv6Address::kBits));
+            hostBits = IPv6Prefix(*v6, prefix).network() != *v6;
+            bytes = v6->to_bytes();
+        } else {
+            return fail("expected an IPv4 or IPv6 address");
+        }
+        // 10.1.2.3/8 is a typo for a host or a wider net; refuse to guess
+        if (hostBits) return fail("non-network bits set");
+        index = static_cast<uint32_t>(filter_.addresses_.size());
+        filter_.addresses_.push_back(bytes);
+        return true;
+    }
+
+    // port N / portrange A-B, current token is the keyword
+    bool parsePort(FilterDir dir, Exits& out) {
+        bool range = token_ == "portrange";
+        next();
+        if (token_.empty()) return fail("expected a port");
+        if (!range) {
+            uint32_t port = 0;
+            if (!parseNumber(port, 65535)) return false;
+            out = emit(FilterOp::Port, dir, port);
+        } else {
+            size_t dash = token_.find('-');
+            if (dash == std::string::npos) return fail("expected a port range A-B");
+            std::string full = token_;
+            uint32_t lo = 0;
+            uint32_t hi = 0;
+            token_ = full.substr(0, dash);
+            if (!parseNumber(lo, 65535)) return false;
+            token_ = full.substr(dash + 1);
+            if (!parseNumber(hi, 65535)) return false;
+            token_ = full;
+            if (lo > hi) return fail("empty port range");
+            out = emit(FilterOp::PortRange, dir, lo | (hi << 16));
+        }
+        next();
+        return true;
+    }
+
+    // Qualified primitive after an optional src/dst
+    // `family` (4 or 16) limits addresses to one IP version, after ip / ip6
+    bool parseDirected(FilterDir dir, Exits& out, uint8_t family = 0) {
+        if (token_ == "port" || token_ == "portrange") return parsePort(dir, out);
+        bool net = token_ == "net";
+        if (net || token_ == "host") {
+            next();
+        } else if (dir == FilterDir::Either) {
+            return fail("expected a primitive");
+        }
+        // "src 10.0.0.1" is shorthand for "src host 10.0.0.1"
+        if (token_.empty()) return fail("expected an address");
+        uint32_t index = 0;
+        uint8_t parsed = 0;
+        uint8_t prefix = 0;
+        if (!parseAddress(net, index, parsed, prefix)) return false;
+        if (family != 0 && parsed != family) return fail("address family does not match the protocol");
+        out = emit(net ? FilterOp::Net : FilterOp::Host, dir, index, parsed, prefix);
+        next();
+        return true;
+    }
+
+    static ProtocolMask protocolKeyword(const std::string& word) {
+        if (word == "ether") return MaskEthernet;
+        if (word == "ip") return MaskIPv4;
+        if (word == "ip6") return MaskIPv6;
+        if (word == "arp") return MaskARP;
+        if (word == "tcp") return MaskTCP;
+        if (word == "udp") return MaskUDP;
+        if (word == "icmp") return MaskIPv4 | MaskICMP;
+        if (word == "icmp6") return MaskIPv6 | MaskICMP;
+        return 0;
+    }
+
+    bool parsePrimitive(Exits& out) {
+        if (token_ == "(") {
+            next();
+            if (!parseExpression(out)) return false;
+            if (token_ != ")") return fail("expected ')'");
+            next();
+            return true;
+        }
+        if (token_ == "not" || token_ == "!") {
+            next();
+            if (!parsePrimitive(out)) return false;
+            std::swap(out.onTrue, out.onFalse);
+            return true;
+        }
+        if (ProtocolMask proto = protocolKeyword(token_)) {
+            out = emit(FilterOp::Proto, FilterDir::Either, proto);
+            next();
+            // "tcp port 80", "udp dst port 53", "ip src host 10.0.0.1", "ip6 net 2001:db8::/32"
+            FilterDir dir = FilterDir::Either;
+            if (token_ == "src" || token_ == "dst") {
+                dir = token_ == "src" ? FilterDir::Src : FilterDir::Dst;
+                next();
+            } else if (token_ != "port" && token_ != "portrange" && token_ != "host" && token_ != "net") {
+                return true;
+            }
+            bool port = token_ == "port" || token_ == "portrange";
+            bool ip = proto == MaskIPv4 || proto == MaskIPv6;
+            if (port && !(proto & (MaskTCP | MaskUDP))) return fail("port qualifier needs tcp or udp");
+            if (!port && !ip) {
+                return fail(proto & (MaskTCP | MaskUDP) ? "expected port or portrange"
+                                                        : "host or net qualifier needs ip or ip6");
+            }
+            patch(out.onTrue, here());
+            Exits test;
+            bool parsed = port ? parsePort(dir, test) : parseDirected(dir, test, proto == MaskIPv4 ? 4 : 16);
+            if (!parsed) return false;
+            out = conjoin(std::move(out), std::move(test));
+            return true;
+        }
+        if (token_ == "less" || token_ == "greater") {
+            FilterOp op = token_ == "less" ? FilterOp::Less : FilterOp::Greater;
+            next();
+            uint32_t length = 0;
+            if (!parseNumber(length, 0xFFFFFFFFu)) return false;
+            out = emit(op, FilterDir::Either, length);
+            next();
+            return true;
+        }
+        FilterDir dir = FilterDir::Either;
+        if (token_ == "src" || token_ == "dst") {
+            dir = token_ == "src" ? FilterDir::Src : FilterDir::Dst;
+            next();
+        }
+        return parseDirected(dir, out);
+    }
+
+    bool parseExpression(Exits& out) {
+        if (!parsePrimitive(out)) return false;
+        for (;;) {
+            bool isAnd = token_ == "and" || token_ == "&&";
+            bool isOr = token_ == "or" || token_ == "||";
+            if (!isAnd && !isOr) return true;
+            next();
+            // The right operand starts here: short-circuit into it on
+            // true (and) or false (or)
+            patch(isAnd ? out.onTrue : out.onFalse, here());
+            Exits rhs;
+            if (!parsePrimitive(rhs)) return false;
+            if (isAnd) {
+                out = conjoin(std::move(out), std::move(rhs));
+            } else {
+                rhs.onTrue.insert(rhs.onTrue.end(), out.onTrue.begin(), out.onTrue.end());
+                out = std::move(rhs);
+            }
+        }
+    }
+
+public:
+    Compiler(PacketFilter& filter, std::string_view text) : filter_(filter), text_(text) {}
+
+    bool run(std::string* error) {
+        next();
+        if (token_.empty()) return true;
+        Exits exits;
+        bool ok = parseExpression(exits);
+        if (ok && !token_.empty()) ok = fail("unexpected token");
+        if (ok && filter_.code_.size() >= FilterInstruction::kReject) ok = fail("expression too long");
+        if (!ok) {
+            if (error) *error = error_;
+            return false;
+        }
+        patch(exits.onTrue, FilterInstruction::kAccept);
+        patch(exits.onFalse, FilterInstruction::kReject);
+        return true;
+    }
+};
+
+inline std::optional<PacketFilter> PacketFilter::compile(std::string_view expression, std::string* error) {
+    PacketFilter filter;
+    filter.expression_ = std::string(expression);
+    Compiler compiler(filter, expression);
+    if (!compiler.run(error)) return std::nullopt;
+    return filter;
+}
+
+} // namespace pcap
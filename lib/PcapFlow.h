@@ -0,0 +1,431 @@
+#pragma once
+
+#include "PcapReader.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace pcap {
+
+// Bidirectional 5-tuple. Endpoints are stored in canonical order (A < B), so
+// both directions of a conversation produce the same key. IPv4 addresses
+// occupy the last 4 bytes of the 16-byte address fields.
+struct FlowKey {
+    std::array<uint8_t, 16> addrA{};
+    std::array<uint8_t, 16> addrB{};
+    uint16_t portA = 0;
+    uint16_t portB = 0;
+    uint8_t protocol = 0;   // 6 = TCP, 17 = UDP
+    uint8_t ipVersion = 0;  // 4 or 6
+
+    bool operator==(const FlowKey& other) const {
+        return addrA == other.addrA && addrB == other.addrB && portA == other.portA &&
+               portB == other.portB && protocol == other.protocol && ipVersion == other.ipVersion;
+    }
+
+    // IPv4 endpoint in host byte order (only meaningful when ipVersion == 4)
+    uint32_t ipv4A() const { return detail::loadBE32(addrA.data() + 12); }
+    uint32_t ipv4B() const { return detail::loadBE32(addrB.data() + 12); }
+
+    uint64_t hash() const {
+        // 64-bit mix of the key words (murmur3 finalizer per word)
+        auto mix = [](uint64_t h, uint64_t v) {
+            h ^= v;
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDULL;
+            h ^= h >> 33;
+            h *= 0xC4CEB9FE1A85EC53ULL;
+            h ^= h >> 33;
+            return h;
+        };
+        uint64_t words[4];
+        std::memcpy(words, addrA.data(), 16);
+        std::memcpy(words + 2, addrB.data(), 16);
+        uint64_t h = 0x9E3779B97F4A7C15ULL;
+        for (uint64_t w : words) h = mix(h, w);
+        return mix(h, (static_cast<uint64_t>(portA) << 32) | (static_cast<uint64_t>(portB) << 16) |
+                          (static_cast<uint64_t>(protocol) << 8) | ipVersion);
+    }
+};
+
+// Extract the canonical 5-tuple of a TCP/UDP packet. `fromA` tells which
+// endpoint sent the packet. Returns nullopt for other protocols and for
+// non-first IP fragments (they carry no transport header).
+inline std::optional<FlowKey> extractFlowKey(const Packet& packet, bool* fromA = nullptr) {
+    std::array<uint8_t, 16> src{}, dst{};
+    uint8_t version;
+    if (auto ip = packet.getLayer<IPv4View>()) {
+        if (ip->fragmentOffset() != 0) return std::nullopt;
+        std::memcpy(src.data() + 12, ip->getData() + 12, 4);
+        std::memcpy(dst.data() + 12, ip->getData() + 16, 4);
+        version = 4;
+    } else if (auto ip6 = packet.getLayer<IPv6View>()) {
+        std::memcpy(src.data(), ip6->srcAddress(), 16);
+        std::memcpy(dst.data(), ip6->dstAddress(), 16);
+        version = 6;
+    } else {
+        return std::nullopt;
+    }
+
+    uint16_t srcPort, dstPort;
+    uint8_t protocol;
+    if (auto tcp = packet.getLayer<TCPView>()) {
+        srcPort = tcp->srcPort();
+        dstPort = tcp->dstPort();
+        protocol = 6;
+    } else if (auto udp = packet.getLayer<UDPView>()) {
+        srcPort = udp->srcPort();
+        dstPort = udp->dstPort();
+        protocol = 17;
+    } else {
+        return std::nullopt;
+    }
+
+    FlowKey key;
+    key.protocol = protocol;
+    key.ipVersion = version;
+    bool srcIsA = src < dst || (src == dst && srcPort <= dstPort);
+    if (srcIsA) {
+        key.addrA = src; key.portA = srcPort;
+        key.addrB = dst; key.portB = dstPort;
+    } else {
+        key.addrA = dst; key.portA = dstPort;
+        key.addrB = src; key.portB = srcPort;
+    }
+    if (fromA) *fromA = srcIsA;
+    return key;
+}
+
+struct FlowDirectionStats {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;          // Captured bytes, link layer included
+    uint32_t retransmits = 0;    // TCP segments whose data was already seen
+};
+
+enum class FlowEndReason : uint8_t {
+    IdleTimeout,   // No packet for FlowTable::Options::idleTimeoutUsec
+    Evicted,       // Table full: least recently active flow made room
+    Flushed        // FlowTable::flush(), e.g. at the end of the capture
+};
+
+// Per-flow metrics. "forward" is the direction of the first packet seen (or
+// of the SYN for TCP), "reverse" is the other one.
+struct FlowRecord {
+    FlowKey key;
+    bool initiatorIsA = true;
+    FlowDirectionStats forward;
+    FlowDirectionStats reverse;
+    uint64_t firstSeenUsec = 0;
+    uint64_t lastSeenUsec = 0;
+
+    // TCP only
+    uint64_t synUsec = 0;            // First SYN
+    uint64_t synAckUsec = 0;         // First SYN+ACK
+    uint64_t handshakeRttUsec = 0;   // SYN to the ACK completing the handshake, 0 if incomplete
+    bool finSeen = false;
+    bool rstSeen = false;
+
+    uint64_t durationUsec() const { return lastSeenUsec - firstSeenUsec; }
+    uint64_t totalPackets() const { return forward.packets + reverse.packets; }
+    uint64_t totalBytes() const { return forward.bytes + reverse.bytes; }
+    bool handshakeComplete() const { return handshakeRttUsec != 0; }
+};
+
+// Open-addressing flow table with idle-timeout and capacity eviction.
+//
+// The hash index is a linear-probing array of 8-byte slots (hash tag + entry
+// index); flow state lives in a separate, densely packed entry pool, so a
+// probe touches one cache line most of the time. Entries are chained in
+// least-recently-active order, which makes idle expiry O(1) per packet.
+// Memory is bounded by Options::maxFlows: when full, the least recently
+// active flow is reported and evicted.
+class FlowTable {
+public:
+    struct Options {
+        size_t maxFlows = size_t{1} << 20;
+        uint64_t idleTimeoutUsec = 120ULL * 1000000;
+    };
+
+    using Callback = std::function<void(const FlowRecord&, FlowEndReason)>;
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFF;
+
+    struct Slot {
+        uint32_t tag = 0;            // 0 = empty, otherwise high hash bits | 1
+        uint32_t index = kNone;      // Entry pool index
+    };
+
+    struct Entry {
+        FlowRecord record;
+        uint32_t nextSeq[2] = {0, 0};  // Per direction (0 = from A), next expected sequence number
+        bool seqValid[2] = {false, false};
+        bool synSeen = false;          // synUsec / synAckUsec are set (either may be stamped 0)
+        bool synAckSeen = false;
+        bool handshakeAckPending = false;
+        uint32_t lruPrev = kNone;
+        uint32_t lruNext = kNone;
+        uint32_t slot = kNone;         // Back-pointer into slots_
+    };
+
+    Options options_;
+    Callback onFlowEnd_;
+    std::vector<Slot> slots_;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> freeEntries_;
+    uint32_t lruHead_ = kNone;  // Most recently active
+    uint32_t lruTail_ = kNone;  // Least recently active
+    size_t size_ = 0;
+    uint64_t nowUsec_ = 0;
+
+    size_t mask() const { return slots_.size() - 1; }
+
+    static uint32_t tagOf(uint64_t hash) { return static_cast<uint32_t>(hash >> 32) | 1u; }
+
+    void lruUnlink(uint32_t i) {
+        Entry& e = entries_[i];
+        if (e.lruPrev != kNone) entries_[e.lruPrev].lruNext = e.lruNext; else lruHead_ = e.lruNext;
+        if (e.lruNext != kNone) entries_[e.lruNext].lruPrev = e.lruPrev; else lruTail_ = e.lruPrev;
+        e.lruPrev = e.lruNext = kNone;
+    }
+
+    void lruPushFront(uint32_t i) {
+        Entry& e = entries_[i];
+        e.lruPrev = kNone;
+        e.lruNext = lruHead_;
+        if (lruHead_ != kNone) entries_[lruHead_].lruPrev = i;
+        lruHead_ = i;
+        if (lruTail_ == kNone) lruTail_ = i;
+    }
+
+    void placeInSlots(uint32_t index, uint32_t tag, uint64_t hash) {
+        size_t pos = hash & mask();
+        while (slots_[pos].tag != 0) pos = (pos + 1) & mask();
+        slots_[pos] = {tag, index};
+        entries_[index].slot = static_cast<uint32_t>(pos);
+    }
+
+    void grow() {
+        size_t newSize = slots_.empty() ? 1024 : slots_.size() * 2;
+        slots_.assign(newSize, Slot{});
+        for (uint32_t i = lruHead_; i != kNone; i = entries_[i].lruNext) {
+            uint64_t h = entries_[i].record.key.hash();
+            placeInSlots(i, tagOf(h), h);
+        }
+    }
+
+    // Backward-shift deletion keeps probe sequences intact without tombstones
+    void eraseSlot(size_t pos) {
+        size_t hole = pos;
+        size_t next = (pos + 1) & mask();
+        while (slots_[next].tag != 0) {
+            size_t home = entries_[slots_[next].index].record.key.hash() & mask();
+            // Move `next` into the hole unless its home lies in (hole, next]
+            bool inRange = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+            if (!inRange) {
+                slots_[hole] = slots_[next];
+                entries_[slots_[hole].index].slot = static_cast<uint32_t>(hole);
+                hole = next;
+            }
+            next = (next + 1) & mask();
+        }
+        slots_[hole] = Slot{};
+    }
+
+    void remove(uint32_t i, FlowEndReason reason) {
+        if (onFlowEnd_) onFlowEnd_(entries_[i].record, reason);
+        eraseSlot(entries_[i].slot);
+        lruUnlink(i);
+        freeEntries_.push_back(i);
+        --size_;
+    }
+
+    uint32_t find(const FlowKey& key, uint64_t hash) const {
+        if (slots_.empty()) return kNone;
+        uint32_t tag = tagOf(hash);
+        for (size_t pos = hash & mask(); slots_[pos].tag != 0; pos = (pos + 1) & mask()) {
+            if (slots_[pos].tag == tag && entries_[slots_[pos].index].record.key == key) {
+                return slots_[pos].index;
+            }
+        }
+        return kNone;
+    }
+
+    uint32_t insert(const FlowKey& key, uint64_t hash) {
+        if (size_ >= options_.maxFlows) remove(lruTail_, FlowEndReason::Evicted);
+        // Keep the load factor at or below 3/4
+        if ((size_ + 1) * 4 > slots_.size() * 3) grow();
+
+        uint32_t i;
+        if (!freeEntries_.empty()) {
+            i = freeEntries_.back();
+            freeEntries_.pop_back();
+            entries_[i] = Entry{};
+        } else {
+            i = static_cast<uint32_t>(entries_.size());
+            entries_.emplace_back();
+        }
+        entries_[i].record.key = key;
+        placeInSlots(i, tagOf(hash), hash);
+        lruPushFront(i);
+        ++size_;
+        return i;
+    }
+
+    static bool seqBefore(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) < 0; }
+
+    void trackTcp(Entry& e, const Packet& packet, uint64_t timestampUsec, bool fromA, bool fromInitiator,
+                  FlowDirectionStats& dir) {
+        const TCPView* tcp = packet.getLayerOfType<TCPView>();
+        FlowRecord& r = e.record;
+        uint8_t flags = tcp->flags();
+        bool syn = flags & TCPView::SYN;
+        bool ack = flags & TCPView::ACK;
+
+        // Stamped with the packet's own time: nowUsec_ may belong to another
+        // flow further ahead in slightly out-of-order input
+        if (syn && !ack && !e.synSeen) {
+            r.synUsec = timestampUsec;
+            e.synSeen = true;
+        } else if (syn && ack && e.synSeen && !e.synAckSeen) {
+            r.synAckUsec = timestampUsec;
+            e.synAckSeen = true;
+            e.handshakeAckPending = true;
+        } else if (!syn && ack && e.handshakeAckPending && fromInitiator) {
+            // At least 1 so handshakeComplete() holds even if the ACK is stamped early
+            r.handshakeRttUsec = timestampUsec > r.synUsec ? timestampUsec - r.synUsec : 1;
+            e.handshakeAckPending = false;
+        }
+        if (flags & TCPView::FIN) r.finSeen = true;
+        if (flags & TCPView::RST) r.rstSeen = true;
+
+        // Sequence space consumed by this segment, from the IP length so
+        // snaplen-truncated captures still count the real payload
+        const uint8_t* ipData;
+        size_t ipLen;
+        if (const IPv4View* ip = packet.getLayerOfType<IPv4View>()) {
+            ipData = ip->getData();
+            ipLen = ip->totalLength();
+        } else {
+            const IPv6View* ip6 = packet.getLayerOfType<IPv6View>();
+            ipData = ip6->getData();
+            ipLen = 40 + size_t{ip6->payloadLength()};
+        }
+        size_t headers = static_cast<size_t>(tcp->getData() - ipData) + tcp->headerLength();
+        uint32_t payload = ipLen > headers ? static_cast<uint32_t>(ipLen - headers) : 0;
+        uint32_t segLen = payload + (syn ? 1 : 0) + ((flags & TCPView::FIN) ? 1 : 0);
+        if (segLen == 0) return;
+
+        int d = fromA ? 0 : 1;
+        uint32_t seq = tcp->seq();
+        uint32_t end = seq + segLen;
+        if (e.seqValid[d] && !seqBefore(e.nextSeq[d], end)) {
+            // Everything in this segment was sent before
+            ++dir.retransmits;
+        } else {
+            e.nextSeq[d] = end;
+            e.seqValid[d] = true;
+        }
+    }
+
+public:
+    FlowTable() : FlowTable(Options{}) {}
+
+    explicit FlowTable(Options options, Callback onFlowEnd = {})
+        : options_(options), onFlowEnd_(std::move(onFlowEnd)) {
+        if (options_.maxFlows == 0) options_.maxFlows = 1;
+    }
+
+    // Account one packet captured at `timestampUsec`. Returns false if the
+    // packet is not TCP/UDP over IP and was ignored.
+    bool process(const Packet& packet, uint64_t timestampUsec, size_t capturedBytes) {
+        bool fromA = true;
+        auto key = extractFlowKey(packet, &fromA);
+        if (!key) return false;
+
+        expire(timestampUsec);
+
+        uint64_t hash = key->hash();
+        uint32_t i = find(*key, hash);
+        bool created = i == kNone;
+        if (created) i = insert(*key, hash);
+
+        Entry& e = entries_[i];
+        FlowRecord& r = e.record;
+        if (created) {
+            r.firstSeenUsec = timestampUsec;
+            r.initiatorIsA = fromA;
+        } else {
+            lruUnlink(i);
+            lruPushFront(i);
+        }
+        // Capture timestamps can step backwards slightly; never shrink the flow
+        r.lastSeenUsec = std::max(r.lastSeenUsec, timestampUsec);
+
+        if (key->protocol == 6) {
+            const TCPView* tcp = packet.getLayerOfType<TCPView>();
+            // A bare SYN names the initiator even if we joined mid-stream
+            if (tcp->hasFlag(TCPView::SYN) && !tcp->hasFlag(TCPView::ACK) && !e.synSeen &&
+                r.initiatorIsA != fromA) {
+                r.initiatorIsA = fromA;
+                std::swap(r.forward, r.reverse);
+            }
+        }
+
+        bool fromInitiator = fromA == r.initiatorIsA;
+        FlowDirectionStats& dir = fromInitiator ? r.forward : r.reverse;
+        ++dir.packets;
+        dir.bytes += capturedBytes;
+
+        if (key->protocol == 6) trackTcp(e, packet, timestampUsec, fromA, fromInitiator, dir);
+        return true;
+    }
+
+    bool process(const RawPacketView& view) {
+        return process(Packet(view), toUsec(view.timestamp_sec, view.timestamp_usec), view.getDataLen());
+    }
+
+    bool process(const RawPacket& raw) {
+        return process(Packet(&raw), toUsec(raw.timestamp_sec, raw.timestamp_usec), raw.getDataLen());
+    }
+
+    static uint64_t toUsec(uint32_t sec, uint32_t usec) {
+        return static_cast<uint64_t>(sec) * 1000000 + usec;
+    }
+
+    // Report and drop every flow idle for longer than the timeout at `nowUsec`
+    void expire(uint64_t nowUsec) {
+        nowUsec_ = std::max(nowUsec_, nowUsec);
+        while (lruTail_ != kNone &&
+               nowUsec_ - entries_[lruTail_].record.lastSeenUsec > options_.idleTimeoutUsec) {
+            remove(lruTail_, FlowEndReason::IdleTimeout);
+        }
+    }
+
+    // Report and drop all remaining flows, oldest activity first
+    void flush() {
+        while (lruTail_ != kNone) remove(lruTail_, FlowEndReason::Flushed);
+    }
+
+    // Current state of a flow, if it is being tracked
+    const FlowRecord* lookup(const FlowKey& key) const {
+        uint32_t i = find(key, key.hash());
+        return i == kNone ? nullptr : &entries_[i].record;
+    }
+
+    // Visit live flows, most recently active first
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for (uint32_t i = lruHead_; i != kNone; i = entries_[i].lruNext) fn(entries_[i].record);
+    }
+
+    size_t size() const { return size_; }
+    size_t maxFlows() const { return options_.maxFlows; }
+};
+
+} // namespace pcap
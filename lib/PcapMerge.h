@@ -0,0 +1,265 @@
+#pragma once
+
+#include "PcapReassembly.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace pcap {
+
+namespace detail {
+
+// Fast 64-bit hash of a whole frame, one multiply per 8 bytes
+inline uint64_t hashFrame(const uint8_t* data, size_t length) {
+    constexpr uint64_t k1 = 0x9E3779B97F4A7C15ULL;
+    constexpr uint64_t k2 = 0xC2B2AE3D27D4EB4FULL;
+    uint64_t h = length * k1;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        h = std::rotl(h ^ (w * k2), 31) * k1;
+    }
+    if (i < length) {
+        uint64_t w = 0;
+        std::memcpy(&w, data + i, length - i);
+        h = std::rotl(h ^ (w * k2), 31) * k1;
+    }
+    return mix64(h, length);
+}
+
+} // namespace detail
+
+// Time-ordered merge of several captures, e.g. taps on different links.
+//
+// Each input keeps exactly one pending record; a binary min-heap on
+// (timestamp, input number) picks the next one, so memory is O(inputs)
+// whatever the file sizes and ties keep input order. Inputs are assumed to
+// be time-ordered themselves; a record older than the last one returned is
+// still passed through and counted in Stats::outOfOrder.
+//
+// With dropDuplicates, a record whose bytes match one already returned from
+// a different input no more than dedupWindowUsec earlier is skipped. Recent
+// records are remembered as (64-bit hash, length, input) in a fixed ring of
+// dedupMaxEntries with an open-addressing index, so the window is bounded
+// in time and in memory. Repeats within one input are real traffic and are
+// kept; the newest one replaces the older entry, so identical frames never
+// pile up in the index.
+class CaptureMerger {
+public:
+    struct Options {
+        ReadMode mode = ReadMode::MemoryMapped;
+        bool dropDuplicates = false;
+        uint64_t dedupWindowUsec = 1000;
+        size_t dedupMaxEntries = 65536;
+    };
+
+    struct Stats {
+        uint64_t packetsRead = 0;
+        uint64_t packetsMerged = 0;  // Returned by getNextPacket()
+        uint64_t duplicates = 0;
+        uint64_t outOfOrder = 0;
+    };
+
+private:
+    struct Input {
+        std::unique_ptr<IFileReaderDevice> reader;
+        RawPacketView view;
+    };
+
+    struct Head {
+        uint64_t timestampUsec;
+        uint32_t input;
+    };
+
+    struct Seen {
+        uint64_t hash;
+        uint64_t timestampUsec;
+        uint32_t length;
+        uint32_t input;
+        bool live;  // False once replaced by a newer repeat from the same input
+    };
+
+    static constexpr uint32_t kNone = 0xFFFFFFFF;
+
+    Options options_;
+    Stats stats_;
+    std::vector<Input> inputs_;
+    std::vector<Head> heap_;
+    uint32_t pending_ = kNone;  // Input whose record was returned last
+    uint64_t lastUsec_ = 0;
+
+    std::vector<Seen> seen_;
+    detail::SlotIndex seenIndex_;
+    size_t seenOldest_ = 0;
+    size_t seenCount_ = 0;
+
+    static bool later(const Head& a, const Head& b) {
+        return a.timestampUsec != b.timestampUsec ? a.timestampUsec > b.timestampUsec : a.input > b.input;
+    }
+
+    static uint64_t toUsec(const RawPacketView& view) {
+        return static_cast<uint64_t>(view.timestamp_sec) * 1000000 + view.timestamp_usec;
+    }
+
+    // Read the next record of `i` into the heap, or drop the reader at EOF
+    void advance(uint32_t i) {
+        Input& in = inputs_[i];
+        if (in.reader && in.reader->getNextPacket(in.view)) {
+            heap_.push_back({toUsec(in.view), i});
+            std::push_heap(heap_.begin(), heap_.end(), later);
+        } else {
+            in.reader.reset();
+        }
+    }
+
+    void forgetOldest() {
+        const Seen& s = seen_[seenOldest_];
+        if (s.live) seenIndex_.erase(s.hash, static_cast<uint32_t>(seenOldest_));
+        seenOldest_ = (seenOldest_ + 1) % seen_.size();
+        --seenCount_;
+    }
+
+    bool isDuplicate(const RawPacketView& view, uint64_t timestampUsec, uint32_t input) {
+        while (seenCount_ > 0 && timestampUsec > seen_[seenOldest_].timestampUsec &&
+               timestampUsec - seen_[seenOldest_].timestampUsec > options_.dedupWindowUsec) {
+            forgetOldest();
+        }
+        uint64_t hash = detail::hashFrame(view.data, view.length);
+        uint32_t match = seenIndex_.find(hash, [&](uint32_t i) {
+            return seen_[i].hash == hash && seen_[i].length == view.length;
+        });
+        if (match != detail::SlotIndex::kNone) {
+            if (seen_[match].input != input) return true;
+            seenIndex_.erase(hash, match);
+            seen_[match].live = false;
+        }
+
+        if (seenCount_ == seen_.size()) forgetOldest();
+        size_t slot = (seenOldest_ + seenCount_) % seen_.size();
+        seen_[slot] = {hash, timestampUsec, view.length, input, true};
+        seenIndex_.insert(hash, static_cast<uint32_t>(slot));
+        ++seenCount_;
+        return false;
+    }
+
+public:
+    CaptureMerger() = default;
+    CaptureMerger(const CaptureMerger&) = delete;
+    CaptureMerger& operator=(const CaptureMerger&) = delete;
+
+    bool open(const std::vector<std::string>& files) { return open(files, Options{}); }
+
+    // Open and read the first record of every file. Fails (and closes
+    // everything) if any file cannot be opened as a capture.
+    bool open(const std::vector<std::string>& files, const Options& options) {
+        close();
+        options_ = options;
+        if (files.size() >= kNone) return false;
+        inputs_.resize(files.size());
+        for (size_t i = 0; i < files.size(); ++i) {
+            inputs_[i].reader.reset(IFileReaderDevice::getReader(files[i], options_.mode));
+            if (!inputs_[i].reader || !inputs_[i].reader->open()) {
+                close();
+                return false;
+            }
+        }
+        if (options_.dropDuplicates) {
+            seen_.resize(std::max<size_t>(options_.dedupMaxEntries, 1));
+            seenIndex_.reserve(seen_.size());
+        }
+        heap_.reserve(inputs_.size());
+        for (size_t i = 0; i < inputs_.size(); ++i) advance(static_cast<uint32_t>(i));
+        return true;
+    }
+
+    // Next record in timestamp order. `view` stays valid until the next
+    // call; `input`, if given, receives the index of the file it came from.
+    bool getNextPacket(RawPacketView& view, size_t* input = nullptr) {
+        // The reader of the last record is only advanced now, so its view
+        // survived until this call
+        if (pending_ != kNone) {
+            advance(pending_);
+            pending_ = kNone;
+        }
+        while (!heap_.empty()) {
+            std::pop_heap(heap_.begin(), heap_.end(), later);
+            Head head = heap_.back();
+            heap_.pop_back();
+            const RawPacketView& next = inputs_[head.input].view;
+            ++stats_.packetsRead;
+
+            if (options_.dropDuplicates && isDuplicate(next, head.timestampUsec, head.input)) {
+                ++stats_.duplicates;
+                advance(head.input);
+                continue;
+            }
+            if (stats_.packetsMerged > 0 && head.timestampUsec < lastUsec_) ++stats_.outOfOrder;
+            lastUsec_ = std::max(lastUsec_, head.timestampUsec);
+            ++stats_.packetsMerged;
+            view = next;
+            if (input) *input = head.input;
+            pending_ = head.input;
+            return true;
+        }
+        return false;
+    }
+
+    bool getNextPacket(RawPacket& packet, size_t* input = nullptr) {
+        RawPacketView view;
+        if (!getNextPacket(view, input)) return false;
+        packet.data.assign(view.data, view.data + view.length);
+        packet.timestamp_sec = view.timestamp_sec;
+        packet.timestamp_usec = view.timestamp_usec;
+        packet.linkType = view.linkType;
+        return true;
+    }
+
+    size_t inputCount() const { return inputs_.size(); }
+    const Stats& stats() const { return stats_; }
+
+    void close() {
+        inputs_.clear();
+        heap_.clear();
+        seen_.clear();
+        seenIndex_ = detail::SlotIndex{};
+        seenOldest_ = seenCount_ = 0;
+        pending_ = kNone;
+        lastUsec_ = 0;
+        stats_ = Stats{};
+    }
+};
+
+// Merge `files` into `outputPath` through IFileWriterDevice. Classic PCAP
+// output needs every input on writerOptions.linkType; use PCAPNG for mixed
+// link types. Returns the merge statistics, or nullopt if a file could not
+// be opened or a record could not be written.
+inline std::optional<CaptureMerger::Stats> mergeCaptures(const std::vector<std::string>& files,
+                                                         const std::string& outputPath,
+                                                         const CaptureMerger::Options& options,
+                                                         const WriterOptions& writerOptions = {}) {
+    CaptureMerger merger;
+    if (!merger.open(files, options)) return std::nullopt;
+    std::unique_ptr<IFileWriterDevice> writer(IFileWriterDevice::getWriter(outputPath, writerOptions));
+    if (!writer || !writer->open()) return std::nullopt;
+    RawPacketView view;
+    while (merger.getNextPacket(view)) {
+        if (!writer->writePacket(view)) return std::nullopt;
+    }
+    if (!writer->flush()) return std::nullopt;
+    writer->close();
+    return merger.stats();
+}
+
+inline std::optional<CaptureMerger::Stats> mergeCaptures(const std::vector<std::string>& files,
+                                                         const std::string& outputPath) {
+    return mergeCaptures(files, outputPath, CaptureMerger::Options{});
+}
+
+} // namespace pcap
@@ -1,11 +1,50 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <cstring>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Optional decoding of compressed captures (.pcap.gz, .pcapng.zst). The build
+// defines these to 1 when zlib / libzstd are available.
+#ifndef PCAP_HAVE_ZLIB
+#define PCAP_HAVE_ZLIB 0
+#endif
+#ifndef PCAP_HAVE_ZSTD
+#define PCAP_HAVE_ZSTD 0
+#endif
+#if PCAP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#if PCAP_HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 namespace pcap {
 
@@ -22,14 +61,166 @@ enum ProtocolType : uint16_t {
     ICMPv6 = 58 | 0x1000  // Layer 4: ICMP for IPv6
 };
 
+namespace detail {
+
+inline uint16_t loadBE16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t loadBE32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+} // namespace detail
+
+// ============ Layer views ============
+//
+// Non-owning views over one protocol header inside a packet buffer. Packet
+// builds them while parsing, so they are only created when the header is
+// fully inside the captured bytes. Fields are decoded from network byte order
+// on access. A view is valid as long as the buffer it points into.
+
+// Common part of every view: header start and bytes captured from there on
+class LayerView {
+protected:
+    const uint8_t* data_ = nullptr;
+    size_t length_ = 0;
+
+public:
+    LayerView() = default;
+    LayerView(const uint8_t* data, size_t length) : data_(data), length_(length) {}
+
+    const uint8_t* getData() const { return data_; }
+    size_t getDataLen() const { return length_; }
+    explicit operator bool() const { return data_ != nullptr; }
+};
+
+class EthernetView : public LayerView {
+private:
+    uint16_t etherType_ = 0;
+    uint16_t headerLen_ = 14;
+
+public:
+    EthernetView() = default;
+    EthernetView(const uint8_t* data, size_t length, uint16_t etherType, uint16_t headerLen)
+        : LayerView(data, length), etherType_(etherType), headerLen_(headerLen) {}
+
+    const uint8_t* dstMac() const { return data_; }
+    const uint8_t* srcMac() const { return data_ + 6; }
+    // EtherType of the payload, after any VLAN tags
+    uint16_t etherType() const { return etherType_; }
+    // 14 bytes plus 4 per VLAN tag
+    uint16_t headerLength() const { return headerLen_; }
+    bool hasVlan() const { return headerLen_ > 14; }
+};
+
+class ARPView : public LayerView {
+public:
+    using LayerView::LayerView;
+
+    uint16_t hardwareType() const { return detail::loadBE16(data_); }
+    uint16_t protocolType() const { return detail::loadBE16(data_ + 2); }
+    uint16_t opcode() const { return detail::loadBE16(data_ + 6); }  // 1 = request, 2 = reply
+    const uint8_t* senderMac() const { return data_ + 8; }
+    uint32_t senderIp() const { return detail::loadBE32(data_ + 14); }
+    const uint8_t* targetMac() const { return data_ + 18; }
+    uint32_t targetIp() const { return detail::loadBE32(data_ + 24); }
+};
+
+class IPv4View : public LayerView {
+public:
+    using LayerView::LayerView;
+
+    uint8_t version() const { return data_[0] >> 4; }
+    uint8_t headerLength() const { return static_cast<uint8_t>((data_[0] & 0x0F) * 4); }
+    uint8_t tos() const { return data_[1]; }
+    uint16_t totalLength() const { return detail::loadBE16(data_ + 2); }
+    uint16_t id() const { return detail::loadBE16(data_ + 4); }
+    bool dontFragment() const { return (data_[6] & 0x40) != 0; }
+    bool moreFragments() const { return (data_[6] & 0x20) != 0; }
+    // Fragment offset in bytes
+    uint16_t fragmentOffset() const { return static_cast<uint16_t>((detail::loadBE16(data_ + 6) & 0x1FFF) * 8); }
+    bool isFragment() const { return moreFragments() || fragmentOffset() != 0; }
+    uint8_t ttl() const { return data_[8]; }
+    uint8_t protocol() const { return data_[9]; }
+    uint16_t checksum() const { return detail::loadBE16(data_ + 10); }
+    // Addresses in host byte order, e.g. 0xC0A80101 for 192.168.1.1
+    uint32_t srcAddress() const { return detail::loadBE32(data_ + 12); }
+    uint32_t dstAddress() const { return detail::loadBE32(data_ + 16); }
+};
+
+class IPv6View : public LayerView {
+public:
+    using LayerView::LayerView;
+
+    uint8_t version() const { return data_[0] >> 4; }
+    uint8_t trafficClass() const { return static_cast<uint8_t>((detail::loadBE16(data_) >> 4) & 0xFF); }
+    uint32_t flowLabel() const { return detail::loadBE32(data_) & 0x000FFFFF; }
+    uint16_t payloadLength() const { return detail::loadBE16(data_ + 4); }
+    // Next header of the fixed header (may be an extension header)
+    uint8_t nextHeader() const { return data_[6]; }
+    uint8_t hopLimit() const { return data_[7]; }
+    // 16 bytes each, network byte order
+    const uint8_t* srcAddress() const { return data_ + 8; }
+    const uint8_t* dstAddress() const { return data_ + 24; }
+};
+
+class TCPView : public LayerView {
+public:
+    using LayerView::LayerView;
+
+    static constexpr uint8_t FIN = 0x01;
+    static constexpr uint8_t SYN = 0x02;
+    static constexpr uint8_t RST = 0x04;
+    static constexpr uint8_t PSH = 0x08;
+    static constexpr uint8_t ACK = 0x10;
+    static constexpr uint8_t URG = 0x20;
+
+    uint16_t srcPort() const { return detail::loadBE16(data_); }
+    uint16_t dstPort() const { return detail::loadBE16(data_ + 2); }
+    uint32_t seq() const { return detail::loadBE32(data_ + 4); }
+    uint32_t ack() const { return detail::loadBE32(data_ + 8); }
+    uint8_t headerLength() const { return static_cast<uint8_t>((data_[12] >> 4) * 4); }
+    uint8_t flags() const { return data_[13]; }
+    bool hasFlag(uint8_t flag) const { return (data_[13] & flag) != 0; }
+    uint16_t window() const { return detail::loadBE16(data_ + 14); }
+    uint16_t checksum() const { return detail::loadBE16(data_ + 16); }
+    // Captured payload after the header and options (may be truncated)
+    const uint8_t* payload() const { return data_ + std::min<size_t>(headerLength(), length_); }
+    size_t payloadLength() const { return length_ - std::min<size_t>(headerLength(), length_); }
+};
+
+class UDPView : public LayerView {
+public:
+    using LayerView::LayerView;
+
+    uint16_t srcPort() const { return detail::loadBE16(data_); }
+    uint16_t dstPort() const { return detail::loadBE16(data_ + 2); }
+    uint16_t length() const { return detail::loadBE16(data_ + 4); }
+    uint16_t checksum() const { return detail::loadBE16(data_ + 6); }
+    const uint8_t* payload() const { return data_ + 8; }
+    size_t payloadLength() const { return length_ - 8; }
+};
+
+// ICMP and ICMPv6 share the type/code/checksum header
+class ICMPView : public LayerView {
+public:
+    using LayerView::LayerView;
+
+    uint8_t type() const { return data_[0]; }
+    uint8_t code() const { return data_[1]; }
+    uint16_t checksum() const { return detail::loadBE16(data_ + 2); }
+};
+
 // Layer classes for getLayerOfType<T>() support
-struct EthernetLayer {};
-struct ARPLayer {};
-struct IPv4Layer {};
-struct IPv6Layer {};
-struct TCPLayer {};
-struct UDPLayer {};
-struct ICMPLayer {};
+using EthernetLayer = EthernetView;
+using ARPLayer = ARPView;
+using IPv4Layer = IPv4View;
+using IPv6Layer = IPv6View;
+using TCPLayer = TCPView;
+using UDPLayer = UDPView;
+using ICMPLayer = ICMPView;
 
 // Raw packet data container
 class RawPacket {
@@ -43,10 +234,26 @@ public:
     size_t getDataLen() const { return data.size(); }
 };
 
+// Non-owning view of a captured record. Points into the reader's mapped file
+// (or its scratch buffer in stream mode) and is only valid until the next
+// getNextPacket() call or close() on the reader that produced it.
+struct RawPacketView {
+    const uint8_t* data = nullptr;
+    uint32_t length = 0;
+    uint32_t timestamp_sec = 0;
+    uint32_t timestamp_usec = 0;
+    uint32_t linkType = 1;
+
+    const uint8_t* getData() const { return data; }
+    size_t getDataLen() const { return length; }
+};
+
 // Parsed packet with protocol detection
 class Packet {
 private:
-    const RawPacket* rawPacket_;
+    const uint8_t* data_ = nullptr;
+    size_t len_ = 0;
+    uint32_t linkType_ = 1;
     bool hasEthernet_ = false;
     bool hasIPv4_ = false;
     bool hasIPv6_ = false;
@@ -54,17 +261,26 @@ private:
     bool hasTCP_ = false;
     bool hasUDP_ = false;
     bool hasICMP_ = false;
+
+    // Header views, cached while parsing
+    EthernetView ethernet_;
+    ARPView arp_;
+    IPv4View ipv4_;
+    IPv6View ipv6_;
+    TCPView tcp_;
+    UDPView udp_;
+    ICMPView icmp_;
     
     void parsePacket() {
-        if (!rawPacket_ || rawPacket_->getDataLen() < 14) return;
+        if (!data_ || len_ < 14) return;
         
-        const uint8_t* data = rawPacket_->getData();
-        size_t len = rawPacket_->getDataLen();
+        const uint8_t* data = data_;
+        size_t len = len_;
         size_t offset = 0;
         uint16_t etherType = 0;
         
         // Parse based on link layer type
-        if (rawPacket_->linkType == 1) {
+        if (linkType_ == 1) {
             // Ethernet frame: [Dst MAC: 6][Src MAC: 6][EtherType: 2][Payload]
             if (len < 14) return;
             
@@ -93,7 +309,8 @@ private:
                 etherType = (data[offset + 2] << 8) | data[offset + 3];
                 offset += 4;
             }
-        } else if (rawPacket_->linkType == 113) {
+            ethernet_ = EthernetView(data, len, etherType, static_cast<uint16_t>(offset));
+        } else if (linkType_ == 113) {
             // Linux cooked capture: 16-byte header
             if (len < 16) return;
             
@@ -110,6 +327,7 @@ private:
         if (etherType == 0x0800 && offset + 20 <= len) {
             // IPv4 packet
             hasIPv4_ = true;
+            ipv4_ = IPv4View(data + offset, len - offset);
             
             // Get protocol type (byte 9 of IPv4 header)
             uint8_t protocol = data[offset + 9];
@@ -121,14 +339,18 @@ private:
             // Check transport layer protocol
             if (protocol == 6 && offset + 20 <= len) {
                 hasTCP_ = true;
+                tcp_ = TCPView(data + offset, len - offset);
             } else if (protocol == 17 && offset + 8 <= len) {
                 hasUDP_ = true;
+                udp_ = UDPView(data + offset, len - offset);
             } else if (protocol == 1) {
                 hasICMP_ = true;
+                if (offset + 4 <= len) icmp_ = ICMPView(data + offset, len - offset);
             }
         } else if (etherType == 0x86DD && offset + 40 <= len) {
             // IPv6 packet (fixed 40-byte header)
             hasIPv6_ = true;
+            ipv6_ = IPv6View(data + offset, len - offset);
             
             // Get next header field (byte 6)
             uint8_t nextHeader = data[offset + 6];
@@ -138,12 +360,15 @@ private:
             while (offset < len) {
                 if (nextHeader == 6 && offset + 20 <= len) {
                     hasTCP_ = true;
+                    tcp_ = TCPView(data + offset, len - offset);
                     break;
                 } else if (nextHeader == 17 && offset + 8 <= len) {
                     hasUDP_ = true;
+                    udp_ = UDPView(data + offset, len - offset);
                     break;
                 } else if (nextHeader == 58) {
                     hasICMP_ = true;
+                    if (offset + 4 <= len) icmp_ = ICMPView(data + offset, len - offset);
                     break;
                 } else if (nextHeader == 0 || nextHeader == 43 || nextHeader == 44 || 
                            nextHeader == 51 || nextHeader == 60) {
@@ -159,11 +384,23 @@ private:
         } else if (etherType == 0x0806) {
             // ARP packet
             hasARP_ = true;
+            if (offset + 28 <= len) arp_ = ARPView(data + offset, len - offset);
         }
     }
     
 public:
-    Packet(const RawPacket* rawPacket) : rawPacket_(rawPacket) {
+    Packet(const RawPacket* rawPacket) {
+        if (rawPacket) {
+            data_ = rawPacket->getData();
+            len_ = rawPacket->getDataLen();
+            linkType_ = rawPacket->linkType;
+        }
+        parsePacket();
+    }
+
+    // Parse straight out of a reader-owned view, without copying the bytes
+    Packet(const RawPacketView& view)
+        : data_(view.data), len_(view.length), linkType_(view.linkType) {
         parsePacket();
     }
     
@@ -180,67 +417,910 @@ public:
         }
     }
     
-    // Generic getLayerOfType - returns nullptr for unsupported types
-    template<typename T> T* getLayerOfType() const { return nullptr; }
-    
-    // Friend functions to allow specializations
-    template<typename T> friend T* getLayerOfType(const Packet& packet);
+    // Cached header view, or nullptr if the packet has no complete header of
+    // that type. Points into the Packet, so it lives as long as the Packet.
+    template<typename T> const T* getLayerOfType() const {
+        const T* layer = nullptr;
+        if constexpr (std::is_same_v<T, EthernetView>) layer = &ethernet_;
+        else if constexpr (std::is_same_v<T, ARPView>) layer = &arp_;
+        else if constexpr (std::is_same_v<T, IPv4View>) layer = &ipv4_;
+        else if constexpr (std::is_same_v<T, IPv6View>) layer = &ipv6_;
+        else if constexpr (std::is_same_v<T, TCPView>) layer = &tcp_;
+        else if constexpr (std::is_same_v<T, UDPView>) layer = &udp_;
+        else if constexpr (std::is_same_v<T, ICMPView>) layer = &icmp_;
+        return (layer && *layer) ? layer : nullptr;
+    }
+
+    // Header view by value, e.g. packet.getLayer<pcpp::TCPView>()
+    template<typename T> std::optional<T> getLayer() const {
+        const T* layer = getLayerOfType<T>();
+        return layer ? std::optional<T>(*layer) : std::nullopt;
+    }
 };
 
-// Helper functions for getLayerOfType<T>(packet)
-// Generic template - returns nullptr for unsupported types
+// Helper function for getLayerOfType<T>(packet); returns nullptr for
+// unsupported types or missing layers. Never allocates.
 template<typename T>
-inline T* getLayerOfType(const Packet&) { 
-    return nullptr; 
+inline const T* getLayerOfType(const Packet& packet) {
+    return packet.getLayerOfType<T>();
 }
 
-// Specializations for supported layer types
-template<>
-inline EthernetLayer* getLayerOfType<EthernetLayer>(const Packet& packet) {
-    return packet.hasEthernet_ ? new EthernetLayer() : nullptr;
-}
+// Read-only memory mapping of a whole file (RAII)
+class MappedFile {
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
 
-template<>
-inline IPv4Layer* getLayerOfType<IPv4Layer>(const Packet& packet) {
-    return packet.hasIPv4_ ? new IPv4Layer() : nullptr;
-}
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
 
-template<>
-inline IPv6Layer* getLayerOfType<IPv6Layer>(const Packet& packet) {
-    return packet.hasIPv6_ ? new IPv6Layer() : nullptr;
-}
+    bool open(const std::string& filename) {
+        close();
+#if defined(_WIN32)
+        file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
 
-template<>
-inline ARPLayer* getLayerOfType<ARPLayer>(const Packet& packet) {
-    return packet.hasARP_ ? new ARPLayer() : nullptr;
-}
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file_, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) {
+            close();
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (!data_) {
+            close();
+            return false;
+        }
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // The mapping keeps its own reference to the file
+        if (addr == MAP_FAILED) return false;
+
+        // Captures are replayed front to back: ask for aggressive read-ahead
+        madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+        data_ = static_cast<const uint8_t*>(addr);
+        size_ = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
 
-template<>
-inline TCPLayer* getLayerOfType<TCPLayer>(const Packet& packet) {
-    return packet.hasTCP_ ? new TCPLayer() : nullptr;
+    bool isOpen() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    ~MappedFile() {
+        close();
+    }
+};
+
+// Write-only file sink for IFileWriterDevice. Each write() hands a list of
+// segments to the OS in one vectored call (writev / sequential WriteFile).
+class OutputFile {
+public:
+    struct Segment {
+        const void* data;
+        size_t size;
+    };
+
+private:
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+#endif
+
+public:
+    OutputFile() = default;
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    // Create or truncate `filename`
+    bool open(const std::string& filename) {
+        close();
+#if defined(_WIN32)
+        file_ = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                            CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        return file_ != INVALID_HANDLE_VALUE;
+#else
+        fd_ = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        return fd_ >= 0;
+#endif
+    }
+
+    bool write(const Segment* segments, size_t count) {
+#if defined(_WIN32)
+        for (size_t i = 0; i < count; ++i) {
+            const auto* p = static_cast<const uint8_t*>(segments[i].data);
+            size_t left = segments[i].size;
+            while (left > 0) {
+                DWORD chunk = static_cast<DWORD>(std::min<size_t>(left, 1u << 30));
+                DWORD written = 0;
+                if (!WriteFile(file_, p, chunk, &written, nullptr)) return false;
+                p += written;
+                left -= written;
+            }
+        }
+        return true;
+#else
+        iovec iov[8];
+        if (count > 8) return false;
+        for (size_t i = 0; i < count; ++i) {
+            iov[i].iov_base = const_cast<void*>(segments[i].data);
+            iov[i].iov_len = segments[i].size;
+        }
+        iovec* next = iov;
+        int left = static_cast<int>(count);
+        while (left > 0) {
+            ssize_t n = ::writev(fd_, next, left);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            // Skip what was fully written and trim a partially written segment
+            auto done = static_cast<size_t>(n);
+            while (left > 0 && done >= next->iov_len) {
+                done -= next->iov_len;
+                ++next;
+                --left;
+            }
+            if (left > 0) {
+                next->iov_base = static_cast<uint8_t*>(next->iov_base) + done;
+                next->iov_len -= done;
+            }
+        }
+        return true;
+#endif
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+    }
+
+    bool isOpen() const {
+#if defined(_WIN32)
+        return file_ != INVALID_HANDLE_VALUE;
+#else
+        return fd_ >= 0;
+#endif
+    }
+
+    ~OutputFile() {
+        close();
+    }
+};
+
+// Compression of a capture file, detected from its first bytes
+enum class Compression {
+    None,
+    Gzip,  // Needs PCAP_HAVE_ZLIB
+    Zstd   // Needs PCAP_HAVE_ZSTD
+};
+
+inline Compression detectCompression(const uint8_t* p, size_t size) {
+    if (size >= 2 && p[0] == 0x1F && p[1] == 0x8B) return Compression::Gzip;
+    if (size >= 4 && p[0] == 0x28 && p[1] == 0xB5 && p[2] == 0x2F && p[3] == 0xFD) return Compression::Zstd;
+    return Compression::None;
 }
 
-template<>
-inline UDPLayer* getLayerOfType<UDPLayer>(const Packet& packet) {
-    return packet.hasUDP_ ? new UDPLayer() : nullptr;
+inline Compression detectCompression(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    uint8_t magic[4] = {};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    return detectCompression(magic, static_cast<size_t>(file.gcount()));
 }
 
-template<>
-inline ICMPLayer* getLayerOfType<ICMPLayer>(const Packet& packet) {
-    return packet.hasICMP_ ? new ICMPLayer() : nullptr;
+// Whether this build can decode `compression`
+constexpr bool isCompressionSupported(Compression compression) {
+    switch (compression) {
+        case Compression::None: return true;
+        case Compression::Gzip: return PCAP_HAVE_ZLIB != 0;
+        case Compression::Zstd: return PCAP_HAVE_ZSTD != 0;
+    }
+    return false;
 }
 
+namespace detail {
+
+// Streaming decoder over a memory-mapped .gz or .zst capture; PrefetchStream
+// calls read() from its producer thread, so decoding overlaps with parsing.
+//
+// gzip is one deflate stream per member and only decodes front to back
+// (concatenated members are followed). zstd frames are independent: runs of
+// small frames with a known size, as written by pzstd or by concatenating
+// .zst files, are decoded by worker jobs running ahead of the reader and
+// copied out in order. A frame too large to buffer, or of unknown size (a
+// single-frame `zstd` file), is streamed on the calling thread instead, as
+// is everything when there are no cores to spare for workers.
+class Decompressor {
+public:
+    static constexpr size_t kJobBytes = 8u << 20;          // Decoded bytes per worker job
+    static constexpr uint64_t kMaxJobFrame = 16u << 20;    // Larger frames are streamed
+
+private:
+    MappedFile input_;
+    Compression kind_ = Compression::None;
+    size_t inputPos_ = 0;   // Next input byte not yet handed to a decoder
+    bool done_ = false;
+    bool failed_ = false;
+
+#if PCAP_HAVE_ZLIB
+    z_stream zs_{};
+    bool zsReady_ = false;
+#endif
+#if PCAP_HAVE_ZSTD
+    struct Job {
+        std::vector<uint8_t> data;
+        std::future<bool> result;
+        size_t pos = 0;
+        bool ready = false;
+    };
+
+    ZSTD_DCtx* dctx_ = nullptr;
+    std::deque<std::unique_ptr<Job>> jobs_;
+    size_t workers_ = 0;
+    size_t frameEnd_ = 0;   // End of the frame being streamed, 0 if none
+
+    // Decoded size of the frame at `pos` if it can go to a worker job
+    // (0 for skippable frames)
+    std::optional<uint64_t> jobFrame(size_t pos, size_t& compressed) const {
+        const uint8_t* src = input_.data() + pos;
+        size_t left = input_.size() - pos;
+        compressed = ZSTD_findFrameCompressedSize(src, left);
+        if (ZSTD_isError(compressed)) return std::nullopt;
+        unsigned long long content = ZSTD_getFrameContentSize(src, left);
+        if (content == ZSTD_CONTENTSIZE_UNKNOWN || content == ZSTD_CONTENTSIZE_ERROR || content > kMaxJobFrame) {
+            return std::nullopt;
+        }
+        return content;
+    }
+
+    // Queue jobs for the frames at inputPos_ until every worker has one or
+    // a frame has to be streamed
+    void launchJobs() {
+        while (jobs_.size() < workers_ && inputPos_ < input_.size()) {
+            size_t begin = inputPos_;
+            size_t end = begin;
+            uint64_t decoded = 0;
+            while (end < input_.size() && decoded < kJobBytes) {
+                size_t compressed = 0;
+                auto content = jobFrame(end, compressed);
+                if (!content) break;
+                decoded += *content;
+                end += compressed;
+            }
+            if (end == begin) return;
+
+            auto job = std::make_unique<Job>();
+            job->data.resize(decoded);
+            Job* raw = job.get();
+            const uint8_t* src = input_.data();
+            job->result = std::async(std::launch::async, [raw, src, begin, end] {
+                ZSTD_DCtx* ctx = ZSTD_createDCtx();
+                if (!ctx) return false;
+                size_t in = begin;
+                size_t out = 0;
+                bool ok = true;
+                while (ok && in < end) {
+                    size_t compressed = ZSTD_findFrameCompressedSize(src + in, end - in);
+                    size_t n = ZSTD_decompressDCtx(ctx, raw->data.data() + out, raw->data.size() - out,
+                                                   src + in, compressed);
+                    ok = !ZSTD_isError(compressed) && !ZSTD_isError(n);
+                    in += compressed;
+                    out += ok ? n : 0;
+                }
+                ZSTD_freeDCtx(ctx);
+                return ok && out == raw->data.size();
+            });
+            jobs_.push_back(std::move(job));
+            inputPos_ = end;
+        }
+    }
+
+    size_t readZstd(uint8_t* out, size_t capacity) {
+        size_t filled = 0;
+        while (filled < capacity && !done_ && !failed_) {
+            if (frameEnd_ != 0) {
+                // Stream one frame through dctx_
+                ZSTD_inBuffer in{input_.data(), frameEnd_, inputPos_};
+                ZSTD_outBuffer o{out + filled, capacity - filled, 0};
+                size_t ret = ZSTD_decompressStream(dctx_, &o, &in);
+                filled += o.pos;
+                inputPos_ = in.pos;
+                if (ZSTD_isError(ret)) {
+                    failed_ = true;
+                } else if (ret == 0) {
+                    frameEnd_ = 0;
+                } else if (in.pos == frameEnd_ && o.pos < o.size) {
+                    failed_ = true;  // Truncated frame
+                }
+                continue;
+            }
+            if (!jobs_.empty()) {
+                Job& job = *jobs_.front();
+                if (!job.ready) {
+                    job.ready = true;
+                    if (!job.result.get()) {
+                        failed_ = true;
+                        break;
+                    }
+                }
+                size_t n = std::min(capacity - filled, job.data.size() - job.pos);
+                std::memcpy(out + filled, job.data.data() + job.pos, n);
+                job.pos += n;
+                filled += n;
+                if (job.pos == job.data.size()) {
+                    jobs_.pop_front();
+                    launchJobs();
+                }
+                continue;
+            }
+            if (inputPos_ >= input_.size()) {
+                done_ = true;
+                break;
+            }
+            launchJobs();
+            if (jobs_.empty()) {
+                size_t compressed = ZSTD_findFrameCompressedSize(input_.data() + inputPos_, input_.size() - inputPos_);
+                // A truncated last frame still streams out what it holds
+                frameEnd_ = ZSTD_isError(compressed) ? input_.size() : inputPos_ + compressed;
+                ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only);
+            }
+        }
+        return filled;
+    }
+#endif
+
+#if PCAP_HAVE_ZLIB
+    size_t readGzip(uint8_t* out, size_t capacity) {
+        size_t filled = 0;
+        while (filled < capacity && !done_ && !failed_) {
+            if (zs_.avail_in == 0) {
+                if (inputPos_ == input_.size()) {
+                    failed_ = true;  // Truncated member
+                    break;
+                }
+                size_t n = std::min<size_t>(input_.size() - inputPos_, 1u << 30);
+                zs_.next_in = const_cast<Bytef*>(input_.data() + inputPos_);
+                zs_.avail_in = static_cast<uInt>(n);
+                inputPos_ += n;
+            }
+            zs_.next_out = out + filled;
+            zs_.avail_out = static_cast<uInt>(std::min<size_t>(capacity - filled, 1u << 30));
+            uInt before = zs_.avail_out;
+            int ret = inflate(&zs_, Z_NO_FLUSH);
+            filled += before - zs_.avail_out;
+            if (ret == Z_STREAM_END) {
+                // Another member may follow; anything else is trailing padding
+                size_t next = inputPos_ - zs_.avail_in;
+                const uint8_t* p = input_.data() + next;
+                if (detectCompression(p, input_.size() - next) == Compression::Gzip) {
+                    inflateReset(&zs_);
+                } else {
+                    done_ = true;
+                }
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                failed_ = true;
+            }
+        }
+        return filled;
+    }
+#endif
+
+public:
+    Decompressor() = default;
+    Decompressor(const Decompressor&) = delete;
+    Decompressor& operator=(const Decompressor&) = delete;
+
+    // Parallel zstd workers by default: the producer and the parsing thread
+    // already keep two cores busy
+    static size_t defaultWorkers() {
+        unsigned cores = std::thread::hardware_concurrency();
+        return cores > 2 ? std::min<size_t>(cores - 2, 8) : 0;
+    }
+
+    // Map `filename` and prepare to decode it. Fails for uncompressed files
+    // and for formats this build does not support.
+    bool open(const std::string& filename, size_t workers = defaultWorkers()) {
+        (void)workers;
+        if (!input_.open(filename)) return false;
+        kind_ = detectCompression(input_.data(), input_.size());
+#if PCAP_HAVE_ZLIB
+        if (kind_ == Compression::Gzip) {
+            zsReady_ = inflateInit2(&zs_, 15 + 16) == Z_OK;
+            return zsReady_;
+        }
+#endif
+#if PCAP_HAVE_ZSTD
+        if (kind_ == Compression::Zstd) {
+            dctx_ = ZSTD_createDCtx();
+            workers_ = workers;
+            return dctx_ != nullptr;
+        }
+#endif
+        return false;
+    }
+
+    Compression compression() const { return kind_; }
+    uint64_t compressedSize() const { return input_.size(); }
+
+    // True once decoding stopped on corrupt or truncated input
+    bool failed() const { return failed_; }
+
+    // Decode up to `capacity` bytes into `out`. Fills it completely unless
+    // the stream ended (or failed).
+    size_t read(uint8_t* out, size_t capacity) {
+#if PCAP_HAVE_ZLIB
+        if (kind_ == Compression::Gzip) return readGzip(out, capacity);
+#endif
+#if PCAP_HAVE_ZSTD
+        if (kind_ == Compression::Zstd) return readZstd(out, capacity);
+#endif
+        (void)out;
+        (void)capacity;
+        return 0;
+    }
+
+    // Start over from the first decoded byte
+    void rewind() {
+        inputPos_ = 0;
+        done_ = failed_ = false;
+#if PCAP_HAVE_ZLIB
+        if (zsReady_) {
+            inflateReset(&zs_);
+            zs_.avail_in = 0;
+        }
+#endif
+#if PCAP_HAVE_ZSTD
+        jobs_.clear();  // Waits for jobs still running
+        frameEnd_ = 0;
+#endif
+    }
+
+    ~Decompressor() {
+#if PCAP_HAVE_ZLIB
+        if (zsReady_) inflateEnd(&zs_);
+#endif
+#if PCAP_HAVE_ZSTD
+        jobs_.clear();
+        ZSTD_freeDCtx(dctx_);
+#endif
+    }
+};
+
+} // namespace detail
+
+// Read-ahead for ReadMode::Prefetch. A producer thread fills large aligned
+// buffers from the file and publishes them through a lock-free
+// single-producer / single-consumer ring; the reading thread parses straight
+// out of them, so disk latency overlaps with parsing. Blocking on an empty
+// or full ring uses std::atomic wait/notify rather than a mutex.
+//
+// Compressed files are decoded by the producer (see detail::Decompressor);
+// positions are then offsets into the decoded stream, and seeking backwards
+// decodes again from the start.
+class PrefetchStream {
+public:
+    static constexpr size_t kBufferSize = 4u << 20;
+    static constexpr size_t kSlots = 4;
+    static constexpr size_t kAlignment = 4096;
+
+private:
+    struct AlignedDelete {
+        void operator()(uint8_t* p) const { ::operator delete[](p, std::align_val_t(kAlignment)); }
+    };
+
+    struct Slot {
+        std::unique_ptr<uint8_t[], AlignedDelete> data;
+        size_t size = 0;
+        bool last = false;  // Short read: end of file (or a read error)
+    };
+
+    std::ifstream file_;            // Touched only by the producer while it runs
+    std::unique_ptr<detail::Decompressor> decoder_;  // Likewise; null for plain files
+    uint64_t fileSize_ = 0;
+    std::array<Slot, kSlots> slots_;
+    std::atomic<uint64_t> produced_{0};  // Slots published so far
+    std::atomic<uint64_t> consumed_{0};  // Slots handed back so far
+    std::atomic<bool> stop_{false};
+    std::thread producer_;
+
+    // Consumer side
+    uint64_t taken_ = 0;            // Slots taken from the ring
+    const Slot* current_ = nullptr;
+    size_t pos_ = 0;                // Read position inside *current_
+    uint64_t base_ = 0;             // File offset of current_->data[0]
+    bool eof_ = false;
+
+    void produce() {
+        uint64_t n = produced_.load(std::memory_order_relaxed);
+        for (;;) {
+            // Load consumed_ before stop_: stop() sets stop_ and then bumps
+            // consumed_, so either stop_ is seen here or `done` is stale and
+            // the wait below returns at once
+            uint64_t done = consumed_.load(std::memory_order_acquire);
+            if (stop_.load(std::memory_order_relaxed)) return;
+            if (done + kSlots <= n) {
+                consumed_.wait(done, std::memory_order_acquire);
+                continue;
+            }
+            Slot& slot = slots_[n % kSlots];
+            if (decoder_) {
+                slot.size = decoder_->read(slot.data.get(), kBufferSize);
+            } else {
+                file_.read(reinterpret_cast<char*>(slot.data.get()), static_cast<std::streamsize>(kBufferSize));
+                slot.size = static_cast<size_t>(file_.gcount());
+            }
+            slot.last = slot.size < kBufferSize;
+            produced_.store(++n, std::memory_order_release);
+            produced_.notify_one();
+            if (slot.last) return;
+        }
+    }
+
+    void start(uint64_t offset) {
+        if (decoder_) {
+            decoder_->rewind();
+        } else {
+            file_.clear();
+            file_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        }
+        produced_.store(0, std::memory_order_relaxed);
+        consumed_.store(0, std::memory_order_relaxed);
+        stop_.store(false, std::memory_order_relaxed);
+        taken_ = 0;
+        current_ = nullptr;
+        pos_ = 0;
+        base_ = offset;
+        eof_ = false;
+        producer_ = std::thread([this] { produce(); });
+    }
+
+    void stop() {
+        if (!producer_.joinable()) return;
+        stop_.store(true, std::memory_order_relaxed);
+        // Change the value the producer may be waiting on, then wake it
+        consumed_.fetch_add(kSlots, std::memory_order_release);
+        consumed_.notify_one();
+        producer_.join();
+    }
+
+    // Hand the current buffer back and wait for the next one
+    bool advance() {
+        if (eof_) return false;
+        if (current_) {
+            bool last = current_->last;
+            base_ += current_->size;
+            current_ = nullptr;
+            consumed_.store(taken_, std::memory_order_release);
+            consumed_.notify_one();
+            if (last) {
+                eof_ = true;
+                return false;
+            }
+        }
+        uint64_t ready = produced_.load(std::memory_order_acquire);
+        while (ready == taken_) {
+            produced_.wait(ready, std::memory_order_acquire);
+            ready = produced_.load(std::memory_order_acquire);
+        }
+        current_ = &slots_[taken_ % kSlots];
+        ++taken_;
+        pos_ = 0;
+        return true;
+    }
+
+    size_t available() const { return current_ ? current_->size - pos_ : 0; }
+
+public:
+    PrefetchStream() = default;
+    PrefetchStream(const PrefetchStream&) = delete;
+    PrefetchStream& operator=(const PrefetchStream&) = delete;
+
+    // Plain captures are read as they are; gzip and zstd ones are decoded
+    // when this build supports them, and refused otherwise
+    bool open(const std::string& filename) {
+        if (detectCompression(filename) != Compression::None) {
+            decoder_ = std::make_unique<detail::Decompressor>();
+            if (!decoder_->open(filename)) return false;
+            fileSize_ = decoder_->compressedSize();
+        } else {
+            file_.open(filename, std::ios::binary | std::ios::ate);
+            if (!file_) return false;
+            fileSize_ = static_cast<uint64_t>(file_.tellg());
+        }
+        for (auto& slot : slots_) {
+            slot.data.reset(static_cast<uint8_t*>(::operator new[](kBufferSize, std::align_val_t(kAlignment))));
+        }
+        start(0);
+        return true;
+    }
+
+    // Size of the file on disk (compressed size for compressed files)
+    uint64_t size() const { return fileSize_; }
+    uint64_t position() const { return base_ + pos_; }
+    Compression compression() const { return decoder_ ? decoder_->compression() : Compression::None; }
+
+    // Restart read-ahead from `offset`; buffered data is discarded
+    bool seek(uint64_t offset) {
+        if (!decoder_ && offset > fileSize_) return false;
+        if (current_ && offset >= base_ && offset <= base_ + current_->size) {
+            pos_ = static_cast<size_t>(offset - base_);
+            return true;
+        }
+        if (!decoder_) {
+            stop();
+            start(offset);
+            return true;
+        }
+        // A decoded stream is only readable forwards
+        if (offset < position()) {
+            stop();
+            start(0);
+        }
+        while (position() < offset) {
+            if (available() == 0 && !advance()) return false;
+            pos_ += static_cast<size_t>(std::min<uint64_t>(available(), offset - position()));
+        }
+        return true;
+    }
+
+    bool read(void* dst, size_t len) {
+        auto* out = static_cast<uint8_t*>(dst);
+        while (len > 0) {
+            if (available() == 0 && !advance()) return false;
+            size_t n = std::min(len, available());
+            std::memcpy(out, current_->data.get() + pos_, n);
+            pos_ += n;
+            out += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    // Point `out` into the current buffer when the bytes are contiguous
+    // there; a record split across two buffers is copied into `sink`
+    bool take(size_t len, std::vector<uint8_t>& sink, const uint8_t*& out) {
+        if (available() == 0 && len > 0 && !advance()) return false;
+        if (available() >= len) {
+            out = current_ ? current_->data.get() + pos_ : sink.data();
+            pos_ += len;
+            return true;
+        }
+        sink.resize(len);
+        out = sink.data();
+        return read(sink.data(), len);
+    }
+
+    ~PrefetchStream() {
+        stop();
+    }
+};
+
+// How IFileReaderDevice pulls bytes from disk
+enum class ReadMode {
+    Stream,        // std::ifstream, each record copied into a buffer
+    MemoryMapped,  // mmap the whole capture, records are views into the mapping
+    Prefetch       // Background thread reads ahead into large buffers, records are views into them
+};
+
+// PCAPNG interface state, from its Interface Description Block (IDB) and the
+// latest Interface Statistics Block (ISB) that referenced it
+struct PcapNGInterface {
+    uint32_t linkType = 1;
+    uint32_t snapLen = 0;            // 0 = unlimited
+    uint8_t tsResolution = 6;        // Raw if_tsresol: 10^-n, or 2^-n when the MSB is set
+    int64_t tsOffset = 0;            // if_tsoffset, seconds added to every timestamp
+    bool hasStatistics = false;
+    uint64_t packetsReceived = 0;    // isb_ifrecv
+    uint64_t packetsDropped = 0;     // isb_ifdrop
+
+    // Timestamp ticks to (sec, usec), precomputed from tsResolution
+    uint64_t ticksPerSecond = 1000000;
+    uint64_t usecMultiplier = 1;     // Decimal resolutions coarser than 1 us
+    uint64_t usecDivisor = 1;        // Decimal resolutions finer than 1 us
+    uint8_t binaryShift = 0;         // Binary resolutions: usec = frac * 10^6 >> shift
+
+    void setResolution(uint8_t tsresol) {
+        tsResolution = tsresol;
+        uint8_t exponent = tsresol & 0x7F;
+        usecMultiplier = 1;
+        usecDivisor = 1;
+        binaryShift = 0;
+        if (tsresol & 0x80) {
+            exponent = exponent > 63 ? 63 : exponent;
+            ticksPerSecond = uint64_t{1} << exponent;
+            binaryShift = exponent;
+        } else {
+            exponent = exponent > 19 ? 19 : exponent;
+            ticksPerSecond = 1;
+            for (uint8_t i = 0; i < exponent; ++i) ticksPerSecond *= 10;
+            for (uint8_t i = exponent; i < 6; ++i) usecMultiplier *= 10;
+            for (uint8_t i = 6; i < exponent; ++i) usecDivisor *= 10;
+        }
+    }
+
+    void toTimeval(uint64_t ticks, uint32_t& sec, uint32_t& usec) const {
+        uint64_t frac = ticks % ticksPerSecond;
+        sec = static_cast<uint32_t>(static_cast<int64_t>(ticks / ticksPerSecond) + tsOffset);
+        if (binaryShift == 0) {
+            usec = static_cast<uint32_t>(frac * usecMultiplier / usecDivisor);
+        } else if (binaryShift <= 44) {
+            // frac < 2^44, so frac * 10^6 < 2^64
+            usec = static_cast<uint32_t>((frac * 1000000) >> binaryShift);
+        } else {
+            usec = static_cast<uint32_t>(((frac >> (binaryShift - 44)) * 1000000) >> 44);
+        }
+    }
+};
+
+// Sparse (timestamp, offset, packet number) index over a capture, built by
+// IFileReaderDevice::buildIndex() and saved as a sidecar next to it. One
+// entry every `interval` records bounds a seek to a binary search plus at
+// most `interval` record reads. PCAPNG files also keep each section's SHB
+// and IDB offsets so a seek can rebuild the interface table directly.
+struct CaptureIndex {
+    struct Entry {
+        uint64_t timestampUsec;
+        uint64_t offset;        // File offset to resume reading from
+        uint64_t packetNumber;  // Zero-based record number read next from `offset`
+        uint32_t section;       // Index into `sections`, kNoSection before the first SHB
+    };
+
+    struct Section {
+        uint64_t offset;                          // Section Header Block
+        std::vector<uint64_t> interfaceOffsets;   // Its Interface Description Blocks
+    };
+
+    static constexpr uint32_t kNoSection = 0xFFFFFFFF;
+    static constexpr uint32_t kMagic = 0x58494350;  // "PCIX"
+    static constexpr uint32_t kVersion = 1;
+
+    uint32_t interval = 0;
+    uint64_t captureSize = 0;   // Size of the indexed file; a mismatch means the sidecar is stale
+    uint64_t packetCount = 0;
+    std::vector<Section> sections;
+    std::vector<Entry> entries;
+
+    static std::string sidecarPath(const std::string& capturePath) { return capturePath + ".idx"; }
+
+    bool save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        auto put = [&out](const auto& value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        put(kMagic);
+        put(kVersion);
+        put(interval);
+        put(static_cast<uint32_t>(sections.size()));
+        put(captureSize);
+        put(packetCount);
+        put(static_cast<uint64_t>(entries.size()));
+        for (const auto& section : sections) {
+            put(section.offset);
+            put(static_cast<uint32_t>(section.interfaceOffsets.size()));
+            for (uint64_t offset : section.interfaceOffsets) put(offset);
+        }
+        for (const auto& e : entries) {
+            put(e.timestampUsec);
+            put(e.offset);
+            put(e.packetNumber);
+            put(e.section);
+        }
+        return static_cast<bool>(out);
+    }
+
+    static std::optional<CaptureIndex> load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return std::nullopt;
+        auto get = [&in](auto& value) {
+            in.read(reinterpret_cast<char*>(&value), sizeof(value));
+            return static_cast<bool>(in);
+        };
+
+        CaptureIndex index;
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t sectionCount = 0;
+        uint64_t entryCount = 0;
+        if (!get(magic) || magic != kMagic || !get(version) || version != kVersion) return std::nullopt;
+        if (!get(index.interval) || !get(sectionCount) || !get(index.captureSize) || !get(index.packetCount) ||
+            !get(entryCount)) {
+            return std::nullopt;
+        }
+        // Every entry accounts for at least one record
+        if (index.interval == 0 || entryCount > index.packetCount) return std::nullopt;
+
+        for (uint32_t i = 0; i < sectionCount && in; ++i) {
+            Section section;
+            uint32_t interfaceCount = 0;
+            if (!get(section.offset) || !get(interfaceCount) || interfaceCount > 65536) return std::nullopt;
+            section.interfaceOffsets.resize(interfaceCount);
+            for (auto& offset : section.interfaceOffsets) {
+                if (!get(offset)) return std::nullopt;
+            }
+            index.sections.push_back(std::move(section));
+        }
+        index.entries.resize(static_cast<size_t>(entryCount));
+        for (auto& e : index.entries) {
+            if (!get(e.timestampUsec) || !get(e.offset) || !get(e.packetNumber) || !get(e.section)) {
+                return std::nullopt;
+            }
+            if (e.section != kNoSection && e.section >= index.sections.size()) return std::nullopt;
+        }
+        return index;
+    }
+};
+
 // PCAP/PCAPNG file reader
 class IFileReaderDevice {
 private:
     std::ifstream file_;
+    MappedFile map_;
+    std::unique_ptr<PrefetchStream> prefetch_;
+    ReadMode mode_ = ReadMode::Stream;
+    size_t mapPos_ = 0;
     bool isPcapNG_ = false;
+    bool nanoTimestamps_ = false;
     uint32_t linkType_ = 1;
     bool swapBytes_ = false;
-    std::vector<uint32_t> interfaceLinkTypes_;
+    std::vector<PcapNGInterface> interfaces_;
+    std::vector<uint8_t> scratch_;  // Record storage for views in stream mode
+    std::function<bool(const RawPacketView&)> filter_;
+    uint64_t fileSize_ = 0;
+    uint64_t dataStart_ = 0;        // Offset of the first record (after the PCAP file header)
+    uint64_t recordIndex_ = 0;      // Zero-based number of the next record
+    CaptureIndex index_;
+    CaptureIndex* indexing_ = nullptr;  // Collects SHB/IDB offsets while buildIndex() runs
+
+    // Sanity bounds: a corrupt length must not turn into a multi-GB read or
+    // an unbounded interface table
+    static constexpr uint32_t kMaxBlockLength = 64u * 1024 * 1024;
+    static constexpr size_t kMaxInterfaces = 65536;
 
     uint16_t swap16(uint16_t val) const {
-        return swapBytes_ ? ((val << 8) | (val >> 8)) : val;
+        return swapBytes_ ? static_cast<uint16_t>((val << 8) | (val >> 8)) : val;
     }
     
     uint32_t swap32(uint32_t val) const {
@@ -248,143 +1328,550 @@ private:
         return ((val << 24) | ((val << 8) & 0x00FF0000) | 
                 ((val >> 8) & 0x0000FF00) | (val >> 24));
     }
-    
-    bool readPcapNGBlock(RawPacket& packet) {
-        uint32_t blockType, blockLen;
-        file_.read(reinterpret_cast<char*>(&blockType), 4);
-        file_.read(reinterpret_cast<char*>(&blockLen), 4);
-        
-        if (!file_ || blockLen < 12) return false;
-        
-        blockType = swap32(blockType);
-        blockLen = swap32(blockLen);
-        
-        if (blockType == 0x00000006) {
-            // Enhanced Packet Block - contains packet data
-            uint32_t interfaceId, capturedLen, packetLen;
-            uint64_t timestamp;
-            
-            file_.read(reinterpret_cast<char*>(&interfaceId), 4);
-            interfaceId = swap32(interfaceId);
-            file_.read(reinterpret_cast<char*>(&timestamp), 8);
-            file_.read(reinterpret_cast<char*>(&capturedLen), 4);
-            file_.read(reinterpret_cast<char*>(&packetLen), 4);
-            
-            capturedLen = swap32(capturedLen);
-            packet.data.resize(capturedLen);
-            file_.read(reinterpret_cast<char*>(packet.data.data()), capturedLen);
-            
-            // Set link type based on interface
-            if (interfaceId < interfaceLinkTypes_.size()) {
-                packet.linkType = interfaceLinkTypes_[interfaceId];
-            } else {
-                packet.linkType = 1;
+
+    uint16_t load16(const uint8_t* p) const {
+        uint16_t val;
+        std::memcpy(&val, p, 2);
+        return swap16(val);
+    }
+
+    uint32_t load32(const uint8_t* p) const {
+        uint32_t val;
+        std::memcpy(&val, p, 4);
+        return swap32(val);
+    }
+
+    // PCAPNG timestamps are two 32-bit words, high word first
+    uint64_t loadTimestamp(const uint8_t* p) const {
+        return (static_cast<uint64_t>(load32(p)) << 32) | load32(p + 4);
+    }
+
+    // 64-bit option values are stored as a single number in section byte order
+    uint64_t loadOption64(const uint8_t* p) const {
+        uint64_t val;
+        std::memcpy(&val, p, 8);
+        if (!swapBytes_) return val;
+        return (static_cast<uint64_t>(swap32(static_cast<uint32_t>(val))) << 32) |
+               swap32(static_cast<uint32_t>(val >> 32));
+    }
+
+    // Copy the next `len` bytes into `dst` (used for small fixed headers)
+    bool readBytes(void* dst, size_t len) {
+        if (mode_ == ReadMode::Prefetch) return prefetch_ && prefetch_->read(dst, len);
+        if (mode_ == ReadMode::MemoryMapped) {
+            if (map_.size() - mapPos_ < len) return false;
+            std::memcpy(dst, map_.data() + mapPos_, len);
+            mapPos_ += len;
+            return true;
+        }
+        file_.read(static_cast<char*>(dst), static_cast<std::streamsize>(len));
+        return static_cast<bool>(file_);
+    }
+
+    // Point `out` at the next `len` bytes and advance past them. Mapped files
+    // hand out a pointer into the mapping, prefetch mode into its current
+    // buffer; streams read into `sink`.
+    bool takeBytes(size_t len, std::vector<uint8_t>& sink, const uint8_t*& out) {
+        if (mode_ == ReadMode::Prefetch) return prefetch_ && prefetch_->take(len, sink, out);
+        if (mode_ == ReadMode::MemoryMapped) {
+            if (map_.size() - mapPos_ < len) return false;
+            out = map_.data() + mapPos_;
+            mapPos_ += len;
+            return true;
+        }
+        sink.resize(len);
+        file_.read(reinterpret_cast<char*>(sink.data()), static_cast<std::streamsize>(len));
+        out = sink.data();
+        return static_cast<bool>(file_);
+    }
+
+    uint64_t position() {
+        if (mode_ == ReadMode::Prefetch) return prefetch_ ? prefetch_->position() : 0;
+        if (mode_ == ReadMode::MemoryMapped) return mapPos_;
+        auto pos = file_.tellg();
+        return pos < 0 ? fileSize_ : static_cast<uint64_t>(pos);
+    }
+
+    bool seekTo(uint64_t offset) {
+        // Offsets in a compressed file are positions in the decoded stream
+        if (offset > fileSize_ && getCompression() == Compression::None) return false;
+        if (mode_ == ReadMode::Prefetch) return prefetch_ && prefetch_->seek(offset);
+        if (mode_ == ReadMode::MemoryMapped) {
+            mapPos_ = static_cast<size_t>(offset);
+            return true;
+        }
+        file_.clear();
+        file_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        return static_cast<bool>(file_);
+    }
+
+    // Re-enter a PCAPNG section: byte order from its SHB, interfaces from
+    // the IDBs that precede `before`
+    bool restoreSection(const CaptureIndex::Section& section, uint64_t before) {
+        uint8_t header[12];
+        if (!seekTo(section.offset) || !readBytes(header, sizeof(header))) return false;
+        uint32_t magic;
+        std::memcpy(&magic, header + 8, 4);
+        if (magic != 0x1A2B3C4D && magic != 0x4D3C2B1A) return false;
+        swapBytes_ = magic == 0x4D3C2B1A;
+        interfaces_.clear();
+
+        for (uint64_t offset : section.interfaceOffsets) {
+            if (offset >= before) break;
+            uint8_t blockHeader[8];
+            if (!seekTo(offset) || !readBytes(blockHeader, sizeof(blockHeader))) return false;
+            uint32_t blockLen = load32(blockHeader + 4);
+            if (load32(blockHeader) != 0x00000001 || blockLen < 12 || blockLen > kMaxBlockLength) return false;
+            const uint8_t* body;
+            if (!takeBytes(blockLen - 8, scratch_, body)) return false;
+            parseInterfaceDescription(body, blockLen - 12);
+        }
+        return true;
+    }
+
+    bool readPcapRecord(RawPacketView& view, std::vector<uint8_t>& sink) {
+        // Record header: [ts_sec: 4][ts_frac: 4][incl_len: 4][orig_len: 4]
+        uint8_t header[16];
+        if (!readBytes(header, sizeof(header))) return false;
+
+        uint32_t inclLen = load32(header + 8);
+        if (inclLen > kMaxBlockLength) return false;
+        const uint8_t* body;
+        if (!takeBytes(inclLen, sink, body)) return false;
+
+        view.data = body;
+        view.length = inclLen;
+        view.timestamp_sec = load32(header);
+        view.timestamp_usec = nanoTimestamps_ ? load32(header + 4) / 1000 : load32(header + 4);
+        view.linkType = linkType_;
+        return true;
+    }
+
+    // Walk PCAPNG options in [p, end): calls fn(code, value, length) for each
+    template<typename Fn>
+    void forEachOption(const uint8_t* p, const uint8_t* end, Fn&& fn) const {
+        while (end - p >= 4) {
+            uint16_t code = load16(p);
+            uint16_t len = load16(p + 2);
+            p += 4;
+            if (code == 0 || end - p < len) return;  // opt_endofopt or truncated
+            fn(code, p, len);
+            p += (len + 3u) & ~3u;
+        }
+    }
+
+    void parseInterfaceDescription(const uint8_t* body, uint32_t bodyLen) {
+        // [linktype: 2][reserved: 2][snaplen: 4][options...]
+        if (bodyLen < 8 || interfaces_.size() >= kMaxInterfaces) return;
+
+        PcapNGInterface iface;
+        iface.linkType = load16(body);
+        iface.snapLen = load32(body + 4);
+        forEachOption(body + 8, body + bodyLen, [&](uint16_t code, const uint8_t* value, uint16_t len) {
+            if (code == 9 && len >= 1) {
+                iface.setResolution(value[0]);          // if_tsresol
+            } else if (code == 14 && len >= 8) {
+                iface.tsOffset = static_cast<int64_t>(loadOption64(value));  // if_tsoffset
+            }
+        });
+        interfaces_.push_back(iface);
+    }
+
+    void parseInterfaceStatistics(const uint8_t* body, uint32_t bodyLen) {
+        // [interface: 4][ts_high: 4][ts_low: 4][options...]
+        if (bodyLen < 12) return;
+
+        uint32_t interfaceId = load32(body);
+        if (interfaceId >= interfaces_.size()) return;
+
+        PcapNGInterface& iface = interfaces_[interfaceId];
+        iface.hasStatistics = true;
+        forEachOption(body + 12, body + bodyLen, [&](uint16_t code, const uint8_t* value, uint16_t len) {
+            if (code == 4 && len >= 8) {
+                iface.packetsReceived = loadOption64(value);  // isb_ifrecv
+            } else if (code == 5 && len >= 8) {
+                iface.packetsDropped = loadOption64(value);   // isb_ifdrop
             }
+        });
+    }
 
-            // Skip padding and options
-            uint32_t padding = (4 - (capturedLen % 4)) % 4;
-            uint32_t remainingBytes = blockLen - 28 - capturedLen - padding;
-            file_.seekg(padding + remainingBytes, std::ios::cur);
-            
-            return file_.good();
-        } else if (blockType == 0x00000001) {
-            // Interface Description Block
-            uint16_t linkType;
-            file_.read(reinterpret_cast<char*>(&linkType), 2);
-            linkType = swap16(linkType);
-            interfaceLinkTypes_.push_back(linkType);
-
-            file_.seekg(blockLen - 10, std::ios::cur);
-            return readPcapNGBlock(packet);
-        } else if (blockType == 0x0A0D0D0A) {
-            // Section Header Block
-            interfaceLinkTypes_.clear();
-            file_.seekg(blockLen - 8, std::ios::cur);
-            return readPcapNGBlock(packet);
+    void fillPacket(RawPacketView& view, uint32_t interfaceId, uint64_t ticks, bool hasTimestamp,
+                    const uint8_t* data, uint32_t capturedLen) const {
+        view.data = data;
+        view.length = capturedLen;
+        view.timestamp_sec = 0;
+        view.timestamp_usec = 0;
+        if (interfaceId < interfaces_.size()) {
+            const PcapNGInterface& iface = interfaces_[interfaceId];
+            view.linkType = iface.linkType;
+            if (hasTimestamp) iface.toTimeval(ticks, view.timestamp_sec, view.timestamp_usec);
+        } else {
+            view.linkType = 1;
+            if (hasTimestamp) PcapNGInterface().toTimeval(ticks, view.timestamp_sec, view.timestamp_usec);
+        }
+    }
+
+    // Iterative block walker: consumes non-packet blocks until the next packet
+    // record, so stack use is constant however many IDB/SHB/ISB blocks appear
+    bool readPcapNGBlock(RawPacketView& view, std::vector<uint8_t>& sink) {
+        while (true) {
+            uint64_t blockStart = indexing_ ? position() : 0;
+            uint8_t header[8];
+            if (!readBytes(header, sizeof(header))) return false;
+
+            uint32_t blockType = load32(header);
+            uint32_t blockLen;
+            const uint8_t* body;
+
+            if (blockType == 0x0A0D0D0A) {
+                // Section Header Block: the byte-order magic decides how to
+                // read everything in this section, including this block's length
+                uint8_t byteOrder[4];
+                if (!readBytes(byteOrder, sizeof(byteOrder))) return false;
+                uint32_t magic;
+                std::memcpy(&magic, byteOrder, 4);
+                if (magic == 0x1A2B3C4D) {
+                    swapBytes_ = false;
+                } else if (magic == 0x4D3C2B1A) {
+                    swapBytes_ = true;
+                } else {
+                    return false;
+                }
+                blockLen = load32(header + 4);
+                if (blockLen < 28 || blockLen > kMaxBlockLength || blockLen % 4) return false;
+                if (!takeBytes(blockLen - 12, sink, body)) return false;
+                interfaces_.clear();
+                if (indexing_) indexing_->sections.push_back({blockStart, {}});
+                continue;
+            }
+
+            blockLen = load32(header + 4);
+            if (blockLen < 12 || blockLen > kMaxBlockLength) return false;
+
+            // Block body, including the trailing copy of the block length
+            if (!takeBytes(blockLen - 8, sink, body)) return false;
+            uint32_t bodyLen = blockLen - 12;
+
+            switch (blockType) {
+                case 0x00000006: {
+                    // Enhanced Packet Block
+                    // [interface: 4][ts_high: 4][ts_low: 4][captured: 4][original: 4][data...][options...]
+                    if (bodyLen < 20) return false;
+                    uint32_t capturedLen = load32(body + 12);
+                    if (capturedLen > bodyLen - 20) return false;
+                    fillPacket(view, load32(body), loadTimestamp(body + 4), true, body + 20, capturedLen);
+                    return true;
+                }
+                case 0x00000003: {
+                    // Simple Packet Block: always interface 0, no timestamp
+                    // [original: 4][data...], captured length is min(original, snaplen, block)
+                    if (bodyLen < 4) return false;
+                    uint32_t capturedLen = load32(body);
+                    if (capturedLen > bodyLen - 4) capturedLen = bodyLen - 4;
+                    if (!interfaces_.empty() && interfaces_[0].snapLen != 0 && capturedLen > interfaces_[0].snapLen) {
+                        capturedLen = interfaces_[0].snapLen;
+                    }
+                    fillPacket(view, 0, 0, false, body + 4, capturedLen);
+                    return true;
+                }
+                case 0x00000002: {
+                    // Obsolete Packet Block
+                    // [interface: 2][drops: 2][ts_high: 4][ts_low: 4][captured: 4][original: 4][data...]
+                    if (bodyLen < 20) return false;
+                    uint32_t capturedLen = load32(body + 12);
+                    if (capturedLen > bodyLen - 20) return false;
+                    fillPacket(view, load16(body), loadTimestamp(body + 4), true, body + 20, capturedLen);
+                    return true;
+                }
+                case 0x00000001:
+                    // Interface Description Block
+                    parseInterfaceDescription(body, bodyLen);
+                    if (indexing_ && !indexing_->sections.empty()) {
+                        indexing_->sections.back().interfaceOffsets.push_back(blockStart);
+                    }
+                    break;
+                case 0x00000005:
+                    // Interface Statistics Block
+                    parseInterfaceStatistics(body, bodyLen);
+                    break;
+                default:
+                    // Name resolution, decryption secrets, custom blocks... (already consumed)
+                    break;
+            }
+        }
+    }
+
+    bool isOpenForReading() const {
+        switch (mode_) {
+            case ReadMode::Stream: return file_.is_open();
+            case ReadMode::MemoryMapped: return map_.isOpen();
+            case ReadMode::Prefetch: return prefetch_ != nullptr;
+        }
+        return false;
+    }
+
+    bool readNextRecord(RawPacketView& view, std::vector<uint8_t>& sink) {
+        if ((mode_ == ReadMode::Stream && !file_) || (mode_ == ReadMode::Prefetch && !prefetch_)) return false;
+        bool ok = isPcapNG_ ? readPcapNGBlock(view, sink) : readPcapRecord(view, sink);
+        if (ok) ++recordIndex_;
+        return ok;
+    }
+
+    // Position at the start of record `packetNumber` from an index entry
+    // (or the first record), ignoring the filter
+    bool seekFrom(const CaptureIndex::Entry* entry, uint64_t packetNumber) {
+        if (entry) {
+            if (isPcapNG_ && entry->section != CaptureIndex::kNoSection &&
+                !restoreSection(index_.sections[entry->section], entry->offset)) {
+                return false;
+            }
+            if (!seekTo(entry->offset)) return false;
+            recordIndex_ = entry->packetNumber;
         } else {
-            // Other block types - skip
-            file_.seekg(blockLen - 8, std::ios::cur);
-            return readPcapNGBlock(packet);
+            interfaces_.clear();
+            if (!seekTo(dataStart_)) return false;
+            recordIndex_ = 0;
+        }
+        RawPacketView view;
+        while (recordIndex_ < packetNumber) {
+            if (!readNextRecord(view, scratch_)) return false;
         }
+        return true;
     }
     
 public:
-    static IFileReaderDevice* getReader(const std::string& filename) {
+    // Stream mode goes through std::ifstream. MemoryMapped maps the whole file
+    // and falls back to Stream when the mapping cannot be created; query
+    // getReadMode() to see which one is in use. Prefetch reads ahead on a
+    // background thread, for cold files and network storage where a mapping
+    // would stall on every page fault.
+    //
+    // gzip and zstd compressed captures are detected from their first bytes
+    // and always read in Prefetch mode, decoded on the read-ahead thread.
+    // Returns nullptr for them if the build lacks zlib / libzstd (see
+    // isCompressionSupported()). Seeking backwards in one decodes again from
+    // the start, and an index built for it only fits that compressed file.
+    static IFileReaderDevice* getReader(const std::string& filename, ReadMode mode = ReadMode::Stream) {
+        if (detectCompression(filename) != Compression::None) mode = ReadMode::Prefetch;
         auto* reader = new IFileReaderDevice();
-        reader->file_.open(filename, std::ios::binary);
+        if (mode == ReadMode::MemoryMapped && reader->map_.open(filename)) {
+            reader->mode_ = ReadMode::MemoryMapped;
+            reader->fileSize_ = reader->map_.size();
+            return reader;
+        }
+        if (mode == ReadMode::Prefetch) {
+            auto stream = std::make_unique<PrefetchStream>();
+            if (!stream->open(filename)) {
+                delete reader;
+                return nullptr;
+            }
+            reader->mode_ = ReadMode::Prefetch;
+            reader->fileSize_ = stream->size();
+            reader->prefetch_ = std::move(stream);
+            return reader;
+        }
+        reader->file_.open(filename, std::ios::binary | std::ios::ate);
         if (!reader->file_) {
             delete reader;
             return nullptr;
         }
+        reader->fileSize_ = static_cast<uint64_t>(reader->file_.tellg());
+        reader->file_.seekg(0, std::ios::beg);
         return reader;
     }
+
+    ReadMode getReadMode() const { return mode_; }
+
+    Compression getCompression() const { return prefetch_ ? prefetch_->compression() : Compression::None; }
+
+    // Only records `filter` accepts are returned by getNextPacket(); it sees
+    // the raw record, before any Packet is built. See PacketFilter in
+    // PcapFilter.h. Pass an empty function to read everything again.
+    void setFilter(std::function<bool(const RawPacketView&)> filter) {
+        filter_ = std::move(filter);
+    }
+
+    // PCAPNG interfaces of the current section (empty for classic PCAP)
+    const std::vector<PcapNGInterface>& getInterfaces() const { return interfaces_; }
     
     bool open() {
-        if (!file_.is_open()) return false;
+        if (!isOpenForReading()) return false;
         
+        recordIndex_ = 0;
+
         // Read magic number to determine file format
         uint32_t magic;
-        file_.read(reinterpret_cast<char*>(&magic), 4);
+        if (!readBytes(&magic, 4)) return false;
         
-        if (magic == 0xA1B2C3D4) {
-            // Classic PCAP format (native byte order)
+        if (magic == 0xA1B2C3D4 || magic == 0xA1B23C4D) {
+            // Classic PCAP format (native byte order, usec or nsec timestamps)
             isPcapNG_ = false;
             swapBytes_ = false;
-            
-            file_.seekg(16, std::ios::cur);  // Skip header fields
-            file_.read(reinterpret_cast<char*>(&linkType_), 4);
-            linkType_ = swap32(linkType_);
-            
-        } else if (magic == 0xD4C3B2A1) {
+            nanoTimestamps_ = magic == 0xA1B23C4D;
+        } else if (magic == 0xD4C3B2A1 || magic == 0x4D3CB2A1) {
             // Classic PCAP format (byte-swapped)
             isPcapNG_ = false;
             swapBytes_ = true;
-            
-            file_.seekg(16, std::ios::cur);
-            file_.read(reinterpret_cast<char*>(&linkType_), 4);
-            linkType_ = swap32(linkType_);
-            
+            nanoTimestamps_ = magic == 0x4D3CB2A1;
         } else if (magic == 0x0A0D0D0A) {
             // PCAPNG format (block-based)
             isPcapNG_ = true;
-            file_.seekg(0, std::ios::beg);
+            dataStart_ = 0;
+            return seekTo(0);
         } else {
             return false;
         }
-        
+
+        // Skip version, thiszone, sigfigs and snaplen, then read the link type
+        uint8_t header[20];
+        if (!readBytes(header, sizeof(header))) return false;
+        linkType_ = load32(header + 16);
+        dataStart_ = 24;
+        return true;
+    }
+
+    // Read the whole capture once and record an index entry every `interval`
+    // records. Call right after open(); the reader is rewound to the first
+    // record afterwards and uses the new index for seeking. Returns
+    // std::nullopt if the reader is not open or already past the start.
+    std::optional<CaptureIndex> buildIndex(uint32_t interval = 4096) {
+        if (interval == 0 || recordIndex_ != 0 || !isOpenForReading()) return std::nullopt;
+
+        CaptureIndex index;
+        index.interval = interval;
+        index.captureSize = fileSize_;
+        indexing_ = &index;
+        RawPacketView view;
+        for (;;) {
+            uint64_t offset = position();
+            auto section = index.sections.empty() ? CaptureIndex::kNoSection
+                                                  : static_cast<uint32_t>(index.sections.size() - 1);
+            uint64_t number = recordIndex_;
+            if (!readNextRecord(view, scratch_)) break;
+            if (number % interval == 0) {
+                uint64_t usec = uint64_t{view.timestamp_sec} * 1000000 + view.timestamp_usec;
+                index.entries.push_back({usec, offset, number, section});
+            }
+        }
+        indexing_ = nullptr;
+        index.packetCount = recordIndex_;
+
+        index_ = index;
+        if (!seekFrom(nullptr, 0)) return std::nullopt;
+        return index;
+    }
+
+    // Use `index` for seekToPacket()/seekToTime(). Rejected when it was
+    // built for a file of a different size.
+    bool setIndex(CaptureIndex index) {
+        if (index.captureSize != fileSize_ || index.interval == 0) return false;
+        index_ = std::move(index);
         return true;
     }
+
+    bool loadIndex(const std::string& path) {
+        auto index = CaptureIndex::load(path);
+        return index && setIndex(std::move(*index));
+    }
+
+    const CaptureIndex& getIndex() const { return index_; }
+
+    // Zero-based number of the record the next read starts from (counting
+    // records the filter rejects)
+    uint64_t getRecordIndex() const { return recordIndex_; }
+
+    // Position so the next read starts at record `packetNumber`. With an
+    // index this is a binary search plus at most `interval` record reads;
+    // without one it scans from the start. Seeking to the record count
+    // positions at the end; beyond it returns false. Interface statistics
+    // (ISB) are not restored by a seek.
+    bool seekToPacket(uint64_t packetNumber) {
+        const CaptureIndex::Entry* entry = nullptr;
+        if (!index_.entries.empty()) {
+            auto it = std::upper_bound(index_.entries.begin(), index_.entries.end(), packetNumber,
+                                       [](uint64_t n, const CaptureIndex::Entry& e) { return n < e.packetNumber; });
+            if (it != index_.entries.begin()) entry = &*std::prev(it);
+        }
+        // Reading forward is cheaper than jumping back to an entry behind us
+        if (recordIndex_ <= packetNumber && (!entry || entry->packetNumber <= recordIndex_)) {
+            RawPacketView view;
+            while (recordIndex_ < packetNumber) {
+                if (!readNextRecord(view, scratch_)) return false;
+            }
+            return true;
+        }
+        return seekFrom(entry, packetNumber);
+    }
+
+    // Position at the first record stamped at or after (sec, usec). Assumes
+    // timestamps do not go backwards, as in a single-interface capture.
+    // Returns false if every record is earlier.
+    bool seekToTime(uint32_t sec, uint32_t usec) {
+        uint64_t target = uint64_t{sec} * 1000000 + usec;
+        const CaptureIndex::Entry* entry = nullptr;
+        auto it = std::lower_bound(index_.entries.begin(), index_.entries.end(), target,
+                                   [](const CaptureIndex::Entry& e, uint64_t t) { return e.timestampUsec < t; });
+        if (it != index_.entries.begin()) entry = &*std::prev(it);
+        if (!seekFrom(entry, entry ? entry->packetNumber : 0)) return false;
+
+        RawPacketView view;
+        for (;;) {
+            // Where the record's blocks start and how many interfaces were
+            // known before them, so a match is re-read without a rescan
+            uint64_t offset = position();
+            size_t interfaceCount = interfaces_.size();
+            uint64_t number = recordIndex_;
+            if (!readNextRecord(view, scratch_)) return false;
+            if (uint64_t{view.timestamp_sec} * 1000000 + view.timestamp_usec >= target) {
+                // IDBs read on the way are read again; an SHB among them
+                // clears the table itself
+                if (interfaces_.size() > interfaceCount) {
+                    interfaces_.erase(interfaces_.begin() + static_cast<std::ptrdiff_t>(interfaceCount),
+                                      interfaces_.end());
+                }
+                recordIndex_ = number;
+                return seekTo(offset);
+            }
+        }
+    }
+
+    // Zero-copy read: `view` points at the record inside the mapping or the
+    // prefetch buffer (or the reader's scratch buffer in stream mode, and for
+    // records split across prefetch buffers) until the next call.
+    bool getNextPacket(RawPacketView& view) {
+        while (readNextRecord(view, scratch_)) {
+            if (!filter_ || filter_(view)) return true;
+        }
+        return false;
+    }
     
     bool getNextPacket(RawPacket& packet) {
-        if (!file_) return false;
-        
-        if (isPcapNG_) {
-            return readPcapNGBlock(packet);
-        } else {
-            // Classic PCAP format
-            uint32_t ts_sec, ts_usec, incl_len, orig_len;
-            
-            file_.read(reinterpret_cast<char*>(&ts_sec), 4);
-            file_.read(reinterpret_cast<char*>(&ts_usec), 4);
-            file_.read(reinterpret_cast<char*>(&incl_len), 4);
-            file_.read(reinterpret_cast<char*>(&orig_len), 4);
-            
-            if (!file_) return false;
-            
-            incl_len = swap32(incl_len);
-            
-            packet.data.resize(incl_len);
-            file_.read(reinterpret_cast<char*>(packet.data.data()), incl_len);
-            packet.linkType = linkType_;
+        RawPacketView view;
+        do {
+            if (!readNextRecord(view, packet.data)) return false;
+        } while (filter_ && !filter_(view));
 
-            return file_.good();
+        const uint8_t* begin = packet.data.data();
+        if (view.data >= begin && view.data < begin + packet.data.size()) {
+            // Stream mode already read the record into packet.data
+            if (view.data != begin) std::memmove(packet.data.data(), view.data, view.length);
+            packet.data.resize(view.length);
+        } else {
+            packet.data.assign(view.data, view.data + view.length);
         }
+        packet.timestamp_sec = view.timestamp_sec;
+        packet.timestamp_usec = view.timestamp_usec;
+        packet.linkType = view.linkType;
+        return true;
     }
     
     void close() {
         if (file_.is_open()) {
             file_.close();
         }
+        map_.close();
+        mapPos_ = 0;
+        prefetch_.reset();
     }
     
     ~IFileReaderDevice() {
@@ -392,6 +1879,267 @@ public:
     }
 };
 
+// On-disk format produced by IFileWriterDevice
+enum class CaptureFormat {
+    Pcap,    // Classic libpcap, microsecond timestamps
+    PcapNG   // SHB + one IDB per link type + EPBs
+};
+
+struct WriterOptions {
+    CaptureFormat format = CaptureFormat::Pcap;
+    uint32_t linkType = 1;           // File link type (classic PCAP) / first IDB (PCAPNG)
+    uint32_t snapLen = 262144;       // Longer packets are truncated (0 = never)
+    size_t bufferSize = 1u << 20;    // Records are batched up to this size before a write
+    uint64_t rotateBytes = 0;        // Start a new file past this size (0 = never)
+    uint32_t rotateSeconds = 0;      // Start a new file this many capture seconds after
+                                     // the first packet of the current one (0 = never)
+};
+
+// PCAP/PCAPNG file writer. Records are packed into one large buffer and
+// flushed with a single vectored write; a record that does not fit goes out
+// in the same call as the pending buffer without being copied.
+//
+// With rotation enabled, files are named after the original with an index
+// before the extension: out.pcap, out.1.pcap, out.2.pcap, ...
+class IFileWriterDevice {
+private:
+    OutputFile file_;
+    WriterOptions options_;
+    std::string baseName_;
+    std::vector<std::string> fileNames_;
+    std::vector<uint8_t> buffer_;
+    std::vector<uint32_t> interfaceLinkTypes_;  // PCAPNG interface id -> link type
+    bool opened_ = false;
+    uint64_t fileBytes_ = 0;         // Bytes in the current file, including buffered ones
+    uint64_t filePackets_ = 0;
+    uint32_t fileStartSec_ = 0;
+    uint64_t packetsWritten_ = 0;
+
+    static constexpr uint32_t kSectionHeaderBlock = 0x0A0D0D0A;
+    static constexpr uint32_t kInterfaceDescriptionBlock = 0x00000001;
+    static constexpr uint32_t kEnhancedPacketBlock = 0x00000006;
+
+    IFileWriterDevice() = default;
+
+    static void put16(uint8_t*& p, uint16_t v) {
+        std::memcpy(p, &v, 2);
+        p += 2;
+    }
+
+    static void put32(uint8_t*& p, uint32_t v) {
+        std::memcpy(p, &v, 4);
+        p += 4;
+    }
+
+    std::string rotatedName(size_t index) const {
+        if (index == 0) return baseName_;
+        size_t slash = baseName_.find_last_of("/\\");
+        size_t dot = baseName_.find_last_of('.');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return baseName_ + "." + std::to_string(index);
+        }
+        return baseName_.substr(0, dot) + "." + std::to_string(index) + baseName_.substr(dot);
+    }
+
+    // Queue one record: fixed header, packet bytes, zero padding and an
+    // optional trailer (the PCAPNG block length repeated at the end)
+    bool appendRecord(const uint8_t* header, size_t headerLen, const uint8_t* data, size_t dataLen,
+                      size_t padLen, const uint8_t* trailer, size_t trailerLen) {
+        size_t total = headerLen + dataLen + padLen + trailerLen;
+        fileBytes_ += total;
+        if (buffer_.size() + total <= options_.bufferSize) {
+            size_t at = buffer_.size();
+            buffer_.resize(at + total);
+            uint8_t* p = buffer_.data() + at;
+            std::memcpy(p, header, headerLen);
+            if (dataLen) std::memcpy(p + headerLen, data, dataLen);
+            std::memset(p + headerLen + dataLen, 0, padLen);
+            if (trailerLen) std::memcpy(p + headerLen + dataLen + padLen, trailer, trailerLen);
+            return true;
+        }
+        static constexpr uint8_t kPadding[4] = {0, 0, 0, 0};
+        OutputFile::Segment segments[] = {
+            {buffer_.data(), buffer_.size()},
+            {header, headerLen},
+            {data, dataLen},
+            {kPadding, padLen},
+            {trailer, trailerLen},
+        };
+        bool ok = file_.write(segments, 5);
+        buffer_.clear();
+        return ok;
+    }
+
+    bool writeFileHeader() {
+        uint8_t header[28];
+        uint8_t* p = header;
+        if (options_.format == CaptureFormat::Pcap) {
+            put32(p, 0xA1B2C3D4);
+            put16(p, 2);
+            put16(p, 4);
+            put32(p, 0);  // thiszone
+            put32(p, 0);  // sigfigs
+            put32(p, options_.snapLen);
+            put32(p, options_.linkType);
+            return appendRecord(header, 24, nullptr, 0, 0, nullptr, 0);
+        }
+        put32(p, kSectionHeaderBlock);
+        put32(p, 28);
+        put32(p, 0x1A2B3C4D);
+        put16(p, 1);
+        put16(p, 0);
+        put32(p, 0xFFFFFFFF);  // Section length unknown
+        put32(p, 0xFFFFFFFF);
+        put32(p, 28);
+        interfaceLinkTypes_.clear();
+        return appendRecord(header, 28, nullptr, 0, 0, nullptr, 0) && interfaceFor(options_.linkType) >= 0;
+    }
+
+    // PCAPNG interface id for `linkType`, emitting its IDB on first use.
+    // Microsecond resolution is the PCAPNG default, so no if_tsresol option.
+    int64_t interfaceFor(uint32_t linkType) {
+        for (size_t i = 0; i < interfaceLinkTypes_.size(); ++i) {
+            if (interfaceLinkTypes_[i] == linkType) return static_cast<int64_t>(i);
+        }
+        uint8_t block[20];
+        uint8_t* p = block;
+        put32(p, kInterfaceDescriptionBlock);
+        put32(p, 20);
+        put16(p, static_cast<uint16_t>(linkType));
+        put16(p, 0);
+        put32(p, options_.snapLen);
+        put32(p, 20);
+        if (!appendRecord(block, 20, nullptr, 0, 0, nullptr, 0)) return -1;
+        interfaceLinkTypes_.push_back(linkType);
+        return static_cast<int64_t>(interfaceLinkTypes_.size() - 1);
+    }
+
+    bool openFile() {
+        std::string name = rotatedName(fileNames_.size());
+        if (!file_.open(name)) return false;
+        fileNames_.push_back(name);
+        fileBytes_ = 0;
+        filePackets_ = 0;
+        return writeFileHeader();
+    }
+
+    bool rotate() {
+        if (!flush()) return false;
+        file_.close();
+        return openFile();
+    }
+
+public:
+    IFileWriterDevice(const IFileWriterDevice&) = delete;
+    IFileWriterDevice& operator=(const IFileWriterDevice&) = delete;
+
+    // Create (or truncate) `filename`. Returns nullptr if it cannot be created.
+    static IFileWriterDevice* getWriter(const std::string& filename, const WriterOptions& options = {}) {
+        auto* writer = new IFileWriterDevice();
+        writer->options_ = options;
+        if (writer->options_.bufferSize < 4096) writer->options_.bufferSize = 4096;
+        writer->baseName_ = filename;
+        if (!writer->file_.open(filename)) {
+            delete writer;
+            return nullptr;
+        }
+        writer->fileNames_.push_back(filename);
+        return writer;
+    }
+
+    // Write the file header. Must be called once before writePacket().
+    bool open() {
+        if (opened_ || !file_.isOpen()) return false;
+        buffer_.reserve(options_.bufferSize);
+        opened_ = writeFileHeader();
+        return opened_;
+    }
+
+    bool writePacket(const RawPacketView& packet) {
+        if (!opened_) return false;
+        if (options_.format == CaptureFormat::Pcap && packet.linkType != options_.linkType) return false;
+
+        uint32_t capLen = options_.snapLen ? std::min<uint32_t>(packet.length, options_.snapLen) : packet.length;
+        uint64_t recordLen = options_.format == CaptureFormat::Pcap ? 16 + uint64_t{capLen}
+                                                                     : 32 + ((uint64_t{capLen} + 3) & ~uint64_t{3});
+
+        if (filePackets_ > 0) {
+            bool bySize = options_.rotateBytes && fileBytes_ + recordLen > options_.rotateBytes;
+            bool byTime = options_.rotateSeconds && packet.timestamp_sec >= fileStartSec_ &&
+                          packet.timestamp_sec - fileStartSec_ >= options_.rotateSeconds;
+            if ((bySize || byTime) && !rotate()) return false;
+        }
+        if (filePackets_ == 0) fileStartSec_ = packet.timestamp_sec;
+
+        uint8_t header[28];
+        uint8_t* p = header;
+        bool ok;
+        if (options_.format == CaptureFormat::Pcap) {
+            put32(p, packet.timestamp_sec);
+            put32(p, packet.timestamp_usec);
+            put32(p, capLen);
+            put32(p, packet.length);
+            ok = appendRecord(header, 16, packet.data, capLen, 0, nullptr, 0);
+        } else {
+            int64_t interfaceId = interfaceFor(packet.linkType);
+            if (interfaceId < 0) return false;
+            uint64_t ticks = uint64_t{packet.timestamp_sec} * 1000000 + packet.timestamp_usec;
+            auto blockLen = static_cast<uint32_t>(recordLen);
+            put32(p, kEnhancedPacketBlock);
+            put32(p, blockLen);
+            put32(p, static_cast<uint32_t>(interfaceId));
+            put32(p, static_cast<uint32_t>(ticks >> 32));
+            put32(p, static_cast<uint32_t>(ticks));
+            put32(p, capLen);
+            put32(p, packet.length);
+            uint8_t trailer[4];
+            std::memcpy(trailer, &blockLen, 4);
+            ok = appendRecord(header, 28, packet.data, capLen, (4 - capLen % 4) % 4, trailer, 4);
+        }
+        if (ok) {
+            ++filePackets_;
+            ++packetsWritten_;
+        }
+        return ok;
+    }
+
+    bool writePacket(const RawPacket& packet) {
+        RawPacketView view;
+        view.data = packet.getData();
+        view.length = static_cast<uint32_t>(packet.getDataLen());
+        view.timestamp_sec = packet.timestamp_sec;
+        view.timestamp_usec = packet.timestamp_usec;
+        view.linkType = packet.linkType;
+        return writePacket(view);
+    }
+
+    // Push buffered records to the OS
+    bool flush() {
+        if (buffer_.empty()) return true;
+        OutputFile::Segment segment{buffer_.data(), buffer_.size()};
+        bool ok = file_.write(&segment, 1);
+        buffer_.clear();
+        return ok;
+    }
+
+    // Files written so far, in order (more than one only with rotation)
+    const std::vector<std::string>& getFileNames() const { return fileNames_; }
+
+    uint64_t getPacketsWritten() const { return packetsWritten_; }
+
+    void close() {
+        if (file_.isOpen()) {
+            flush();
+            file_.close();
+        }
+        opened_ = false;
+    }
+
+    ~IFileWriterDevice() {
+        close();
+    }
+};
+
 } // namespace pcap
 
 namespace pcpp = pcap;
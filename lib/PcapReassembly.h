@@ -0,0 +1,1013 @@
+#pragma once
+
+#include "PcapFlow.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace pcap {
+
+namespace detail {
+
+// murmur3 64-bit finalizer applied to h ^ v
+inline uint64_t mix64(uint64_t h, uint64_t v) {
+    h ^= v;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Fixed-size byte chunks carved from slabs of kSlabChunks. The pool grows one
+// slab at a time up to its byte budget (rounded up to whole slabs) and never
+// shrinks, so its footprint is bounded whatever the traffic looks like:
+// allocate() returns kNoChunk once the budget is spent. Chunks can be
+// chained through next() to hold runs longer than one chunk.
+class ChunkPool {
+public:
+    static constexpr uint32_t kNoChunk = 0xFFFFFFFF;
+    static constexpr size_t kSlabChunks = 64;
+
+private:
+    size_t chunkSize_;
+    size_t maxChunks_;
+    std::vector<std::unique_ptr<uint8_t[]>> slabs_;
+    std::vector<uint32_t> next_;
+    std::vector<uint32_t> free_;
+    size_t inUse_ = 0;
+
+    void addSlab() {
+        uint32_t base = static_cast<uint32_t>(slabs_.size() * kSlabChunks);
+        slabs_.push_back(std::make_unique<uint8_t[]>(kSlabChunks * chunkSize_));
+        next_.resize(base + kSlabChunks, kNoChunk);
+        // Reversed so chunks are handed out in address order
+        for (size_t i = kSlabChunks; i-- > 0;) free_.push_back(base + static_cast<uint32_t>(i));
+    }
+
+public:
+    ChunkPool(size_t chunkSize, size_t maxBytes) : chunkSize_(chunkSize) {
+        size_t chunks = std::max<size_t>(maxBytes / chunkSize, 1);
+        maxChunks_ = (chunks + kSlabChunks - 1) / kSlabChunks * kSlabChunks;
+    }
+
+    uint32_t allocate() {
+        if (free_.empty()) {
+            if (slabs_.size() * kSlabChunks >= maxChunks_) return kNoChunk;
+            addSlab();
+        }
+        uint32_t c = free_.back();
+        free_.pop_back();
+        next_[c] = kNoChunk;
+        ++inUse_;
+        return c;
+    }
+
+    void release(uint32_t c) {
+        free_.push_back(c);
+        --inUse_;
+    }
+
+    void releaseChain(uint32_t head) {
+        while (head != kNoChunk) {
+            uint32_t n = next_[head];
+            release(head);
+            head = n;
+        }
+    }
+
+    // Copy `len` bytes into a fresh chain. All or nothing: returns kNoChunk
+    // without allocating if the budget cannot hold them.
+    uint32_t store(const uint8_t* data, size_t len) {
+        size_t needed = std::max<size_t>((len + chunkSize_ - 1) / chunkSize_, 1);
+        if (needed > available()) return kNoChunk;
+        uint32_t head = kNoChunk, tail = kNoChunk;
+        for (size_t done = 0; done < len || head == kNoChunk; done += chunkSize_) {
+            uint32_t c = allocate();
+            std::memcpy(this->data(c), data + done, std::min(chunkSize_, len - done));
+            if (tail == kNoChunk) head = c; else next_[tail] = c;
+            tail = c;
+        }
+        return head;
+    }
+
+    // Copy the first `len` bytes of a chain to `out`
+    void load(uint32_t head, size_t len, uint8_t* out) const {
+        for (size_t done = 0; done < len; done += chunkSize_, head = next_[head]) {
+            std::memcpy(out + done, data(head), std::min(chunkSize_, len - done));
+        }
+    }
+
+    uint8_t* data(uint32_t c) { return slabs_[c / kSlabChunks].get() + (c % kSlabChunks) * chunkSize_; }
+    const uint8_t* data(uint32_t c) const {
+        return slabs_[c / kSlabChunks].get() + (c % kSlabChunks) * chunkSize_;
+    }
+    uint32_t& next(uint32_t c) { return next_[c]; }
+
+    size_t chunkSize() const { return chunkSize_; }
+    size_t available() const { return maxChunks_ - inUse_; }
+    size_t bytesInUse() const { return inUse_ * chunkSize_; }
+    size_t capacityBytes() const { return maxChunks_ * chunkSize_; }
+};
+
+// Open-addressing index from a 64-bit hash to an entry number, sized once
+// for a known maximum entry count so the load factor stays at or below 1/2.
+// Slots keep the low hash bits; callers compare their own keys on a match.
+class SlotIndex {
+public:
+    static constexpr uint32_t kNone = 0xFFFFFFFF;
+
+private:
+    struct Slot {
+        uint32_t hash = 0;
+        uint32_t index = kNone;  // kNone = empty
+    };
+
+    std::vector<Slot> slots_;
+
+    size_t mask() const { return slots_.size() - 1; }
+
+public:
+    void reserve(size_t maxEntries) {
+        size_t n = 16;
+        while (n < maxEntries * 2) n <<= 1;
+        slots_.assign(n, Slot{});
+    }
+
+    bool empty() const { return slots_.empty(); }
+
+    template<typename Equal>
+    uint32_t find(uint64_t hash, Equal&& equal) const {
+        if (slots_.empty()) return kNone;
+        uint32_t h = static_cast<uint32_t>(hash);
+        for (size_t pos = h & mask(); slots_[pos].index != kNone; pos = (pos + 1) & mask()) {
+            if (slots_[pos].hash == h && equal(slots_[pos].index)) return slots_[pos].index;
+        }
+        return kNone;
+    }
+
+    void insert(uint64_t hash, uint32_t index) {
+        uint32_t h = static_cast<uint32_t>(hash);
+        size_t pos = h & mask();
+        while (slots_[pos].index != kNone) pos = (pos + 1) & mask();
+        slots_[pos] = {h, index};
+    }
+
+    // Backward-shift deletion keeps probe sequences intact without tombstones
+    void erase(uint64_t hash, uint32_t index) {
+        size_t hole = static_cast<uint32_t>(hash) & mask();
+        while (slots_[hole].index != index) hole = (hole + 1) & mask();
+        size_t next = (hole + 1) & mask();
+        while (slots_[next].index != kNone) {
+            size_t home = slots_[next].hash & mask();
+            bool inRange = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+            if (!inRange) {
+                slots_[hole] = slots_[next];
+                hole = next;
+            }
+            next = (next + 1) & mask();
+        }
+        slots_[hole] = Slot{};
+    }
+};
+
+} // namespace detail
+
+// ============ IP defragmentation ============
+
+// Identity of a fragmented datagram: addresses and identification, plus the
+// protocol for IPv4 (RFC 791). IPv4 addresses occupy the last 4 bytes.
+struct FragmentKey {
+    std::array<uint8_t, 16> src{};
+    std::array<uint8_t, 16> dst{};
+    uint32_t id = 0;
+    uint8_t protocol = 0;   // IPv4 only
+    uint8_t ipVersion = 0;  // 4 or 6
+
+    bool operator==(const FragmentKey& other) const {
+        return src == other.src && dst == other.dst && id == other.id && protocol == other.protocol &&
+               ipVersion == other.ipVersion;
+    }
+
+    uint64_t hash() const {
+        uint64_t words[4];
+        std::memcpy(words, src.data(), 16);
+        std::memcpy(words + 2, dst.data(), 16);
+        uint64_t h = 0x9E3779B97F4A7C15ULL;
+        for (uint64_t w : words) h = detail::mix64(h, w);
+        return detail::mix64(h, (static_cast<uint64_t>(id) << 16) | (static_cast<uint64_t>(protocol) << 8) |
+                                    ipVersion);
+    }
+};
+
+enum class ReassemblyStatus : uint8_t {
+    NotFragment,   // Not an IP fragment: use the packet as it is
+    Buffered,      // Fragment stored (or an exact duplicate ignored), datagram incomplete
+    Reassembled,   // Last missing fragment arrived: the output holds the whole datagram
+    Dropped        // Malformed or overlapping fragment, or no memory for it
+};
+
+// IPv4 and IPv6 fragment reassembly.
+//
+// Each datagram in progress tracks the byte ranges still missing as a hole
+// list (RFC 815) and keeps its payload in 1 KiB chunks from a shared pool, so
+// out-of-order and duplicate fragments cost no reallocation. Memory is capped
+// twice: Options::maxBytes bounds the pool and Options::maxDatagrams the
+// table; when either is full the oldest datagram is dropped to make room.
+// A datagram is dropped as well when it times out (counted from its first
+// fragment), has more than Options::maxFragments pieces, or receives a
+// fragment that overlaps data it already holds (RFC 5722 for IPv6; applied
+// to IPv4 too, which defeats teardrop-style overlap tricks).
+//
+// A reassembled datagram is returned as a complete frame: the link and IP
+// headers of the offset-0 fragment with fragmentation fields cleared and
+// lengths fixed up (the IPv6 Fragment header is removed), followed by the
+// whole payload, so Packet and FlowTable see its transport header.
+class IPReassembly {
+public:
+    struct Options {
+        size_t maxBytes = size_t{32} << 20;        // Fragment payload buffered across all datagrams
+        size_t maxDatagrams = 8192;
+        uint64_t timeoutUsec = 30ULL * 1000000;    // From the first fragment, like Linux ipfrag_time
+        uint32_t maxFragments = 64;                // Per datagram
+    };
+
+    struct Stats {
+        uint64_t fragments = 0;     // Fragments seen
+        uint64_t reassembled = 0;   // Datagrams completed
+        uint64_t timedOut = 0;      // Datagrams dropped by the timeout
+        uint64_t evicted = 0;       // Datagrams dropped to make room
+        uint64_t overlaps = 0;      // Datagrams dropped for overlapping fragments
+        uint64_t malformed = 0;     // Fragments or datagrams rejected as invalid
+    };
+
+    static constexpr size_t kChunkSize = 1024;
+    static constexpr uint32_t kMaxPayload = 65535;
+    // Link and IP headers kept from the offset-0 fragment
+    static constexpr size_t kMaxHeader = 128;
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFF;
+    static constexpr uint32_t kOpenEnd = 0xFFFFFFFF;
+    static constexpr size_t kChunksPerDatagram = (kMaxPayload + kChunkSize) / kChunkSize;
+
+    struct Hole {
+        uint32_t first;
+        uint32_t last;  // Inclusive; kOpenEnd until the last fragment is seen
+    };
+
+    // Payload range of a fragment already stored
+    struct Range {
+        uint32_t first;
+        uint32_t end;
+    };
+
+    struct Entry {
+        FragmentKey key;
+        uint64_t hash = 0;
+        uint64_t firstSeenUsec = 0;
+        std::vector<Hole> holes;   // Keeps its capacity across reuse
+        std::vector<Range> received;  // Likewise; tells exact duplicates from overlaps
+        std::array<uint32_t, kChunksPerDatagram> chunks;
+        uint32_t payloadLength = 0;  // Valid once lastSeen
+        uint32_t highestEnd = 0;
+        uint32_t fragments = 0;
+        uint32_t linkType = 1;
+        bool lastSeen = false;
+        uint16_t headerLength = 0;   // 0 until the offset-0 fragment arrives
+        uint16_t ipOffset = 0;       // IP header position inside `header`
+        std::array<uint8_t, kMaxHeader> header;
+        uint32_t agePrev = kNone;
+        uint32_t ageNext = kNone;
+    };
+
+    // One fragment, decoded
+    struct Fragment {
+        FragmentKey key;
+        const uint8_t* payload = nullptr;
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        bool more = false;
+        size_t headerLength = 0;     // Unfragmentable part: link + IP headers (+ IPv6 extensions)
+        size_t ipOffset = 0;
+        size_t nextHeaderPos = 0;    // IPv6: byte naming the Fragment header, patched on output
+        uint8_t nextHeader = 0;      // IPv6: protocol after the Fragment header
+    };
+
+    Options options_;
+    Stats stats_;
+    detail::ChunkPool pool_;
+    detail::SlotIndex index_;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> freeEntries_;
+    uint32_t newest_ = kNone;
+    uint32_t oldest_ = kNone;
+    size_t size_ = 0;
+    uint64_t nowUsec_ = 0;
+
+    void ageUnlink(uint32_t i) {
+        Entry& e = entries_[i];
+        if (e.agePrev != kNone) entries_[e.agePrev].ageNext = e.ageNext; else newest_ = e.ageNext;
+        if (e.ageNext != kNone) entries_[e.ageNext].agePrev = e.agePrev; else oldest_ = e.agePrev;
+        e.agePrev = e.ageNext = kNone;
+    }
+
+    void remove(uint32_t i) {
+        Entry& e = entries_[i];
+        for (uint32_t& c : e.chunks) {
+            if (c != detail::ChunkPool::kNoChunk) pool_.release(c);
+            c = detail::ChunkPool::kNoChunk;
+        }
+        index_.erase(e.hash, i);
+        ageUnlink(i);
+        freeEntries_.push_back(i);
+        --size_;
+    }
+
+    uint32_t insert(const FragmentKey& key, uint64_t hash) {
+        if (index_.empty()) index_.reserve(options_.maxDatagrams);
+        if (size_ >= options_.maxDatagrams) {
+            remove(oldest_);
+            ++stats_.evicted;
+        }
+        uint32_t i;
+        if (!freeEntries_.empty()) {
+            i = freeEntries_.back();
+            freeEntries_.pop_back();
+        } else {
+            i = static_cast<uint32_t>(entries_.size());
+            entries_.emplace_back();
+            entries_[i].chunks.fill(detail::ChunkPool::kNoChunk);
+        }
+        Entry& e = entries_[i];
+        e.key = key;
+        e.hash = hash;
+        e.firstSeenUsec = nowUsec_;
+        e.holes.assign(1, Hole{0, kOpenEnd});
+        e.received.clear();
+        e.payloadLength = e.highestEnd = e.fragments = 0;
+        e.lastSeen = false;
+        e.headerLength = 0;
+        index_.insert(hash, i);
+        // Newest at the head, oldest at the tail
+        e.agePrev = kNone;
+        e.ageNext = newest_;
+        if (newest_ != kNone) entries_[newest_].agePrev = i;
+        newest_ = i;
+        if (oldest_ == kNone) oldest_ = i;
+        ++size_;
+        return i;
+    }
+
+    // Chunk for payload bytes at `offset`, evicting older datagrams when the
+    // pool is exhausted. kNoChunk if `self` is the only datagram left.
+    uint32_t chunkFor(uint32_t self, uint32_t offset) {
+        uint32_t& slot = entries_[self].chunks[offset / kChunkSize];
+        while (slot == detail::ChunkPool::kNoChunk) {
+            slot = pool_.allocate();
+            if (slot != detail::ChunkPool::kNoChunk) break;
+            uint32_t victim = oldest_ == self ? entries_[self].agePrev : oldest_;
+            if (victim == kNone) return detail::ChunkPool::kNoChunk;
+            remove(victim);
+            ++stats_.evicted;
+        }
+        return slot;
+    }
+
+    static bool decode(const uint8_t* data, size_t len, uint32_t linkType, Fragment& f, bool& malformed) {
+        malformed = false;
+        RawPacketView view{data, static_cast<uint32_t>(len), 0, 0, linkType};
+        Packet packet(view);
+        if (const IPv4View* ip = packet.getLayerOfType<IPv4View>()) {
+            if (!ip->isFragment()) return false;
+            size_t ipOffset = static_cast<size_t>(ip->getData() - data);
+            size_t ihl = ip->headerLength();
+            size_t total = ip->totalLength();
+            if (ihl < 20 || total < ihl || ipOffset + total > len) {
+                malformed = true;  // Bad header, or snaplen cut the fragment short
+                return true;
+            }
+            std::memcpy(f.key.src.data() + 12, ip->getData() + 12, 4);
+            std::memcpy(f.key.dst.data() + 12, ip->getData() + 16, 4);
+            f.key.id = ip->id();
+            f.key.protocol = ip->protocol();
+            f.key.ipVersion = 4;
+            f.payload = ip->getData() + ihl;
+            f.offset = ip->fragmentOffset();
+            f.length = static_cast<uint32_t>(total - ihl);
+            f.more = ip->moreFragments();
+            f.ipOffset = ipOffset;
+            f.headerLength = ipOffset + ihl;
+            return true;
+        }
+        const IPv6View* ip6 = packet.getLayerOfType<IPv6View>();
+        if (!ip6) return false;
+
+        // Walk the extension headers allowed before a Fragment header
+        size_t ipOffset = static_cast<size_t>(ip6->getData() - data);
+        size_t end = ipOffset + 40 + ip6->payloadLength();
+        size_t offset = ipOffset + 40;
+        size_t nextHeaderPos = ipOffset + 6;
+        uint8_t nextHeader = ip6->nextHeader();
+        while (nextHeader == 0 || nextHeader == 43 || nextHeader == 60) {
+            if (offset + 2 > len) return false;
+            nextHeaderPos = offset;
+            nextHeader = data[offset];
+            offset += (size_t{data[offset + 1]} + 1) * 8;
+        }
+        if (nextHeader != 44) return false;
+        if (offset + 8 > end || end > len) {
+            malformed = true;
+            return true;
+        }
+        uint16_t offsetField = detail::loadBE16(data + offset + 2);
+        std::memcpy(f.key.src.data(), ip6->srcAddress(), 16);
+        std::memcpy(f.key.dst.data(), ip6->dstAddress(), 16);
+        f.key.id = detail::loadBE32(data + offset + 4);
+        f.key.ipVersion = 6;
+        f.payload = data + offset + 8;
+        f.offset = offsetField & 0xFFF8;
+        f.length = static_cast<uint32_t>(end - offset - 8);
+        f.more = (offsetField & 1) != 0;
+        f.ipOffset = ipOffset;
+        f.headerLength = offset;
+        f.nextHeaderPos = nextHeaderPos;
+        f.nextHeader = data[offset];
+        return true;
+    }
+
+    // Build the reassembled frame; false if it would not fit in the IP length fields
+    bool assemble(const Entry& e, RawPacket& out) const {
+        size_t ipHeader = e.headerLength - e.ipOffset;
+        if ((e.key.ipVersion == 4 && ipHeader + e.payloadLength > kMaxPayload) ||
+            (e.key.ipVersion == 6 && ipHeader - 40 + e.payloadLength > kMaxPayload)) {
+            return false;
+        }
+        out.data.resize(e.headerLength + e.payloadLength);
+        uint8_t* p = out.data.data();
+        std::memcpy(p, e.header.data(), e.headerLength);
+        for (uint32_t done = 0; done < e.payloadLength; done += kChunkSize) {
+            std::memcpy(p + e.headerLength + done, pool_.data(e.chunks[done / kChunkSize]),
+                        std::min<size_t>(kChunkSize, e.payloadLength - done));
+        }
+
+        uint8_t* ip = p + e.ipOffset;
+        if (e.key.ipVersion == 4) {
+            uint16_t total = static_cast<uint16_t>(ipHeader + e.payloadLength);
+            ip[2] = static_cast<uint8_t>(total >> 8);
+            ip[3] = static_cast<uint8_t>(total);
+            ip[6] &= 0x40;  // Keep DF, clear MF and the offset
+            ip[7] = 0;
+            ip[10] = ip[11] = 0;
+            uint32_t sum = 0;
+            for (size_t i = 0; i < ipHeader; i += 2) sum += detail::loadBE16(ip + i);
+            while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+            uint16_t checksum = static_cast<uint16_t>(~sum);
+            ip[10] = static_cast<uint8_t>(checksum >> 8);
+            ip[11] = static_cast<uint8_t>(checksum);
+        } else {
+            uint16_t payload = static_cast<uint16_t>(ipHeader - 40 + e.payloadLength);
+            ip[4] = static_cast<uint8_t>(payload >> 8);
+            ip[5] = static_cast<uint8_t>(payload);
+        }
+        return true;
+    }
+
+    ReassemblyStatus drop(uint32_t i, uint64_t& counter) {
+        remove(i);
+        ++counter;
+        return ReassemblyStatus::Dropped;
+    }
+
+    ReassemblyStatus addFragment(const Fragment& f, uint32_t linkType, const uint8_t* frame, RawPacket& out) {
+        uint64_t hash = f.key.hash();
+        uint32_t i = index_.find(hash, [&](uint32_t n) { return entries_[n].key == f.key; });
+        if (i == kNone) i = insert(f.key, hash);
+        Entry& e = entries_[i];
+
+        uint32_t first = f.offset;
+        uint32_t end = first + f.length;
+        if (++e.fragments > options_.maxFragments) return drop(i, stats_.malformed);
+        if (!f.more) {
+            // The last fragment fixes the size; nothing may lie beyond it
+            if ((e.lastSeen && e.payloadLength != end) || e.highestEnd > end) return drop(i, stats_.malformed);
+            e.lastSeen = true;
+            e.payloadLength = end;
+        } else if (e.lastSeen && end > e.payloadLength) {
+            return drop(i, stats_.malformed);
+        }
+
+        // The fragment must fill part of exactly one hole, or be a duplicate
+        uint32_t covered = 0;
+        size_t target = e.holes.size();
+        for (size_t h = 0; h < e.holes.size(); ++h) {
+            uint64_t lo = std::max(first, e.holes[h].first);
+            uint64_t hi = std::min<uint64_t>(uint64_t{end} - 1, e.holes[h].last);
+            if (f.length != 0 && lo <= hi) {
+                covered += static_cast<uint32_t>(hi - lo + 1);
+                target = h;
+            }
+        }
+        if (covered != 0 && covered != f.length) return drop(i, stats_.overlaps);
+        // Inside data already held: only a repeat of a stored fragment is harmless
+        if (covered == 0 && f.length != 0 &&
+            std::none_of(e.received.begin(), e.received.end(),
+                         [&](const Range& r) { return r.first == first && r.end == end; })) {
+            return drop(i, stats_.overlaps);
+        }
+
+        if (covered != 0) {
+            for (uint32_t at = first; at < end;) {
+                uint32_t c = chunkFor(i, at);
+                if (c == detail::ChunkPool::kNoChunk) return drop(i, stats_.evicted);
+                uint32_t n = std::min<uint32_t>(end - at, static_cast<uint32_t>(kChunkSize - at % kChunkSize));
+                std::memcpy(pool_.data(c) + at % kChunkSize, f.payload + (at - first), n);
+                at += n;
+            }
+            Hole hole = e.holes[target];
+            e.holes.erase(e.holes.begin() + static_cast<std::ptrdiff_t>(target));
+            if (first > hole.first) e.holes.push_back({hole.first, first - 1});
+            if (end - 1 < hole.last) e.holes.push_back({end, hole.last});
+            e.highestEnd = std::max(e.highestEnd, end);
+            e.received.push_back({first, end});
+        }
+        if (e.lastSeen) {
+            // Close the open-ended hole at the now known payload length
+            std::erase_if(e.holes, [&](const Hole& h) { return h.first >= e.payloadLength; });
+            for (Hole& h : e.holes) h.last = std::min(h.last, e.payloadLength - 1);
+        }
+
+        if (first == 0 && e.headerLength == 0) {
+            if (f.headerLength > kMaxHeader) return drop(i, stats_.malformed);
+            std::memcpy(e.header.data(), frame, f.headerLength);
+            if (f.key.ipVersion == 6) e.header[f.nextHeaderPos] = f.nextHeader;
+            e.headerLength = static_cast<uint16_t>(f.headerLength);
+            e.ipOffset = static_cast<uint16_t>(f.ipOffset);
+            e.linkType = linkType;
+        }
+
+        if (!e.lastSeen || !e.holes.empty()) return ReassemblyStatus::Buffered;
+        if (!assemble(e, out)) return drop(i, stats_.malformed);
+        out.linkType = e.linkType;
+        remove(i);
+        ++stats_.reassembled;
+        return ReassemblyStatus::Reassembled;
+    }
+
+    ReassemblyStatus process(const uint8_t* data, size_t len, uint32_t linkType, uint64_t timestampUsec,
+                             RawPacket& out) {
+        Fragment f;
+        bool malformed;
+        if (!decode(data, len, linkType, f, malformed)) return ReassemblyStatus::NotFragment;
+        expire(timestampUsec);
+        ++stats_.fragments;
+        // Non-final fragments carry a multiple of 8 bytes (RFC 791, RFC 8200)
+        if (malformed || f.offset + f.length > kMaxPayload || (f.more && (f.length == 0 || f.length % 8))) {
+            ++stats_.malformed;
+            return ReassemblyStatus::Dropped;
+        }
+        return addFragment(f, linkType, data, out);
+    }
+
+public:
+    IPReassembly() : IPReassembly(Options{}) {}
+
+    explicit IPReassembly(Options options)
+        : options_(options), pool_(kChunkSize, options.maxBytes) {
+        if (options_.maxDatagrams == 0) options_.maxDatagrams = 1;
+    }
+
+    // Feed one captured frame. On Reassembled, `out` holds the whole
+    // datagram with the timestamp of the fragment that completed it; on
+    // NotFragment the caller should use the input as it is.
+    ReassemblyStatus process(const RawPacketView& view, RawPacket& out) {
+        auto status = process(view.data, view.length, view.linkType,
+                              FlowTable::toUsec(view.timestamp_sec, view.timestamp_usec), out);
+        if (status == ReassemblyStatus::Reassembled) {
+            out.timestamp_sec = view.timestamp_sec;
+            out.timestamp_usec = view.timestamp_usec;
+        }
+        return status;
+    }
+
+    ReassemblyStatus process(const RawPacket& raw, RawPacket& out) {
+        RawPacketView view{raw.getData(), static_cast<uint32_t>(raw.getDataLen()), raw.timestamp_sec,
+                           raw.timestamp_usec, raw.linkType};
+        return process(view, out);
+    }
+
+    // Drop every datagram whose first fragment is older than the timeout
+    void expire(uint64_t nowUsec) {
+        nowUsec_ = std::max(nowUsec_, nowUsec);
+        while (oldest_ != kNone && nowUsec_ - entries_[oldest_].firstSeenUsec > options_.timeoutUsec) {
+            remove(oldest_);
+            ++stats_.timedOut;
+        }
+    }
+
+    // Datagrams in progress
+    size_t size() const { return size_; }
+    size_t bytesInUse() const { return pool_.bytesInUse(); }
+    const Stats& stats() const { return stats_; }
+    const Options& options() const { return options_; }
+};
+
+// ============ TCP stream reassembly ============
+
+enum class TcpStreamEnd : uint8_t {
+    Closed,        // Both directions delivered up to their FIN
+    Reset,         // RST seen
+    IdleTimeout,   // No packet for TcpReassembly::Options::idleTimeoutUsec
+    Evicted,       // Table full: least recently active stream made room
+    Flushed        // TcpReassembly::flush(), e.g. at the end of the capture
+};
+
+// A run of in-order bytes from one direction of a connection
+struct TcpStreamData {
+    const FlowKey* key = nullptr;
+    bool fromInitiator = true;      // Sent by the SYN sender (or the first packet's sender)
+    const uint8_t* data = nullptr;  // Valid during the callback only
+    size_t length = 0;
+    uint64_t offset = 0;            // Stream offset of data[0] in this direction
+    uint64_t skipped = 0;           // Bytes lost right before data[0]: never captured, or given up
+    uint64_t timestampUsec = 0;     // Capture time of the segment that carried the bytes
+};
+
+// Rebuilds the ordered byte stream of each TCP direction.
+//
+// In-order segments are handed to the data callback straight from the
+// packet, without copying. Segments that arrive ahead of a gap are copied
+// into 512-byte chunks from a shared pool and released in order once the
+// gap fills; bytes that were already delivered are trimmed (first copy
+// wins). Buffering is capped per direction and for the whole pool: when a
+// cap is hit the direction gives up on its oldest gap, reports it through
+// TcpStreamData::skipped and carries on, so hostile or lossy traffic costs
+// bounded memory and never stalls the stream. Streams are tracked by
+// FlowKey with idle expiry and LRU eviction, as in FlowTable.
+class TcpReassembly {
+public:
+    struct Options {
+        size_t maxStreams = size_t{1} << 16;
+        uint64_t idleTimeoutUsec = 120ULL * 1000000;
+        size_t maxBytes = size_t{64} << 20;              // Out-of-order data across all streams
+        size_t maxBytesPerDirection = size_t{1} << 20;   // Out-of-order data per direction
+    };
+
+    struct Stats {
+        uint64_t segments = 0;      // TCP segments seen
+        uint64_t outOfOrder = 0;    // Segments buffered ahead of a gap
+        uint64_t retransmits = 0;   // Segments carrying only bytes already delivered
+        uint64_t skippedBytes = 0;  // Sequence space given up as lost
+    };
+
+    using DataCallback = std::function<void(const TcpStreamData&)>;
+    using EndCallback = std::function<void(const FlowKey&, TcpStreamEnd)>;
+
+    static constexpr size_t kChunkSize = 512;
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFF;
+
+    struct Segment {
+        uint32_t seq = 0;
+        uint32_t length = 0;
+        uint32_t missing = 0;       // Tail cut off by the snaplen
+        uint32_t chunks = detail::ChunkPool::kNoChunk;
+        uint32_t next = kNone;      // Next segment of the direction, in sequence order
+        uint64_t timestampUsec = 0;
+    };
+
+    struct Direction {
+        uint32_t nextSeq = 0;
+        uint32_t finSeq = 0;
+        bool seqValid = false;
+        bool finSeen = false;
+        uint64_t offset = 0;        // Bytes delivered or skipped so far
+        uint64_t pendingSkip = 0;   // Skipped bytes not yet reported
+        uint32_t pending = kNone;   // Out-of-order segments, by sequence number
+        size_t pendingBytes = 0;
+
+        bool closed() const { return finSeen && nextSeq == finSeq; }
+    };
+
+    struct Entry {
+        FlowKey key;
+        uint64_t hash = 0;
+        bool initiatorIsA = true;
+        bool delivered = false;     // Any data handed out yet
+        Direction dir[2];           // 0 = sent by endpoint A
+        uint64_t lastSeenUsec = 0;
+        uint32_t lruPrev = kNone;
+        uint32_t lruNext = kNone;
+    };
+
+    Options options_;
+    Stats stats_;
+    DataCallback onData_;
+    EndCallback onEnd_;
+    detail::ChunkPool pool_;
+    detail::SlotIndex index_;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> freeEntries_;
+    std::vector<Segment> segments_;
+    std::vector<uint32_t> freeSegments_;
+    std::vector<uint8_t> scratch_;
+    uint32_t lruHead_ = kNone;  // Most recently active
+    uint32_t lruTail_ = kNone;  // Least recently active
+    size_t size_ = 0;
+    uint64_t nowUsec_ = 0;
+
+    static bool seqBefore(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) < 0; }
+
+    void lruUnlink(uint32_t i) {
+        Entry& e = entries_[i];
+        if (e.lruPrev != kNone) entries_[e.lruPrev].lruNext = e.lruNext; else lruHead_ = e.lruNext;
+        if (e.lruNext != kNone) entries_[e.lruNext].lruPrev = e.lruPrev; else lruTail_ = e.lruPrev;
+        e.lruPrev = e.lruNext = kNone;
+    }
+
+    void lruPushFront(uint32_t i) {
+        Entry& e = entries_[i];
+        e.lruPrev = kNone;
+        e.lruNext = lruHead_;
+        if (lruHead_ != kNone) entries_[lruHead_].lruPrev = i;
+        lruHead_ = i;
+        if (lruTail_ == kNone) lruTail_ = i;
+    }
+
+    void deliver(Entry& e, int d, const uint8_t* data, size_t length, uint64_t timestampUsec) {
+        Direction& dir = e.dir[d];
+        dir.offset += dir.pendingSkip;
+        TcpStreamData chunk;
+        chunk.key = &e.key;
+        chunk.fromInitiator = (d == 0) == e.initiatorIsA;
+        chunk.data = data;
+        chunk.length = length;
+        chunk.offset = dir.offset;
+        chunk.skipped = dir.pendingSkip;
+        chunk.timestampUsec = timestampUsec;
+        dir.offset += length;
+        dir.pendingSkip = 0;
+        e.delivered = true;
+        if (onData_) onData_(chunk);
+    }
+
+    // Give up on the bytes up to `seq`
+    void skipTo(Direction& dir, uint32_t seq) {
+        uint32_t gap = seq - dir.nextSeq;
+        dir.pendingSkip += gap;
+        stats_.skippedBytes += gap;
+        dir.nextSeq = seq;
+    }
+
+    void freeSegment(Direction& dir, uint32_t s) {
+        dir.pending = segments_[s].next;
+        dir.pendingBytes -= segments_[s].length;
+        pool_.releaseChain(segments_[s].chunks);
+        freeSegments_.push_back(s);
+    }
+
+    // Release every buffered segment the stream has caught up with
+    void drain(Entry& e, int d) {
+        Direction& dir = e.dir[d];
+        while (dir.pending != kNone && !seqBefore(dir.nextSeq, segments_[dir.pending].seq)) {
+            uint32_t s = dir.pending;
+            Segment seg = segments_[s];
+            uint32_t overlap = dir.nextSeq - seg.seq;
+            if (overlap < seg.length) {
+                scratch_.resize(seg.length);
+                pool_.load(seg.chunks, seg.length, scratch_.data());
+                dir.nextSeq += seg.length - overlap;
+                freeSegment(dir, s);
+                deliver(e, d, scratch_.data() + overlap, seg.length - overlap, seg.timestampUsec);
+            } else {
+                freeSegment(dir, s);
+            }
+            uint32_t end = seg.seq + seg.length + seg.missing;
+            if (seqBefore(dir.nextSeq, end)) skipTo(dir, end);
+        }
+    }
+
+    // Deliver everything buffered, skipping over the gaps
+    void drainAll(Entry& e, int d) {
+        Direction& dir = e.dir[d];
+        while (dir.pending != kNone) {
+            skipTo(dir, segments_[dir.pending].seq);
+            drain(e, d);
+        }
+    }
+
+    bool store(Direction& dir, uint32_t seq, const uint8_t* data, size_t length, uint32_t missing,
+               uint64_t timestampUsec) {
+        if (dir.pendingBytes + length > options_.maxBytesPerDirection) return false;
+        uint32_t chunks = pool_.store(data, length);
+        if (chunks == detail::ChunkPool::kNoChunk) return false;
+
+        uint32_t s;
+        if (!freeSegments_.empty()) {
+            s = freeSegments_.back();
+            freeSegments_.pop_back();
+        } else {
+            s = static_cast<uint32_t>(segments_.size());
+            segments_.emplace_back();
+        }
+        Segment& seg = segments_[s];
+        seg.seq = seq;
+        seg.length = static_cast<uint32_t>(length);
+        seg.missing = missing;
+        seg.chunks = chunks;
+        seg.timestampUsec = timestampUsec;
+
+        // Sorted insert; most segments land at or near the end of short lists
+        uint32_t* link = &dir.pending;
+        while (*link != kNone && !seqBefore(seq, segments_[*link].seq)) link = &segments_[*link].next;
+        seg.next = *link;
+        *link = s;
+        dir.pendingBytes += length;
+        ++stats_.outOfOrder;
+        return true;
+    }
+
+    // `missing` bytes past the captured `length` were cut off by the snaplen;
+    // once the stream reaches them they are skipped rather than waited for
+    void addPayload(Entry& e, int d, uint32_t seq, const uint8_t* data, size_t length, uint32_t missing,
+                    uint64_t timestampUsec) {
+        Direction& dir = e.dir[d];
+        uint32_t end = seq + static_cast<uint32_t>(length) + missing;
+        for (;;) {
+            if (!seqBefore(dir.nextSeq, seq)) {
+                if (!seqBefore(dir.nextSeq, end)) {
+                    ++stats_.retransmits;
+                    return;
+                }
+                uint32_t overlap = dir.nextSeq - seq;
+                if (overlap < length) {
+                    dir.nextSeq += static_cast<uint32_t>(length - overlap);
+                    deliver(e, d, data + overlap, length - overlap, timestampUsec);
+                }
+                if (seqBefore(dir.nextSeq, end)) skipTo(dir, end);
+                drain(e, d);
+                return;
+            }
+            if (store(dir, seq, data, length, missing, timestampUsec)) return;
+            // No room: give up on the gap before this segment if it is the
+            // oldest, otherwise on the oldest gap of this direction, and retry
+            if (dir.pending == kNone || seqBefore(seq, segments_[dir.pending].seq)) {
+                skipTo(dir, seq);
+            } else {
+                skipTo(dir, segments_[dir.pending].seq);
+                drain(e, d);
+            }
+        }
+    }
+
+    void remove(uint32_t i, TcpStreamEnd reason) {
+        Entry& e = entries_[i];
+        drainAll(e, 0);
+        drainAll(e, 1);
+        if (onEnd_) onEnd_(e.key, reason);
+        index_.erase(e.hash, i);
+        lruUnlink(i);
+        freeEntries_.push_back(i);
+        --size_;
+    }
+
+    uint32_t insert(const FlowKey& key, uint64_t hash) {
+        if (index_.empty()) index_.reserve(options_.maxStreams);
+        if (size_ >= options_.maxStreams) remove(lruTail_, TcpStreamEnd::Evicted);
+        uint32_t i;
+        if (!freeEntries_.empty()) {
+            i = freeEntries_.back();
+            freeEntries_.pop_back();
+            entries_[i] = Entry{};
+        } else {
+            i = static_cast<uint32_t>(entries_.size());
+            entries_.emplace_back();
+        }
+        entries_[i].key = key;
+        entries_[i].hash = hash;
+        index_.insert(hash, i);
+        lruPushFront(i);
+        ++size_;
+        return i;
+    }
+
+public:
+    explicit TcpReassembly(DataCallback onData, EndCallback onEnd = {})
+        : TcpReassembly(Options{}, std::move(onData), std::move(onEnd)) {}
+
+    TcpReassembly(Options options, DataCallback onData, EndCallback onEnd = {})
+        : options_(options), onData_(std::move(onData)), onEnd_(std::move(onEnd)),
+          pool_(kChunkSize, options.maxBytes) {
+        if (options_.maxStreams == 0) options_.maxStreams = 1;
+    }
+
+    // Feed one packet captured at `timestampUsec`. Returns false if it is not
+    // TCP over IP and was ignored. Feed reassembled datagrams from
+    // IPReassembly rather than raw fragments.
+    bool process(const Packet& packet, uint64_t timestampUsec) {
+        bool fromA = true;
+        auto key = extractFlowKey(packet, &fromA);
+        if (!key || key->protocol != 6) return false;
+        const TCPView* tcp = packet.getLayerOfType<TCPView>();
+        ++stats_.segments;
+
+        expire(timestampUsec);
+
+        uint64_t hash = key->hash();
+        uint32_t i = index_.find(hash, [&](uint32_t n) { return entries_[n].key == *key; });
+        bool created = i == kNone;
+        if (created) {
+            i = insert(*key, hash);
+            entries_[i].initiatorIsA = fromA;
+        } else {
+            lruUnlink(i);
+            lruPushFront(i);
+        }
+        Entry& e = entries_[i];
+        e.lastSeenUsec = std::max(e.lastSeenUsec, timestampUsec);
+
+        uint8_t flags = tcp->flags();
+        bool syn = flags & TCPView::SYN;
+        // A bare SYN names the initiator if we joined before any data
+        if (syn && !(flags & TCPView::ACK) && !e.delivered) e.initiatorIsA = fromA;
+
+        if (flags & TCPView::RST) {
+            remove(i, TcpStreamEnd::Reset);
+            return true;
+        }
+
+        // Payload per the IP length; snaplen may have cut the captured part
+        // shorter, and the missing tail is then skipped as a gap
+        const uint8_t* ipData;
+        size_t ipLen;
+        if (const IPv4View* ip = packet.getLayerOfType<IPv4View>()) {
+            ipData = ip->getData();
+            ipLen = ip->totalLength();
+        } else {
+            const IPv6View* ip6 = packet.getLayerOfType<IPv6View>();
+            ipData = ip6->getData();
+            ipLen = 40 + size_t{ip6->payloadLength()};
+        }
+        size_t headers = static_cast<size_t>(tcp->getData() - ipData) + tcp->headerLength();
+        size_t declared = ipLen > headers ? ipLen - headers : 0;
+        size_t captured = std::min(declared, tcp->payloadLength());
+
+        int d = fromA ? 0 : 1;
+        Direction& dir = e.dir[d];
+        uint32_t seq = tcp->seq();
+        if (syn) {
+            if (!dir.seqValid) dir.nextSeq = seq + 1;
+            seq += 1;
+        } else if (!dir.seqValid) {
+            dir.nextSeq = seq;
+        }
+        dir.seqValid = true;
+
+        if (declared != 0) {
+            addPayload(e, d, seq, tcp->payload(), captured, static_cast<uint32_t>(declared - captured),
+                       timestampUsec);
+        }
+        if (flags & TCPView::FIN) {
+            dir.finSeen = true;
+            dir.finSeq = seq + static_cast<uint32_t>(declared);
+        }
+        if (e.dir[0].closed() && e.dir[1].closed()) remove(i, TcpStreamEnd::Closed);
+        return true;
+    }
+
+    bool process(const RawPacketView& view) {
+        return process(Packet(view), FlowTable::toUsec(view.timestamp_sec, view.timestamp_usec));
+    }
+
+    bool process(const RawPacket& raw) {
+        return process(Packet(&raw), FlowTable::toUsec(raw.timestamp_sec, raw.timestamp_usec));
+    }
+
+    // End every stream idle for longer than the timeout at `nowUsec`,
+    // delivering what it still buffers
+    void expire(uint64_t nowUsec) {
+        nowUsec_ = std::max(nowUsec_, nowUsec);
+        while (lruTail_ != kNone && nowUsec_ - entries_[lruTail_].lastSeenUsec > options_.idleTimeoutUsec) {
+            remove(lruTail_, TcpStreamEnd::IdleTimeout);
+        }
+    }
+
+    // End all remaining streams, oldest activity first
+    void flush() {
+        while (lruTail_ != kNone) remove(lruTail_, TcpStreamEnd::Flushed);
+    }
+
+    size_t size() const { return size_; }
+    size_t bytesInUse() const { return pool_.bytesInUse(); }
+    const Stats& stats() const { return stats_; }
+    const Options& options() const { return options_; }
+};
+
+} // namespace pcap
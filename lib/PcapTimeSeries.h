@@ -0,0 +1,275 @@
+#pragma once
+
+#include "PcapClassify.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace pcap {
+
+// HDR-style histogram of non-negative integers (packet sizes here). Values
+// below 2^kSubBits are counted exactly; above that every power of two is
+// split into 2^(kSubBits-1) equal sub-buckets, so any reported value is
+// within 1/128 (< 0.8%) of the recorded one. Fixed size, O(1) record.
+class HdrHistogram {
+public:
+    static constexpr unsigned kSubBits = 8;
+    static constexpr uint64_t kMaxValue = 0xFFFFFFFF;  // Larger values are clamped
+
+private:
+    static constexpr size_t kExact = size_t{1} << kSubBits;
+    static constexpr size_t kHalf = kExact / 2;
+    static constexpr size_t kBuckets = kExact + (32 - kSubBits) * kHalf;
+
+    std::array<uint64_t, kBuckets> counts_{};
+    uint64_t total_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+
+    static size_t indexOf(uint64_t v) {
+        if (v < kExact) return static_cast<size_t>(v);
+        unsigned shift = static_cast<unsigned>(std::bit_width(v)) - kSubBits;
+        return kExact + (shift - 1) * kHalf + static_cast<size_t>((v >> shift) - kHalf);
+    }
+
+    // Largest value that lands in bucket `i`
+    static uint64_t highestOf(size_t i) {
+        if (i < kExact) return i;
+        unsigned shift = static_cast<unsigned>((i - kExact) / kHalf) + 1;
+        uint64_t top = kHalf + (i - kExact) % kHalf;
+        return ((top + 1) << shift) - 1;
+    }
+
+public:
+    void record(uint64_t value, uint64_t count = 1) {
+        value = std::min(value, kMaxValue);
+        counts_[indexOf(value)] += count;
+        total_ += count;
+        sum_ += value * count;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    void merge(const HdrHistogram& other) {
+        for (size_t i = 0; i < kBuckets; ++i) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    void reset() { *this = HdrHistogram{}; }
+
+    uint64_t count() const { return total_; }
+    uint64_t min() const { return total_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ ? static_cast<double>(sum_) / static_cast<double>(total_) : 0.0; }
+
+    // Smallest recorded value v such that `percentile`% of values are <= v
+    // (up to bucket precision). 0 when empty.
+    uint64_t valueAtPercentile(double percentile) const {
+        if (total_ == 0) return 0;
+        double clamped = std::clamp(percentile, 0.0, 100.0);
+        auto rank = static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(total_) + 0.5);
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::clamp(highestOf(i), min_, max_);
+        }
+        return max_;
+    }
+};
+
+// Series tracked by ThroughputAggregator: index 0 counts every packet, the
+// rest follow ProtocolType as Packet::isPacketOfType() reports it. Series
+// i + 1 is bit i of a ProtocolMask, so masks are accumulated without lookups.
+inline constexpr std::array<ProtocolType, 7> kSeriesProtocols = {Ethernet, IPv4, IPv6, ARP, TCP, UDP, ICMP};
+inline constexpr size_t kSeriesCount = kSeriesProtocols.size() + 1;
+static_assert(MaskEthernet == 1 && MaskICMP == 1 << (kSeriesProtocols.size() - 1));
+
+// Series index of a protocol, 0 (all packets) for anything not tracked
+constexpr size_t seriesIndex(ProtocolType type) {
+    for (size_t i = 0; i < kSeriesProtocols.size(); ++i) {
+        if (kSeriesProtocols[i] == type) return i + 1;
+    }
+    return 0;
+}
+
+// Packets and bytes seen in [startUsec, startUsec + widthUsec)
+struct ThroughputBucket {
+    uint64_t startUsec = 0;
+    uint64_t widthUsec = 0;
+    std::array<uint64_t, kSeriesCount> packets{};
+    std::array<uint64_t, kSeriesCount> bytes{};
+
+    bool empty() const { return packets[0] == 0; }
+
+    double packetsPerSecond(size_t series = 0) const {
+        return static_cast<double>(packets[series]) * 1e6 / static_cast<double>(widthUsec);
+    }
+    double bytesPerSecond(size_t series = 0) const {
+        return static_cast<double>(bytes[series]) * 1e6 / static_cast<double>(widthUsec);
+    }
+};
+
+// Streaming packet-rate and byte-rate aggregation at several resolutions.
+//
+// Each resolution keeps a fixed ring of Options::ringSize buckets aligned to
+// multiples of its width. A bucket is handed to the callback once it falls
+// off the ring, i.e. when a packet ringSize widths newer arrives, so memory
+// stays constant however long the capture is and slightly out-of-order
+// timestamps (up to ringSize - 1 widths) still land in the right bucket.
+// Older stragglers are only counted in latePackets(). Buckets in which no
+// packet arrived are not emitted: gaps in the series mean zero.
+//
+// Packet sizes (captured bytes) go into one HdrHistogram per series.
+class ThroughputAggregator {
+public:
+    struct Options {
+        std::vector<uint64_t> resolutionsUsec = {1000, 100000, 1000000};
+        size_t ringSize = 8;
+    };
+
+    using Callback = std::function<void(const ThroughputBucket&)>;
+
+private:
+    struct Level {
+        uint64_t widthUsec;
+        std::vector<ThroughputBucket> ring;
+        uint64_t head = 0;      // Newest bucket number (start / width)
+        uint64_t headStart = 0; // Lets packets in the newest bucket, the common
+                                // case, skip the division
+        bool started = false;
+    };
+
+    size_t ringSize_;
+    Callback onBucket_;
+    std::vector<Level> levels_;
+    std::array<HdrHistogram, kSeriesCount> sizes_;
+    uint64_t latePackets_ = 0;
+
+    void emit(ThroughputBucket& bucket) {
+        if (!bucket.empty() && onBucket_) onBucket_(bucket);
+        bucket.packets.fill(0);
+        bucket.bytes.fill(0);
+    }
+
+    void addToLevel(Level& level, uint64_t timestampUsec, uint64_t bytes, ProtocolMask mask) {
+        uint64_t number = timestampUsec - level.headStart < level.widthUsec ? level.head
+                                                                            : timestampUsec / level.widthUsec;
+        if (!level.started) {
+            level.head = number;
+            level.headStart = number * level.widthUsec;
+            level.started = true;
+        } else if (number > level.head) {
+            // Emit what falls off the ring, oldest first; at most ringSize buckets
+            uint64_t firstLive = number - std::min<uint64_t>(number, ringSize_ - 1);
+            uint64_t from = level.head - std::min<uint64_t>(level.head, ringSize_ - 1);
+            for (uint64_t n = from; n < firstLive && n <= level.head; ++n) emit(level.ring[n % ringSize_]);
+            level.head = number;
+            level.headStart = number * level.widthUsec;
+        } else if (level.head - number >= ringSize_) {
+            ++latePackets_;
+            return;
+        }
+
+        ThroughputBucket& bucket = level.ring[number % ringSize_];
+        bucket.startUsec = number * level.widthUsec;
+        ++bucket.packets[0];
+        bucket.bytes[0] += bytes;
+        for (size_t i = 0; i < kSeriesProtocols.size(); ++i) {
+            uint64_t bit = (mask >> i) & 1;
+            bucket.packets[i + 1] += bit;
+            bucket.bytes[i + 1] += bytes * bit;
+        }
+    }
+
+public:
+    explicit ThroughputAggregator(Callback onBucket) : ThroughputAggregator(Options{}, std::move(onBucket)) {}
+
+    ThroughputAggregator(Options options, Callback onBucket)
+        : ringSize_(std::max<size_t>(options.ringSize, 1)), onBucket_(std::move(onBucket)) {
+        for (uint64_t width : options.resolutionsUsec) {
+            Level level{std::max<uint64_t>(width, 1), std::vector<ThroughputBucket>(ringSize_)};
+            for (auto& bucket : level.ring) bucket.widthUsec = level.widthUsec;
+            levels_.push_back(std::move(level));
+        }
+    }
+
+    // Account one packet of `bytes` captured bytes with the given protocols
+    void add(uint64_t timestampUsec, uint64_t bytes, ProtocolMask mask) {
+        uint64_t late = latePackets_;
+        for (Level& level : levels_) addToLevel(level, timestampUsec, bytes, mask);
+        if (latePackets_ != late) latePackets_ = late + 1;  // Count a packet once, not per level
+
+        sizes_[0].record(bytes);
+        for (ProtocolMask rest = mask; rest; rest &= rest - 1) sizes_[std::countr_zero(rest) + 1].record(bytes);
+    }
+
+    void add(const RawPacketView& view) {
+        add(static_cast<uint64_t>(view.timestamp_sec) * 1000000 + view.timestamp_usec, view.length,
+            protocolMaskOf(Packet(view)));
+    }
+
+    void add(const RawPacket& raw) {
+        add(static_cast<uint64_t>(raw.timestamp_sec) * 1000000 + raw.timestamp_usec, raw.getDataLen(),
+            protocolMaskOf(Packet(&raw)));
+    }
+
+    // Classify a batch with classifyBatch() and account every packet
+    void addBatch(std::span<const RawPacketView> views) {
+        constexpr size_t kChunk = 1024;
+        std::array<ProtocolMask, kChunk> masks;
+        for (size_t from = 0; from < views.size(); from += kChunk) {
+            auto chunk = views.subspan(from, std::min(kChunk, views.size() - from));
+            classifyBatch(chunk, std::span<ProtocolMask>(masks.data(), chunk.size()));
+            for (size_t i = 0; i < chunk.size(); ++i) {
+                add(static_cast<uint64_t>(chunk[i].timestamp_sec) * 1000000 + chunk[i].timestamp_usec,
+                    chunk[i].length, masks[i]);
+            }
+        }
+    }
+
+    // Emit every bucket still on the rings, oldest first per resolution
+    void flush() {
+        for (Level& level : levels_) {
+            if (!level.started) continue;
+            uint64_t from = level.head - std::min<uint64_t>(level.head, ringSize_ - 1);
+            for (uint64_t n = from; n <= level.head; ++n) emit(level.ring[n % ringSize_]);
+            level.started = false;
+        }
+    }
+
+    // Totals over the live ring of resolution `level`: a sliding window of
+    // ringSize widths ending with the newest bucket
+    ThroughputBucket window(size_t level) const {
+        const Level& l = levels_[level];
+        ThroughputBucket total;
+        total.widthUsec = l.widthUsec * ringSize_;
+        total.startUsec = (l.head + 1 - std::min<uint64_t>(l.head + 1, ringSize_)) * l.widthUsec;
+        if (!l.started) return total;
+        for (const auto& bucket : l.ring) {
+            for (size_t i = 0; i < kSeriesCount; ++i) {
+                total.packets[i] += bucket.packets[i];
+                total.bytes[i] += bucket.bytes[i];
+            }
+        }
+        return total;
+    }
+
+    size_t resolutionCount() const { return levels_.size(); }
+    uint64_t resolutionUsec(size_t level) const { return levels_[level].widthUsec; }
+    const HdrHistogram& sizes(ProtocolType type) const { return sizes_[seriesIndex(type)]; }
+    const HdrHistogram& allSizes() const { return sizes_[0]; }
+    // Packets too old for the ring of at least one resolution
+    uint64_t latePackets() const { return latePackets_; }
+};
+
+} // namespace pcap
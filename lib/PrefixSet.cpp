@@ -0,0 +1,209 @@
+#include "PrefixSet.h"
+#include "FastNetworkUtils.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+unsigned trailing_zeros(IPv4Address a) { return static_cast<unsigned>(std::countr_zero(a.to_uint32())); }
+
+unsigned trailing_zeros(const IPv6Address& a) {
+    if (a.low() != 0) return static_cast<unsigned>(std::countr_zero(a.low()));
+    return 64 + static_cast<unsigned>(std::countr_zero(a.high()));
+}
+
+// Minimal cover of [first, last]: the largest aligned block starting at
+// `first` that stays inside the range, repeated until the range is used up
+template<typename Address, typename Emit>
+void cover(Address first, Address last, Emit&& emit) {
+    while (true) {
+        unsigned length = Address::kBits - std::min(trailing_zeros(first), Address::kBits);
+        while ((first | ~Address::mask(length)) > last) ++length;
+        BasicPrefix<Address> block(first, length);
+        emit(block);
+        if (block.broadcast() == last) return;
+        first = block.broadcast() + 1;
+    }
+}
+
+size_t format_address(IPv4Address a, char* out) {
+    return FastNetworkUtils::uint32_to_ipv4(a.to_uint32(), {out, FastNetworkUtils::kIPv4TextMax});
+}
+
+size_t format_address(const IPv6Address& a, char* out) {
+    return FastNetworkUtils::bytes_to_ipv6(a.to_bytes(), {out, FastNetworkUtils::kIPv6TextMax});
+}
+
+// Appends "address/length\n" without building a std::string per line
+template<typename Address>
+void write_prefix(std::ostream& out, const BasicPrefix<Address>& prefix) {
+    // Address, '/', at most three length digits, '\n'
+    char line[FastNetworkUtils::kIPv6TextMax + 5];
+    char* end = line + format_address(prefix.network(), line);
+    *end++ = '/';
+    end = std::to_chars(end, end + 3, prefix.length()).ptr;
+    *end++ = '\n';
+    out.write(line, end - line);
+}
+
+std::string_view trim(std::string_view s) {
+    constexpr std::string_view kSpace = " \t\r\n";
+    size_t begin = s.find_first_not_of(kSpace);
+    if (begin == std::string_view::npos) return {};
+    return s.substr(begin, s.find_last_not_of(kSpace) - begin + 1);
+}
+
+} // namespace
+
+template<typename Address>
+BasicPrefixSet<Address>::BasicPrefixSet(std::span<const PrefixType> prefixes) {
+    std::vector<Range> ranges;
+    ranges.reserve(prefixes.size());
+    for (const PrefixType& p : prefixes) ranges.push_back({p.network(), p.broadcast()});
+    ranges_ = normalize(std::move(ranges));
+}
+
+template<typename Address>
+std::vector<typename BasicPrefixSet<Address>::Range> BasicPrefixSet<Address>::normalize(std::vector<Range> ranges) {
+    std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return a.first < b.first; });
+    return coalesce(std::move(ranges));
+}
+
+template<typename Address>
+std::vector<typename BasicPrefixSet<Address>::Range> BasicPrefixSet<Address>::coalesce(std::vector<Range> ranges) {
+    size_t out = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        // Merge when overlapping or adjacent; last + 1 wraps only at the
+        // top address, where nothing can follow anyway
+        if (out > 0 && (ranges[i].first <= ranges[out - 1].last || ranges[i].first == ranges[out - 1].last + 1)) {
+            ranges[out - 1].last = std::max(ranges[out - 1].last, ranges[i].last);
+        } else {
+            ranges[out++] = ranges[i];
+        }
+    }
+    ranges.resize(out);
+    return ranges;
+}
+
+// ============ Set Algebra ============
+
+template<typename Address>
+BasicPrefixSet<Address> BasicPrefixSet<Address>::unite(const BasicPrefixSet& other) const {
+    std::vector<Range> merged;
+    merged.reserve(ranges_.size() + other.ranges_.size());
+    std::merge(ranges_.begin(), ranges_.end(), other.ranges_.begin(), other.ranges_.end(), std::back_inserter(merged),
+               [](const Range& a, const Range& b) { return a.first < b.first; });
+    BasicPrefixSet result;
+    result.ranges_ = coalesce(std::move(merged));
+    return result;
+}
+
+template<typename Address>
+BasicPrefixSet<Address> BasicPrefixSet<Address>::intersect(const BasicPrefixSet& other) const {
+    BasicPrefixSet result;
+    auto a = ranges_.begin(), b = other.ranges_.begin();
+    while (a != ranges_.end() && b != other.ranges_.end()) {
+        Address first = std::max(a->first, b->first);
+        Address last = std::min(a->last, b->last);
+        if (first <= last) result.ranges_.push_back({first, last});
+        // The range that ends first cannot meet anything further on
+        if (a->last < b->last) {
+            ++a;
+        } else {
+            ++b;
+        }
+    }
+    return result;
+}
+
+template<typename Address>
+BasicPrefixSet<Address> BasicPrefixSet<Address>::subtract(const BasicPrefixSet& other) const {
+    BasicPrefixSet result;
+    auto b = other.ranges_.begin();
+    for (Range a : ranges_) {
+        // Skip removed ranges entirely below this one
+        while (b != other.ranges_.end() && b->last < a.first) ++b;
+        bool remaining = true;
+        for (auto cut = b; cut != other.ranges_.end() && cut->first <= a.last; ++cut) {
+            if (cut->first > a.first) result.ranges_.push_back({a.first, cut->first - 1});
+            if (cut->last >= a.last) {
+                remaining = false;
+                break;
+            }
+            a.first = cut->last + 1;
+        }
+        if (remaining) result.ranges_.push_back(a);
+    }
+    return result;
+}
+
+// ============ Queries ============
+
+template<typename Address>
+bool BasicPrefixSet<Address>::contains(Address address) const {
+    // First range starting after the address; the one before it may hold it
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), address,
+                               [](Address a, const Range& r) { return a < r.first; });
+    return it != ranges_.begin() && address <= std::prev(it)->last;
+}
+
+template<typename Address>
+bool BasicPrefixSet<Address>::contains(const PrefixType& prefix) const {
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), prefix.network(),
+                               [](Address a, const Range& r) { return a < r.first; });
+    return it != ranges_.begin() && prefix.broadcast() <= std::prev(it)->last;
+}
+
+template<typename Address>
+std::vector<typename BasicPrefixSet<Address>::PrefixType> BasicPrefixSet<Address>::prefixes() const {
+    std::vector<PrefixType> result;
+    for (const Range& r : ranges_) cover(r.first, r.last, [&](const PrefixType& p) { result.push_back(p); });
+    return result;
+}
+
+template<typename Address>
+uint64_t BasicPrefixSet<Address>::address_count() const
+    requires(Address::kBits == 32)
+{
+    uint64_t count = 0;
+    for (const Range& r : ranges_) count += uint64_t{r.last.to_uint32()} - r.first.to_uint32() + 1;
+    return count;
+}
+
+// ============ Text Streams ============
+
+template<typename Address>
+BasicPrefixSet<Address> BasicPrefixSet<Address>::read(std::istream& in, size_t* rejected) {
+    std::vector<Range> ranges;
+    size_t bad = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string_view text = trim(line);
+        if (text.empty() || text.front() == '#') continue;
+        if (auto prefix = PrefixType::parse(text)) {
+            ranges.push_back({prefix->network(), prefix->broadcast()});
+        } else {
+            ++bad;
+        }
+    }
+    if (rejected) *rejected = bad;
+    BasicPrefixSet result;
+    result.ranges_ = normalize(std::move(ranges));
+    return result;
+}
+
+template<typename Address>
+void BasicPrefixSet<Address>::write(std::ostream& out) const {
+    // Prefixes are written as they are produced, the cover is never held
+    for (const Range& r : ranges_) cover(r.first, r.last, [&](const PrefixType& p) { write_prefix(out, p); });
+}
+
+template class BasicPrefixSet<IPv4Address>;
+template class BasicPrefixSet<IPv6Address>;
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "IpAddress.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+/**
+ * @class BasicPrefixSet
+ * @brief A set of addresses given as CIDR prefixes, with set algebra.
+ *
+ * Stored as sorted, disjoint, non-adjacent inclusive ranges of addresses,
+ * so every set has one representation however its prefixes overlapped.
+ * Building from n prefixes is a sort and a merge, O(n log n); union,
+ * intersection and difference are a single merge over both range lists,
+ * O(n + m); prefixes() turns the ranges back into the minimal CIDR cover.
+ *
+ * Example:
+ *   std::ifstream feed("cloud-ranges.txt"), blocked("blocklist.txt");
+ *   auto allowed = PrefixSet::read(feed).subtract(PrefixSet::read(blocked));
+ *   allowed.write(std::cout);   // minimal CIDR list, one per line
+ */
+template<typename Address>
+class BasicPrefixSet {
+public:
+    using PrefixType = BasicPrefix<Address>;
+
+    /// Inclusive range of addresses
+    struct Range {
+        Address first;
+        Address last;
+
+        bool operator==(const Range&) const = default;
+    };
+
+    BasicPrefixSet() = default;
+
+    /**
+     * Set of the addresses covered by any of the prefixes (aggregation).
+     * Example: {10.0.0.0/25, 10.0.0.128/25, 10.0.0.64/26} → {10.0.0.0/24}
+     *
+     * @param prefixes Prefixes in any order, overlaps allowed
+     */
+    explicit BasicPrefixSet(std::span<const PrefixType> prefixes);
+
+    // ============ Set Algebra ============
+
+    /// Addresses in this set or the other
+    BasicPrefixSet unite(const BasicPrefixSet& other) const;
+
+    /// Addresses in both sets
+    BasicPrefixSet intersect(const BasicPrefixSet& other) const;
+
+    /// Addresses in this set and not in the other
+    BasicPrefixSet subtract(const BasicPrefixSet& other) const;
+
+    // ============ Queries ============
+
+    /**
+     * Check if an address is in the set (binary search over the ranges).
+     *
+     * @param address The address
+     * @return true if some prefix of the set contains it
+     */
+    bool contains(Address address) const;
+
+    /**
+     * Check if every address of a prefix is in the set.
+     *
+     * @param prefix The prefix
+     * @return true if the set covers the whole prefix
+     */
+    bool contains(const PrefixType& prefix) const;
+
+    /**
+     * The minimal list of prefixes covering exactly this set, in address order.
+     *
+     * @return Aggregated prefixes
+     */
+    std::vector<PrefixType> prefixes() const;
+
+    /// The disjoint ranges, in address order
+    const std::vector<Range>& ranges() const { return ranges_; }
+
+    bool empty() const { return ranges_.empty(); }
+
+    /// Number of addresses in the set
+    uint64_t address_count() const
+        requires(Address::kBits == 32);
+
+    bool operator==(const BasicPrefixSet&) const = default;
+
+    // ============ Text Streams ============
+
+    /**
+     * Read one CIDR per line ("10.0.0.0/8"; a bare address is a host prefix).
+     * Blank lines and lines starting with '#' are skipped, surrounding
+     * whitespace is ignored. Lines are parsed as they are read, so only the
+     * prefixes are held in memory.
+     *
+     * @param in Text stream
+     * @param rejected If not null, receives the number of malformed lines
+     *                 (including prefixes with host bits set)
+     * @return The aggregated set of every valid line
+     */
+    static BasicPrefixSet read(std::istream& in, size_t* rejected = nullptr);
+
+    /**
+     * Write the minimal CIDR cover, one prefix per line.
+     *
+     * @param out Text stream
+     */
+    void write(std::ostream& out) const;
+
+private:
+    // Sort, then coalesce
+    static std::vector<Range> normalize(std::vector<Range> ranges);
+
+    // Merge overlapping or adjacent ranges of a list sorted by first address
+    static std::vector<Range> coalesce(std::vector<Range> ranges);
+
+    std::vector<Range> ranges_;
+};
+
+using PrefixSet = BasicPrefixSet<IPv4Address>;
+using IPv6PrefixSet = BasicPrefixSet<IPv6Address>;
+
+extern template class BasicPrefixSet<IPv4Address>;
+extern template class BasicPrefixSet<IPv6Address>;
@@ -0,0 +1,211 @@
+#include "PrefixTable.h"
+#include "FastNetworkUtils.h"
+
+#include <algorithm>
+#include <string_view>
+
+namespace {
+
+bool parse_prefix_length(std::string_view text, unsigned max, unsigned& out) {
+    if (text.empty() || text.size() > 3) return false;
+    unsigned n = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        n = n * 10 + static_cast<unsigned>(c - '0');
+    }
+    if (n > max) return false;
+    out = n;
+    return true;
+}
+
+bool host_bits_clear(const uint8_t* key, size_t bytes, unsigned prefix) {
+    for (size_t i = 0; i < bytes; ++i) {
+        unsigned bit = static_cast<unsigned>(i) * 8;
+        uint8_t host = prefix >= bit + 8 ? 0 : prefix <= bit ? 0xFF : static_cast<uint8_t>(0xFF >> (prefix - bit));
+        if (key[i] & host) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// ============ Trie ============
+
+PrefixTable::Trie::Trie() : root(65536, kEmpty), rootLen(65536, 0) {}
+
+uint32_t PrefixTable::Trie::new_chunk(uint32_t value, uint8_t len) {
+    auto chunk = static_cast<uint32_t>(slots.size() >> 8);
+    slots.resize(slots.size() + 256, value);
+    lens.resize(lens.size() + 256, len);
+    return chunk;
+}
+
+void PrefixTable::Trie::push_down(uint32_t chunk, unsigned prefix, uint32_t value) {
+    size_t base = static_cast<size_t>(chunk) << 8;
+    for (size_t i = base; i < base + 256; ++i) fill(slots[i], lens[i], prefix, value);
+}
+
+// A slot takes the new value unless a longer prefix already owns it; links
+// pass the value down to whatever the longer prefixes left uncovered
+void PrefixTable::Trie::fill(uint32_t& slot, uint8_t& len, unsigned prefix, uint32_t value) {
+    if (slot & kLink) {
+        push_down(slot & ~kLink, prefix, value);
+    } else if (len <= prefix) {
+        slot = value;
+        len = static_cast<uint8_t>(prefix);
+    }
+}
+
+void PrefixTable::Trie::insert(const uint8_t* key, unsigned prefix, uint32_t value) {
+    size_t top = (static_cast<size_t>(key[0]) << 8) | key[1];
+    if (prefix <= 16) {
+        size_t span = size_t{1} << (16 - prefix);
+        size_t first = top & ~(span - 1);
+        for (size_t i = first; i < first + span; ++i) fill(root[i], rootLen[i], prefix, value);
+        return;
+    }
+    if (!(root[top] & kLink)) root[top] = kLink | new_chunk(root[top], rootLen[top]);
+    uint32_t chunk = root[top] & ~kLink;
+
+    // Byte `b` of the key indexes the chunk that covers bits up to `end`
+    for (size_t b = 2, end = 24;; ++b, end += 8) {
+        size_t base = static_cast<size_t>(chunk) << 8;
+        if (prefix <= end) {
+            size_t span = size_t{1} << (end - prefix);
+            size_t first = base + (key[b] & ~(span - 1));
+            for (size_t i = first; i < first + span; ++i) fill(slots[i], lens[i], prefix, value);
+            return;
+        }
+        size_t pos = base + key[b];
+        if (!(slots[pos] & kLink)) {
+            uint32_t next = new_chunk(slots[pos], lens[pos]);
+            slots[pos] = kLink | next;
+        }
+        chunk = slots[pos] & ~kLink;
+    }
+}
+
+// ============ Building ============
+
+bool PrefixTable::insert(const std::string& cidr, uint32_t value) {
+    std::string_view text = cidr;
+    size_t slash = text.find('/');
+    std::string_view address = text.substr(0, slash);
+
+    if (auto v4 = FastNetworkUtils::ipv4_to_uint32(address)) {
+        unsigned prefix = 32;
+        if (slash != std::string_view::npos && !parse_prefix_length(text.substr(slash + 1), 32, prefix)) return false;
+        return insert_v4(*v4, static_cast<uint8_t>(prefix), value);
+    }
+    if (auto v6 = IPv6Address::parse(address)) {
+        unsigned prefix = 128;
+        if (slash != std::string_view::npos && !parse_prefix_length(text.substr(slash + 1), 128, prefix)) return false;
+        return insert_v6(v6->to_bytes(), static_cast<uint8_t>(prefix), value);
+    }
+    return false;
+}
+
+bool PrefixTable::insert_v4(uint32_t network, uint8_t prefix, uint32_t value) {
+    uint32_t host = prefix >= 32 ? 0 : 0xFFFFFFFFu >> prefix;
+    if (prefix > 32 || (network & host) || value > kMaxValue) return false;
+    IPv6Bytes key{};
+    key[0] = static_cast<uint8_t>(network >> 24);
+    key[1] = static_cast<uint8_t>(network >> 16);
+    key[2] = static_cast<uint8_t>(network >> 8);
+    key[3] = static_cast<uint8_t>(network);
+    v4_.insert(key.data(), prefix, value + 1);
+    v4_.prefixes.insert({key, prefix});
+    return true;
+}
+
+bool PrefixTable::insert_v6(const IPv6Bytes& network, uint8_t prefix, uint32_t value) {
+    if (prefix > 128 || !host_bits_clear(network.data(), network.size(), prefix) || value > kMaxValue) return false;
+    v6_.insert(network.data(), prefix, value + 1);
+    v6_.prefixes.insert({network, prefix});
+    return true;
+}
+
+void PrefixTable::clear() {
+    v4_ = Trie{};
+    v6_ = Trie{};
+}
+
+// ============ Longest-Prefix Match ============
+
+std::optional<uint32_t> PrefixTable::lookup(const IPv6Bytes& address) const {
+    uint32_t slot = v6_.root[(static_cast<size_t>(address[0]) << 8) | address[1]];
+    for (size_t b = 2; slot & kLink; ++b) slot = v6_.slots[(static_cast<size_t>(slot & ~kLink) << 8) | address[b]];
+    if (slot == kEmpty) return std::nullopt;
+    return slot - 1;
+}
+
+std::optional<uint32_t> PrefixTable::lookup(const std::string& address) const {
+    if (auto v4 = FastNetworkUtils::ipv4_to_uint32(address)) return lookup(*v4);
+    if (auto v6 = IPv6Address::parse(address)) return lookup(v6->to_bytes());
+    return std::nullopt;
+}
+
+void PrefixTable::lookup_batch(std::span<const uint32_t> addresses, std::span<uint32_t> values) const {
+    // Level by level over a group: the loads of one level are independent,
+    // so their misses are in flight together. Addresses already resolved
+    // reload slot 0 instead of branching, and kEmpty - 1 wraps to kNoMatch.
+    constexpr size_t kGroup = 16;
+    const uint32_t* root = v4_.root.data();
+    const uint32_t* slots = v4_.slots.data();
+    size_t n = std::min(addresses.size(), values.size());
+    size_t i = 0;
+    for (; !v4_.slots.empty() && i + kGroup <= n; i += kGroup) {
+        const uint32_t* a = addresses.data() + i;
+        uint32_t s[kGroup];
+        for (size_t k = 0; k < kGroup; ++k) s[k] = root[a[k] >> 16];
+        for (unsigned shift : {8u, 0u}) {
+            for (size_t k = 0; k < kGroup; ++k) {
+                bool link = s[k] & kLink;
+                uint32_t next = slots[link ? ((s[k] & ~kLink) << 8) | ((a[k] >> shift) & 0xFF) : 0];
+                s[k] = link ? next : s[k];
+            }
+        }
+        for (size_t k = 0; k < kGroup; ++k) values[i + k] = s[k] - 1;
+    }
+    for (; v4_.slots.empty() && i < n; ++i) values[i] = root[addresses[i] >> 16] - 1;
+    for (; i < n; ++i) values[i] = lookup(addresses[i]).value_or(kNoMatch);
+}
+
+void PrefixTable::lookup_batch(std::span<const IPv6Bytes> addresses, std::span<uint32_t> values) const {
+    constexpr size_t kGroup = 16;
+    const uint32_t* slots = v6_.slots.data();
+    size_t n = std::min(addresses.size(), values.size());
+    size_t i = 0;
+    for (; i + kGroup <= n; i += kGroup) {
+        const IPv6Bytes* a = addresses.data() + i;
+        uint32_t s[kGroup];
+        uint32_t links = 0;  // Bit k: address k still has a level to go
+        for (size_t k = 0; k < kGroup; ++k) {
+            s[k] = v6_.root[(static_cast<size_t>(a[k][0]) << 8) | a[k][1]];
+            links |= (s[k] >> 31) << k;
+        }
+        for (size_t b = 2; links; ++b) {
+            uint32_t next = 0;
+            for (size_t k = 0; k < kGroup; ++k) {
+                if (s[k] & kLink) {
+                    s[k] = slots[(static_cast<size_t>(s[k] & ~kLink) << 8) | a[k][b]];
+                    next |= (s[k] >> 31) << k;
+                }
+            }
+            links = next;
+        }
+        for (size_t k = 0; k < kGroup; ++k) values[i + k] = s[k] - 1;
+    }
+    for (; i < n; ++i) values[i] = lookup(addresses[i]).value_or(kNoMatch);
+}
+
+// ============ Introspection ============
+
+size_t PrefixTable::memory_bytes() const {
+    size_t bytes = 0;
+    for (const Trie* t : {&v4_, &v6_}) {
+        bytes += t->root.capacity() * sizeof(uint32_t) + t->rootLen.capacity();
+        bytes += t->slots.capacity() * sizeof(uint32_t) + t->lens.capacity();
+    }
+    return bytes;
+}
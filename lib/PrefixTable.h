@@ -0,0 +1,186 @@
+#pragma once
+
+#include "IpAddress.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @class PrefixTable
+ * @brief Longest-prefix-match table over IPv4 and IPv6 CIDRs.
+ *
+ * Each family is a multibit trie with a 16-bit root stride followed by
+ * 8-bit strides (16-8-8 for IPv4, 16-8-...-8 for IPv6), with controlled
+ * prefix expansion: every slot holds either the value of the longest prefix
+ * covering it or a link to the next 256-slot chunk. A lookup is therefore
+ * one indexed load per level touched, at most 3 for IPv4, with no
+ * comparisons or backtracking. The 256 KiB root stays in cache; chunks are
+ * only allocated under prefixes longer than /16.
+ *
+ * Inserting a prefix that already exists replaces its value. Lookups are
+ * const and may run concurrently; inserts need exclusive access.
+ *
+ * Example:
+ *   PrefixTable routes;
+ *   routes.insert("10.0.0.0/8", 1);
+ *   routes.insert("10.1.0.0/16", 2);
+ *   routes.lookup(0x0A010203);   // → 2
+ *   routes.lookup(0x0A020304);   // → 1
+ */
+class PrefixTable {
+public:
+    /// IPv6 address in network byte order
+    using IPv6Bytes = std::array<uint8_t, 16>;
+
+    /// Written by lookup_batch() for addresses no prefix covers
+    static constexpr uint32_t kNoMatch = 0xFFFFFFFF;
+
+    /// Largest value that can be stored (values share a slot with chunk links)
+    static constexpr uint32_t kMaxValue = 0x7FFFFFFE;
+
+    // ============ Building ============
+
+    /**
+     * Insert a prefix from CIDR text. A bare address is a host route
+     * (/32 or /128).
+     * Example: insert("192.168.0.0/16", 7), insert("2001:db8::/32", 9)
+     *
+     * @param cidr "address/length" in IPv4 or IPv6 notation
+     * @param value Value returned by lookups this prefix wins (≤ kMaxValue)
+     * @return false if the text is malformed, has host bits set, or value is out of range
+     */
+    bool insert(const std::string& cidr, uint32_t value);
+
+    /**
+     * Insert an IPv4 prefix.
+     *
+     * @param network Network address (host bits must be zero)
+     * @param prefix Prefix length (0-32)
+     * @param value Value for addresses this prefix wins (≤ kMaxValue)
+     * @return false on invalid prefix length, host bits set or value out of range
+     */
+    bool insert_v4(uint32_t network, uint8_t prefix, uint32_t value);
+
+    /**
+     * Insert an IPv6 prefix.
+     *
+     * @param network Network address (host bits must be zero)
+     * @param prefix Prefix length (0-128)
+     * @param value Value for addresses this prefix wins (≤ kMaxValue)
+     * @return false on invalid prefix length, host bits set or value out of range
+     */
+    bool insert_v6(const IPv6Bytes& network, uint8_t prefix, uint32_t value);
+
+    /**
+     * Insert a typed prefix, e.g. insert("10.0.0.0/8"_cidr, 1).
+     *
+     * @param prefix IPv4 prefix (host bits are already clear)
+     * @param value Value for addresses this prefix wins (≤ kMaxValue)
+     * @return false if value is out of range
+     */
+    bool insert(const Prefix& prefix, uint32_t value) {
+        return insert_v4(prefix.network().to_uint32(), static_cast<uint8_t>(prefix.length()), value);
+    }
+
+    /// IPv6 counterpart of insert(const Prefix&, uint32_t)
+    bool insert(const IPv6Prefix& prefix, uint32_t value) {
+        return insert_v6(prefix.network().to_bytes(), static_cast<uint8_t>(prefix.length()), value);
+    }
+
+    /**
+     * Remove every prefix of both families and release the chunks.
+     */
+    void clear();
+
+    // ============ Longest-Prefix Match ============
+
+    /**
+     * Value of the longest IPv4 prefix containing the address.
+     *
+     * @param address IPv4 address (0xC0A80101 for 192.168.1.1)
+     * @return The value, or std::nullopt if no prefix matches
+     */
+    std::optional<uint32_t> lookup(uint32_t address) const {
+        uint32_t slot = v4_.root[address >> 16];
+        if (slot & kLink) {
+            slot = v4_.slots[((slot & ~kLink) << 8) | ((address >> 8) & 0xFF)];
+            if (slot & kLink) slot = v4_.slots[((slot & ~kLink) << 8) | (address & 0xFF)];
+        }
+        if (slot == kEmpty) return std::nullopt;
+        return slot - 1;
+    }
+
+    /**
+     * Value of the longest IPv6 prefix containing the address.
+     *
+     * @param address IPv6 address in network byte order
+     * @return The value, or std::nullopt if no prefix matches
+     */
+    std::optional<uint32_t> lookup(const IPv6Bytes& address) const;
+
+    /**
+     * Value of the longest prefix containing an address given as text.
+     *
+     * @param address IPv4 or IPv6 address string
+     * @return The value, or std::nullopt if malformed or no prefix matches
+     */
+    std::optional<uint32_t> lookup(const std::string& address) const;
+
+    std::optional<uint32_t> lookup(IPv4Address address) const { return lookup(address.to_uint32()); }
+    std::optional<uint32_t> lookup(const IPv6Address& address) const { return lookup(address.to_bytes()); }
+
+    /**
+     * Look up many IPv4 addresses. Slot loads of a group of addresses are
+     * issued together, so cache misses overlap instead of queueing.
+     *
+     * @param addresses IPv4 addresses
+     * @param values Receives the value for each address, or kNoMatch; must be at least as long
+     */
+    void lookup_batch(std::span<const uint32_t> addresses, std::span<uint32_t> values) const;
+
+    /**
+     * Look up many IPv6 addresses.
+     *
+     * @param addresses IPv6 addresses in network byte order
+     * @param values Receives the value for each address, or kNoMatch; must be at least as long
+     */
+    void lookup_batch(std::span<const IPv6Bytes> addresses, std::span<uint32_t> values) const;
+
+    // ============ Introspection ============
+
+    /// Number of distinct IPv4 prefixes inserted
+    size_t size_v4() const { return v4_.prefixes.size(); }
+
+    /// Number of distinct IPv6 prefixes inserted
+    size_t size_v6() const { return v6_.prefixes.size(); }
+
+    /// Bytes held by both tries
+    size_t memory_bytes() const;
+
+private:
+    // Slot encoding: kEmpty, value + 1, or kLink | chunk index
+    static constexpr uint32_t kEmpty = 0;
+    static constexpr uint32_t kLink = 0x80000000;
+
+    struct Trie {
+        std::vector<uint32_t> root;    // 65536 slots: the first 16 bits
+        std::vector<uint8_t> rootLen;  // Prefix length that set each root slot
+        std::vector<uint32_t> slots;   // 256 slots per chunk: one byte each
+        std::vector<uint8_t> lens;
+        std::set<std::pair<IPv6Bytes, uint8_t>> prefixes;  // Distinct (network, length) pairs
+
+        Trie();
+        void insert(const uint8_t* key, unsigned prefix, uint32_t slot);
+        void fill(uint32_t& slot, uint8_t& len, unsigned prefix, uint32_t value);
+        void push_down(uint32_t chunk, unsigned prefix, uint32_t value);
+        uint32_t new_chunk(uint32_t value, uint8_t len);
+    };
+
+    Trie v4_;
+    Trie v6_;
+};
@@ -0,0 +1,178 @@
+#include "PublicSuffixList.h"
+#include "FastNetworkUtils.h"
+
+#include <algorithm>
+#include <istream>
+#include <iterator>
+#include <map>
+#include <utility>
+
+namespace {
+
+constexpr std::string_view kBuiltinList =
+#include "PublicSuffixListData.inc"
+    ;
+
+constexpr std::string_view kPrivateSection = "===BEGIN PRIVATE DOMAINS===";
+
+constexpr size_t kLabelMax = 63;
+
+char to_lower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+// Trie node while rules are added; flattened once the list is read
+struct BuildNode {
+    std::map<std::string, uint32_t, std::less<>> children;
+    uint8_t flags = 0;
+};
+
+} // namespace
+
+PublicSuffixList::PublicSuffixList() : nodes_(1, Node{0, 0, 0, 1, 0}) {}
+
+PublicSuffixList PublicSuffixList::parse(std::string_view text, Sections sections, size_t* rejected) {
+    std::vector<BuildNode> tree(1);
+    size_t rules = 0;
+    size_t bad = 0;
+
+    while (!text.empty()) {
+        size_t eol = std::min(text.find('\n'), text.size());
+        std::string_view line = text.substr(0, eol);
+        text.remove_prefix(std::min(eol + 1, text.size()));
+
+        if (line.starts_with("//")) {
+            if (sections == Sections::IcannOnly && line.find(kPrivateSection) != std::string_view::npos) break;
+            continue;
+        }
+        std::string_view rule = line.substr(0, line.find_first_of(" \t\r"));
+        if (rule.empty()) continue;
+
+        uint8_t flag = kRule;
+        if (rule.front() == '!') {
+            flag = kException;
+            rule.remove_prefix(1);
+        } else if (rule.starts_with("*.")) {
+            flag = kWildcard;
+            rule.remove_prefix(2);
+        }
+        // A wildcard is only allowed as the leftmost label, and not with '!';
+        // an exception needs a parent to become the suffix
+        if (rule.empty() || rule.front() == '.' || rule.back() == '.' || rule.find('*') != std::string_view::npos ||
+            rule.find("..") != std::string_view::npos || (flag == kException && rule.find('.') == std::string_view::npos)) {
+            ++bad;
+            continue;
+        }
+
+        // Walk from the last label, adding nodes as needed
+        uint32_t node = 0;
+        std::string label;
+        bool too_long = false;
+        while (!rule.empty()) {
+            size_t dot = rule.rfind('.');
+            size_t begin = dot == std::string_view::npos ? 0 : dot + 1;
+            if (rule.size() - begin > kLabelMax) {
+                too_long = true;
+                break;
+            }
+            label.clear();
+            std::transform(rule.begin() + static_cast<std::ptrdiff_t>(begin), rule.end(), std::back_inserter(label),
+                           to_lower);
+            rule.remove_suffix(rule.size() - (dot == std::string_view::npos ? 0 : dot));
+            auto it = tree[node].children.find(label);
+            if (it == tree[node].children.end()) {
+                it = tree[node].children.emplace(label, static_cast<uint32_t>(tree.size())).first;
+                tree.emplace_back();
+            }
+            node = it->second;
+        }
+        if (too_long) {
+            ++bad;
+            continue;
+        }
+        if (!(tree[node].flags & flag)) ++rules;
+        tree[node].flags |= flag;
+    }
+
+    // Breadth-first, so each node's children are contiguous, in label order
+    PublicSuffixList list;
+    list.rule_count_ = rules;
+    list.nodes_.reserve(tree.size());
+    std::vector<uint32_t> order = {0};
+    order.reserve(tree.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        const BuildNode& from = tree[order[i]];
+        list.nodes_[i].flags = from.flags;
+        list.nodes_[i].first_child = static_cast<uint32_t>(list.nodes_.size());
+        list.nodes_[i].child_count = static_cast<uint32_t>(from.children.size());
+        for (const auto& [label, child] : from.children) {
+            list.nodes_.push_back({static_cast<uint32_t>(list.labels_.size()), static_cast<uint8_t>(label.size()), 0, 0, 0});
+            list.labels_ += label;
+            order.push_back(child);
+        }
+    }
+
+    if (rejected) *rejected = bad;
+    return list;
+}
+
+PublicSuffixList PublicSuffixList::load(std::istream& in, Sections sections, size_t* rejected) {
+    std::string text(std::istreambuf_iterator<char>(in), {});
+    return parse(text, sections, rejected);
+}
+
+const PublicSuffixList& PublicSuffixList::builtin() {
+    static const PublicSuffixList list = parse(kBuiltinList);
+    return list;
+}
+
+// ============ Lookup ============
+
+PublicSuffixList::Match PublicSuffixList::match(std::string_view host) const {
+    auto labels = FastNetworkUtils::parse_fqdn(host);
+    if (labels.empty()) return {};
+
+    // Rules are stored in lower case; a valid host is at most 253 characters
+    char lower[FastNetworkUtils::kHostnameMax];
+    std::transform(host.begin(), host.end(), lower, to_lower);
+
+    // The implicit "*" rule: an unlisted TLD is a suffix of one label
+    size_t n = labels.size();
+    size_t suffix = 1;
+    const Node* node = nodes_.data();
+    for (size_t depth = 0; depth < n; ++depth) {
+        size_t i = n - 1 - depth;
+        std::string_view label(lower + labels.starts[i], labels[i].size());
+        if (node->flags & kWildcard) suffix = std::max(suffix, depth + 1);
+
+        const Node* first = nodes_.data() + node->first_child;
+        const Node* last = first + node->child_count;
+        const Node* child = std::lower_bound(first, last, label, [this](const Node& a, std::string_view b) {
+            return std::string_view(labels_.data() + a.label, a.length) < b;
+        });
+        if (child == last || std::string_view(labels_.data() + child->label, child->length) != label) break;
+
+        // An exception makes its parent the suffix, whatever else matches
+        if (child->flags & kException) {
+            suffix = depth;
+            break;
+        }
+        if (child->flags & kRule) suffix = std::max(suffix, depth + 1);
+        node = child;
+    }
+
+    Match result;
+    result.suffix = labels.starts[n - suffix];
+    if (suffix < n) result.domain = labels.starts[n - suffix - 1];
+    return result;
+}
+
+std::string_view PublicSuffixList::public_suffix(std::string_view host) const {
+    Match m = match(host);
+    return m.suffix == std::string_view::npos ? std::string_view{} : host.substr(m.suffix);
+}
+
+std::string_view PublicSuffixList::registrable_domain(std::string_view host) const {
+    Match m = match(host);
+    return m.domain == std::string_view::npos ? std::string_view{} : host.substr(m.domain);
+}
+
+size_t PublicSuffixList::memory_bytes() const { return nodes_.capacity() * sizeof(Node) + labels_.capacity(); }
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class PublicSuffixList
+ * @brief Public suffix and registrable domain lookup (https://publicsuffix.org).
+ *
+ * The rules are compiled into a trie over reversed labels ("co.uk" is
+ * uk → co). Nodes live in one flat array in breadth-first order, so the
+ * children of a node are contiguous and sorted, and each step of a lookup
+ * is a binary search among them; labels are stored once in a shared
+ * string. A lookup validates and splits the host with
+ * FastNetworkUtils::parse_fqdn and walks one node per label from the TLD,
+ * without allocating.
+ *
+ * Rules follow the list's algorithm: the longest matching rule wins,
+ * "*.ck" matches any label under ck, "!www.ck" makes www.ck registrable,
+ * and an unlisted TLD is a public suffix of one label.
+ *
+ * Example:
+ *   const auto& psl = PublicSuffixList::builtin();
+ *   psl.registrable_domain("eu.lobby.game.co.uk");   // "game.co.uk"
+ *   psl.public_suffix("eu.lobby.game.co.uk");        // "co.uk"
+ */
+class PublicSuffixList {
+public:
+    /// Which parts of the list to use
+    enum class Sections {
+        All,        ///< ICANN and private (hosting platform) rules
+        IcannOnly,  ///< Stop at "===BEGIN PRIVATE DOMAINS==="
+    };
+
+    /**
+     * Empty list: every TLD is a public suffix of one label.
+     */
+    PublicSuffixList();
+
+    /**
+     * Compile rules in the list's file format: one rule per line, the rule
+     * ends at the first whitespace, "//" starts a comment line. Labels are
+     * matched case-insensitively; hosts are plain LDH names, so IDN rules
+     * only match when written as A-labels (xn--).
+     *
+     * @param text List text
+     * @param sections Which sections to use
+     * @param rejected If not null, receives the number of malformed rules
+     * @return The compiled list
+     */
+    static PublicSuffixList parse(std::string_view text, Sections sections = Sections::All,
+                                  size_t* rejected = nullptr);
+
+    /**
+     * Compile a list file, e.g. a downloaded public_suffix_list.dat.
+     *
+     * @param in Text stream
+     * @param sections Which sections to use
+     * @param rejected If not null, receives the number of malformed rules
+     * @return The compiled list
+     */
+    static PublicSuffixList load(std::istream& in, Sections sections = Sections::All, size_t* rejected = nullptr);
+
+    /**
+     * The list built into the library (PublicSuffixListData.inc), compiled
+     * on first use.
+     *
+     * @return Shared instance
+     */
+    static const PublicSuffixList& builtin();
+
+    // ============ Lookup ============
+
+    /**
+     * Public suffix of a host.
+     * Example: "www.example.co.uk" → "co.uk", "a.b.c.kobe.jp" → "c.kobe.jp" (rule *.kobe.jp)
+     *
+     * @param host Hostname (no trailing dot)
+     * @return View into host, or empty if the host is not a valid hostname
+     */
+    std::string_view public_suffix(std::string_view host) const;
+
+    /**
+     * Registrable domain: the public suffix plus one label.
+     * Example: "www.example.co.uk" → "example.co.uk", "co.uk" → ""
+     *
+     * @param host Hostname (no trailing dot)
+     * @return View into host, or empty if the host is invalid or is itself
+     *         a public suffix
+     */
+    std::string_view registrable_domain(std::string_view host) const;
+
+    /// Number of rules compiled
+    size_t rule_count() const { return rule_count_; }
+
+    /// Bytes held by the trie
+    size_t memory_bytes() const;
+
+private:
+    static constexpr uint8_t kRule = 1;       // The path to this node is a rule
+    static constexpr uint8_t kWildcard = 2;   // "*." followed by the path is a rule
+    static constexpr uint8_t kException = 4;  // "!" followed by the path is a rule
+
+    struct Node {
+        uint32_t label;        // Offset of the label in labels_
+        uint8_t length;        // Label length
+        uint8_t flags;         // kRule | kWildcard | kException
+        uint32_t first_child;  // Children are nodes_[first_child, first_child + child_count)
+        uint32_t child_count;
+    };
+
+    // Where the public suffix and the registrable domain start in a host;
+    // npos if the host is invalid or has no registrable domain
+    struct Match {
+        size_t suffix = std::string_view::npos;
+        size_t domain = std::string_view::npos;
+    };
+
+    Match match(std::string_view host) const;
+
+    std::vector<Node> nodes_;  // nodes_[0] is the root (the empty label)
+    std::string labels_;
+    size_t rule_count_ = 0;
+};
@@ -0,0 +1,153 @@
+#include "SubnetAllocator.h"
+#include "FastNetworkUtils.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// Number of addresses in a block; 64-bit so the /0 block fits
+uint64_t block_size(unsigned length) { return uint64_t{1} << (IPv4Address::kBits - length); }
+
+// The lower half of a block of this length keeps the block's network, the
+// upper half adds this bit
+uint32_t upper_half_bit(unsigned length) { return 1u << (IPv4Address::kBits - 1 - length); }
+
+std::string_view trim(std::string_view s) {
+    constexpr std::string_view kSpace = " \t\r\n";
+    size_t begin = s.find_first_not_of(kSpace);
+    if (begin == std::string_view::npos) return {};
+    return s.substr(begin, s.find_last_not_of(kSpace) - begin + 1);
+}
+
+void write_prefix(std::ostream& out, uint32_t network, unsigned length) {
+    out << FastNetworkUtils::uint32_to_ipv4(network).view() << '/' << length << '\n';
+}
+
+} // namespace
+
+SubnetAllocator::SubnetAllocator(const Prefix& pool) : pool_(pool), free_addresses_(block_size(pool.length())) {
+    free_[pool.length()].insert(pool.network().to_uint32());
+}
+
+// ============ Allocation ============
+
+std::optional<Prefix> SubnetAllocator::allocate(unsigned length) {
+    if (length < pool_.length() || length > IPv4Address::kBits) return std::nullopt;
+
+    // Smallest free block that is large enough
+    unsigned level = length;
+    while (free_[level].empty()) {
+        if (level == pool_.length()) return std::nullopt;
+        --level;
+    }
+    uint32_t network = *free_[level].begin();
+    free_[level].erase(free_[level].begin());
+
+    // Keep the lower half of each split, free the upper one
+    for (; level < length; ++level) free_[level + 1].insert(network | upper_half_bit(level));
+
+    allocated_.emplace(network, static_cast<uint8_t>(length));
+    free_addresses_ -= block_size(length);
+    return Prefix(IPv4Address(network), length);
+}
+
+bool SubnetAllocator::reserve(const Prefix& prefix) {
+    if (!pool_.contains(prefix)) return false;
+    uint32_t target = prefix.network().to_uint32();
+
+    // The free block holding the prefix, if any; it is at most as long
+    unsigned level = prefix.length();
+    std::set<uint32_t>::iterator it;
+    while ((it = free_[level].find(target & IPv4Address::mask(level).to_uint32())) == free_[level].end()) {
+        if (level == pool_.length()) return false;
+        --level;
+    }
+    uint32_t network = *it;
+    free_[level].erase(it);
+
+    // Split towards the prefix, freeing the half that does not hold it
+    for (; level < prefix.length(); ++level) {
+        uint32_t half = upper_half_bit(level);
+        free_[level + 1].insert((network | half) ^ (target & half));
+        network |= target & half;
+    }
+
+    allocated_.emplace(network, static_cast<uint8_t>(prefix.length()));
+    free_addresses_ -= block_size(prefix.length());
+    return true;
+}
+
+bool SubnetAllocator::release(const Prefix& prefix) {
+    uint32_t network = prefix.network().to_uint32();
+    auto it = allocated_.find(network);
+    if (it == allocated_.end() || it->second != prefix.length()) return false;
+    allocated_.erase(it);
+    free_addresses_ += block_size(prefix.length());
+
+    // Merge upwards while the buddy is free as a whole
+    unsigned level = prefix.length();
+    while (level > pool_.length()) {
+        uint32_t half = upper_half_bit(level - 1);
+        auto buddy = free_[level].find(network ^ half);
+        if (buddy == free_[level].end()) break;
+        free_[level].erase(buddy);
+        network &= ~half;
+        --level;
+    }
+    free_[level].insert(network);
+    return true;
+}
+
+// ============ State ============
+
+bool SubnetAllocator::is_allocated(const Prefix& prefix) const {
+    auto it = allocated_.find(prefix.network().to_uint32());
+    return it != allocated_.end() && it->second == prefix.length();
+}
+
+std::vector<Prefix> SubnetAllocator::allocations() const {
+    std::vector<Prefix> result;
+    result.reserve(allocated_.size());
+    for (auto [network, length] : allocated_) result.emplace_back(IPv4Address(network), length);
+    return result;
+}
+
+std::optional<unsigned> SubnetAllocator::largest_free_length() const {
+    for (unsigned level = pool_.length(); level < kLevels; ++level) {
+        if (!free_[level].empty()) return level;
+    }
+    return std::nullopt;
+}
+
+double SubnetAllocator::fragmentation() const {
+    auto largest = largest_free_length();
+    if (!largest) return 0.0;
+    return 1.0 - static_cast<double>(block_size(*largest)) / static_cast<double>(free_addresses_);
+}
+
+// ============ Serialization ============
+
+void SubnetAllocator::write(std::ostream& out) const {
+    write_prefix(out, pool_.network().to_uint32(), pool_.length());
+    for (auto [network, length] : allocated_) write_prefix(out, network, length);
+}
+
+std::optional<SubnetAllocator> SubnetAllocator::read(std::istream& in) {
+    std::optional<SubnetAllocator> result;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string_view text = trim(line);
+        if (text.empty() || text.front() == '#') continue;
+        auto prefix = Prefix::parse(text);
+        if (!prefix) return std::nullopt;
+        if (!result) {
+            result.emplace(*prefix);
+        } else if (!result->reserve(*prefix)) {
+            return std::nullopt;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "IpAddress.h"
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+/**
+ * @class SubnetAllocator
+ * @brief Buddy allocator handing out aligned sub-prefixes of an IPv4 pool.
+ *
+ * Free space is kept as one ordered list of free blocks per prefix length.
+ * allocate() takes the lowest free block of the smallest size that fits and
+ * splits it in halves down to the requested length; release() merges a block
+ * with its buddy (the other half of its parent) for as long as the buddy is
+ * free. Both are O(32 log n) for n free blocks, and results depend only on
+ * the sequence of calls, so replaying a log gives the same allocations.
+ *
+ * Because free blocks are merged eagerly, the allocations alone determine
+ * the free lists; write() saves just the pool and the allocations, and
+ * read() rebuilds the same state.
+ *
+ * Example:
+ *   SubnetAllocator pool("10.20.0.0/16"_cidr);
+ *   auto fleet = pool.allocate(26);      // 10.20.0.0/26
+ *   auto match = pool.allocate(28);      // 10.20.0.64/28
+ *   pool.release(*fleet);
+ */
+class SubnetAllocator {
+public:
+    /**
+     * Allocator with the whole pool free.
+     *
+     * @param pool Parent prefix to carve
+     */
+    explicit SubnetAllocator(const Prefix& pool);
+
+    // ============ Allocation ============
+
+    /**
+     * Allocate a block of the given prefix length, at the lowest address
+     * among the smallest free blocks that can hold it.
+     * Example: in a fresh 10.0.0.0/24, allocate(26) → 10.0.0.0/26
+     *
+     * @param length Prefix length, from the pool's length to 32
+     * @return The block, or std::nullopt if no free block is large enough
+     */
+    std::optional<Prefix> allocate(unsigned length);
+
+    /**
+     * Allocate a specific block, e.g. one assigned outside the allocator.
+     *
+     * @param prefix Block inside the pool
+     * @return false if any of its addresses is already allocated
+     */
+    bool reserve(const Prefix& prefix);
+
+    /**
+     * Free an allocated block and merge it with free buddies.
+     *
+     * @param prefix A block returned by allocate() or passed to reserve()
+     * @return false if the prefix is not an allocated block
+     */
+    bool release(const Prefix& prefix);
+
+    // ============ State ============
+
+    const Prefix& pool() const { return pool_; }
+
+    /// Check if exactly this block is allocated
+    bool is_allocated(const Prefix& prefix) const;
+
+    /// Allocated blocks, in address order
+    std::vector<Prefix> allocations() const;
+
+    size_t allocation_count() const { return allocated_.size(); }
+
+    /// Number of addresses not in any allocated block
+    uint64_t free_addresses() const { return free_addresses_; }
+
+    /**
+     * Length of the largest free block: the shortest prefix allocate() can
+     * still satisfy.
+     *
+     * @return Prefix length, or std::nullopt if the pool is full
+     */
+    std::optional<unsigned> largest_free_length() const;
+
+    /**
+     * External fragmentation: the share of free addresses that are not in
+     * the largest free block, 1 - largest / free.
+     * Example: a fresh pool → 0.0; free /25 and /26 only → 1/3
+     *
+     * @return Value in [0, 1); 0 when nothing or everything is free
+     */
+    double fragmentation() const;
+
+    // ============ Serialization ============
+
+    /**
+     * Write the pool on the first line, then one allocated block per line.
+     *
+     * @param out Text stream
+     */
+    void write(std::ostream& out) const;
+
+    /**
+     * Rebuild an allocator from the output of write(). Blank lines and lines
+     * starting with '#' are skipped.
+     *
+     * @param in Text stream
+     * @return The allocator, or std::nullopt if a line is malformed or a
+     *         block is outside the pool or overlaps another
+     */
+    static std::optional<SubnetAllocator> read(std::istream& in);
+
+private:
+    static constexpr unsigned kLevels = IPv4Address::kBits + 1;
+
+    Prefix pool_;
+    // Network addresses of the free blocks, by prefix length
+    std::array<std::set<uint32_t>, kLevels> free_;
+    // Network address → prefix length of each allocated block
+    std::map<uint32_t, uint8_t> allocated_;
+    uint64_t free_addresses_;
+};
@@ -0,0 +1,298 @@
+/**
+ * Reader throughput benchmark: stream vs memory-mapped vs prefetch
+ * IFileReaderDevice, per-packet Packet parsing vs classifyBatch, compiled
+ * PacketFilter vs hand-written Packet checks, reader -> IFileWriterDevice
+ * piping, columnar export and column scans vs re-parsing, throughput time
+ * series aggregation, two-way merge with deduplication, and
+ * pcap::analyzeParallel scaling with thread count.
+ *
+ * Usage: 01-pcap-bench [capture file] [passes]
+ * Defaults to the course capture extracted into data/.
+ */
+#include <PcapAnalyzer.h>
+#include <PcapClassify.h>
+#include <PcapColumnar.h>
+#include <PcapFilter.h>
+#include <PcapMerge.h>
+#include <PcapTimeSeries.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Result {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t checksum = 0;  // Keeps the compiler from discarding the reads
+    double seconds = 0;
+};
+
+// pcpp::Packet takes a pointer for owned packets and a reference for views
+pcpp::Packet parse(const pcpp::RawPacket& packet) { return pcpp::Packet(&packet); }
+pcpp::Packet parse(const pcpp::RawPacketView& view) { return pcpp::Packet(view); }
+
+template<typename PacketT>
+Result run(const std::string& file, pcpp::ReadMode mode, int passes) {
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(file, mode));
+        if (!reader || !reader->open()) return result;
+
+        PacketT packet;
+        while (reader->getNextPacket(packet)) {
+            pcpp::Packet parsed = parse(packet);
+            ++result.packets;
+            result.bytes += packet.getDataLen();
+            result.checksum += parsed.isPacketOfType(pcpp::TCP) ? 1 : 0;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Memory-mapped views stay valid until close(), so a whole batch can be
+// gathered before classifying it
+Result runBatched(const std::string& file, int passes, pcpp::SimdLevel level) {
+    constexpr size_t kBatch = 1024;
+    Result result;
+    std::vector<pcpp::RawPacketView> batch(kBatch);
+    std::vector<pcpp::ProtocolMask> masks(kBatch);
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(
+            pcpp::IFileReaderDevice::getReader(file, pcpp::ReadMode::MemoryMapped));
+        if (!reader || !reader->open() || reader->getReadMode() != pcpp::ReadMode::MemoryMapped) return result;
+
+        size_t count = 0;
+        do {
+            count = 0;
+            while (count < kBatch && reader->getNextPacket(batch[count])) {
+                result.bytes += batch[count].length;
+                ++count;
+            }
+            pcpp::classifyBatch(std::span<const pcpp::RawPacketView>(batch.data(), count),
+                                std::span<pcpp::ProtocolMask>(masks.data(), count), level);
+            for (size_t i = 0; i < count; ++i) result.checksum += (masks[i] & pcpp::MaskTCP) ? 1 : 0;
+            result.packets += count;
+        } while (count == kBatch);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Count TCP packets on port 80, either through a compiled filter in the
+// reader loop or by building a Packet for every record
+Result runFilter(const std::string& file, int passes, bool compiled) {
+    Result result;
+    auto filter = pcpp::PacketFilter::compile("tcp port 80");
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(
+            pcpp::IFileReaderDevice::getReader(file, pcpp::ReadMode::MemoryMapped));
+        if (!reader || !reader->open()) return result;
+        if (compiled) reader->setFilter(*filter);
+
+        pcpp::RawPacketView view;
+        while (reader->getNextPacket(view)) {
+            if (!compiled) {
+                pcpp::Packet packet(view);
+                const auto* tcp = packet.getLayerOfType<pcpp::TCPView>();
+                if (!tcp || (tcp->srcPort() != 80 && tcp->dstPort() != 80)) continue;
+            }
+            ++result.packets;
+            result.bytes += view.length;
+            result.checksum += 1;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Copy every packet (or only TCP) from `file` into a temporary capture
+Result runPipe(const std::string& file, int passes, pcpp::CaptureFormat format, bool tcpOnly) {
+    Result result;
+    std::string out = (std::filesystem::temp_directory_path() / "gg-network-bench-out").string();
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(
+            pcpp::IFileReaderDevice::getReader(file, pcpp::ReadMode::MemoryMapped));
+        if (!reader || !reader->open()) return result;
+
+        pcpp::WriterOptions options;
+        options.format = format;
+        std::unique_ptr<pcpp::IFileWriterDevice> writer(pcpp::IFileWriterDevice::getWriter(out, options));
+        if (!writer || !writer->open()) return result;
+
+        pcpp::RawPacketView view;
+        while (reader->getNextPacket(view)) {
+            if (tcpOnly && !pcpp::Packet(view).isPacketOfType(pcpp::TCP)) continue;
+            if (!writer->writePacket(view)) continue;
+            ++result.packets;
+            result.bytes += view.length;
+        }
+        writer->close();
+        result.checksum += writer->getPacketsWritten();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::remove(out.c_str());
+    return result;
+}
+
+// Export the capture to a columnar file once per pass
+Result runExport(const std::string& file, const std::string& out, int passes) {
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        auto rows = pcpp::exportColumnar(file, out);
+        if (!rows) return result;
+        result.packets += *rows;
+        result.checksum += *rows;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.bytes = std::filesystem::file_size(out) * static_cast<uint64_t>(passes);
+    return result;
+}
+
+// TCP packets on port 80 (as runFilter), from four columns of the export
+Result runColumnScan(const std::string& columnar, int passes) {
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        pcpp::ColumnarReader reader;
+        if (!reader.open(columnar)) return result;
+        auto columns = pcpp::columnBit(pcpp::Column::L4Protocol) | pcpp::columnBit(pcpp::Column::SrcPort) |
+                       pcpp::columnBit(pcpp::Column::DstPort) | pcpp::columnBit(pcpp::Column::Length);
+        reader.scan(columns, [&](const pcpp::ColumnBatch& batch) {
+            for (size_t i = 0; i < batch.rows; ++i) {
+                bool match = batch.l4Protocol[i] == 6 && (batch.srcPort[i] == 80 || batch.dstPort[i] == 80);
+                result.packets += match;
+                result.bytes += match ? batch.length[i] : 0;
+            }
+            result.checksum += batch.rows;
+        });
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// 1 ms / 100 ms / 1 s throughput series over batches of mapped views
+Result runTimeSeries(const std::string& file, int passes) {
+    constexpr size_t kBatch = 1024;
+    Result result;
+    std::vector<pcpp::RawPacketView> batch(kBatch);
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(
+            pcpp::IFileReaderDevice::getReader(file, pcpp::ReadMode::MemoryMapped));
+        if (!reader || !reader->open() || reader->getReadMode() != pcpp::ReadMode::MemoryMapped) return result;
+
+        pcpp::ThroughputAggregator aggregator([&](const pcpp::ThroughputBucket& bucket) {
+            result.checksum += bucket.packets[pcpp::seriesIndex(pcpp::TCP)];
+        });
+        size_t count = 0;
+        do {
+            count = 0;
+            while (count < kBatch && reader->getNextPacket(batch[count])) {
+                result.bytes += batch[count].length;
+                ++count;
+            }
+            aggregator.addBatch(std::span<const pcpp::RawPacketView>(batch.data(), count));
+            result.packets += count;
+        } while (count == kBatch);
+        aggregator.flush();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Merge the capture with itself; with dedup every second copy is dropped
+Result runMerge(const std::string& file, int passes, bool dedup) {
+    Result result;
+    pcpp::CaptureMerger::Options options;
+    options.dropDuplicates = dedup;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        pcpp::CaptureMerger merger;
+        if (!merger.open({file, file}, options)) return result;
+        pcpp::RawPacketView view;
+        while (merger.getNextPacket(view)) result.bytes += view.length;
+        result.packets += merger.stats().packetsRead;
+        result.checksum += merger.stats().packetsMerged;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void report(const char* name, const Result& r) {
+    double mpps = r.seconds > 0 ? r.packets / r.seconds / 1e6 : 0;
+    double mbps = r.seconds > 0 ? r.bytes / r.seconds / 1e6 : 0;
+    std::cout << name << ": " << r.packets << " packets in " << r.seconds << " s ("
+              << mpps << " Mpkt/s, " << mbps << " MB/s, tcp=" << r.checksum << ")" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string file = argc > 1 ? argv[1] : "data/The Ultimate PCAP v20251206.pcapng";
+    int passes = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    std::cout << "Benchmarking " << file << " (" << passes << " passes)" << std::endl;
+
+    report("stream  RawPacket    ", run<pcpp::RawPacket>(file, pcpp::ReadMode::Stream, passes));
+    report("mmap    RawPacket    ", run<pcpp::RawPacket>(file, pcpp::ReadMode::MemoryMapped, passes));
+    report("stream  RawPacketView", run<pcpp::RawPacketView>(file, pcpp::ReadMode::Stream, passes));
+    report("mmap    RawPacketView", run<pcpp::RawPacketView>(file, pcpp::ReadMode::MemoryMapped, passes));
+    report("prefetch RawPacket    ", run<pcpp::RawPacket>(file, pcpp::ReadMode::Prefetch, passes));
+    report("prefetch RawPacketView", run<pcpp::RawPacketView>(file, pcpp::ReadMode::Prefetch, passes));
+    report("batch   scalar       ", runBatched(file, passes, pcpp::SimdLevel::Scalar));
+    report("batch   sse2         ", runBatched(file, passes, pcpp::SimdLevel::SSE2));
+    report("batch   avx2         ", runBatched(file, passes, pcpp::SimdLevel::AVX2));
+    report("filter  Packet       ", runFilter(file, passes, false));
+    report("filter  compiled     ", runFilter(file, passes, true));
+    report("write   pcap         ", runPipe(file, passes, pcpp::CaptureFormat::Pcap, false));
+    report("write   pcapng       ", runPipe(file, passes, pcpp::CaptureFormat::PcapNG, false));
+    report("write   pcapng tcp   ", runPipe(file, passes, pcpp::CaptureFormat::PcapNG, true));
+
+    std::string columnar = (std::filesystem::temp_directory_path() / "gg-network-bench.pcol").string();
+    report("columnar export      ", runExport(file, columnar, passes));
+    report("columnar scan        ", runColumnScan(columnar, passes));
+    std::remove(columnar.c_str());
+
+    report("time series          ", runTimeSeries(file, passes));
+    report("merge   x2           ", runMerge(file, passes, false));
+    report("merge   x2 dedup     ", runMerge(file, passes, true));
+
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    for (unsigned threads : threadCounts) {
+        Result r;
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            pcpp::ProtocolStats stats;
+            pcpp::ParallelOptions options;
+            options.threads = threads;
+            pcpp::analyzeParallel(file, stats, options);
+            r.packets += stats.totalPackets;
+            r.bytes += stats.totalBytes;
+            r.checksum += stats.tcp;
+        }
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::string name = "parallel x" + std::to_string(threads);
+        name.resize(21, ' ');
+        report(name.c_str(), r);
+    }
+
+    return 0;
+}
@@ -0,0 +1,254 @@
+/**
+ * Synthetic capture builder for the library tests.
+ *
+ * Writes small PCAP/PCAPNG files with hand-made frames so the reader,
+ * parser and analysis code can be tested without the course capture.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace capture_builder {
+
+struct Record {
+    std::vector<uint8_t> frame;
+    uint32_t sec = 0;
+    uint32_t usec = 0;
+};
+
+inline void put16be(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+inline void put32be(std::vector<uint8_t>& out, uint32_t v) {
+    put16be(out, static_cast<uint16_t>(v >> 16));
+    put16be(out, static_cast<uint16_t>(v));
+}
+
+inline void put16le(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+inline void put32le(std::vector<uint8_t>& out, uint32_t v) {
+    put16le(out, static_cast<uint16_t>(v));
+    put16le(out, static_cast<uint16_t>(v >> 16));
+}
+
+// Ethernet II header with the given EtherType
+inline std::vector<uint8_t> ethernet(uint16_t etherType) {
+    std::vector<uint8_t> f = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB};
+    put16be(f, etherType);
+    return f;
+}
+
+// IPv4 header (no options) followed by `l4`, wrapped in Ethernet
+inline std::vector<uint8_t> ipv4(uint32_t src, uint32_t dst, uint8_t protocol,
+                                 const std::vector<uint8_t>& l4, uint8_t ttl = 64) {
+    std::vector<uint8_t> f = ethernet(0x0800);
+    f.push_back(0x45);
+    f.push_back(0x00);
+    put16be(f, static_cast<uint16_t>(20 + l4.size()));
+    put16be(f, 0x1234);  // Identification
+    put16be(f, 0x4000);  // Don't fragment
+    f.push_back(ttl);
+    f.push_back(protocol);
+    put16be(f, 0);       // Checksum (not verified by the reader)
+    put32be(f, src);
+    put32be(f, dst);
+    f.insert(f.end(), l4.begin(), l4.end());
+    return f;
+}
+
+// IPv6 header followed by `l4`, wrapped in Ethernet. Addresses are 16 bytes.
+inline std::vector<uint8_t> ipv6(const std::vector<uint8_t>& src, const std::vector<uint8_t>& dst,
+                                 uint8_t nextHeader, const std::vector<uint8_t>& l4, uint8_t hopLimit = 64) {
+    std::vector<uint8_t> f = ethernet(0x86DD);
+    put32be(f, 0x60000000);
+    put16be(f, static_cast<uint16_t>(l4.size()));
+    f.push_back(nextHeader);
+    f.push_back(hopLimit);
+    f.insert(f.end(), src.begin(), src.end());
+    f.insert(f.end(), dst.begin(), dst.end());
+    f.insert(f.end(), l4.begin(), l4.end());
+    return f;
+}
+
+inline std::vector<uint8_t> udp(uint16_t sport, uint16_t dport, size_t payloadLen) {
+    std::vector<uint8_t> h;
+    put16be(h, sport);
+    put16be(h, dport);
+    put16be(h, static_cast<uint16_t>(8 + payloadLen));
+    put16be(h, 0);
+    h.resize(8 + payloadLen, 0xAB);
+    return h;
+}
+
+inline std::vector<uint8_t> tcp(uint16_t sport, uint16_t dport, uint32_t seq, uint32_t ack,
+                                uint8_t flags, size_t payloadLen = 0, uint16_t window = 65535) {
+    std::vector<uint8_t> h;
+    put16be(h, sport);
+    put16be(h, dport);
+    put32be(h, seq);
+    put32be(h, ack);
+    h.push_back(0x50);  // Data offset: 5 words
+    h.push_back(flags);
+    put16be(h, window);
+    put16be(h, 0);      // Checksum
+    put16be(h, 0);      // Urgent pointer
+    h.resize(20 + payloadLen, 0xCD);
+    return h;
+}
+
+inline std::vector<uint8_t> arp() {
+    std::vector<uint8_t> f = ethernet(0x0806);
+    f.resize(14 + 28, 0);
+    return f;
+}
+
+inline std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("gg-network-" + name)).string();
+}
+
+// Classic PCAP, little-endian, microsecond timestamps
+inline void writePcap(const std::string& path, const std::vector<Record>& records, uint32_t linkType = 1) {
+    std::vector<uint8_t> out;
+    put32le(out, 0xA1B2C3D4);
+    put16le(out, 2);
+    put16le(out, 4);
+    put32le(out, 0);
+    put32le(out, 0);
+    put32le(out, 65535);
+    put32le(out, linkType);
+    for (const auto& r : records) {
+        put32le(out, r.sec);
+        put32le(out, r.usec);
+        put32le(out, static_cast<uint32_t>(r.frame.size()));
+        put32le(out, static_cast<uint32_t>(r.frame.size()));
+        out.insert(out.end(), r.frame.begin(), r.frame.end());
+    }
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(out.data()),
+                                                static_cast<std::streamsize>(out.size()));
+}
+
+inline void padTo4(std::vector<uint8_t>& out) {
+    while (out.size() % 4) out.push_back(0);
+}
+
+inline void appendBlock(std::vector<uint8_t>& out, uint32_t type, const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> padded = body;
+    padTo4(padded);
+    uint32_t len = static_cast<uint32_t>(12 + padded.size());
+    put32le(out, type);
+    put32le(out, len);
+    out.insert(out.end(), padded.begin(), padded.end());
+    put32le(out, len);
+}
+
+inline void appendSectionHeader(std::vector<uint8_t>& out) {
+    std::vector<uint8_t> shb;
+    put32le(shb, 0x1A2B3C4D);
+    put16le(shb, 1);
+    put16le(shb, 0);
+    put32le(shb, 0xFFFFFFFF);  // Section length: unknown
+    put32le(shb, 0xFFFFFFFF);
+    appendBlock(out, 0x0A0D0D0A, shb);
+}
+
+inline void appendOption(std::vector<uint8_t>& out, uint16_t code, const std::vector<uint8_t>& value) {
+    put16le(out, code);
+    put16le(out, static_cast<uint16_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+    padTo4(out);
+}
+
+// IDB; tsresol is written as an if_tsresol option unless it is the default (6)
+inline void appendInterface(std::vector<uint8_t>& out, uint16_t linkType, uint32_t snapLen = 65535,
+                            uint8_t tsresol = 6) {
+    std::vector<uint8_t> idb;
+    put16le(idb, linkType);
+    put16le(idb, 0);
+    put32le(idb, snapLen);
+    if (tsresol != 6) {
+        appendOption(idb, 9, {tsresol});
+        appendOption(idb, 0, {});
+    }
+    appendBlock(out, 0x00000001, idb);
+}
+
+// Enhanced Packet Block with a raw timestamp in interface ticks
+inline void appendEnhancedPacket(std::vector<uint8_t>& out, uint32_t interfaceId, uint64_t ticks,
+                                 const std::vector<uint8_t>& frame) {
+    std::vector<uint8_t> epb;
+    put32le(epb, interfaceId);
+    put32le(epb, static_cast<uint32_t>(ticks >> 32));
+    put32le(epb, static_cast<uint32_t>(ticks));
+    put32le(epb, static_cast<uint32_t>(frame.size()));
+    put32le(epb, static_cast<uint32_t>(frame.size()));
+    epb.insert(epb.end(), frame.begin(), frame.end());
+    appendBlock(out, 0x00000006, epb);
+}
+
+// Enhanced Packet Block with a microsecond timestamp
+inline void appendEnhancedPacket(std::vector<uint8_t>& out, uint32_t interfaceId, const Record& r) {
+    appendEnhancedPacket(out, interfaceId, static_cast<uint64_t>(r.sec) * 1000000ULL + r.usec, r.frame);
+}
+
+inline void appendSimplePacket(std::vector<uint8_t>& out, const std::vector<uint8_t>& frame) {
+    std::vector<uint8_t> spb;
+    put32le(spb, static_cast<uint32_t>(frame.size()));
+    spb.insert(spb.end(), frame.begin(), frame.end());
+    appendBlock(out, 0x00000003, spb);
+}
+
+inline void appendInterfaceStatistics(std::vector<uint8_t>& out, uint32_t interfaceId,
+                                      uint64_t received, uint64_t dropped) {
+    std::vector<uint8_t> isb;
+    put32le(isb, interfaceId);
+    put32le(isb, 0);
+    put32le(isb, 0);
+    std::vector<uint8_t> value;
+    put32le(value, static_cast<uint32_t>(received));
+    put32le(value, static_cast<uint32_t>(received >> 32));
+    appendOption(isb, 4, value);
+    value.clear();
+    put32le(value, static_cast<uint32_t>(dropped));
+    put32le(value, static_cast<uint32_t>(dropped >> 32));
+    appendOption(isb, 5, value);
+    appendOption(isb, 0, {});
+    appendBlock(out, 0x00000005, isb);
+}
+
+inline void writeBytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()),
+                                                static_cast<std::streamsize>(bytes.size()));
+}
+
+// Single-section PCAPNG: SHB, one IDB, then one EPB per record
+inline void writePcapNG(const std::string& path, const std::vector<Record>& records, uint16_t linkType = 1) {
+    std::vector<uint8_t> out;
+    appendSectionHeader(out);
+    appendInterface(out, linkType);
+    for (const auto& r : records) {
+        appendEnhancedPacket(out, 0, r);
+    }
+    writeBytes(path, out);
+}
+
+// A small mixed capture: UDP, TCP, ARP and odd-length frames to exercise padding
+inline std::vector<Record> sampleRecords() {
+    std::vector<Record> records;
+    records.push_back({ipv4(0x0A000001, 0x0A000002, 17, udp(5000, 9999, 13)), 100, 1});
+    records.push_back({ipv4(0x0A000002, 0x0A000001, 6, tcp(80, 40000, 1, 0, 0x12)), 100, 250});
+    records.push_back({arp(), 101, 0});
+    records.push_back({ipv4(0xC0A80001, 0x08080808, 17, udp(53, 53, 3)), 102, 999999});
+    return records;
+}
+
+} // namespace capture_builder
@@ -0,0 +1,215 @@
+/**
+ * Tests for CaptureIndex sidecars and IFileReaderDevice::seekToPacket() /
+ * seekToTime() on classic PCAP and multi-section, multi-interface PCAPNG,
+ * in every read mode.
+ */
+#include <doctest/doctest.h>
+#include <PcapReader.h>
+
+#include "capture_builder.h"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+constexpr uint32_t kPackets = 1000;
+
+// Packet i is a UDP datagram from port i, stamped at 1000 s + i * 10 ms
+Record numbered(uint32_t i) {
+    uint64_t usec = 1'000'000'000ull + uint64_t{i} * 10'000;
+    return {ipv4(0x0A000001, 0x0A000002, 17, udp(static_cast<uint16_t>(i), 9, i % 7)),
+            static_cast<uint32_t>(usec / 1'000'000), static_cast<uint32_t>(usec % 1'000'000)};
+}
+
+uint16_t packetId(const pcpp::RawPacket& raw) {
+    pcpp::Packet packet(&raw);
+    const auto* udp = packet.getLayerOfType<pcpp::UDPView>();
+    return udp ? udp->srcPort() : 0xFFFF;
+}
+
+std::string writeNumberedPcap() {
+    std::vector<Record> records;
+    for (uint32_t i = 0; i < kPackets; ++i) records.push_back(numbered(i));
+    std::string path = tempPath("index.pcap");
+    writePcap(path, records);
+    return path;
+}
+
+// Two sections. The first has a nanosecond interface added mid-section and
+// packets alternate between interfaces; the second restarts with one
+// microsecond interface. Seeking must rebuild the right interface table.
+std::string writeNumberedPcapNG() {
+    std::vector<uint8_t> out;
+    appendSectionHeader(out);
+    appendInterface(out, 1);
+    for (uint32_t i = 0; i < kPackets; ++i) {
+        Record r = numbered(i);
+        if (i == 100) appendInterface(out, 1, 65535, 9);
+        if (i == 600) {
+            appendSectionHeader(out);
+            appendInterface(out, 1);
+        }
+        if (i % 50 == 0) appendInterfaceStatistics(out, 0, i, 0);
+        uint64_t usec = uint64_t{r.sec} * 1'000'000 + r.usec;
+        if (i > 100 && i < 600 && i % 2) {
+            appendEnhancedPacket(out, 1, usec * 1000, r.frame);
+        } else {
+            appendEnhancedPacket(out, 0, usec, r.frame);
+        }
+    }
+    std::string path = tempPath("index.pcapng");
+    writeBytes(path, out);
+    return path;
+}
+
+void checkSeeks(pcpp::IFileReaderDevice& reader) {
+    std::mt19937 rng(11);
+    pcpp::RawPacket raw;
+    for (int n = 0; n < 200; ++n) {
+        uint32_t target = rng() % kPackets;
+        REQUIRE(reader.seekToPacket(target));
+        CHECK(reader.getRecordIndex() == target);
+        REQUIRE(reader.getNextPacket(raw));
+        CHECK(packetId(raw) == target);
+        Record expected = numbered(target);
+        CHECK(raw.timestamp_sec == expected.sec);
+        CHECK(raw.timestamp_usec == expected.usec);
+    }
+
+    // Exactly on a timestamp, between two, before the first, after the last
+    Record r = numbered(437);
+    REQUIRE(reader.seekToTime(r.sec, r.usec));
+    REQUIRE(reader.getNextPacket(raw));
+    CHECK(packetId(raw) == 437);
+
+    REQUIRE(reader.seekToTime(r.sec, r.usec + 1));
+    REQUIRE(reader.getNextPacket(raw));
+    CHECK(packetId(raw) == 438);
+
+    REQUIRE(reader.seekToTime(0, 0));
+    REQUIRE(reader.getNextPacket(raw));
+    CHECK(packetId(raw) == 0);
+
+    Record last = numbered(kPackets - 1);
+    CHECK_FALSE(reader.seekToTime(last.sec + 1, 0));
+    CHECK_FALSE(reader.seekToPacket(kPackets + 1));
+    REQUIRE(reader.seekToPacket(kPackets));  // End of capture
+    CHECK_FALSE(reader.getNextPacket(raw));
+
+    // Sequential reading carries on after a seek
+    REQUIRE(reader.seekToPacket(kPackets - 3));
+    int remaining = 0;
+    while (reader.getNextPacket(raw)) ++remaining;
+    CHECK(remaining == 3);
+}
+
+} // namespace
+
+TEST_SUITE("Capture index") {
+    TEST_CASE("seeking through classic PCAP and PCAPNG in both modes") {
+        for (const std::string& path : {writeNumberedPcap(), writeNumberedPcapNG()}) {
+            for (auto mode : {pcpp::ReadMode::Stream, pcpp::ReadMode::MemoryMapped, pcpp::ReadMode::Prefetch}) {
+                CAPTURE(path);
+                CAPTURE(static_cast<int>(mode));
+                std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path, mode));
+                REQUIRE(reader);
+                REQUIRE(reader->open());
+
+                auto index = reader->buildIndex(64);
+                REQUIRE(index);
+                CHECK(index->packetCount == kPackets);
+                CHECK(index->entries.size() == (kPackets + 63) / 64);
+
+                // Rewound after building
+                pcpp::RawPacket raw;
+                REQUIRE(reader->getNextPacket(raw));
+                CHECK(packetId(raw) == 0);
+
+                checkSeeks(*reader);
+            }
+            std::remove(path.c_str());
+        }
+    }
+
+    TEST_CASE("sidecar round-trip and staleness check") {
+        std::string path = writeNumberedPcapNG();
+        std::string sidecar = pcpp::CaptureIndex::sidecarPath(path);
+        {
+            std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path));
+            REQUIRE(reader->open());
+            auto index = reader->buildIndex(100);
+            REQUIRE(index);
+            REQUIRE(index->save(sidecar));
+            CHECK(index->sections.size() == 2);
+            CHECK(index->sections[0].interfaceOffsets.size() == 2);
+        }
+
+        auto loaded = pcpp::CaptureIndex::load(sidecar);
+        REQUIRE(loaded);
+        CHECK(loaded->entries.size() == 10);
+        CHECK(loaded->entries[3].packetNumber == 300);
+
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(
+            pcpp::IFileReaderDevice::getReader(path, pcpp::ReadMode::MemoryMapped));
+        REQUIRE(reader->open());
+        REQUIRE(reader->loadIndex(sidecar));
+        checkSeeks(*reader);
+
+        // An index for a different file size is refused
+        loaded->captureSize += 1;
+        CHECK_FALSE(reader->setIndex(*loaded));
+        CHECK_FALSE(reader->loadIndex(sidecar + ".missing"));
+
+        std::remove(sidecar.c_str());
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("seekToPacket works without an index") {
+        std::string path = writeNumberedPcap();
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path));
+        REQUIRE(reader->open());
+        pcpp::RawPacket raw;
+        REQUIRE(reader->seekToPacket(500));
+        REQUIRE(reader->getNextPacket(raw));
+        CHECK(packetId(raw) == 500);
+        REQUIRE(reader->seekToPacket(5));
+        REQUIRE(reader->getNextPacket(raw));
+        CHECK(packetId(raw) == 5);
+        reader->close();
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("seekToTime works without an index") {
+        for (const std::string& path : {writeNumberedPcap(), writeNumberedPcapNG()}) {
+            for (auto mode : {pcpp::ReadMode::Stream, pcpp::ReadMode::MemoryMapped, pcpp::ReadMode::Prefetch}) {
+                CAPTURE(path);
+                CAPTURE(static_cast<int>(mode));
+                std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path, mode));
+                REQUIRE(reader->open());
+                pcpp::RawPacket raw;
+                // 100 follows a new interface, 600 a new section
+                for (uint32_t target : {437u, 100u, 600u, 999u, 0u, 601u}) {
+                    Record r = numbered(target);
+                    REQUIRE(reader->seekToTime(r.sec, r.usec));
+                    CHECK(reader->getRecordIndex() == target);
+                    REQUIRE(reader->getNextPacket(raw));
+                    CHECK(packetId(raw) == target);
+                    CHECK(raw.timestamp_usec == r.usec);
+                    // Reading carries on from there
+                    if (target + 1 < kPackets) {
+                        REQUIRE(reader->getNextPacket(raw));
+                        CHECK(packetId(raw) == target + 1);
+                    } else {
+                        CHECK_FALSE(reader->getNextPacket(raw));
+                    }
+                }
+            }
+            std::remove(path.c_str());
+        }
+    }
+}
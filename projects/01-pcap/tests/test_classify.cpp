@@ -0,0 +1,147 @@
+/**
+ * Tests for classifyBatch(): every SIMD level must agree with
+ * Packet::isPacketOfType() on well-formed, truncated and mangled frames.
+ */
+#include <doctest/doctest.h>
+#include <PcapClassify.h>
+
+#include "capture_builder.h"
+
+#include <random>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+const std::vector<uint8_t> kV6Src(16, 0x20);
+const std::vector<uint8_t> kV6Dst(16, 0x30);
+
+// Hop-by-hop extension header carrying `next`, padded to 8 bytes
+std::vector<uint8_t> hopByHop(uint8_t next, const std::vector<uint8_t>& l4) {
+    std::vector<uint8_t> h = {next, 0, 0, 0, 0, 0, 0, 0};
+    h.insert(h.end(), l4.begin(), l4.end());
+    return h;
+}
+
+std::vector<uint8_t> vlan(std::vector<uint8_t> frame) {
+    std::vector<uint8_t> tag = {0x81, 0x00, 0x00, 0x2A};
+    frame.insert(frame.begin() + 12, tag.begin(), tag.end());
+    return frame;
+}
+
+std::vector<std::vector<uint8_t>> templates() {
+    return {
+        ipv4(0x0A000001, 0x0A000002, 6, tcp(1234, 80, 1, 0, pcpp::TCPView::SYN)),
+        ipv4(0x0A000001, 0x0A000002, 17, udp(5000, 9999, 12)),
+        ipv4(0x0A000001, 0x0A000002, 1, {8, 0, 0, 0, 0, 1, 0, 1}),
+        ipv4(0x0A000001, 0x0A000002, 47, std::vector<uint8_t>(24, 0)),
+        ipv6(kV6Src, kV6Dst, 6, tcp(1234, 443, 1, 0, pcpp::TCPView::ACK, 10)),
+        ipv6(kV6Src, kV6Dst, 17, udp(53, 53, 30)),
+        ipv6(kV6Src, kV6Dst, 58, {128, 0, 0, 0, 0, 1, 0, 1}),
+        ipv6(kV6Src, kV6Dst, 0, hopByHop(17, udp(1, 2, 4))),
+        ipv6(kV6Src, kV6Dst, 60, hopByHop(6, tcp(1, 2, 3, 4, 0))),
+        arp(),
+        vlan(ipv4(0x0A000001, 0x0A000002, 17, udp(5000, 9999, 12))),
+        vlan(ipv6(kV6Src, kV6Dst, 6, tcp(1, 2, 3, 4, 0))),
+        ethernet(0x8035),
+        ethernet(0x88CC),
+        ethernet(0x0100),
+    };
+}
+
+std::vector<pcpp::RawPacket> corpus(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    auto shapes = templates();
+    std::vector<pcpp::RawPacket> packets;
+    // Every truncation of every template hits each length bound exactly
+    for (const auto& shape : shapes) {
+        for (size_t len = 0; len <= shape.size(); ++len) {
+            pcpp::RawPacket raw;
+            raw.data.assign(shape.begin(), shape.begin() + len);
+            packets.push_back(std::move(raw));
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pcpp::RawPacket raw;
+        raw.data = shapes[rng() % shapes.size()];
+        switch (rng() % 8) {
+            case 0:  // Truncate anywhere
+                raw.data.resize(rng() % (raw.data.size() + 1));
+                break;
+            case 1:  // Flip one byte in the first 60
+                if (!raw.data.empty()) raw.data[rng() % std::min<size_t>(raw.data.size(), 60)] = rng() & 0xFF;
+                break;
+            case 2:  // Random IPv4 IHL
+                if (raw.data.size() > 14) raw.data[14] = static_cast<uint8_t>(0x40 | (rng() & 0x0F));
+                break;
+            case 3:
+                raw.linkType = 113;
+                break;
+            case 4:
+                raw.linkType = 101;
+                break;
+            default:
+                break;
+        }
+        packets.push_back(std::move(raw));
+    }
+    return packets;
+}
+
+} // namespace
+
+TEST_SUITE("Batch classification") {
+    TEST_CASE("Masks agree with isPacketOfType at every SIMD level") {
+        auto packets = corpus(5000, 42);
+        std::vector<pcpp::ProtocolMask> expected;
+        for (const auto& raw : packets) expected.push_back(pcpp::protocolMaskOf(pcpp::Packet(&raw)));
+
+        for (auto level : {pcpp::SimdLevel::Scalar, pcpp::SimdLevel::SSE2, pcpp::SimdLevel::AVX2}) {
+            CAPTURE(static_cast<int>(level));
+            std::vector<pcpp::ProtocolMask> masks(packets.size(), 0xFF);
+            pcpp::classifyBatch(std::span<const pcpp::RawPacket>(packets), masks, level);
+            size_t mismatches = 0;
+            for (size_t i = 0; i < packets.size(); ++i) {
+                if (masks[i] != expected[i]) ++mismatches;
+            }
+            CHECK(mismatches == 0);
+        }
+    }
+
+    TEST_CASE("Views classify like owned packets") {
+        auto packets = corpus(777, 7);
+        std::vector<pcpp::RawPacketView> views;
+        for (const auto& raw : packets) {
+            views.push_back({raw.getData(), static_cast<uint32_t>(raw.getDataLen()), 0, 0, raw.linkType});
+        }
+        std::vector<pcpp::ProtocolMask> fromRaw(packets.size()), fromViews(views.size());
+        pcpp::classifyBatch(std::span<const pcpp::RawPacket>(packets), fromRaw);
+        pcpp::classifyBatch(std::span<const pcpp::RawPacketView>(views), fromViews);
+        CHECK(fromRaw == fromViews);
+    }
+
+    TEST_CASE("Known frames get the expected bits") {
+        std::vector<pcpp::RawPacket> packets(3);
+        packets[0].data = ipv4(1, 2, 17, udp(5000, 9999, 0));
+        packets[1].data = ipv6(kV6Src, kV6Dst, 0, hopByHop(6, tcp(1, 2, 3, 4, 0)));
+        packets[2].data = arp();
+        std::vector<pcpp::ProtocolMask> masks(3);
+        pcpp::classifyBatch(std::span<const pcpp::RawPacket>(packets), masks);
+
+        CHECK(masks[0] == (pcpp::MaskEthernet | pcpp::MaskIPv4 | pcpp::MaskUDP));
+        CHECK(masks[1] == (pcpp::MaskEthernet | pcpp::MaskIPv6 | pcpp::MaskTCP));
+        CHECK(masks[2] == (pcpp::MaskEthernet | pcpp::MaskARP));
+        CHECK(pcpp::isMaskOfType(masks[0], pcpp::UDP));
+        CHECK_FALSE(pcpp::isMaskOfType(masks[0], pcpp::TCP));
+    }
+
+    TEST_CASE("Only min(packets, masks) entries are written") {
+        std::vector<pcpp::RawPacket> packets(4);
+        for (auto& p : packets) p.data = arp();
+        std::vector<pcpp::ProtocolMask> masks(2, 0);
+        pcpp::classifyBatch(std::span<const pcpp::RawPacket>(packets), masks);
+        CHECK(masks[0] == (pcpp::MaskEthernet | pcpp::MaskARP));
+        CHECK(masks[1] == (pcpp::MaskEthernet | pcpp::MaskARP));
+    }
+}
@@ -0,0 +1,216 @@
+/**
+ * Tests for the columnar metadata export: per-chunk encodings, row groups,
+ * column subsets, time-range scans and rejection of damaged files.
+ */
+#include <doctest/doctest.h>
+#include <PcapColumnar.h>
+
+#include "capture_builder.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+std::vector<pcpp::PacketRow> randomRows(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<pcpp::PacketRow> rows;
+    uint64_t ts = 1'700'000'000'000'000ull;
+    for (size_t i = 0; i < count; ++i) {
+        pcpp::PacketRow row;
+        ts += rng() % 2000;
+        row.timestampUsec = ts;
+        row.linkType = i < count / 2 ? 1 : 113;
+        row.l3Protocol = rng() % 3 ? 0x0800 : 0x86DD;
+        row.l4Protocol = rng() % 2 ? 6 : 17;
+        row.srcAddr[15] = static_cast<uint8_t>(rng() % 5);
+        row.dstAddr[0] = static_cast<uint8_t>(rng());
+        row.dstAddr[15] = static_cast<uint8_t>(rng());
+        row.srcPort = static_cast<uint16_t>(rng());
+        row.dstPort = rng() % 4 ? 443 : 53;
+        row.length = 60 + rng() % 1400;
+        row.ipLength = static_cast<uint16_t>(row.length - 14);
+        row.ttl = 64;
+        row.tcpFlags = static_cast<uint8_t>(rng() % 4 ? 0x10 : 0x18);
+        row.ipFlags = pcpp::PacketRow::DontFragment;
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+template<typename T>
+pcpp::detail::ColumnEncoding roundTrip(const std::vector<T>& values) {
+    std::vector<uint8_t> encoded;
+    pcpp::detail::encodeColumn(values, encoded);
+    std::vector<T> decoded;
+    REQUIRE(pcpp::detail::decodeColumn(encoded.data(), encoded.size(), values.size(), decoded));
+    CHECK(decoded == values);
+    return static_cast<pcpp::detail::ColumnEncoding>(encoded[0]);
+}
+
+} // namespace
+
+TEST_SUITE("Columnar export") {
+    TEST_CASE("each encoding is picked for the data it suits and decodes exactly") {
+        using pcpp::detail::ColumnEncoding;
+        std::mt19937 rng(1);
+        std::vector<uint32_t> constant(5000, 1);
+        std::vector<uint16_t> fewDistinct, random16;
+        std::vector<uint64_t> increasing, random64;
+        std::vector<pcpp::Address16> hosts;
+        uint64_t t = 1'000'000;
+        for (int i = 0; i < 5000; ++i) {
+            fewDistinct.push_back(static_cast<uint16_t>(1000 + rng() % 12));
+            random16.push_back(static_cast<uint16_t>(rng()));
+            increasing.push_back(t += rng() % 100);
+            random64.push_back((uint64_t{rng()} << 32) | rng());
+            pcpp::Address16 a{};
+            a[15] = static_cast<uint8_t>(rng() % 7);
+            hosts.push_back(a);
+        }
+        CHECK(roundTrip(constant) == ColumnEncoding::RLE);
+        CHECK(roundTrip(fewDistinct) == ColumnEncoding::Dictionary);
+        CHECK(roundTrip(increasing) == ColumnEncoding::Delta);
+        CHECK(roundTrip(random64) == ColumnEncoding::Plain);
+        CHECK(roundTrip(hosts) == ColumnEncoding::Dictionary);
+        roundTrip(random16);
+        roundTrip(std::vector<uint8_t>{7});
+    }
+
+    TEST_CASE("rows round-trip through row groups and column subsets") {
+        auto rows = randomRows(3500, 2);
+        std::string path = tempPath("rows.pcol");
+        {
+            pcpp::ColumnarWriter writer;
+            pcpp::ColumnarWriter::Options options;
+            options.rowGroupSize = 1000;
+            REQUIRE(writer.open(path, options));
+            for (const auto& row : rows) REQUIRE(writer.append(row));
+            CHECK(writer.getRowsWritten() == rows.size());
+            REQUIRE(writer.close());
+        }
+
+        pcpp::ColumnarReader reader;
+        REQUIRE(reader.open(path));
+        CHECK(reader.rowCount() == 3500);
+        CHECK(reader.rowGroupSize() == 1000);
+        REQUIRE(reader.rowGroupCount() == 4);
+        CHECK(reader.rowGroup(3).rows == 500);
+        CHECK(reader.rowGroup(1).minTimestampUsec == rows[1000].timestampUsec);
+        CHECK(reader.rowGroup(1).maxTimestampUsec == rows[1999].timestampUsec);
+
+        // The link type is constant within each group: a single RLE run
+        CHECK(reader.rowGroup(0).sizes[static_cast<size_t>(pcpp::Column::LinkType)] < 8);
+
+        size_t next = 0;
+        CHECK(reader.scan(pcpp::kAllColumns, [&](const pcpp::ColumnBatch& batch) {
+            for (size_t i = 0; i < batch.rows; ++i) CHECK(batch.row(i) == rows[next++]);
+        }));
+        CHECK(next == rows.size());
+
+        pcpp::ColumnBatch batch;
+        REQUIRE(reader.readRowGroup(2, batch, pcpp::columnBit(pcpp::Column::DstPort)));
+        CHECK(batch.rows == 1000);
+        CHECK(batch.dstPort.size() == 1000);
+        CHECK(batch.dstPort[5] == rows[2005].dstPort);
+        CHECK(batch.timestampUsec.empty());
+        CHECK(batch.srcAddr.empty());
+        CHECK_FALSE(reader.readRowGroup(4, batch));
+
+        // Only row groups overlapping the range are decoded
+        size_t groups = 0;
+        reader.scan(
+            pcpp::columnBit(pcpp::Column::Timestamp), [&](const pcpp::ColumnBatch&) { ++groups; },
+            rows[1500].timestampUsec, rows[2500].timestampUsec);
+        CHECK(groups == 2);
+        reader.close();
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("exportColumnar matches per-packet decoding") {
+        auto records = sampleRecords();
+        std::vector<uint8_t> a(16, 0x20), b(16, 0x30);
+        records.push_back({ipv6(a, b, 6, tcp(443, 50000, 1, 2, pcpp::TCPView::ACK | pcpp::TCPView::PSH, 10)), 103, 5});
+        records.push_back({ipv6(a, b, 58, {128, 0, 0, 0}), 104, 6});
+        std::string capture = tempPath("columnar.pcap");
+        std::string path = tempPath("columnar.pcol");
+        writePcap(capture, records);
+
+        auto rows = pcpp::exportColumnar(capture, path);
+        REQUIRE(rows);
+        CHECK(*rows == records.size());
+
+        pcpp::ColumnarReader reader;
+        REQUIRE(reader.open(path));
+        pcpp::ColumnBatch batch;
+        REQUIRE(reader.readRowGroup(0, batch));
+        REQUIRE(batch.rows == records.size());
+        for (size_t i = 0; i < records.size(); ++i) {
+            pcpp::RawPacket raw;
+            raw.data = records[i].frame;
+            raw.timestamp_sec = records[i].sec;
+            raw.timestamp_usec = records[i].usec;
+            CHECK(batch.row(i) == pcpp::PacketRow::fromPacket(raw));
+        }
+        CHECK(batch.l4Protocol[1] == 6);
+        CHECK(batch.srcPort[1] == 80);
+        CHECK(batch.tcpFlags[1] == 0x12);
+        CHECK(batch.l3Protocol[2] == 0x0806);
+        CHECK(batch.dstAddr[3][15] == 8);
+        CHECK(batch.ipFlags[0] == pcpp::PacketRow::DontFragment);
+        CHECK(batch.l4Protocol[5] == 58);
+        CHECK(batch.ttl[4] == 64);
+        CHECK(batch.timestampUsec[3] == 102'999'999);
+
+        CHECK_FALSE(pcpp::exportColumnar(capture + ".missing", path));
+        reader.close();
+        std::remove(capture.c_str());
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("damaged files are refused") {
+        std::string path = tempPath("damaged.pcol");
+        {
+            pcpp::ColumnarWriter writer;
+            REQUIRE(writer.open(path));
+            for (const auto& row : randomRows(100, 3)) writer.append(row);
+        }  // Closed by the destructor
+        std::vector<uint8_t> good;
+        {
+            std::ifstream in(path, std::ios::binary);
+            good.assign(std::istreambuf_iterator<char>(in), {});
+        }
+        pcpp::ColumnarReader reader;
+        REQUIRE(reader.open(path));
+        CHECK(reader.rowCount() == 100);
+        size_t linkTypeChunk = reader.rowGroup(0).offsets[static_cast<size_t>(pcpp::Column::LinkType)];
+        reader.close();
+
+        auto damaged = good;
+        damaged.resize(good.size() - 3);
+        writeBytes(path, damaged);
+        CHECK_FALSE(reader.open(path));
+
+        damaged = good;
+        damaged[0] = 'X';
+        writeBytes(path, damaged);
+        CHECK_FALSE(reader.open(path));
+
+        // An RLE run longer than the row group
+        damaged = good;
+        REQUIRE(damaged[linkTypeChunk] == static_cast<uint8_t>(pcpp::detail::ColumnEncoding::RLE));
+        damaged[linkTypeChunk + 1] = 101;
+        writeBytes(path, damaged);
+        REQUIRE(reader.open(path));
+        pcpp::ColumnBatch batch;
+        CHECK_FALSE(reader.readRowGroup(0, batch));
+        CHECK(reader.readRowGroup(0, batch, pcpp::columnBit(pcpp::Column::DstPort)));
+        reader.close();
+        std::remove(path.c_str());
+    }
+}
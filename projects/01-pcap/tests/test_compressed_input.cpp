@@ -0,0 +1,253 @@
+/**
+ * Tests for compressed capture input: gzip and zstd files (single frame,
+ * many frames decoded in parallel, concatenated members) read back exactly
+ * like the plain capture, including seeks and truncated input.
+ *
+ * Compressed fixtures are produced with zlib / libzstd themselves, so each
+ * format is only exercised when the build has it (PCAP_HAVE_ZLIB /
+ * PCAP_HAVE_ZSTD); otherwise the reader must refuse it.
+ */
+#include <doctest/doctest.h>
+#include <PcapReader.h>
+
+#include "capture_builder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+#if PCAP_HAVE_ZLIB || PCAP_HAVE_ZSTD
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), {}};
+}
+
+std::vector<pcpp::RawPacket> readAll(const std::string& path) {
+    std::vector<pcpp::RawPacket> packets;
+    std::unique_ptr<pcpp::IFileReaderDevice> reader(
+        pcpp::IFileReaderDevice::getReader(path, pcpp::ReadMode::MemoryMapped));
+    if (!reader || !reader->open()) return packets;
+    pcpp::RawPacket raw;
+    while (reader->getNextPacket(raw)) packets.push_back(raw);
+    return packets;
+}
+
+// Enough records to span several prefetch buffers and zstd worker jobs
+std::vector<Record> manyRecords(size_t count) {
+    std::vector<Record> records;
+    for (size_t i = 0; i < count; ++i) {
+        auto frame = ipv4(0x0A000000 + static_cast<uint32_t>(i), 0x0A0000FF, 17,
+                          udp(static_cast<uint16_t>(i), 53, 200 + i % 1200));
+        frame[frame.size() - 1] = static_cast<uint8_t>(i * 7);
+        records.push_back({frame, static_cast<uint32_t>(1000 + i / 1000), static_cast<uint32_t>(i % 1000)});
+    }
+    return records;
+}
+
+bool samePackets(const std::vector<pcpp::RawPacket>& a, const std::vector<pcpp::RawPacket>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].data != b[i].data || a[i].timestamp_sec != b[i].timestamp_sec ||
+            a[i].timestamp_usec != b[i].timestamp_usec || a[i].linkType != b[i].linkType) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+#if PCAP_HAVE_ZLIB
+std::vector<uint8_t> gzip(const uint8_t* data, size_t size) {
+    z_stream zs{};
+    deflateInit2(&zs, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::vector<uint8_t> out(deflateBound(&zs, static_cast<uLong>(size)));
+    zs.next_in = const_cast<Bytef*>(data);
+    zs.avail_in = static_cast<uInt>(size);
+    zs.next_out = out.data();
+    zs.avail_out = static_cast<uInt>(out.size());
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+#endif
+
+#if PCAP_HAVE_ZSTD
+// One frame per `frameSize` input bytes; sizes are written to the frame
+// header unless `unknownSize`, which forces the streaming path
+std::vector<uint8_t> zstd(const std::vector<uint8_t>& data, size_t frameSize, bool unknownSize = false) {
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_contentSizeFlag, unknownSize ? 0 : 1);
+    std::vector<uint8_t> out;
+    for (size_t pos = 0; pos < data.size(); pos += frameSize) {
+        size_t n = std::min(frameSize, data.size() - pos);
+        std::vector<uint8_t> frame(ZSTD_compressBound(n));
+        size_t written = ZSTD_compress2(cctx, frame.data(), frame.size(), data.data() + pos, n);
+        REQUIRE_FALSE(ZSTD_isError(written));
+        out.insert(out.end(), frame.begin(), frame.begin() + static_cast<std::ptrdiff_t>(written));
+    }
+    ZSTD_freeCCtx(cctx);
+    return out;
+}
+#endif
+
+#if PCAP_HAVE_ZLIB || PCAP_HAVE_ZSTD
+void checkCompressed(const std::string& path, pcpp::Compression expected,
+                     const std::vector<pcpp::RawPacket>& plain) {
+    std::unique_ptr<pcpp::IFileReaderDevice> reader(
+        pcpp::IFileReaderDevice::getReader(path, pcpp::ReadMode::MemoryMapped));
+    REQUIRE(reader != nullptr);
+    CHECK(reader->getReadMode() == pcpp::ReadMode::Prefetch);
+    CHECK(reader->getCompression() == expected);
+    CHECK(samePackets(readAll(path), plain));
+}
+#endif
+
+} // namespace
+
+TEST_SUITE("Compressed input") {
+    TEST_CASE("compression is detected from the magic bytes") {
+        const uint8_t gz[] = {0x1F, 0x8B, 0x08, 0x00};
+        const uint8_t zst[] = {0x28, 0xB5, 0x2F, 0xFD};
+        const uint8_t pcap[] = {0xD4, 0xC3, 0xB2, 0xA1};
+        CHECK(pcpp::detectCompression(gz, 4) == pcpp::Compression::Gzip);
+        CHECK(pcpp::detectCompression(zst, 4) == pcpp::Compression::Zstd);
+        CHECK(pcpp::detectCompression(pcap, 4) == pcpp::Compression::None);
+        CHECK(pcpp::detectCompression(zst, 3) == pcpp::Compression::None);
+
+        std::string path = tempPath("plain.pcap");
+        writePcap(path, sampleRecords());
+        CHECK(pcpp::detectCompression(path) == pcpp::Compression::None);
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(
+            pcpp::IFileReaderDevice::getReader(path, pcpp::ReadMode::MemoryMapped));
+        CHECK(reader->getCompression() == pcpp::Compression::None);
+        std::remove(path.c_str());
+
+        // A format the build cannot decode is refused up front
+        path = tempPath("unsupported.pcap.zst");
+        writeBytes(path, {0x28, 0xB5, 0x2F, 0xFD, 0, 0, 0, 0});
+        std::unique_ptr<pcpp::IFileReaderDevice> zstdReader(pcpp::IFileReaderDevice::getReader(path));
+        CHECK((zstdReader != nullptr) == pcpp::isCompressionSupported(pcpp::Compression::Zstd));
+        std::remove(path.c_str());
+    }
+
+#if PCAP_HAVE_ZLIB
+    TEST_CASE("gzip captures read like the plain file, across members") {
+        std::string plainPath = tempPath("gzip-plain.pcapng");
+        std::string path = tempPath("capture.pcapng.gz");
+        writePcapNG(plainPath, manyRecords(12000));
+        auto bytes = readFile(plainPath);
+        auto plain = readAll(plainPath);
+        REQUIRE(plain.size() == 12000);
+
+        writeBytes(path, gzip(bytes.data(), bytes.size()));
+        checkCompressed(path, pcpp::Compression::Gzip, plain);
+
+        // `cat a.gz b.gz`, split inside a record
+        size_t half = bytes.size() / 2 + 3;
+        auto members = gzip(bytes.data(), half);
+        auto second = gzip(bytes.data() + half, bytes.size() - half);
+        members.insert(members.end(), second.begin(), second.end());
+        writeBytes(path, members);
+        checkCompressed(path, pcpp::Compression::Gzip, plain);
+
+        // Truncated: everything decoded before the cut, then a clean stop
+        members.resize(members.size() - second.size() / 2);
+        writeBytes(path, members);
+        auto truncated = readAll(path);
+        CHECK(truncated.size() > 5000);
+        CHECK(truncated.size() < plain.size());
+        CHECK(truncated.back().data == plain[truncated.size() - 1].data);
+        std::remove(plainPath.c_str());
+        std::remove(path.c_str());
+    }
+#endif
+
+#if PCAP_HAVE_ZSTD
+    TEST_CASE("zstd captures read like the plain file, framed or streamed") {
+        std::string plainPath = tempPath("zstd-plain.pcap");
+        std::string path = tempPath("capture.pcap.zst");
+        writePcap(plainPath, manyRecords(12000));
+        auto bytes = readFile(plainPath);
+        auto plain = readAll(plainPath);
+        REQUIRE(plain.size() == 12000);
+
+        // Single frame, size in the header
+        writeBytes(path, zstd(bytes, bytes.size()));
+        checkCompressed(path, pcpp::Compression::Zstd, plain);
+        // Single frame of unknown size: streamed
+        writeBytes(path, zstd(bytes, bytes.size(), true));
+        checkCompressed(path, pcpp::Compression::Zstd, plain);
+        // Many small frames: several parallel jobs
+        auto framed = zstd(bytes, 1u << 20);
+        writeBytes(path, framed);
+        checkCompressed(path, pcpp::Compression::Zstd, plain);
+        // Parallel frames, then a streamed one
+        auto mixed = zstd(std::vector<uint8_t>(bytes.begin(), bytes.begin() + (9u << 20)), 1u << 20);
+        auto tail = zstd(std::vector<uint8_t>(bytes.begin() + (9u << 20), bytes.end()), bytes.size(), true);
+        mixed.insert(mixed.end(), tail.begin(), tail.end());
+        writeBytes(path, mixed);
+        checkCompressed(path, pcpp::Compression::Zstd, plain);
+
+        // The decoder gives identical bytes with any number of workers,
+        // including when a job ends inside a read
+        for (size_t workers : {0, 1, 3}) {
+            CAPTURE(workers);
+            pcpp::detail::Decompressor decoder;
+            REQUIRE(decoder.open(path, workers));
+            std::vector<uint8_t> decoded, chunk(777777);
+            while (size_t n = decoder.read(chunk.data(), chunk.size())) {
+                decoded.insert(decoded.end(), chunk.begin(), chunk.begin() + static_cast<std::ptrdiff_t>(n));
+            }
+            CHECK_FALSE(decoder.failed());
+            CHECK(decoded == bytes);
+            decoder.rewind();
+            CHECK(decoder.read(chunk.data(), 24) == 24);
+            CHECK(std::equal(chunk.begin(), chunk.begin() + 24, bytes.begin()));
+        }
+
+        // Corrupt frame: reading stops without crashing
+        framed[framed.size() / 2] ^= 0xFF;
+        framed[framed.size() / 2 + 1] ^= 0xFF;
+        writeBytes(path, framed);
+        CHECK(readAll(path).size() < plain.size());
+        std::remove(plainPath.c_str());
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("seeks and indexes work on the decoded stream") {
+        std::string plainPath = tempPath("seek-plain.pcap");
+        std::string path = tempPath("seek.pcap.zst");
+        writePcap(plainPath, manyRecords(12000));
+        writeBytes(path, zstd(readFile(plainPath), 1u << 20));
+        auto plain = readAll(plainPath);
+
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path));
+        REQUIRE(reader->open());
+        auto index = reader->buildIndex(1000);
+        REQUIRE(index);
+        CHECK(index->packetCount == 12000);
+
+        pcpp::RawPacket raw;
+        for (uint64_t target : {11000u, 250u, 7777u, 0u}) {
+            REQUIRE(reader->seekToPacket(target));
+            REQUIRE(reader->getNextPacket(raw));
+            CHECK(raw.data == plain[target].data);
+        }
+        REQUIRE(reader->seekToTime(1005, 500));
+        REQUIRE(reader->getNextPacket(raw));
+        CHECK(raw.data == plain[5500].data);
+        CHECK_FALSE(reader->seekToPacket(12001));
+        std::remove(plainPath.c_str());
+        std::remove(path.c_str());
+    }
+#endif
+}
@@ -0,0 +1,221 @@
+/**
+ * Tests for pcap::FlowTable: 5-tuple extraction, per-direction counters,
+ * TCP handshake RTT / retransmits, and idle / capacity eviction.
+ */
+#include <doctest/doctest.h>
+#include <PcapFlow.h>
+
+#include "capture_builder.h"
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+constexpr uint32_t kClient = 0x0A000001;
+constexpr uint32_t kServer = 0x0A000002;
+
+struct Feed {
+    pcpp::FlowTable& table;
+    void operator()(const std::vector<uint8_t>& frame, uint64_t usec) {
+        pcpp::RawPacket raw;
+        raw.data = frame;
+        raw.timestamp_sec = static_cast<uint32_t>(usec / 1000000);
+        raw.timestamp_usec = static_cast<uint32_t>(usec % 1000000);
+        table.process(raw);
+    }
+};
+
+} // namespace
+
+TEST_SUITE("Flow table") {
+    TEST_CASE("both directions map to one canonical key") {
+        pcpp::RawPacket a, b;
+        a.data = ipv4(kServer, kClient, 17, udp(53, 40000, 4));
+        b.data = ipv4(kClient, kServer, 17, udp(40000, 53, 4));
+        bool fromA1 = false, fromA2 = false;
+        auto k1 = pcpp::extractFlowKey(pcpp::Packet(&a), &fromA1);
+        auto k2 = pcpp::extractFlowKey(pcpp::Packet(&b), &fromA2);
+        REQUIRE(k1.has_value());
+        REQUIRE(k2.has_value());
+        CHECK(*k1 == *k2);
+        CHECK(k1->hash() == k2->hash());
+        CHECK(fromA1 != fromA2);
+        CHECK(k1->ipv4A() == kClient);
+        CHECK(k1->portA == 40000);
+        CHECK(k1->protocol == 17);
+
+        pcpp::RawPacket arpRaw;
+        arpRaw.data = arp();
+        CHECK_FALSE(pcpp::extractFlowKey(pcpp::Packet(&arpRaw)).has_value());
+    }
+
+    TEST_CASE("TCP handshake RTT, byte counts and retransmits") {
+        pcpp::FlowTable table;
+        Feed feed{table};
+        using T = pcpp::TCPView;
+        feed(ipv4(kClient, kServer, 6, tcp(40000, 80, 1000, 0, T::SYN)), 10'000'000);
+        feed(ipv4(kServer, kClient, 6, tcp(80, 40000, 5000, 1001, T::SYN | T::ACK)), 10'001'000);
+        feed(ipv4(kClient, kServer, 6, tcp(40000, 80, 1001, 5001, T::ACK)), 10'002'500);
+        feed(ipv4(kClient, kServer, 6, tcp(40000, 80, 1001, 5001, T::ACK | T::PSH, 100)), 10'003'000);
+        feed(ipv4(kClient, kServer, 6, tcp(40000, 80, 1001, 5001, T::ACK | T::PSH, 100)), 10'203'000);  // Retransmit
+        feed(ipv4(kServer, kClient, 6, tcp(80, 40000, 5001, 1101, T::ACK, 200)), 10'204'000);
+        feed(ipv4(kClient, kServer, 6, tcp(40000, 80, 1101, 5201, T::FIN | T::ACK)), 10'300'000);
+
+        REQUIRE(table.size() == 1);
+        const pcpp::FlowRecord* flow = nullptr;
+        table.forEach([&](const pcpp::FlowRecord& r) { flow = &r; });
+        REQUIRE(flow != nullptr);
+        CHECK(flow->handshakeComplete());
+        CHECK(flow->handshakeRttUsec == 2500);
+        CHECK(flow->synAckUsec - flow->synUsec == 1000);
+        CHECK(flow->forward.packets == 5);
+        CHECK(flow->reverse.packets == 2);
+        CHECK(flow->forward.retransmits == 1);
+        CHECK(flow->reverse.retransmits == 0);
+        CHECK(flow->durationUsec() == 300'000);
+        CHECK(flow->finSeen);
+        CHECK_FALSE(flow->rstSeen);
+        CHECK(flow->key.ipv4A() == kClient);
+        CHECK(flow->initiatorIsA);
+    }
+
+    TEST_CASE("handshake times use each packet's own timestamp") {
+        pcpp::FlowTable table;
+        Feed feed{table};
+        using T = pcpp::TCPView;
+        // Merged input: another flow's packet arrives first, stamped later
+        feed(ipv4(kServer, kClient, 17, udp(53, 5353, 10)), 50'000'000);
+        feed(ipv4(kClient, kServer, 6, tcp(40000, 80, 1000, 0, T::SYN)), 10'000'000);
+        feed(ipv4(kServer, kClient, 6, tcp(80, 40000, 5000, 1001, T::SYN | T::ACK)), 10'001'000);
+        feed(ipv4(kClient, kServer, 6, tcp(40000, 80, 1001, 5001, T::ACK)), 10'002'500);
+        // A handshake stamped at the epoch
+        feed(ipv4(kClient, kServer, 6, tcp(40001, 80, 1000, 0, T::SYN)), 0);
+        feed(ipv4(kServer, kClient, 6, tcp(80, 40001, 5000, 1001, T::SYN | T::ACK)), 1'000);
+        feed(ipv4(kClient, kServer, 6, tcp(40001, 80, 1001, 5001, T::ACK)), 3'000);
+
+        size_t checked = 0;
+        table.forEach([&](const pcpp::FlowRecord& r) {
+            if (r.key.protocol != 6) return;
+            bool epoch = r.key.portA == 40001 || r.key.portB == 40001;
+            CHECK(r.handshakeComplete());
+            CHECK(r.synUsec == (epoch ? 0u : 10'000'000u));
+            CHECK(r.synAckUsec - r.synUsec == 1000);
+            CHECK(r.handshakeRttUsec == (epoch ? 3000u : 2500u));
+            ++checked;
+        });
+        CHECK(checked == 2);
+    }
+
+    TEST_CASE("a SYN seen after mid-stream traffic names the initiator") {
+        pcpp::FlowTable table;
+        Feed feed{table};
+        using T = pcpp::TCPView;
+        // Server speaks first (e.g. capture started late), then a fresh SYN from the client
+        feed(ipv4(kServer, kClient, 6, tcp(80, 40000, 1, 1, T::ACK, 10)), 1);
+        feed(ipv4(kClient, kServer, 6, tcp(40000, 80, 9, 0, T::SYN)), 2);
+
+        table.forEach([&](const pcpp::FlowRecord& r) {
+            CHECK(r.forward.packets == 1);  // The SYN
+            CHECK(r.reverse.packets == 1);
+            CHECK(r.key.ipv4A() == kClient);
+            CHECK(r.initiatorIsA);
+        });
+    }
+
+    TEST_CASE("idle flows are reported and removed") {
+        std::vector<std::pair<uint16_t, pcpp::FlowEndReason>> ended;
+        pcpp::FlowTable::Options options;
+        options.idleTimeoutUsec = 1'000'000;
+        pcpp::FlowTable table(options, [&](const pcpp::FlowRecord& r, pcpp::FlowEndReason why) {
+            ended.push_back({r.key.portA == 53 ? r.key.portB : r.key.portA, why});
+        });
+        Feed feed{table};
+
+        feed(ipv4(kClient, kServer, 17, udp(1111, 53, 1)), 0);
+        feed(ipv4(kClient, kServer, 17, udp(2222, 53, 1)), 500'000);
+        feed(ipv4(kClient, kServer, 17, udp(2222, 53, 1)), 900'000);
+        CHECK(ended.empty());
+
+        feed(ipv4(kClient, kServer, 17, udp(3333, 53, 1)), 1'600'000);  // Port 1111 idle for 1.6 s
+        REQUIRE(ended.size() == 1);
+        CHECK(ended[0].first == 1111);
+        CHECK(ended[0].second == pcpp::FlowEndReason::IdleTimeout);
+        CHECK(table.size() == 2);
+
+        table.flush();
+        CHECK(ended.size() == 3);
+        CHECK(ended[1].second == pcpp::FlowEndReason::Flushed);
+        CHECK(ended[1].first == 2222);  // Oldest activity first
+        CHECK(table.size() == 0);
+    }
+
+    TEST_CASE("memory stays bounded by maxFlows") {
+        size_t evicted = 0;
+        pcpp::FlowTable::Options options;
+        options.maxFlows = 100;
+        pcpp::FlowTable table(options, [&](const pcpp::FlowRecord&, pcpp::FlowEndReason why) {
+            if (why == pcpp::FlowEndReason::Evicted) ++evicted;
+        });
+        Feed feed{table};
+        for (uint32_t i = 0; i < 1000; ++i) {
+            feed(ipv4(kClient + i, kServer, 17, udp(1000, 53, 0)), i);
+        }
+        CHECK(table.size() == 100);
+        CHECK(evicted == 900);
+    }
+
+    TEST_CASE("lookups stay correct across growth and deletion") {
+        pcpp::FlowTable::Options options;
+        options.idleTimeoutUsec = 50'000;
+        pcpp::FlowTable table(options);
+        Feed feed{table};
+
+        // 200k flows over 200 ms of capture time: older ones expire as we go
+        std::map<uint32_t, uint64_t> lastSeen;
+        for (uint32_t i = 0; i < 200000; ++i) {
+            uint32_t host = i % 150000;
+            feed(ipv4(0x0B000000 + host, kServer, 17, udp(static_cast<uint16_t>(host), 9999, 0)), i);
+            lastSeen[host] = i;
+        }
+
+        size_t live = 0;
+        for (const auto& [host, usec] : lastSeen) {
+            pcpp::RawPacket raw;
+            raw.data = ipv4(0x0B000000 + host, kServer, 17, udp(static_cast<uint16_t>(host), 9999, 0));
+            auto key = pcpp::extractFlowKey(pcpp::Packet(&raw));
+            const pcpp::FlowRecord* r = table.lookup(*key);
+            bool expected = 199999 - usec <= options.idleTimeoutUsec;
+            CHECK((r != nullptr) == expected);
+            if (r) {
+                ++live;
+                CHECK(r->lastSeenUsec == usec);
+            }
+        }
+        CHECK(live == table.size());
+    }
+
+    TEST_CASE("flows stream out of a capture file") {
+        std::string path = tempPath("flows.pcapng");
+        writePcapNG(path, sampleRecords());
+
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(
+            pcpp::IFileReaderDevice::getReader(path, pcpp::ReadMode::MemoryMapped));
+        REQUIRE(reader != nullptr);
+        REQUIRE(reader->open());
+
+        std::vector<pcpp::FlowRecord> flows;
+        pcpp::FlowTable table({}, [&](const pcpp::FlowRecord& r, pcpp::FlowEndReason) { flows.push_back(r); });
+        pcpp::RawPacketView view;
+        while (reader->getNextPacket(view)) table.process(view);
+        table.flush();
+
+        // UDP 5000->9999, TCP 80->40000, UDP 53->53; ARP is not a flow
+        CHECK(flows.size() == 3);
+        std::remove(path.c_str());
+    }
+}
@@ -0,0 +1,174 @@
+/**
+ * Tests for the typed layer views (EthernetView, IPv4View, TCPView, ...)
+ * and for getLayerOfType<T>() not touching the heap.
+ */
+#include <doctest/doctest.h>
+#include <PcapReader.h>
+
+#include "capture_builder.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+
+pcpp::RawPacket makeRaw(std::vector<uint8_t> frame) {
+    pcpp::RawPacket raw;
+    raw.data = std::move(frame);
+    return raw;
+}
+
+} // namespace
+
+// Count heap allocations made by this test binary. GCC cannot see that the
+// replaced new/delete pair both use malloc/free and warns at inlined sites.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+TEST_SUITE("Layer views") {
+    TEST_CASE("IPv4 and TCP fields") {
+        auto raw = makeRaw(ipv4(0xC0A80001, 0x0A000002, 6,
+                                tcp(443, 51000, 0x01020304, 0xA0B0C0D0, pcpp::TCPView::SYN | pcpp::TCPView::ACK, 5, 1024),
+                                37));
+        pcpp::Packet packet(&raw);
+
+        auto ip = packet.getLayer<pcpp::IPv4View>();
+        REQUIRE(ip.has_value());
+        CHECK(ip->version() == 4);
+        CHECK(ip->headerLength() == 20);
+        CHECK(ip->srcAddress() == 0xC0A80001);
+        CHECK(ip->dstAddress() == 0x0A000002);
+        CHECK(ip->ttl() == 37);
+        CHECK(ip->protocol() == 6);
+        CHECK(ip->totalLength() == 45);
+        CHECK(ip->dontFragment());
+        CHECK_FALSE(ip->isFragment());
+
+        auto tcp = packet.getLayer<pcpp::TCPView>();
+        REQUIRE(tcp.has_value());
+        CHECK(tcp->srcPort() == 443);
+        CHECK(tcp->dstPort() == 51000);
+        CHECK(tcp->seq() == 0x01020304);
+        CHECK(tcp->ack() == 0xA0B0C0D0);
+        CHECK(tcp->flags() == (pcpp::TCPView::SYN | pcpp::TCPView::ACK));
+        CHECK(tcp->hasFlag(pcpp::TCPView::SYN));
+        CHECK_FALSE(tcp->hasFlag(pcpp::TCPView::FIN));
+        CHECK(tcp->window() == 1024);
+        CHECK(tcp->payloadLength() == 5);
+
+        CHECK_FALSE(packet.getLayer<pcpp::UDPView>().has_value());
+        CHECK_FALSE(packet.getLayer<pcpp::IPv6View>().has_value());
+    }
+
+    TEST_CASE("UDP over IPv6") {
+        std::vector<uint8_t> src(16, 0), dst(16, 0);
+        src[0] = 0x20; src[1] = 0x01; src[15] = 1;
+        dst[15] = 1;
+        auto raw = makeRaw(ipv6(src, dst, 17, udp(5353, 5353, 12), 255));
+        pcpp::Packet packet(&raw);
+
+        auto ip = packet.getLayer<pcpp::IPv6View>();
+        REQUIRE(ip.has_value());
+        CHECK(ip->version() == 6);
+        CHECK(ip->hopLimit() == 255);
+        CHECK(ip->nextHeader() == 17);
+        CHECK(ip->payloadLength() == 20);
+        CHECK(std::vector<uint8_t>(ip->srcAddress(), ip->srcAddress() + 16) == src);
+        CHECK(std::vector<uint8_t>(ip->dstAddress(), ip->dstAddress() + 16) == dst);
+
+        auto udp = packet.getLayer<pcpp::UDPView>();
+        REQUIRE(udp.has_value());
+        CHECK(udp->srcPort() == 5353);
+        CHECK(udp->length() == 20);
+        CHECK(udp->payloadLength() == 12);
+        CHECK(udp->payload()[0] == 0xAB);
+    }
+
+    TEST_CASE("Ethernet with a VLAN tag and ARP") {
+        std::vector<uint8_t> frame = ethernet(0x8100);
+        put16be(frame, 42);      // VLAN TCI
+        put16be(frame, 0x0806);  // Inner EtherType
+        std::vector<uint8_t> arpBody = {0x00, 0x01, 0x08, 0x00, 6, 4, 0x00, 0x02,
+                                        1, 2, 3, 4, 5, 6, 10, 0, 0, 1,
+                                        7, 8, 9, 10, 11, 12, 10, 0, 0, 2};
+        frame.insert(frame.end(), arpBody.begin(), arpBody.end());
+        auto raw = makeRaw(frame);
+        pcpp::Packet packet(&raw);
+
+        auto eth = packet.getLayer<pcpp::EthernetView>();
+        REQUIRE(eth.has_value());
+        CHECK(eth->etherType() == 0x0806);
+        CHECK(eth->hasVlan());
+        CHECK(eth->headerLength() == 18);
+        CHECK(eth->dstMac()[0] == 0x00);
+        CHECK(eth->srcMac()[0] == 0x66);
+
+        auto arp = packet.getLayer<pcpp::ARPView>();
+        REQUIRE(arp.has_value());
+        CHECK(arp->opcode() == 2);
+        CHECK(arp->senderIp() == 0x0A000001);
+        CHECK(arp->targetIp() == 0x0A000002);
+        CHECK(arp->targetMac()[5] == 12);
+    }
+
+    TEST_CASE("getLayerOfType returns cached views, never new objects") {
+        auto raw = makeRaw(ipv4(1, 2, 17, udp(1, 2, 0)));
+        pcpp::Packet packet(&raw);
+
+        const pcpp::IPv4Layer* a = packet.getLayerOfType<pcpp::IPv4Layer>();
+        const pcpp::IPv4Layer* b = pcpp::getLayerOfType<pcpp::IPv4Layer>(packet);
+        REQUIRE(a != nullptr);
+        CHECK(a == b);
+        CHECK(a->getData() == raw.getData() + 14);
+        CHECK(packet.getLayerOfType<pcpp::TCPLayer>() == nullptr);
+        CHECK(packet.getLayerOfType<pcpp::ARPLayer>() == nullptr);
+        CHECK(packet.getLayerOfType<int>() == nullptr);
+    }
+
+    TEST_CASE("truncated headers produce no view") {
+        auto full = ipv4(1, 2, 6, tcp(1, 2, 0, 0, 0));
+        full.resize(14 + 20 + 10);  // Half a TCP header
+        auto raw = makeRaw(full);
+        pcpp::Packet packet(&raw);
+
+        CHECK(packet.isPacketOfType(pcpp::IPv4));
+        CHECK_FALSE(packet.isPacketOfType(pcpp::TCP));
+        CHECK_FALSE(packet.getLayer<pcpp::TCPView>().has_value());
+    }
+
+    TEST_CASE("parsing and layer inspection do not allocate") {
+        std::vector<pcpp::RawPacket> packets;
+        for (const auto& r : sampleRecords()) packets.push_back(makeRaw(r.frame));
+
+        uint64_t checksum = 0;
+        size_t before = g_allocations.load();
+        for (int round = 0; round < 1000; ++round) {
+            for (const auto& raw : packets) {
+                pcpp::Packet packet(&raw);
+                if (auto ip = packet.getLayer<pcpp::IPv4View>()) checksum += ip->ttl();
+                if (auto* tcp = packet.getLayerOfType<pcpp::TCPLayer>()) checksum += tcp->srcPort();
+                if (auto udp = packet.getLayer<pcpp::UDPView>()) checksum += udp->dstPort();
+                if (auto* eth = pcpp::getLayerOfType<pcpp::EthernetLayer>(packet)) checksum += eth->etherType();
+            }
+        }
+        size_t after = g_allocations.load();
+        CHECK(after == before);
+        CHECK(checksum != 0);
+    }
+}
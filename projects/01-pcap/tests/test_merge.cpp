@@ -0,0 +1,155 @@
+/**
+ * Tests for the multi-file capture merge: timestamp order across inputs,
+ * duplicate suppression across taps and writing the merged stream.
+ */
+#include <doctest/doctest.h>
+#include <PcapMerge.h>
+
+#include "capture_builder.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+// A UDP frame whose payload identifies it
+std::vector<uint8_t> tagged(uint16_t tag, size_t payload = 20) {
+    auto frame = ipv4(0x0A000001, 0x0A000002, 17, udp(tag, 9999, payload));
+    frame.back() = static_cast<uint8_t>(tag);
+    return frame;
+}
+
+uint16_t tagOf(const pcpp::RawPacketView& view) {
+    return pcpp::detail::loadBE16(view.data + 14 + 20);
+}
+
+void removeAll(const std::vector<std::string>& paths) {
+    for (const auto& p : paths) std::remove(p.c_str());
+}
+
+} // namespace
+
+TEST_SUITE("Capture merge") {
+    TEST_CASE("records come out in timestamp order, ties in input order") {
+        std::vector<std::string> files = {tempPath("merge_a.pcap"), tempPath("merge_b.pcapng"),
+                                          tempPath("merge_c.pcap")};
+        writePcap(files[0], {{tagged(1), 10, 0}, {tagged(4), 10, 300}, {tagged(7), 12, 0}});
+        writePcapNG(files[1], {{tagged(2), 10, 100}, {tagged(5), 10, 300}, {tagged(8), 13, 5}});
+        writePcap(files[2], {{tagged(3), 10, 200}, {tagged(6), 11, 0}});
+
+        for (auto mode : {pcpp::ReadMode::Stream, pcpp::ReadMode::MemoryMapped, pcpp::ReadMode::Prefetch}) {
+            CAPTURE(static_cast<int>(mode));
+            pcpp::CaptureMerger merger;
+            pcpp::CaptureMerger::Options options;
+            options.mode = mode;
+            REQUIRE(merger.open(files, options));
+            CHECK(merger.inputCount() == 3);
+
+            std::vector<uint16_t> tags;
+            std::vector<size_t> inputs;
+            pcpp::RawPacketView view;
+            size_t input = 0;
+            while (merger.getNextPacket(view, &input)) {
+                tags.push_back(tagOf(view));
+                inputs.push_back(input);
+            }
+            std::vector<uint16_t> expectedTags = {1, 2, 3, 4, 5, 6, 7, 8};
+            std::vector<size_t> expectedInputs = {0, 1, 2, 0, 1, 2, 0, 1};
+            CHECK(tags == expectedTags);
+            CHECK(inputs == expectedInputs);
+            CHECK(merger.stats().packetsMerged == 8);
+            CHECK(merger.stats().outOfOrder == 0);
+            CHECK_FALSE(merger.getNextPacket(view));
+        }
+
+        pcpp::CaptureMerger merger;
+        CHECK_FALSE(merger.open({files[0], files[0] + ".missing"}));
+        CHECK(merger.inputCount() == 0);
+        REQUIRE(merger.open({}));
+        pcpp::RawPacket raw;
+        CHECK_FALSE(merger.getNextPacket(raw));
+        removeAll(files);
+    }
+
+    TEST_CASE("frames seen on another tap within the window are dropped") {
+        std::vector<std::string> files = {tempPath("tap_a.pcap"), tempPath("tap_b.pcap")};
+        // Tap B sees 1 and 2 slightly later, 3 too late to be a copy, and 4
+        // never; tap A repeats 5 itself
+        writePcap(files[0], {{tagged(1), 20, 0}, {tagged(2), 20, 100}, {tagged(3), 20, 200},
+                             {tagged(5), 20, 300}, {tagged(5), 20, 310}, {tagged(4), 20, 400}});
+        writePcap(files[1], {{tagged(1), 20, 40}, {tagged(2), 20, 900}, {tagged(3), 21, 0}});
+
+        pcpp::CaptureMerger::Options options;
+        options.dropDuplicates = true;
+        options.dedupWindowUsec = 1000;
+        pcpp::CaptureMerger merger;
+        REQUIRE(merger.open(files, options));
+        std::vector<uint16_t> tags;
+        pcpp::RawPacket raw;
+        while (merger.getNextPacket(raw)) tags.push_back(pcpp::detail::loadBE16(raw.data.data() + 34));
+        std::vector<uint16_t> expected = {1, 2, 3, 5, 5, 4, 3};
+        CHECK(tags == expected);
+        CHECK(merger.stats().packetsRead == 9);
+        CHECK(merger.stats().duplicates == 2);
+
+        // Same length, different bytes: not a duplicate
+        auto other = tagged(1);
+        other[20] ^= 1;
+        writePcap(files[1], {{other, 20, 10}});
+        REQUIRE(merger.open(files, options));
+        while (merger.getNextPacket(raw)) {}
+        CHECK(merger.stats().duplicates == 0);
+
+        // The remembered set is capped: with room for one frame, 1 is
+        // forgotten by the time its copy arrives
+        writePcap(files[1], {{tagged(1), 20, 150}});
+        options.dedupMaxEntries = 1;
+        REQUIRE(merger.open(files, options));
+        while (merger.getNextPacket(raw)) {}
+        CHECK(merger.stats().duplicates == 0);
+        options.dedupMaxEntries = 4;
+        REQUIRE(merger.open(files, options));
+        while (merger.getNextPacket(raw)) {}
+        CHECK(merger.stats().duplicates == 1);
+        removeAll(files);
+    }
+
+    TEST_CASE("mergeCaptures writes the merged stream through the writer") {
+        std::vector<std::string> files = {tempPath("merge_in_a.pcap"), tempPath("merge_in_b.pcap")};
+        std::string out = tempPath("merge_out.pcap");
+        writePcap(files[0], {{tagged(1), 30, 0}, {tagged(3), 30, 20}});
+        writePcap(files[1], {{tagged(2), 30, 10}, {tagged(3), 30, 25}, {arp(), 31, 0}});
+
+        pcpp::CaptureMerger::Options options;
+        options.dropDuplicates = true;
+        auto stats = pcpp::mergeCaptures(files, out, options);
+        REQUIRE(stats);
+        CHECK(stats->packetsMerged == 4);
+        CHECK(stats->duplicates == 1);
+
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(out));
+        REQUIRE(reader->open());
+        std::vector<uint32_t> usecs;
+        pcpp::RawPacketView view;
+        while (reader->getNextPacket(view)) usecs.push_back(view.timestamp_usec);
+        std::vector<uint32_t> expected = {0, 10, 20, 0};
+        CHECK(usecs == expected);
+        reader->close();
+
+        // Mixed link types only fit PCAPNG
+        writePcap(files[1], {{tagged(2), 30, 10}}, 101);
+        CHECK_FALSE(pcpp::mergeCaptures(files, out));
+        pcpp::WriterOptions writerOptions;
+        writerOptions.format = pcpp::CaptureFormat::PcapNG;
+        stats = pcpp::mergeCaptures(files, out, pcpp::CaptureMerger::Options{}, writerOptions);
+        REQUIRE(stats);
+        CHECK(stats->packetsMerged == 3);
+        CHECK_FALSE(pcpp::mergeCaptures({files[0], out + ".missing"}, out));
+        removeAll(files);
+        std::remove(out.c_str());
+    }
+}
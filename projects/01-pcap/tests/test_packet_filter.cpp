@@ -0,0 +1,177 @@
+/**
+ * Tests for PacketFilter: expression parsing, primitive semantics, and
+ * filtering inside IFileReaderDevice.
+ */
+#include <doctest/doctest.h>
+#include <PcapFilter.h>
+
+#include "capture_builder.h"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+std::vector<uint8_t> v6(uint8_t last) {
+    std::vector<uint8_t> a(16, 0);
+    a[0] = 0x20;
+    a[1] = 0x01;
+    a[2] = 0x0d;
+    a[3] = 0xb8;
+    a[15] = last;
+    return a;
+}
+
+pcpp::RawPacket makeRaw(std::vector<uint8_t> frame, uint32_t linkType = 1) {
+    pcpp::RawPacket raw;
+    raw.data = std::move(frame);
+    raw.linkType = linkType;
+    return raw;
+}
+
+bool matches(const std::string& expression, const pcpp::RawPacket& raw) {
+    std::string error;
+    auto filter = pcpp::PacketFilter::compile(expression, &error);
+    INFO(expression << ": " << error);
+    REQUIRE(filter.has_value());
+    return filter->matches(raw);
+}
+
+} // namespace
+
+TEST_SUITE("Packet filter") {
+    TEST_CASE("protocol keywords agree with isPacketOfType") {
+        std::mt19937 rng(3);
+        std::vector<pcpp::RawPacket> packets = {
+            makeRaw(ipv4(1, 2, 6, tcp(1, 2, 3, 4, 0))),
+            makeRaw(ipv4(1, 2, 17, udp(1, 2, 3))),
+            makeRaw(ipv4(1, 2, 1, {8, 0, 0, 0})),
+            makeRaw(ipv6(v6(1), v6(2), 58, {128, 0, 0, 0})),
+            makeRaw(ipv6(v6(1), v6(2), 6, tcp(1, 2, 3, 4, 0))),
+            makeRaw(arp()),
+        };
+        for (size_t i = 0; i < 2000; ++i) {
+            auto raw = packets[rng() % 6];
+            raw.data.resize(rng() % (raw.data.size() + 1));
+            if (rng() % 4 == 0) raw.linkType = 113;
+            packets.push_back(raw);
+        }
+
+        const std::pair<const char*, pcpp::ProtocolType> keywords[] = {
+            {"ether", pcpp::Ethernet}, {"ip", pcpp::IPv4}, {"ip6", pcpp::IPv6}, {"arp", pcpp::ARP},
+            {"tcp", pcpp::TCP},        {"udp", pcpp::UDP},
+        };
+        for (const auto& [word, type] : keywords) {
+            auto filter = pcpp::PacketFilter::compile(word);
+            REQUIRE(filter);
+            size_t mismatches = 0;
+            for (const auto& raw : packets) {
+                if (filter->matches(raw) != pcpp::Packet(&raw).isPacketOfType(type)) ++mismatches;
+            }
+            CHECK_MESSAGE(mismatches == 0, word);
+        }
+    }
+
+    TEST_CASE("hosts, nets and ports") {
+        auto dns = makeRaw(ipv4(0x0A010203, 0xC0A80001, 17, udp(5353, 53, 10)));
+        CHECK(matches("udp", dns));
+        CHECK(matches("udp and dst port 53 and net 10.0.0.0/8", dns));
+        CHECK(matches("src net 10.1.0.0/16", dns));
+        CHECK_FALSE(matches("dst net 10.0.0.0/8", dns));
+        CHECK(matches("host 192.168.0.1", dns));
+        CHECK(matches("dst 192.168.0.1", dns));
+        CHECK_FALSE(matches("src host 192.168.0.1", dns));
+        CHECK(matches("port 5353", dns));
+        CHECK_FALSE(matches("dst port 5353", dns));
+        CHECK(matches("udp src port 5353", dns));
+        CHECK_FALSE(matches("tcp port 53", dns));
+        CHECK(matches("portrange 50-60", dns));
+        CHECK_FALSE(matches("src portrange 50-60", dns));
+        CHECK(matches("net 10.1.2.3", dns));
+        CHECK_FALSE(matches("net 10.1.2.4", dns));
+        CHECK(matches("net 10.0.0.0/7", dns));  // 10/7 covers 10.x and 11.x
+        CHECK(matches("net 0.0.0.0/0", dns));
+        CHECK_FALSE(matches("net ::/0", dns));  // Address family must match
+        CHECK(matches("ip host 10.1.2.3", dns));
+        CHECK(matches("ip src host 10.1.2.3", dns));
+        CHECK_FALSE(matches("ip dst host 10.1.2.3", dns));
+        CHECK(matches("ip dst 192.168.0.1 and udp", dns));
+        CHECK(matches("ip net 10.0.0.0/8 or tcp", dns));
+        CHECK_FALSE(matches("not ip src net 10.0.0.0/8", dns));
+
+        auto web6 = makeRaw(ipv6(v6(1), v6(2), 6, tcp(443, 50000, 1, 2, pcpp::TCPView::ACK)));
+        CHECK(matches("ip6 and tcp src port 443", web6));
+        CHECK(matches("src host 2001:db8::1", web6));
+        CHECK(matches("dst host 2001:DB8:0:0:0:0:0:2", web6));
+        CHECK(matches("net 2001:db8::/32", web6));
+        CHECK_FALSE(matches("net 2001:db9::/32", web6));
+        CHECK(matches("ip6 net 2001:db8::/32", web6));
+        CHECK(matches("ip6 dst host 2001:db8::2", web6));
+        CHECK_FALSE(matches("ip6 src net 2001:db9::/32", web6));
+        CHECK_FALSE(matches("ip", web6));
+        CHECK_FALSE(matches("icmp6", web6));
+    }
+
+    TEST_CASE("boolean operators follow pcap-filter precedence") {
+        auto udp53 = makeRaw(ipv4(1, 2, 17, udp(53, 53, 0)));
+        CHECK(matches("not tcp", udp53));
+        CHECK(matches("! tcp && udp", udp53));
+        CHECK(matches("tcp or udp", udp53));
+        CHECK(matches("tcp || (udp && port 53)", udp53));
+        CHECK_FALSE(matches("not (tcp or udp)", udp53));
+        // and/or are left-associative with equal precedence:
+        // "udp or tcp and arp" is "(udp or tcp) and arp"
+        CHECK_FALSE(matches("udp or tcp and arp", udp53));
+        CHECK(matches("udp or (tcp and arp)", udp53));
+        CHECK(matches("less 100", udp53));
+        CHECK(matches("greater 42 and less 42", udp53));
+        CHECK(matches("", udp53));
+    }
+
+    TEST_CASE("syntax errors are reported") {
+        for (const char* bad : {"udp and", "port", "port 70000", "net 10.0.0.0/33", "host 1.2.3",
+                                "portrange 9-1", "(udp", "udp)", "arp port 1", "frobnicate", "tcp src 1.2.3.4",
+                                "host 1:2:3:4:5:6:7:8:9", "host 1::2::3", "src port x", "net 10.1.2.3/8",
+                                "net 11.0.0.0/7", "net 2001:db8::1/64", "ip host 2001:db8::1",
+                                "ip6 net 10.0.0.0/8", "tcp host 1.2.3.4", "arp src 1.2.3.4", "ip port 80",
+                                "ip src"}) {
+            std::string error;
+            CHECK_MESSAGE(!pcpp::PacketFilter::compile(bad, &error).has_value(), bad);
+            CHECK_MESSAGE(!error.empty(), bad);
+        }
+    }
+
+    TEST_CASE("the reader skips rejected records in both modes") {
+        auto records = sampleRecords();  // UDP 5000->9999, TCP, ARP, UDP 53->53
+        std::string path = tempPath("filter.pcap");
+        writePcap(path, records);
+
+        auto filter = pcpp::PacketFilter::compile("udp and dst port 9999 and net 10.0.0.0/8");
+        REQUIRE(filter);
+        for (auto mode : {pcpp::ReadMode::Stream, pcpp::ReadMode::MemoryMapped}) {
+            std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path, mode));
+            REQUIRE(reader);
+            REQUIRE(reader->open());
+            reader->setFilter(*filter);
+
+            pcpp::RawPacket raw;
+            REQUIRE(reader->getNextPacket(raw));
+            CHECK(raw.data == records[0].frame);
+            CHECK_FALSE(reader->getNextPacket(raw));
+        }
+
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path));
+        REQUIRE(reader->open());
+        reader->setFilter(*pcpp::PacketFilter::compile("not udp"));
+        pcpp::RawPacketView view;
+        size_t count = 0;
+        while (reader->getNextPacket(view)) ++count;
+        CHECK(count == 2);
+        reader->close();
+        std::remove(path.c_str());
+    }
+}
@@ -0,0 +1,184 @@
+/**
+ * Tests for the PCAPNG block walker: SPB/EPB/OPB packets, IDB options
+ * (if_tsresol, snaplen), ISB statistics, byte order and bounds.
+ */
+#include <doctest/doctest.h>
+#include <PcapReader.h>
+
+#include "capture_builder.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+std::vector<pcpp::RawPacket> readAll(const std::string& path, pcpp::ReadMode mode,
+                                     std::vector<pcpp::PcapNGInterface>* interfaces = nullptr) {
+    std::vector<pcpp::RawPacket> packets;
+    std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path, mode));
+    if (!reader || !reader->open()) return packets;
+    pcpp::RawPacket raw;
+    while (reader->getNextPacket(raw)) {
+        packets.push_back(raw);
+    }
+    if (interfaces) *interfaces = reader->getInterfaces();
+    return packets;
+}
+
+const pcpp::ReadMode kModes[] = {pcpp::ReadMode::Stream, pcpp::ReadMode::MemoryMapped};
+
+} // namespace
+
+TEST_SUITE("PCAPNG blocks") {
+    TEST_CASE("EPB timestamps honour if_tsresol per interface") {
+        auto frame = ipv4(0x0A000001, 0x0A000002, 17, udp(1, 2, 4));
+        std::vector<uint8_t> bytes;
+        appendSectionHeader(bytes);
+        appendInterface(bytes, 1);                 // Default: microseconds
+        appendInterface(bytes, 1, 65535, 9);       // Nanoseconds
+        appendInterface(bytes, 1, 65535, 0x80 | 10);  // 2^-10 seconds
+        appendEnhancedPacket(bytes, 0, 5000001ULL, frame);
+        appendEnhancedPacket(bytes, 1, 7123456789ULL, frame);
+        appendEnhancedPacket(bytes, 2, (3ULL << 10) | 512, frame);
+        std::string path = tempPath("blocks-tsresol.pcapng");
+        writeBytes(path, bytes);
+
+        for (auto mode : kModes) {
+            auto packets = readAll(path, mode);
+            REQUIRE(packets.size() == 3);
+            CHECK(packets[0].timestamp_sec == 5);
+            CHECK(packets[0].timestamp_usec == 1);
+            CHECK(packets[1].timestamp_sec == 7);
+            CHECK(packets[1].timestamp_usec == 123456);
+            CHECK(packets[2].timestamp_sec == 3);
+            CHECK(packets[2].timestamp_usec == 500000);
+        }
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("Simple Packet Blocks are truncated to the interface snaplen") {
+        auto frame = ipv4(0x0A000001, 0x0A000002, 17, udp(1, 2, 40));
+        std::vector<uint8_t> bytes;
+        appendSectionHeader(bytes);
+        appendInterface(bytes, 1, 34);
+        appendSimplePacket(bytes, frame);
+        std::string path = tempPath("blocks-spb.pcapng");
+        writeBytes(path, bytes);
+
+        for (auto mode : kModes) {
+            auto packets = readAll(path, mode);
+            REQUIRE(packets.size() == 1);
+            CHECK(packets[0].data == std::vector<uint8_t>(frame.begin(), frame.begin() + 34));
+            CHECK(pcpp::Packet(&packets[0]).isPacketOfType(pcpp::IPv4));
+        }
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("Interface Statistics Blocks update the interface table") {
+        std::vector<uint8_t> bytes;
+        appendSectionHeader(bytes);
+        appendInterface(bytes, 113, 262144, 9);
+        appendEnhancedPacket(bytes, 0, 1, arp());
+        appendInterfaceStatistics(bytes, 0, 1000, 7);
+        std::string path = tempPath("blocks-isb.pcapng");
+        writeBytes(path, bytes);
+
+        for (auto mode : kModes) {
+            std::vector<pcpp::PcapNGInterface> interfaces;
+            auto packets = readAll(path, mode, &interfaces);
+            CHECK(packets.size() == 1);
+            REQUIRE(interfaces.size() == 1);
+            CHECK(interfaces[0].linkType == 113);
+            CHECK(interfaces[0].snapLen == 262144);
+            CHECK(interfaces[0].tsResolution == 9);
+            CHECK(interfaces[0].hasStatistics);
+            CHECK(interfaces[0].packetsReceived == 1000);
+            CHECK(interfaces[0].packetsDropped == 7);
+        }
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("big-endian sections are decoded") {
+        auto frame = arp();
+        std::vector<uint8_t> bytes;
+        // SHB
+        put32be(bytes, 0x0A0D0D0A);
+        put32be(bytes, 28);
+        put32be(bytes, 0x1A2B3C4D);
+        put16be(bytes, 1);
+        put16be(bytes, 0);
+        put32be(bytes, 0xFFFFFFFF);
+        put32be(bytes, 0xFFFFFFFF);
+        put32be(bytes, 28);
+        // IDB
+        put32be(bytes, 1);
+        put32be(bytes, 20);
+        put16be(bytes, 1);
+        put16be(bytes, 0);
+        put32be(bytes, 65535);
+        put32be(bytes, 20);
+        // EPB
+        uint32_t epbLen = static_cast<uint32_t>(32 + frame.size());
+        put32be(bytes, 6);
+        put32be(bytes, epbLen);
+        put32be(bytes, 0);
+        put32be(bytes, 0);
+        put32be(bytes, 42000007);
+        put32be(bytes, static_cast<uint32_t>(frame.size()));
+        put32be(bytes, static_cast<uint32_t>(frame.size()));
+        bytes.insert(bytes.end(), frame.begin(), frame.end());
+        put32be(bytes, epbLen);
+        std::string path = tempPath("blocks-be.pcapng");
+        writeBytes(path, bytes);
+
+        for (auto mode : kModes) {
+            auto packets = readAll(path, mode);
+            REQUIRE(packets.size() == 1);
+            CHECK(packets[0].data == frame);
+            CHECK(packets[0].timestamp_sec == 42);
+            CHECK(packets[0].timestamp_usec == 7);
+            CHECK(pcpp::Packet(&packets[0]).isPacketOfType(pcpp::ARP));
+        }
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("long runs of non-packet blocks do not grow the stack") {
+        std::vector<uint8_t> bytes;
+        appendSectionHeader(bytes);
+        appendInterface(bytes, 1);
+        for (int i = 0; i < 200000; ++i) {
+            appendInterfaceStatistics(bytes, 0, static_cast<uint64_t>(i), 0);
+        }
+        appendEnhancedPacket(bytes, 0, 1, arp());
+        std::string path = tempPath("blocks-many.pcapng");
+        writeBytes(path, bytes);
+
+        for (auto mode : kModes) {
+            std::vector<pcpp::PcapNGInterface> interfaces;
+            CHECK(readAll(path, mode, &interfaces).size() == 1);
+            REQUIRE(interfaces.size() == 1);
+            CHECK(interfaces[0].packetsReceived == 199999);
+        }
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("corrupt block lengths stop the walk") {
+        std::vector<uint8_t> bytes;
+        appendSectionHeader(bytes);
+        appendInterface(bytes, 1);
+        appendEnhancedPacket(bytes, 0, 1, arp());
+        put32le(bytes, 6);
+        put32le(bytes, 0xFFFFFFF0);  // Way past kMaxBlockLength
+        bytes.resize(bytes.size() + 64, 0);
+        std::string path = tempPath("blocks-corrupt.pcapng");
+        writeBytes(path, bytes);
+
+        for (auto mode : kModes) {
+            CHECK(readAll(path, mode).size() == 1);
+        }
+        std::remove(path.c_str());
+    }
+}
@@ -0,0 +1,231 @@
+/**
+ * Tests for IFileReaderDevice stream, memory-mapped and prefetch reading.
+ *
+ * Uses synthetic captures from capture_builder.h, so these run without the
+ * course PCAP being downloaded.
+ */
+#include <doctest/doctest.h>
+#include <PcapReader.h>
+
+#include "capture_builder.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace {
+
+std::vector<pcpp::RawPacket> readAll(const std::string& path, pcpp::ReadMode mode) {
+    std::vector<pcpp::RawPacket> packets;
+    std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path, mode));
+    if (!reader || !reader->open()) return packets;
+    pcpp::RawPacket raw;
+    while (reader->getNextPacket(raw)) {
+        packets.push_back(raw);
+    }
+    return packets;
+}
+
+} // namespace
+
+TEST_SUITE("Reader modes") {
+    TEST_CASE("memory-mapped mode is selected for existing files") {
+        std::string path = capture_builder::tempPath("modes-select.pcap");
+        capture_builder::writePcap(path, capture_builder::sampleRecords());
+
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(
+            pcpp::IFileReaderDevice::getReader(path, pcpp::ReadMode::MemoryMapped));
+        REQUIRE(reader != nullptr);
+        CHECK(reader->getReadMode() == pcpp::ReadMode::MemoryMapped);
+        CHECK(reader->open());
+
+        std::unique_ptr<pcpp::IFileReaderDevice> missing(
+            pcpp::IFileReaderDevice::getReader(path + ".missing", pcpp::ReadMode::MemoryMapped));
+        CHECK(missing == nullptr);
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("classic PCAP reads identically in all modes") {
+        auto records = capture_builder::sampleRecords();
+        std::string path = capture_builder::tempPath("modes.pcap");
+        capture_builder::writePcap(path, records);
+
+        auto streamed = readAll(path, pcpp::ReadMode::Stream);
+        auto mapped = readAll(path, pcpp::ReadMode::MemoryMapped);
+        auto prefetched = readAll(path, pcpp::ReadMode::Prefetch);
+        REQUIRE(streamed.size() == records.size());
+        REQUIRE(mapped.size() == records.size());
+        REQUIRE(prefetched.size() == records.size());
+        for (size_t i = 0; i < records.size(); ++i) {
+            CHECK(streamed[i].data == records[i].frame);
+            CHECK(mapped[i].data == records[i].frame);
+            CHECK(prefetched[i].data == records[i].frame);
+            CHECK(prefetched[i].timestamp_usec == records[i].usec);
+            CHECK(mapped[i].timestamp_sec == records[i].sec);
+            CHECK(mapped[i].timestamp_usec == records[i].usec);
+            CHECK(streamed[i].timestamp_usec == records[i].usec);
+            CHECK(mapped[i].linkType == 1);
+        }
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("PCAPNG reads identically in all modes") {
+        auto records = capture_builder::sampleRecords();
+        std::string path = capture_builder::tempPath("modes.pcapng");
+        capture_builder::writePcapNG(path, records, 113);
+
+        auto streamed = readAll(path, pcpp::ReadMode::Stream);
+        auto mapped = readAll(path, pcpp::ReadMode::MemoryMapped);
+        auto prefetched = readAll(path, pcpp::ReadMode::Prefetch);
+        REQUIRE(streamed.size() == records.size());
+        REQUIRE(mapped.size() == records.size());
+        REQUIRE(prefetched.size() == records.size());
+        for (size_t i = 0; i < records.size(); ++i) {
+            CHECK(streamed[i].data == records[i].frame);
+            CHECK(mapped[i].data == records[i].frame);
+            CHECK(prefetched[i].data == records[i].frame);
+            CHECK(prefetched[i].linkType == 113);
+            CHECK(mapped[i].linkType == 113);
+            CHECK(mapped[i].timestamp_sec == records[i].sec);
+            CHECK(streamed[i].timestamp_usec == records[i].usec);
+        }
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("views point into the mapping and parse like owned packets") {
+        auto records = capture_builder::sampleRecords();
+        std::string path = capture_builder::tempPath("modes-view.pcapng");
+        capture_builder::writePcapNG(path, records);
+
+        for (auto mode : {pcpp::ReadMode::Stream, pcpp::ReadMode::MemoryMapped, pcpp::ReadMode::Prefetch}) {
+            std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path, mode));
+            REQUIRE(reader != nullptr);
+            REQUIRE(reader->open());
+
+            pcpp::RawPacketView view;
+            size_t i = 0;
+            while (reader->getNextPacket(view)) {
+                REQUIRE(i < records.size());
+                CHECK(std::vector<uint8_t>(view.getData(), view.getData() + view.getDataLen()) == records[i].frame);
+
+                pcpp::RawPacket owned;
+                owned.data = records[i].frame;
+                pcpp::Packet fromView(view);
+                pcpp::Packet fromOwned(&owned);
+                for (auto type : {pcpp::Ethernet, pcpp::IPv4, pcpp::IPv6, pcpp::ARP, pcpp::TCP, pcpp::UDP, pcpp::ICMP}) {
+                    CHECK(fromView.isPacketOfType(type) == fromOwned.isPacketOfType(type));
+                }
+                ++i;
+            }
+            CHECK(i == records.size());
+        }
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("truncated capture stops cleanly") {
+        auto records = capture_builder::sampleRecords();
+        std::string path = capture_builder::tempPath("modes-truncated.pcap");
+        capture_builder::writePcap(path, records);
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 5);
+
+        CHECK(readAll(path, pcpp::ReadMode::Stream).size() == records.size() - 1);
+        CHECK(readAll(path, pcpp::ReadMode::MemoryMapped).size() == records.size() - 1);
+        CHECK(readAll(path, pcpp::ReadMode::Prefetch).size() == records.size() - 1);
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("corrupt record length stops cleanly") {
+        // A record header claiming ~3.75 GB must not be allocated or read
+        auto records = capture_builder::sampleRecords();
+        std::string path = capture_builder::tempPath("modes-corrupt.pcap");
+        capture_builder::writePcap(path, records);
+        {
+            std::vector<uint8_t> bogus;
+            capture_builder::put32le(bogus, 1);
+            capture_builder::put32le(bogus, 0);
+            capture_builder::put32le(bogus, 0xF0000000);
+            capture_builder::put32le(bogus, 0xF0000000);
+            bogus.resize(bogus.size() + 64, 0xAB);
+            std::ofstream(path, std::ios::binary | std::ios::app)
+                .write(reinterpret_cast<const char*>(bogus.data()), static_cast<std::streamsize>(bogus.size()));
+        }
+
+        CHECK(readAll(path, pcpp::ReadMode::Stream).size() == records.size());
+        CHECK(readAll(path, pcpp::ReadMode::MemoryMapped).size() == records.size());
+        CHECK(readAll(path, pcpp::ReadMode::Prefetch).size() == records.size());
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("prefetch handles records split across read-ahead buffers") {
+        // ~14 MB: several full ring buffers, with records straddling each boundary
+        std::vector<capture_builder::Record> records;
+        for (uint32_t i = 0; i < 9000; ++i) {
+            records.push_back({capture_builder::ipv4(i, 2, 17, capture_builder::udp(1, 2, (i * 7919) % 3000)), i, i});
+        }
+        for (bool pcapng : {false, true}) {
+            CAPTURE(pcapng);
+            std::string path = capture_builder::tempPath(pcapng ? "modes-big.pcapng" : "modes-big.pcap");
+            if (pcapng) {
+                capture_builder::writePcapNG(path, records);
+            } else {
+                capture_builder::writePcap(path, records);
+            }
+            REQUIRE(std::filesystem::file_size(path) > 3 * pcpp::PrefetchStream::kBufferSize);
+
+            auto prefetched = readAll(path, pcpp::ReadMode::Prefetch);
+            REQUIRE(prefetched.size() == records.size());
+            size_t mismatches = 0;
+            for (size_t i = 0; i < records.size(); ++i) {
+                if (prefetched[i].data != records[i].frame || prefetched[i].timestamp_sec != records[i].sec) {
+                    ++mismatches;
+                }
+            }
+            CHECK(mismatches == 0);
+
+            // Closing mid-file stops the producer thread
+            std::unique_ptr<pcpp::IFileReaderDevice> reader(
+                pcpp::IFileReaderDevice::getReader(path, pcpp::ReadMode::Prefetch));
+            REQUIRE(reader->open());
+            pcpp::RawPacketView view;
+            for (int i = 0; i < 10; ++i) REQUIRE(reader->getNextPacket(view));
+            reader->close();
+            CHECK_FALSE(reader->getNextPacket(view));
+            std::remove(path.c_str());
+        }
+    }
+
+    TEST_CASE("prefetch restarts and stops at any point in a large capture") {
+        // Larger than the whole ring, so the producer is stopped both while
+        // it waits on a full ring and while it is still filling one
+        std::vector<capture_builder::Record> records;
+        for (uint32_t i = 0; i < 12000; ++i) {
+            records.push_back({capture_builder::ipv4(i, 2, 17, capture_builder::udp(1, 2, 1400)), i, i});
+        }
+        std::string path = capture_builder::tempPath("modes-restart.pcap");
+        capture_builder::writePcap(path, records);
+        REQUIRE(std::filesystem::file_size(path) > pcpp::PrefetchStream::kSlots * pcpp::PrefetchStream::kBufferSize);
+
+        for (int round = 0; round < 50; ++round) {
+            std::unique_ptr<pcpp::IFileReaderDevice> reader(
+                pcpp::IFileReaderDevice::getReader(path, pcpp::ReadMode::Prefetch));
+            REQUIRE(reader->open());
+            if (round % 2) reader->close();  // Right after open, then again in the destructor
+        }
+
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(
+            pcpp::IFileReaderDevice::getReader(path, pcpp::ReadMode::Prefetch));
+        REQUIRE(reader->open());
+        pcpp::RawPacketView view;
+        size_t mismatches = 0;
+        for (uint64_t round = 0; round < 40; ++round) {
+            // Backwards seeks restart the producer from the first record
+            uint64_t target = (round * 7919) % records.size();
+            REQUIRE(reader->seekToPacket(target));
+            REQUIRE(reader->getNextPacket(view));
+            if (view.timestamp_sec != records[target].sec) ++mismatches;
+        }
+        CHECK(mismatches == 0);
+        reader->close();
+        std::remove(path.c_str());
+    }
+}
@@ -0,0 +1,490 @@
+/**
+ * Tests for IPReassembly and TcpReassembly: fragment ordering, overlaps,
+ * timeouts and memory caps, TCP reordering and retransmissions, and
+ * decoding the newline-delimited chat protocol (projects/04-chat) out of a
+ * capture with fragmented and reordered segments.
+ */
+#include <doctest/doctest.h>
+#include <PcapReassembly.h>
+
+#include "capture_builder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+constexpr uint32_t kClient = 0x0A000001;
+constexpr uint32_t kServer = 0x0A000002;
+constexpr uint16_t kChatPort = 9999;
+
+std::vector<uint8_t> v6(uint8_t last) {
+    std::vector<uint8_t> a(16, 0);
+    a[0] = 0x20;
+    a[1] = 0x01;
+    a[15] = last;
+    return a;
+}
+
+std::vector<uint8_t> bytes(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> out(n);
+    for (auto& b : out) b = static_cast<uint8_t>(rng());
+    return out;
+}
+
+pcpp::RawPacket makeRaw(std::vector<uint8_t> frame, uint32_t sec = 1) {
+    pcpp::RawPacket raw;
+    raw.data = std::move(frame);
+    raw.timestamp_sec = sec;
+    return raw;
+}
+
+// Split an unfragmented IPv4 frame into fragments carrying `step` bytes of
+// IP payload each (a multiple of 8)
+std::vector<std::vector<uint8_t>> fragmentIPv4(const std::vector<uint8_t>& frame, size_t step, uint16_t id) {
+    const size_t header = 14 + 20;
+    std::vector<std::vector<uint8_t>> out;
+    for (size_t at = 0; at < frame.size() - header; at += step) {
+        size_t n = std::min(step, frame.size() - header - at);
+        std::vector<uint8_t> f(frame.begin(), frame.begin() + header);
+        f.insert(f.end(), frame.begin() + static_cast<std::ptrdiff_t>(header + at),
+                 frame.begin() + static_cast<std::ptrdiff_t>(header + at + n));
+        uint16_t total = static_cast<uint16_t>(20 + n);
+        uint16_t flags = static_cast<uint16_t>(at / 8) | (header + at + n < frame.size() ? 0x2000 : 0);
+        f[16] = static_cast<uint8_t>(total >> 8);
+        f[17] = static_cast<uint8_t>(total);
+        f[18] = static_cast<uint8_t>(id >> 8);
+        f[19] = static_cast<uint8_t>(id);
+        f[20] = static_cast<uint8_t>(flags >> 8);
+        f[21] = static_cast<uint8_t>(flags);
+        out.push_back(std::move(f));
+    }
+    return out;
+}
+
+// Same for IPv6: a Fragment header goes after the fixed header
+std::vector<std::vector<uint8_t>> fragmentIPv6(const std::vector<uint8_t>& frame, size_t step, uint32_t id) {
+    const size_t header = 14 + 40;
+    uint8_t nextHeader = frame[14 + 6];
+    std::vector<std::vector<uint8_t>> out;
+    for (size_t at = 0; at < frame.size() - header; at += step) {
+        size_t n = std::min(step, frame.size() - header - at);
+        std::vector<uint8_t> f(frame.begin(), frame.begin() + header);
+        f[14 + 6] = 44;
+        uint16_t payload = static_cast<uint16_t>(8 + n);
+        f[14 + 4] = static_cast<uint8_t>(payload >> 8);
+        f[14 + 5] = static_cast<uint8_t>(payload);
+        f.push_back(nextHeader);
+        f.push_back(0);
+        put16be(f, static_cast<uint16_t>(at | (header + at + n < frame.size() ? 1 : 0)));
+        put32be(f, id);
+        f.insert(f.end(), frame.begin() + static_cast<std::ptrdiff_t>(header + at),
+                 frame.begin() + static_cast<std::ptrdiff_t>(header + at + n));
+        out.push_back(std::move(f));
+    }
+    return out;
+}
+
+// TCP segment with the given payload bytes
+std::vector<uint8_t> tcpSegment(uint32_t src, uint32_t dst, uint16_t sport, uint16_t dport, uint32_t seq,
+                                uint8_t flags, const std::string& payload = {}) {
+    auto l4 = tcp(sport, dport, seq, 0, flags);
+    l4.insert(l4.end(), payload.begin(), payload.end());
+    return ipv4(src, dst, 6, l4);
+}
+
+} // namespace
+
+TEST_SUITE("IP reassembly") {
+    TEST_CASE("IPv4 fragments in any order rebuild the datagram") {
+        auto original = ipv4(kClient, kServer, 17, udp(5000, 53, 3000));
+        std::copy_n(bytes(3000, 1).begin(), 3000, original.begin() + 42);
+        auto fragments = fragmentIPv4(original, 1480, 77);
+        REQUIRE(fragments.size() == 3);
+
+        std::mt19937 rng(5);
+        for (int round = 0; round < 6; ++round) {
+            std::shuffle(fragments.begin(), fragments.end(), rng);
+            pcpp::IPReassembly reassembly;
+            pcpp::RawPacket out;
+            CHECK(reassembly.process(makeRaw(fragments[0]), out) == pcpp::ReassemblyStatus::Buffered);
+            // An exact duplicate is ignored
+            CHECK(reassembly.process(makeRaw(fragments[0]), out) == pcpp::ReassemblyStatus::Buffered);
+            CHECK(reassembly.process(makeRaw(fragments[1]), out) == pcpp::ReassemblyStatus::Buffered);
+            REQUIRE(reassembly.process(makeRaw(fragments[2], 9), out) == pcpp::ReassemblyStatus::Reassembled);
+            CHECK(reassembly.size() == 0);
+            CHECK(reassembly.bytesInUse() == 0);
+            CHECK(out.timestamp_sec == 9);
+
+            // Same bytes as the original apart from id, flags and checksum
+            REQUIRE(out.data.size() == original.size());
+            CHECK(std::equal(out.data.begin() + 34, out.data.end(), original.begin() + 34));
+            CHECK(std::equal(out.data.begin(), out.data.begin() + 18, original.begin()));
+            pcpp::Packet packet(&out);
+            auto ip = packet.getLayer<pcpp::IPv4View>();
+            REQUIRE(ip);
+            CHECK_FALSE(ip->isFragment());
+            uint32_t sum = 0;
+            for (size_t i = 0; i < 20; i += 2) sum += pcpp::detail::loadBE16(ip->getData() + i);
+            while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+            CHECK(sum == 0xFFFF);
+            REQUIRE(packet.getLayer<pcpp::UDPView>());
+            CHECK(packet.getLayer<pcpp::UDPView>()->dstPort() == 53);
+        }
+    }
+
+    TEST_CASE("IPv6 fragments rebuild the datagram without the Fragment header") {
+        auto original = ipv6(v6(1), v6(2), 6, tcp(443, 50000, 1, 0, pcpp::TCPView::ACK, 2000));
+        auto fragments = fragmentIPv6(original, 1232, 0xDEADBEEF);
+        REQUIRE(fragments.size() == 2);
+
+        pcpp::IPReassembly reassembly;
+        pcpp::RawPacket out;
+        CHECK(reassembly.process(makeRaw(fragments[1]), out) == pcpp::ReassemblyStatus::Buffered);
+        REQUIRE(reassembly.process(makeRaw(fragments[0]), out) == pcpp::ReassemblyStatus::Reassembled);
+        CHECK(out.data == original);
+        CHECK(pcpp::Packet(&out).isPacketOfType(pcpp::TCP));
+
+        // Unfragmented packets pass through
+        CHECK(reassembly.process(makeRaw(original), out) == pcpp::ReassemblyStatus::NotFragment);
+        CHECK(reassembly.process(makeRaw(arp()), out) == pcpp::ReassemblyStatus::NotFragment);
+        CHECK(reassembly.stats().reassembled == 1);
+    }
+
+    TEST_CASE("overlapping and malformed fragments are dropped") {
+        auto original = ipv4(kClient, kServer, 17, udp(1, 2, 2000));
+        auto a = fragmentIPv4(original, 1000, 1);
+        auto b = fragmentIPv4(original, 808, 1);  // Different cut points, same datagram
+
+        pcpp::IPReassembly reassembly;
+        pcpp::RawPacket out;
+        CHECK(reassembly.process(makeRaw(a[0]), out) == pcpp::ReassemblyStatus::Buffered);
+        CHECK(reassembly.process(makeRaw(b[1]), out) == pcpp::ReassemblyStatus::Dropped);
+        CHECK(reassembly.stats().overlaps == 1);
+        CHECK(reassembly.size() == 0);
+
+        // The rest of the datagram alone never completes
+        CHECK(reassembly.process(makeRaw(a[1]), out) == pcpp::ReassemblyStatus::Buffered);
+        CHECK(reassembly.process(makeRaw(a[2]), out) == pcpp::ReassemblyStatus::Buffered);
+
+        // Non-final fragment that is not a multiple of 8 bytes
+        auto odd = fragmentIPv4(original, 1000, 2)[0];
+        odd.pop_back();
+        odd[17] -= 1;
+        CHECK(reassembly.process(makeRaw(odd), out) == pcpp::ReassemblyStatus::Dropped);
+
+        // Data past the final fragment's end
+        auto c = fragmentIPv4(original, 1000, 3);
+        CHECK(reassembly.process(makeRaw(c[1]), out) == pcpp::ReassemblyStatus::Buffered);
+        auto shortLast = fragmentIPv4(ipv4(kClient, kServer, 17, udp(1, 2, 100)), 1000, 3)[0];
+        shortLast[21] = 63;  // Last fragment at offset 504: payload would end at 612
+        CHECK(reassembly.process(makeRaw(shortLast), out) == pcpp::ReassemblyStatus::Dropped);
+        CHECK(reassembly.stats().malformed == 2);
+
+        // A fragment inside data already held, but not a repeat of one piece:
+        // [0,16) [16,32), then [8,24) with other bytes
+        auto d = fragmentIPv4(ipv4(kClient, kServer, 17, udp(1, 2, 32)), 16, 4);
+        REQUIRE(d.size() == 3);
+        auto straddle = d[1];
+        straddle[21] = 1;  // Offset 8
+        CHECK(reassembly.process(makeRaw(d[0]), out) == pcpp::ReassemblyStatus::Buffered);
+        CHECK(reassembly.process(makeRaw(d[1]), out) == pcpp::ReassemblyStatus::Buffered);
+        CHECK(reassembly.process(makeRaw(straddle), out) == pcpp::ReassemblyStatus::Dropped);
+        CHECK(reassembly.stats().overlaps == 2);
+        CHECK(reassembly.process(makeRaw(d[2]), out) == pcpp::ReassemblyStatus::Buffered);
+    }
+
+    TEST_CASE("incomplete datagrams time out") {
+        auto fragments = fragmentIPv4(ipv4(kClient, kServer, 17, udp(1, 2, 100)), 64, 9);
+        pcpp::IPReassembly::Options options;
+        options.timeoutUsec = 5'000'000;
+        pcpp::IPReassembly reassembly(options);
+        pcpp::RawPacket out;
+        CHECK(reassembly.process(makeRaw(fragments[0], 100), out) == pcpp::ReassemblyStatus::Buffered);
+        CHECK(reassembly.process(makeRaw(arp(), 104), out) == pcpp::ReassemblyStatus::NotFragment);
+        reassembly.expire(104'000'000);
+        CHECK(reassembly.size() == 1);
+        CHECK(reassembly.process(makeRaw(fragments[1], 106), out) == pcpp::ReassemblyStatus::Buffered);
+        CHECK(reassembly.stats().timedOut == 1);
+        CHECK(reassembly.size() == 1);
+    }
+
+    TEST_CASE("memory stays capped under a flood of incomplete datagrams") {
+        pcpp::IPReassembly::Options options;
+        options.maxBytes = 256 * 1024;
+        options.maxDatagrams = 1000;
+        pcpp::IPReassembly reassembly(options);
+        pcpp::RawPacket out;
+
+        // Each attack datagram claims a chunk near 64 KiB and never completes
+        auto bait = fragmentIPv4(ipv4(kClient, kServer, 17, udp(1, 2, 64000)), 1480, 0);
+        for (uint16_t id = 0; id < 5000; ++id) {
+            auto f = bait[id % 40 + 1];
+            f[18] = static_cast<uint8_t>(id >> 8);
+            f[19] = static_cast<uint8_t>(id);
+            reassembly.process(makeRaw(f), out);
+            REQUIRE(reassembly.bytesInUse() <= 256 * 1024 + 64 * pcpp::IPReassembly::kChunkSize);
+            REQUIRE(reassembly.size() <= 1000);
+        }
+        CHECK(reassembly.stats().evicted > 0);
+
+        // Genuine traffic still gets through
+        auto good = fragmentIPv4(ipv4(kServer, kClient, 17, udp(3, 4, 3000)), 1480, 1);
+        CHECK(reassembly.process(makeRaw(good[0]), out) == pcpp::ReassemblyStatus::Buffered);
+        CHECK(reassembly.process(makeRaw(good[1]), out) == pcpp::ReassemblyStatus::Buffered);
+        CHECK(reassembly.process(makeRaw(good[2]), out) == pcpp::ReassemblyStatus::Reassembled);
+    }
+}
+
+TEST_SUITE("TCP reassembly") {
+    TEST_CASE("reordered, duplicated and overlapping segments come out in order") {
+        std::string message;
+        for (int i = 0; i < 200; ++i) message += "line " + std::to_string(i) + "\n";
+
+        // 40-byte segments, some split differently to overlap their neighbours
+        std::vector<pcpp::RawPacket> packets;
+        packets.push_back(makeRaw(tcpSegment(kClient, kServer, 40000, kChatPort, 99, pcpp::TCPView::SYN)));
+        for (size_t at = 0; at < message.size(); at += 40) {
+            packets.push_back(makeRaw(tcpSegment(kClient, kServer, 40000, kChatPort, 100 + static_cast<uint32_t>(at),
+                                                 pcpp::TCPView::ACK, message.substr(at, 40))));
+            if (at % 200 == 0 && at >= 20) {
+                packets.push_back(makeRaw(tcpSegment(kClient, kServer, 40000, kChatPort,
+                                                     100 + static_cast<uint32_t>(at - 20), pcpp::TCPView::ACK,
+                                                     message.substr(at - 20, 50))));
+            }
+        }
+        std::mt19937 rng(17);
+        std::shuffle(packets.begin() + 1, packets.end(), rng);
+        packets.push_back(packets[3]);  // Late retransmission
+
+        std::string received;
+        uint64_t skipped = 0;
+        pcpp::TcpReassembly reassembly([&](const pcpp::TcpStreamData& chunk) {
+            CHECK(chunk.fromInitiator);
+            CHECK(chunk.offset == received.size());
+            received.append(reinterpret_cast<const char*>(chunk.data), chunk.length);
+            skipped += chunk.skipped;
+        });
+        for (const auto& p : packets) CHECK(reassembly.process(p));
+        reassembly.flush();
+
+        CHECK(received == message);
+        CHECK(skipped == 0);
+        CHECK(reassembly.stats().retransmits >= 1);
+        CHECK(reassembly.stats().outOfOrder > 0);
+        CHECK(reassembly.bytesInUse() == 0);
+    }
+
+    TEST_CASE("FIN on both sides closes the stream; RST resets it") {
+        std::vector<std::pair<bool, pcpp::TcpStreamEnd>> ends;
+        std::string toServer, toClient;
+        pcpp::TcpReassembly reassembly(
+            [&](const pcpp::TcpStreamData& chunk) {
+                (chunk.fromInitiator ? toServer : toClient)
+                    .append(reinterpret_cast<const char*>(chunk.data), chunk.length);
+            },
+            [&](const pcpp::FlowKey& key, pcpp::TcpStreamEnd reason) { ends.push_back({key.portB == 9999, reason}); });
+
+        using pcpp::TCPView;
+        // Server's first packet is seen before the client's SYN
+        reassembly.process(makeRaw(tcpSegment(kServer, kClient, kChatPort, 40000, 500, TCPView::SYN | TCPView::ACK)));
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 40000, kChatPort, 10, TCPView::SYN)));
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 40000, kChatPort, 11, TCPView::ACK, "hi\n")));
+        reassembly.process(makeRaw(tcpSegment(kServer, kClient, kChatPort, 40000, 501, TCPView::ACK, "ok\n")));
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 40000, kChatPort, 14, TCPView::FIN | TCPView::ACK)));
+        CHECK(ends.empty());
+        reassembly.process(makeRaw(tcpSegment(kServer, kClient, kChatPort, 40000, 504, TCPView::FIN | TCPView::ACK)));
+        REQUIRE(ends.size() == 1);
+        CHECK(ends[0].second == pcpp::TcpStreamEnd::Closed);
+        CHECK(toServer == "hi\n");
+        CHECK(toClient == "ok\n");
+        CHECK(reassembly.size() == 0);
+
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 40001, kChatPort, 1, TCPView::ACK, "a")));
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 40001, kChatPort, 5, TCPView::ACK, "b")));
+        reassembly.process(makeRaw(tcpSegment(kServer, kClient, kChatPort, 40001, 9, TCPView::RST)));
+        REQUIRE(ends.size() == 2);
+        CHECK(ends[1].second == pcpp::TcpStreamEnd::Reset);
+        CHECK(toServer == "hi\nab");  // Buffered data is delivered before the end
+    }
+
+    TEST_CASE("a direction gives up on its oldest gap when over its cap") {
+        pcpp::TcpReassembly::Options options;
+        options.maxBytesPerDirection = 4096;
+        std::string received;
+        std::vector<uint64_t> skips;
+        pcpp::TcpReassembly reassembly(options, [&](const pcpp::TcpStreamData& chunk) {
+            received.append(reinterpret_cast<const char*>(chunk.data), chunk.length);
+            if (chunk.skipped) skips.push_back(chunk.skipped);
+        });
+
+        std::string block(1000, 'x');
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 1, 2, 0, pcpp::TCPView::ACK, block)));
+        // Bytes 1000..1999 are lost; keep sending after the hole
+        for (uint32_t seq = 2000; seq < 20000; seq += 1000) {
+            reassembly.process(makeRaw(tcpSegment(kClient, kServer, 1, 2, seq, pcpp::TCPView::ACK, block)));
+            REQUIRE(reassembly.bytesInUse() <= 8 * pcpp::TcpReassembly::kChunkSize + 4096);
+        }
+        REQUIRE(skips.size() == 1);
+        CHECK(skips[0] == 1000);
+        CHECK(received.size() >= 14000);
+        CHECK(reassembly.stats().skippedBytes == 1000);
+        reassembly.flush();
+        CHECK(received.size() == 19000);
+    }
+
+    TEST_CASE("a full direction skips only up to an earlier incoming segment") {
+        pcpp::TcpReassembly::Options options;
+        options.maxBytesPerDirection = 1000;
+        std::string received;
+        std::vector<uint64_t> skips;
+        pcpp::TcpReassembly reassembly(options, [&](const pcpp::TcpStreamData& chunk) {
+            received.append(reinterpret_cast<const char*>(chunk.data), chunk.length);
+            if (chunk.skipped) skips.push_back(chunk.skipped);
+        });
+
+        using pcpp::TCPView;
+        std::string first(1000, 'a'), middle(300, 'b'), last(800, 'c');
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 1, 2, 0, TCPView::ACK, first)));
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 1, 2, 1800, TCPView::ACK, last)));
+        // No room for it, but it comes before the buffered segment
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 1, 2, 1500, TCPView::ACK, middle)));
+
+        CHECK(received == first + middle + last);
+        REQUIRE(skips.size() == 1);
+        CHECK(skips[0] == 500);
+        CHECK(reassembly.stats().skippedBytes == 500);
+        CHECK(reassembly.stats().retransmits == 0);
+        CHECK(reassembly.bytesInUse() == 0);
+    }
+
+    TEST_CASE("snaplen-truncated segments skip their missing tails") {
+        std::string received;
+        std::vector<uint64_t> offsets, skips;
+        std::vector<pcpp::TcpStreamEnd> ends;
+        pcpp::TcpReassembly reassembly(
+            [&](const pcpp::TcpStreamData& chunk) {
+                CHECK(chunk.fromInitiator);
+                received.append(reinterpret_cast<const char*>(chunk.data), chunk.length);
+                offsets.push_back(chunk.offset);
+                skips.push_back(chunk.skipped);
+            },
+            [&](const pcpp::FlowKey&, pcpp::TcpStreamEnd reason) { ends.push_back(reason); });
+
+        // As with tcpdump -s 154: 100 of every 1000 payload bytes are captured
+        auto truncated = [](std::vector<uint8_t> frame) {
+            frame.resize(14 + 20 + 20 + 100);
+            return makeRaw(std::move(frame));
+        };
+        using pcpp::TCPView;
+        std::vector<pcpp::RawPacket> packets;
+        std::string expected;
+        for (uint32_t i = 0; i < 100; ++i) {
+            std::string block(1000, static_cast<char>('a' + i % 26));
+            expected += block.substr(0, 100);
+            packets.push_back(truncated(tcpSegment(kClient, kServer, 40000, kChatPort, i * 1000, TCPView::ACK, block)));
+        }
+        std::swap(packets[50], packets[51]);  // One truncated segment waits in the buffer
+        for (const auto& p : packets) reassembly.process(p);
+
+        CHECK(received == expected);
+        REQUIRE(offsets.size() == 100);
+        for (size_t i = 0; i < 100; ++i) {
+            CHECK(offsets[i] == i * 1000);
+            CHECK(skips[i] == (i == 0 ? 0 : 900));
+        }
+        CHECK(reassembly.stats().outOfOrder == 1);
+        CHECK(reassembly.stats().skippedBytes == 100 * 900);
+        CHECK(reassembly.bytesInUse() == 0);
+
+        reassembly.process(makeRaw(tcpSegment(kClient, kServer, 40000, kChatPort, 100000, TCPView::FIN | TCPView::ACK)));
+        CHECK(ends.empty());
+        reassembly.process(makeRaw(tcpSegment(kServer, kClient, kChatPort, 40000, 7, TCPView::FIN | TCPView::ACK)));
+        REQUIRE(ends.size() == 1);
+        CHECK(ends[0] == pcpp::TcpStreamEnd::Closed);
+    }
+
+    TEST_CASE("chat messages decode from a capture with fragments and reordering") {
+        using pcpp::TCPView;
+        const std::vector<std::string> clientLines = {"alice", "hello everyone", "/msg bob " + std::string(2500, 'z'),
+                                                      "/quit"};
+        const std::vector<std::string> serverLines = {"[Server]: Welcome alice", "[bob]: hi alice",
+                                                      "[Server]: Goodbye"};
+
+        std::vector<Record> records;
+        uint32_t t = 0;
+        auto add = [&](std::vector<uint8_t> frame) { records.push_back({std::move(frame), 1000, t++}); };
+        add(tcpSegment(kClient, kServer, 40000, kChatPort, 1000, TCPView::SYN));
+        add(tcpSegment(kServer, kClient, kChatPort, 40000, 7000, TCPView::SYN | TCPView::ACK));
+
+        uint32_t clientSeq = 1001, serverSeq = 7001;
+        std::vector<std::vector<uint8_t>> delayed;
+        for (size_t i = 0; i < clientLines.size(); ++i) {
+            std::string line = clientLines[i] + "\n";
+            auto segment = tcpSegment(kClient, kServer, 40000, kChatPort, clientSeq, TCPView::ACK | TCPView::PSH, line);
+            clientSeq += static_cast<uint32_t>(line.size());
+            if (line.size() > 1480) {
+                // Fragmented on the way, last fragment first
+                auto fragments = fragmentIPv4(segment, 1480, 0x4242);
+                for (size_t f = fragments.size(); f-- > 0;) add(fragments[f]);
+            } else if (i == 1) {
+                delayed.push_back(segment);  // Overtaken by the next segments
+            } else {
+                add(segment);
+            }
+            if (i < serverLines.size()) {
+                std::string reply = serverLines[i] + "\n";
+                add(tcpSegment(kServer, kClient, kChatPort, 40000, serverSeq, TCPView::ACK | TCPView::PSH, reply));
+                serverSeq += static_cast<uint32_t>(reply.size());
+            }
+        }
+        for (auto& segment : delayed) add(segment);
+        add(tcpSegment(kClient, kServer, 40000, kChatPort, clientSeq, TCPView::FIN | TCPView::ACK));
+        add(tcpSegment(kServer, kClient, kChatPort, 40000, serverSeq, TCPView::FIN | TCPView::ACK));
+
+        std::string path = tempPath("chat.pcap");
+        writePcap(path, records);
+
+        std::map<bool, std::string> streams;
+        std::map<bool, std::vector<std::string>> lines;
+        int closed = 0;
+        pcpp::TcpReassembly tcpReassembly(
+            [&](const pcpp::TcpStreamData& chunk) {
+                std::string& buffer = streams[chunk.fromInitiator];
+                buffer.append(reinterpret_cast<const char*>(chunk.data), chunk.length);
+                for (size_t nl; (nl = buffer.find('\n')) != std::string::npos; buffer.erase(0, nl + 1)) {
+                    lines[chunk.fromInitiator].push_back(buffer.substr(0, nl));
+                }
+            },
+            [&](const pcpp::FlowKey&, pcpp::TcpStreamEnd reason) { closed += reason == pcpp::TcpStreamEnd::Closed; });
+        pcpp::IPReassembly ipReassembly;
+
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path));
+        REQUIRE(reader);
+        REQUIRE(reader->open());
+        pcpp::RawPacketView view;
+        pcpp::RawPacket whole;
+        while (reader->getNextPacket(view)) {
+            switch (ipReassembly.process(view, whole)) {
+                case pcpp::ReassemblyStatus::NotFragment: tcpReassembly.process(view); break;
+                case pcpp::ReassemblyStatus::Reassembled: tcpReassembly.process(whole); break;
+                default: break;
+            }
+        }
+        reader->close();
+        std::remove(path.c_str());
+
+        CHECK(closed == 1);
+        CHECK(ipReassembly.stats().reassembled == 1);
+        CHECK(lines[true] == clientLines);
+        CHECK(lines[false] == serverLines);
+    }
+}
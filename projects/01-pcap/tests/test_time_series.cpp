@@ -0,0 +1,174 @@
+/**
+ * Tests for the throughput time series: bucket alignment per resolution,
+ * incremental emission from the fixed rings, late packets, sliding windows
+ * and the packet-size histogram.
+ */
+#include <doctest/doctest.h>
+#include <PcapTimeSeries.h>
+
+#include "capture_builder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+pcpp::RawPacketView viewOf(const Record& r) {
+    return {r.frame.data(), static_cast<uint32_t>(r.frame.size()), r.sec, r.usec, 1};
+}
+
+} // namespace
+
+TEST_SUITE("Time series") {
+    TEST_CASE("the size histogram is exact for small values and within 1% above") {
+        pcpp::HdrHistogram h;
+        CHECK(h.valueAtPercentile(50) == 0);
+        for (uint64_t v = 1; v <= 200; ++v) h.record(v);
+        CHECK(h.count() == 200);
+        CHECK(h.min() == 1);
+        CHECK(h.max() == 200);
+        CHECK(h.valueAtPercentile(50) == 100);
+        CHECK(h.valueAtPercentile(100) == 200);
+        CHECK(h.mean() == doctest::Approx(100.5));
+
+        pcpp::HdrHistogram big;
+        std::mt19937 rng(4);
+        std::vector<uint64_t> values;
+        for (int i = 0; i < 20000; ++i) {
+            values.push_back(60 + rng() % 65000);
+            big.record(values.back());
+        }
+        std::sort(values.begin(), values.end());
+        for (double p : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9}) {
+            auto exact = static_cast<double>(values[static_cast<size_t>(p / 100 * values.size()) - 1]);
+            CHECK(static_cast<double>(big.valueAtPercentile(p)) == doctest::Approx(exact).epsilon(0.01));
+        }
+
+        h.merge(big);
+        CHECK(h.count() == 20200);
+        CHECK(h.min() == 1);
+        CHECK(h.max() == values.back());
+        big.record(uint64_t{1} << 40);  // Clamped, not out of range
+        CHECK(big.max() == pcpp::HdrHistogram::kMaxValue);
+    }
+
+    TEST_CASE("buckets are aligned per resolution and counted per protocol") {
+        std::string path = tempPath("time_series.pcap");
+        writePcap(path, sampleRecords());
+        std::map<uint64_t, std::vector<pcpp::ThroughputBucket>> byWidth;
+        pcpp::ThroughputAggregator aggregator([&](const pcpp::ThroughputBucket& b) {
+            byWidth[b.widthUsec].push_back(b);
+        });
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path));
+        REQUIRE(reader->open());
+        pcpp::RawPacket raw;
+        while (reader->getNextPacket(raw)) aggregator.add(raw);
+        aggregator.flush();
+
+        const auto& seconds = byWidth[1000000];
+        REQUIRE(seconds.size() == 3);
+        CHECK(seconds[0].startUsec == 100'000'000);
+        CHECK(seconds[0].packets[0] == 2);
+        CHECK(seconds[0].packets[pcpp::seriesIndex(pcpp::TCP)] == 1);
+        CHECK(seconds[0].packets[pcpp::seriesIndex(pcpp::UDP)] == 1);
+        CHECK(seconds[0].packets[pcpp::seriesIndex(pcpp::IPv4)] == 2);
+        CHECK(seconds[0].bytes[0] == 14 + 20 + 8 + 13 + 14 + 20 + 20);
+        CHECK(seconds[0].packetsPerSecond() == doctest::Approx(2.0));
+        CHECK(seconds[1].packets[pcpp::seriesIndex(pcpp::ARP)] == 1);
+        CHECK(seconds[1].packets[pcpp::seriesIndex(pcpp::IPv4)] == 0);
+        CHECK(seconds[2].startUsec == 102'000'000);
+
+        // The first two packets share a millisecond; the empty ones between
+        // packets are not emitted
+        CHECK(byWidth[1000].size() == 3);
+        CHECK(byWidth[1000][0].bytesPerSecond() == doctest::Approx(seconds[0].bytes[0] * 1000.0));
+        CHECK(byWidth[100000].size() == 3);
+        CHECK(byWidth[100000][2].startUsec == 102'900'000);
+
+        CHECK(aggregator.allSizes().count() == 4);
+        CHECK(aggregator.sizes(pcpp::ARP).max() == 42);
+        CHECK(aggregator.sizes(pcpp::UDP).count() == 2);
+        reader->close();
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("buckets are emitted as the ring advances, not at the end") {
+        pcpp::ThroughputAggregator::Options options;
+        options.resolutionsUsec = {1000};
+        options.ringSize = 4;
+        std::vector<pcpp::ThroughputBucket> emitted;
+        pcpp::ThroughputAggregator aggregator(options, [&](const pcpp::ThroughputBucket& b) {
+            emitted.push_back(b);
+        });
+        auto frame = ipv4(1, 2, 17, udp(1, 2, 10));
+
+        // Two packets per millisecond for 10 ms
+        for (uint64_t ms = 0; ms < 10; ++ms) {
+            aggregator.add(5'000'000 + ms * 1000, frame.size(), pcpp::MaskEthernet | pcpp::MaskIPv4 | pcpp::MaskUDP);
+            aggregator.add(5'000'000 + ms * 1000 + 500, frame.size(), pcpp::MaskEthernet | pcpp::MaskIPv4);
+        }
+        REQUIRE(emitted.size() == 6);
+        CHECK(emitted[0].startUsec == 5'000'000);
+        CHECK(emitted[5].startUsec == 5'005'000);
+        CHECK(emitted[5].packets[0] == 2);
+        CHECK(emitted[5].packets[pcpp::seriesIndex(pcpp::UDP)] == 1);
+
+        // Sliding window: the four newest milliseconds
+        auto window = aggregator.window(0);
+        CHECK(window.startUsec == 5'006'000);
+        CHECK(window.widthUsec == 4000);
+        CHECK(window.packets[0] == 8);
+        CHECK(window.packetsPerSecond() == doctest::Approx(2000.0));
+
+        // Still within the ring: lands in its own bucket
+        aggregator.add(5'007'100, frame.size(), pcpp::MaskEthernet);
+        // Older than the ring
+        aggregator.add(5'001'000, frame.size(), pcpp::MaskEthernet);
+        CHECK(aggregator.latePackets() == 1);
+
+        // A long gap flushes the whole ring without emitting empty buckets
+        aggregator.add(9'000'000, frame.size(), pcpp::MaskEthernet);
+        REQUIRE(emitted.size() == 10);
+        CHECK(emitted[7].startUsec == 5'007'000);
+        CHECK(emitted[7].packets[0] == 3);
+        aggregator.flush();
+        REQUIRE(emitted.size() == 11);
+        CHECK(emitted.back().startUsec == 9'000'000);
+        aggregator.flush();
+        CHECK(emitted.size() == 11);
+    }
+
+    TEST_CASE("addBatch matches adding packet by packet") {
+        auto records = sampleRecords();
+        std::vector<uint8_t> a(16, 1), b(16, 2);
+        for (uint32_t i = 0; i < 3000; ++i) {
+            auto frame = i % 3 ? ipv4(i, 7, 6, tcp(80, 1000, i, 0, 0x10, i % 500)) : ipv6(a, b, 17, udp(9, 9, i % 90));
+            records.push_back({frame, 200 + i / 1000, (i % 1000) * 997});
+        }
+        std::vector<pcpp::RawPacketView> views;
+        for (const auto& r : records) views.push_back(viewOf(r));
+
+        std::vector<pcpp::ThroughputBucket> one, batch;
+        pcpp::ThroughputAggregator single([&](const pcpp::ThroughputBucket& bk) { one.push_back(bk); });
+        pcpp::ThroughputAggregator batched([&](const pcpp::ThroughputBucket& bk) { batch.push_back(bk); });
+        for (const auto& v : views) single.add(v);
+        batched.addBatch(views);
+        single.flush();
+        batched.flush();
+
+        REQUIRE(one.size() == batch.size());
+        for (size_t i = 0; i < one.size(); ++i) {
+            CHECK(one[i].startUsec == batch[i].startUsec);
+            CHECK(one[i].packets == batch[i].packets);
+            CHECK(one[i].bytes == batch[i].bytes);
+        }
+        CHECK(single.sizes(pcpp::IPv6).count() == 1000);
+        CHECK(batched.sizes(pcpp::TCP).valueAtPercentile(100) == single.sizes(pcpp::TCP).max());
+    }
+}
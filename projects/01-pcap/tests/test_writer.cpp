@@ -0,0 +1,186 @@
+/**
+ * Tests for IFileWriterDevice: PCAP and PCAPNG output read back through
+ * IFileReaderDevice, buffer bypass for large records, and file rotation.
+ */
+#include <doctest/doctest.h>
+#include <PcapReader.h>
+
+#include "capture_builder.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace capture_builder;
+
+namespace {
+
+std::vector<pcpp::RawPacket> readAll(const std::string& path) {
+    std::vector<pcpp::RawPacket> packets;
+    std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path));
+    if (!reader || !reader->open()) return packets;
+    pcpp::RawPacket raw;
+    while (reader->getNextPacket(raw)) {
+        packets.push_back(raw);
+    }
+    return packets;
+}
+
+pcpp::RawPacket toRaw(const Record& r, uint32_t linkType = 1) {
+    pcpp::RawPacket raw;
+    raw.data = r.frame;
+    raw.timestamp_sec = r.sec;
+    raw.timestamp_usec = r.usec;
+    raw.linkType = linkType;
+    return raw;
+}
+
+bool writeAll(const std::string& path, const std::vector<pcpp::RawPacket>& packets,
+              const pcpp::WriterOptions& options) {
+    std::unique_ptr<pcpp::IFileWriterDevice> writer(pcpp::IFileWriterDevice::getWriter(path, options));
+    if (!writer || !writer->open()) return false;
+    for (const auto& p : packets) {
+        if (!writer->writePacket(p)) return false;
+    }
+    writer->close();
+    return true;
+}
+
+void removeAll(const std::vector<std::string>& paths) {
+    for (const auto& p : paths) std::remove(p.c_str());
+}
+
+} // namespace
+
+TEST_SUITE("Writer") {
+    TEST_CASE("PCAP and PCAPNG round-trip through the reader") {
+        std::vector<pcpp::RawPacket> packets;
+        for (const auto& r : sampleRecords()) packets.push_back(toRaw(r));
+
+        for (auto format : {pcpp::CaptureFormat::Pcap, pcpp::CaptureFormat::PcapNG}) {
+            CAPTURE(static_cast<int>(format));
+            std::string path = tempPath(format == pcpp::CaptureFormat::Pcap ? "writer.pcap" : "writer.pcapng");
+            pcpp::WriterOptions options;
+            options.format = format;
+            REQUIRE(writeAll(path, packets, options));
+
+            auto back = readAll(path);
+            REQUIRE(back.size() == packets.size());
+            for (size_t i = 0; i < packets.size(); ++i) {
+                CHECK(back[i].data == packets[i].data);
+                CHECK(back[i].timestamp_sec == packets[i].timestamp_sec);
+                CHECK(back[i].timestamp_usec == packets[i].timestamp_usec);
+                CHECK(back[i].linkType == 1);
+            }
+            std::remove(path.c_str());
+        }
+    }
+
+    TEST_CASE("records larger than the buffer bypass it") {
+        std::vector<pcpp::RawPacket> packets;
+        packets.push_back(toRaw({ipv4(1, 2, 17, udp(1, 2, 10)), 1, 0}));
+        packets.push_back(toRaw({ipv4(1, 2, 17, udp(1, 2, 20000)), 1, 1}));
+        packets.push_back(toRaw({ipv4(1, 2, 17, udp(1, 2, 5)), 1, 2}));
+
+        pcpp::WriterOptions options;
+        options.format = pcpp::CaptureFormat::PcapNG;
+        options.bufferSize = 4096;
+        std::string path = tempPath("writer-large.pcapng");
+        REQUIRE(writeAll(path, packets, options));
+
+        auto back = readAll(path);
+        REQUIRE(back.size() == 3);
+        for (size_t i = 0; i < 3; ++i) CHECK(back[i].data == packets[i].data);
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("snapLen truncates captured bytes") {
+        pcpp::WriterOptions options;
+        options.snapLen = 40;
+        std::string path = tempPath("writer-snap.pcap");
+        REQUIRE(writeAll(path, {toRaw({ipv4(1, 2, 17, udp(1, 2, 100)), 1, 0})}, options));
+
+        auto back = readAll(path);
+        REQUIRE(back.size() == 1);
+        CHECK(back[0].data.size() == 40);
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("PCAPNG gets one interface per link type; PCAP rejects a mismatch") {
+        auto eth = toRaw({arp(), 5, 0}, 1);
+        auto cooked = toRaw({std::vector<uint8_t>(20, 0), 6, 0}, 113);
+
+        pcpp::WriterOptions options;
+        options.format = pcpp::CaptureFormat::PcapNG;
+        std::string path = tempPath("writer-links.pcapng");
+        REQUIRE(writeAll(path, {eth, cooked, eth}, options));
+
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path));
+        REQUIRE(reader);
+        REQUIRE(reader->open());
+        pcpp::RawPacket raw;
+        std::vector<uint32_t> linkTypes;
+        while (reader->getNextPacket(raw)) linkTypes.push_back(raw.linkType);
+        CHECK(linkTypes == std::vector<uint32_t>({1, 113, 1}));
+        CHECK(reader->getInterfaces().size() == 2);
+        reader->close();
+        std::remove(path.c_str());
+
+        std::string pcapPath = tempPath("writer-links.pcap");
+        std::unique_ptr<pcpp::IFileWriterDevice> writer(pcpp::IFileWriterDevice::getWriter(pcapPath));
+        REQUIRE(writer);
+        REQUIRE(writer->open());
+        CHECK(writer->writePacket(eth));
+        CHECK_FALSE(writer->writePacket(cooked));
+        writer->close();
+        std::remove(pcapPath.c_str());
+    }
+
+    TEST_CASE("size-based rotation splits into numbered files") {
+        std::vector<pcpp::RawPacket> packets;
+        for (uint32_t i = 0; i < 20; ++i) packets.push_back(toRaw({ipv4(1, 2, 17, udp(1, 2, 60)), i, 0}));
+
+        pcpp::WriterOptions options;
+        options.rotateBytes = 24 + 5 * (16 + 102);  // File header + five records
+        std::string path = tempPath("writer-rotate.pcap");
+        std::unique_ptr<pcpp::IFileWriterDevice> writer(pcpp::IFileWriterDevice::getWriter(path, options));
+        REQUIRE(writer);
+        REQUIRE(writer->open());
+        for (const auto& p : packets) REQUIRE(writer->writePacket(p));
+        writer->close();
+
+        auto names = writer->getFileNames();
+        REQUIRE(names.size() == 4);
+        CHECK(names[0] == path);
+        CHECK(names[1] == tempPath("writer-rotate.1.pcap"));
+        uint32_t expectedSec = 0;
+        for (const auto& name : names) {
+            auto back = readAll(name);
+            REQUIRE(back.size() == 5);
+            for (const auto& p : back) CHECK(p.timestamp_sec == expectedSec++);
+        }
+        CHECK(writer->getPacketsWritten() == 20);
+        removeAll(names);
+    }
+
+    TEST_CASE("time-based rotation follows capture timestamps") {
+        pcpp::WriterOptions options;
+        options.format = pcpp::CaptureFormat::PcapNG;
+        options.rotateSeconds = 10;
+        std::string path = tempPath("writer-time.pcapng");
+        std::unique_ptr<pcpp::IFileWriterDevice> writer(pcpp::IFileWriterDevice::getWriter(path, options));
+        REQUIRE(writer);
+        REQUIRE(writer->open());
+        for (uint32_t sec : {100u, 105u, 109u, 110u, 119u, 135u}) {
+            REQUIRE(writer->writePacket(toRaw({arp(), sec, 0})));
+        }
+        writer->close();
+
+        auto names = writer->getFileNames();
+        REQUIRE(names.size() == 3);
+        CHECK(readAll(names[0]).size() == 3);
+        CHECK(readAll(names[1]).size() == 2);
+        CHECK(readAll(names[2]).size() == 1);
+        removeAll(names);
+    }
+}
@@ -0,0 +1,521 @@
+/**
+ * Network utilities benchmark: PrefixTable longest-prefix match (single and
+ * batch, IPv4 and IPv6) against a linear scan of the routes, and the
+ * allocation-free FastNetworkUtils parse/format/subnet functions against
+ * std::string implementations written the way the NetworkUtils.cpp hints
+ * suggest (std::regex, std::istringstream, std::ostringstream), and the
+ * SIMD batch conversions at each instruction set level, IPv6 parsing and
+ * RFC 5952 formatting, AddressClassifier against per-range predicates, and
+ * PrefixSet aggregation, set algebra and text streaming over the routes,
+ * SubnetAllocator allocate/release churn, hostname validation and label
+ * splitting over a corpus of real domain names, and PublicSuffixList
+ * registrable-domain lookups against a hash set of suffix strings.
+ *
+ * Usage: 02-addressing-bench [routes] [passes]
+ * Routes and addresses are generated from a fixed seed.
+ */
+#include "AddressClassifier.h"
+#include "FastNetworkUtils.h"
+#include "NetworkUtils.h"
+#include "PrefixSet.h"
+#include "PrefixTable.h"
+#include "PublicSuffixList.h"
+#include "SubnetAllocator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+struct Result {
+    uint64_t operations = 0;
+    uint64_t checksum = 0;  // Keeps the compiler from discarding the work
+    double seconds = 0;
+};
+
+struct Route {
+    uint32_t network;
+    uint8_t prefix;
+};
+
+template<typename Body>
+Result timed(int passes, Body&& body) {
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) body(result);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Prefix lengths roughly as in a full BGP table: mostly /24, some /16-/23
+std::vector<Route> makeRoutes(size_t count, std::mt19937& rng) {
+    std::vector<Route> routes;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t prefix = rng() % 2 ? 24 : static_cast<uint8_t>(16 + rng() % 17);
+        uint32_t mask = 0xFFFFFFFFu << (32 - prefix);
+        routes.push_back({static_cast<uint32_t>(rng()) & mask, prefix});
+    }
+    return routes;
+}
+
+// ============ Hint-style string implementations ============
+
+bool hintIsValidIpv4(const std::string& ip) {
+    static const std::regex pattern(R"(^(\d{1,3})\.(\d{1,3})\.(\d{1,3})\.(\d{1,3})$)");
+    std::smatch match;
+    if (!std::regex_match(ip, match, pattern)) return false;
+    for (size_t i = 1; i <= 4; ++i) {
+        if (std::stoi(match[i].str()) > 255) return false;
+    }
+    return true;
+}
+
+std::optional<uint32_t> hintIpv4ToUint32(const std::string& ip) {
+    if (!hintIsValidIpv4(ip)) return std::nullopt;
+    std::istringstream in(ip);
+    uint32_t result = 0;
+    for (int i = 0; i < 4; ++i) {
+        int octet;
+        char dot;
+        in >> octet;
+        if (i < 3) in >> dot;
+        result = (result << 8) | static_cast<uint32_t>(octet);
+    }
+    return result;
+}
+
+std::string hintUint32ToIpv4(uint32_t ip) {
+    std::ostringstream out;
+    out << ((ip >> 24) & 0xFF) << '.' << ((ip >> 16) & 0xFF) << '.' << ((ip >> 8) & 0xFF) << '.' << (ip & 0xFF);
+    return out.str();
+}
+
+std::string hintNetworkAddress(const std::string& ip, uint8_t prefix) {
+    auto value = hintIpv4ToUint32(ip);
+    if (!value) return "";
+    return hintUint32ToIpv4(*value & FastNetworkUtils::prefix_to_mask(prefix));
+}
+
+// Hostname rules as NetworkUtils.cpp hints suggest: split with getline,
+// check characters with std::isalnum
+std::vector<std::string> hintParseFqdn(const std::string& fqdn) {
+    if (fqdn.empty() || fqdn.size() > 253) return {};
+    std::vector<std::string> labels;
+    std::istringstream in(fqdn);
+    std::string label;
+    while (std::getline(in, label, '.')) {
+        if (label.empty() || label.size() > 63 || label.front() == '-' || label.back() == '-') return {};
+        for (char c : label) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-') return {};
+        }
+        labels.push_back(label);
+    }
+    if (labels.empty() || fqdn.back() == '.') return {};
+    bool numeric = true;
+    for (char c : labels.back()) numeric = numeric && std::isdigit(static_cast<unsigned char>(c));
+    if (numeric) return {};
+    return labels;
+}
+
+bool hintIsValidHostname(const std::string& hostname) { return !hintParseFqdn(hostname).empty(); }
+
+std::string hintGetDomain(const std::string& fqdn) {
+    auto labels = hintParseFqdn(fqdn);
+    return labels.size() < 2 ? "" : labels[labels.size() - 2];
+}
+
+// Real registrable domains under service-style subdomains, 1 in 16 broken
+// the way config typos and junk SNI are
+std::vector<std::string> makeHostnames(size_t count, std::mt19937& rng) {
+    static const char* const kDomains[] = {
+        "google.com", "youtube.com", "facebook.com", "wikipedia.org", "amazon.co.uk", "steampowered.com",
+        "epicgames.com", "riotgames.com", "playstation.net", "xboxlive.com", "battle.net", "ea.com",
+        "cloudflare.net", "akamaiedge.net", "amazonaws.com", "azurewebsites.net", "googleusercontent.com",
+        "discord.gg", "twitch.tv", "github.io", "bbc.co.uk", "nintendo.co.jp", "yandex.ru", "baidu.com",
+        "mozilla.org", "apple.com", "ubisoft.com", "unity3d.com", "xn--80ak6aa92e.com", "example.com.au",
+    };
+    static const char* const kLabels[] = {
+        "www", "api", "cdn", "eu-west-1", "us-east-2", "match", "lobby", "auth", "static", "img", "gs-042",
+        "prod", "edge", "telemetry", "login", "store", "content", "ap-southeast-1", "voice", "ws",
+    };
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string name = kDomains[rng() % std::size(kDomains)];
+        for (size_t depth = rng() % 4; depth > 0; --depth) name = std::string(kLabels[rng() % std::size(kLabels)]) + "." + name;
+        if (rng() % 16 == 0) {
+            switch (rng() % 4) {
+            case 0: name.insert(name.begin() + static_cast<long>(rng() % name.size()), '_'); break;
+            case 1: name.insert(0, "-"); break;
+            case 2: name += "."; break;
+            default: name = FastNetworkUtils::uint32_to_ipv4(rng()).c_str(); break;
+            }
+        }
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+// Registrable domain the obvious way: try each suffix of the host, longest
+// first, in a hash set of rule strings (no wildcards or exceptions)
+std::string hintRegistrableDomain(const std::unordered_set<std::string>& suffixes, const std::string& host) {
+    auto labels = hintParseFqdn(host);
+    for (size_t i = 1; i < labels.size(); ++i) {
+        std::string suffix;
+        for (size_t j = i; j < labels.size(); ++j) suffix += (j > i ? "." : "") + labels[j];
+        if (suffixes.count(suffix)) return labels[i - 1] + "." + suffix;
+    }
+    return labels.size() >= 2 ? labels[labels.size() - 2] + "." + labels.back() : "";
+}
+
+void report(const char* name, const Result& r) {
+    double mops = r.seconds > 0 ? r.operations / r.seconds / 1e6 : 0;
+    double ns = r.operations > 0 ? r.seconds * 1e9 / r.operations : 0;
+    std::cout << name << ": " << r.operations << " ops in " << r.seconds << " s ("
+              << mops << " Mops/s, " << ns << " ns/op, sum=" << r.checksum << ")" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t routeCount = argc > 1 ? std::stoul(argv[1]) : 100000;
+    int passes = argc > 2 ? std::stoi(argv[2]) : 5;
+    std::mt19937 rng(2024);
+
+    std::cout << "Benchmarking " << routeCount << " routes (" << passes << " passes)" << std::endl;
+
+    // ============ Longest-prefix match ============
+
+    auto routes = makeRoutes(routeCount, rng);
+    PrefixTable table;
+    for (size_t i = 0; i < routes.size(); ++i) {
+        table.insert_v4(routes[i].network, routes[i].prefix, static_cast<uint32_t>(i));
+    }
+    std::vector<uint32_t> addresses(1 << 20);
+    for (auto& a : addresses) a = rng();
+    std::cout << "prefix table: " << table.memory_bytes() / 1024 << " KiB" << std::endl;
+
+    report("lpm  v4 single       ", timed(passes, [&](Result& r) {
+        for (uint32_t a : addresses) r.checksum += table.lookup(a).value_or(0);
+        r.operations += addresses.size();
+    }));
+    std::vector<uint32_t> values(addresses.size());
+    report("lpm  v4 batch        ", timed(passes, [&](Result& r) {
+        table.lookup_batch(addresses, values);
+        for (uint32_t v : values) r.checksum += v;
+        r.operations += addresses.size();
+    }));
+
+    // The per-address alternative: test every route, keep the longest
+    std::vector<uint32_t> few(addresses.begin(), addresses.begin() + 256);
+    report("lpm  v4 linear scan  ", timed(passes, [&](Result& r) {
+        for (uint32_t a : few) {
+            int best = -1;
+            for (const auto& route : routes) {
+                uint32_t mask = 0xFFFFFFFFu << (32 - route.prefix);
+                if ((a & mask) == route.network && route.prefix > best) best = route.prefix;
+            }
+            r.checksum += static_cast<uint32_t>(best);
+        }
+        r.operations += few.size();
+    }));
+
+    PrefixTable table6;
+    std::vector<PrefixTable::IPv6Bytes> addresses6(1 << 18);
+    for (size_t i = 0; i < routeCount / 4; ++i) {
+        PrefixTable::IPv6Bytes network{0x20, static_cast<uint8_t>(rng() % 8)};
+        for (size_t b = 2; b < 6; ++b) network[b] = static_cast<uint8_t>(rng());
+        table6.insert_v6(network, static_cast<uint8_t>(rng() % 2 ? 48 : 32), static_cast<uint32_t>(i));
+    }
+    for (auto& a : addresses6) {
+        a = {0x20, static_cast<uint8_t>(rng() % 8)};
+        for (size_t b = 2; b < 16; ++b) a[b] = static_cast<uint8_t>(rng());
+    }
+    report("lpm  v6 single       ", timed(passes, [&](Result& r) {
+        for (const auto& a : addresses6) r.checksum += table6.lookup(a).value_or(0);
+        r.operations += addresses6.size();
+    }));
+    std::vector<uint32_t> values6(addresses6.size());
+    report("lpm  v6 batch        ", timed(passes, [&](Result& r) {
+        table6.lookup_batch(addresses6, values6);
+        for (uint32_t v : values6) r.checksum += v;
+        r.operations += addresses6.size();
+    }));
+
+    // ============ Parsing and formatting ============
+
+    std::vector<std::string> texts;
+    for (size_t i = 0; i < 100000; ++i) texts.push_back(FastNetworkUtils::uint32_to_ipv4(rng()).c_str());
+
+    report("parse  string/regex  ", timed(passes, [&](Result& r) {
+        for (const auto& t : texts) r.checksum += hintIpv4ToUint32(t).value_or(0);
+        r.operations += texts.size();
+    }));
+    report("parse  string_view   ", timed(passes, [&](Result& r) {
+        for (const auto& t : texts) r.checksum += FastNetworkUtils::ipv4_to_uint32(t).value_or(0);
+        r.operations += texts.size();
+    }));
+    report("format ostringstream ", timed(passes, [&](Result& r) {
+        for (uint32_t a : addresses) r.checksum += hintUint32ToIpv4(a).size();
+        r.operations += addresses.size();
+    }));
+    report("format fixed buffer  ", timed(passes, [&](Result& r) {
+        char buffer[FastNetworkUtils::kIPv4TextMax];
+        for (uint32_t a : addresses) r.checksum += FastNetworkUtils::uint32_to_ipv4(a, buffer);
+        r.operations += addresses.size();
+    }));
+    report("network string       ", timed(passes, [&](Result& r) {
+        for (const auto& t : texts) r.checksum += hintNetworkAddress(t, 24).size();
+        r.operations += texts.size();
+    }));
+    report("network string_view  ", timed(passes, [&](Result& r) {
+        for (const auto& t : texts) r.checksum += FastNetworkUtils::get_network_address(t, 24).size();
+        r.operations += texts.size();
+    }));
+
+    // ============ Batch conversion ============
+
+    std::vector<std::string_view> views(texts.begin(), texts.end());
+    std::vector<uint32_t> parsed(views.size());
+    std::unique_ptr<bool[]> valid(new bool[views.size()]);
+    std::vector<std::array<char, 16>> formatted(addresses.size());
+    std::vector<uint8_t> lengths(addresses.size());
+    const std::pair<const char*, NetworkUtils::SimdLevel> levels[] = {
+        {"scalar", NetworkUtils::SimdLevel::Scalar},
+        {"ssse3 ", NetworkUtils::SimdLevel::SSSE3},
+        {"avx2  ", NetworkUtils::SimdLevel::AVX2},
+    };
+    for (const auto& [name, level] : levels) {
+        if (level > NetworkUtils::detect_simd_level()) continue;
+        std::string label = std::string("parse  batch ") + name + "  ";
+        report(label.c_str(), timed(passes, [&](Result& r) {
+            r.checksum += NetworkUtils::ipv4_to_uint32_batch(views, parsed, {valid.get(), views.size()}, level);
+            for (uint32_t v : parsed) r.checksum += v;
+            r.operations += views.size();
+        }));
+    }
+    for (const auto& [name, level] : levels) {
+        if (level > NetworkUtils::detect_simd_level()) continue;
+        std::string label = std::string("format batch ") + name + "  ";
+        report(label.c_str(), timed(passes, [&](Result& r) {
+            NetworkUtils::uint32_to_ipv4_batch(addresses, formatted, lengths, level);
+            for (uint8_t n : lengths) r.checksum += n;
+            r.operations += addresses.size();
+        }));
+    }
+
+    // ============ IPv6 ============
+
+    std::vector<std::string> texts6;
+    for (size_t i = 0; i < 100000; ++i) {
+        texts6.push_back(FastNetworkUtils::bytes_to_ipv6(addresses6[i % addresses6.size()]).c_str());
+    }
+    report("parse  ipv6          ", timed(passes, [&](Result& r) {
+        for (const auto& t : texts6) r.checksum += FastNetworkUtils::ipv6_to_bytes(t).value_or(PrefixTable::IPv6Bytes{})[15];
+        r.operations += texts6.size();
+    }));
+    report("format ipv6          ", timed(passes, [&](Result& r) {
+        char buffer[FastNetworkUtils::kIPv6TextMax];
+        for (const auto& a : addresses6) r.checksum += FastNetworkUtils::bytes_to_ipv6(a, buffer);
+        r.operations += addresses6.size();
+    }));
+    report("network ipv6 /48     ", timed(passes, [&](Result& r) {
+        for (const auto& t : texts6) r.checksum += FastNetworkUtils::get_network_address_v6(t, 48).size();
+        r.operations += texts6.size();
+    }));
+
+    // ============ Classification ============
+
+    report("classify predicates  ", timed(passes, [&](Result& r) {
+        // The per-range tests is_private_ip / is_reserved_ip do, on integers
+        for (uint32_t a : addresses) {
+            bool is_private = (a & 0xFF000000) == 0x0A000000 || (a & 0xFFF00000) == 0xAC100000 ||
+                              (a & 0xFFFF0000) == 0xC0A80000 || (a & 0xFF000000) == 0x7F000000 ||
+                              (a & 0xFFFF0000) == 0xA9FE0000;
+            bool is_reserved = (a & 0xFF000000) == 0 || (a & 0xF0000000) == 0xF0000000;
+            r.checksum += is_private + 2 * is_reserved;
+        }
+        r.operations += addresses.size();
+    }));
+    AddressClassifier classifier;
+    std::vector<uint32_t> classes(addresses.size());
+    report("classify single      ", timed(passes, [&](Result& r) {
+        for (uint32_t a : addresses) r.checksum += classifier.classify(IPv4Address(a));
+        r.operations += addresses.size();
+    }));
+    for (const auto& [name, level] : levels) {
+        if (level > NetworkUtils::detect_simd_level()) continue;
+        std::string label = std::string("classify batch ") + name;
+        report(label.c_str(), timed(passes, [&](Result& r) {
+            classifier.classify_batch(addresses, classes, level);
+            for (uint32_t c : classes) r.checksum += c;
+            r.operations += addresses.size();
+        }));
+    }
+
+    // ============ Prefix sets ============
+
+    // The routes split in two lists, as a feed and a blocklist would be
+    std::vector<Prefix> feed, blocked;
+    for (size_t i = 0; i < routes.size(); ++i) {
+        (i % 2 ? blocked : feed).emplace_back(IPv4Address(routes[i].network), routes[i].prefix);
+    }
+    PrefixSet feedSet(feed), blockedSet(blocked);
+    std::cout << "prefix sets: " << feedSet.ranges().size() << " + " << blockedSet.ranges().size() << " ranges"
+              << std::endl;
+
+    report("set aggregate        ", timed(passes, [&](Result& r) {
+        r.checksum += PrefixSet(feed).ranges().size();
+        r.operations += feed.size();
+    }));
+    report("set unite            ", timed(passes, [&](Result& r) {
+        r.checksum += feedSet.unite(blockedSet).ranges().size();
+        r.operations += feedSet.ranges().size() + blockedSet.ranges().size();
+    }));
+    report("set intersect        ", timed(passes, [&](Result& r) {
+        r.checksum += feedSet.intersect(blockedSet).ranges().size();
+        r.operations += feedSet.ranges().size() + blockedSet.ranges().size();
+    }));
+    report("set subtract         ", timed(passes, [&](Result& r) {
+        r.checksum += feedSet.subtract(blockedSet).ranges().size();
+        r.operations += feedSet.ranges().size() + blockedSet.ranges().size();
+    }));
+    report("set cover            ", timed(passes, [&](Result& r) {
+        auto cover = feedSet.prefixes();
+        r.checksum += cover.size();
+        r.operations += cover.size();
+    }));
+    report("set contains         ", timed(passes, [&](Result& r) {
+        for (uint32_t a : addresses) r.checksum += feedSet.contains(IPv4Address(a));
+        r.operations += addresses.size();
+    }));
+    std::ostringstream feedText;
+    feedSet.write(feedText);
+    std::string text = feedText.str();
+    size_t lines = feedSet.prefixes().size();
+    report("set write            ", timed(passes, [&](Result& r) {
+        std::ostringstream out;
+        feedSet.write(out);
+        r.checksum += out.str().size();
+        r.operations += lines;
+    }));
+    report("set read             ", timed(passes, [&](Result& r) {
+        std::istringstream in(text);
+        r.checksum += PrefixSet::read(in).ranges().size();
+        r.operations += lines;
+    }));
+
+    // ============ Hostnames ============
+
+    auto hostnames = makeHostnames(100000, rng);
+    size_t hostnameBytes = 0;
+    for (const auto& h : hostnames) hostnameBytes += h.size();
+    std::cout << "hostnames: " << hostnames.size() << ", " << hostnameBytes / hostnames.size() << " chars average"
+              << std::endl;
+
+    report("hostname valid string", timed(passes, [&](Result& r) {
+        for (const auto& h : hostnames) r.checksum += hintIsValidHostname(h);
+        r.operations += hostnames.size();
+    }));
+    report("hostname valid view  ", timed(passes, [&](Result& r) {
+        for (const auto& h : hostnames) r.checksum += FastNetworkUtils::is_valid_hostname(h);
+        r.operations += hostnames.size();
+    }));
+    report("fqdn split vector    ", timed(passes, [&](Result& r) {
+        for (const auto& h : hostnames) r.checksum += hintParseFqdn(h).size();
+        r.operations += hostnames.size();
+    }));
+    report("fqdn split labels    ", timed(passes, [&](Result& r) {
+        for (const auto& h : hostnames) r.checksum += FastNetworkUtils::parse_fqdn(h).size();
+        r.operations += hostnames.size();
+    }));
+    report("domain string        ", timed(passes, [&](Result& r) {
+        for (const auto& h : hostnames) r.checksum += hintGetDomain(h).size();
+        r.operations += hostnames.size();
+    }));
+    report("domain view          ", timed(passes, [&](Result& r) {
+        for (const auto& h : hostnames) r.checksum += FastNetworkUtils::get_domain(h).size();
+        r.operations += hostnames.size();
+    }));
+
+    // ============ Public suffixes ============
+
+    const auto& psl = PublicSuffixList::builtin();
+    std::cout << "public suffix list: " << psl.rule_count() << " rules, " << psl.memory_bytes() / 1024 << " KiB"
+              << std::endl;
+    report("registrable builtin  ", timed(passes, [&](Result& r) {
+        for (const auto& h : hostnames) r.checksum += psl.registrable_domain(h).size();
+        r.operations += hostnames.size();
+    }));
+
+    // About the size of the full list: 1500 TLDs with 7500 rules under them
+    std::string listText = "com\nnet\norg\nuk\nco.uk\njp\nco.jp\nau\ncom.au\nio\ngithub.io\n";
+    for (int i = 0; i < 1500; ++i) listText += "tld" + std::to_string(i) + "\n";
+    for (int i = 0; i < 7500; ++i) {
+        listText += "sld" + std::to_string(i) + "." + (i % 3 ? "tld" + std::to_string(i % 1500) : "jp") + "\n";
+    }
+    auto fullPsl = PublicSuffixList::parse(listText);
+    std::unordered_set<std::string> suffixSet;
+    for (size_t pos = 0; pos < listText.size();) {
+        size_t eol = listText.find('\n', pos);
+        suffixSet.insert(listText.substr(pos, eol - pos));
+        pos = eol + 1;
+    }
+    std::cout << "public suffix list: " << fullPsl.rule_count() << " rules, " << fullPsl.memory_bytes() / 1024
+              << " KiB" << std::endl;
+    report("registrable hash set ", timed(passes, [&](Result& r) {
+        for (const auto& h : hostnames) r.checksum += hintRegistrableDomain(suffixSet, h).size();
+        r.operations += hostnames.size();
+    }));
+    report("registrable trie     ", timed(passes, [&](Result& r) {
+        for (const auto& h : hostnames) r.checksum += fullPsl.registrable_domain(h).size();
+        r.operations += hostnames.size();
+    }));
+
+    // ============ Subnet allocation ============
+
+    // A /8 pool carved into /26 and /28 fleets
+    std::vector<unsigned> fleetLengths(routeCount);
+    for (auto& l : fleetLengths) l = rng() % 2 ? 26 : 28;
+    SubnetAllocator ipam("10.0.0.0/8"_cidr);
+    std::vector<Prefix> fleets;
+    fleets.reserve(routeCount);
+    report("ipam allocate        ", timed(1, [&](Result& r) {
+        for (unsigned l : fleetLengths) {
+            if (auto block = ipam.allocate(l)) fleets.push_back(*block);
+        }
+        r.checksum += fleets.size();
+        r.operations += fleetLengths.size();
+    }));
+    std::shuffle(fleets.begin(), fleets.end(), rng);
+    report("ipam release/realloc ", timed(passes, [&](Result& r) {
+        // Free a random half, then fill the holes again
+        size_t half = fleets.size() / 2;
+        for (size_t i = 0; i < half; ++i) r.checksum += ipam.release(fleets[i]);
+        for (size_t i = 0; i < half; ++i) fleets[i] = ipam.allocate(fleets[i].length()).value_or(fleets[i]);
+        std::shuffle(fleets.begin(), fleets.end(), rng);
+        r.operations += 2 * half;
+    }));
+    std::cout << "ipam: " << ipam.allocation_count() << " blocks, fragmentation " << ipam.fragmentation()
+              << std::endl;
+    std::stringstream ipamState;
+    report("ipam write+read      ", timed(passes, [&](Result& r) {
+        ipamState.str({});
+        ipam.write(ipamState);
+        r.checksum += SubnetAllocator::read(ipamState)->allocation_count();
+        r.operations += ipam.allocation_count();
+    }));
+
+    return 0;
+}
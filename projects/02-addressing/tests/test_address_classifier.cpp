@@ -0,0 +1,99 @@
+/**
+ * Tests for AddressClassifier: the standard classes agree with the
+ * FastNetworkUtils predicates, user ranges combine with them, and every
+ * SIMD level gives the scalar result, including the unaligned tail.
+ */
+#include <doctest/doctest.h>
+#include "AddressClassifier.h"
+#include "FastNetworkUtils.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using C = AddressClassifier;
+
+TEST_SUITE("Address Classifier") {
+    TEST_CASE("Standard ranges") {
+        AddressClassifier classifier;
+        CHECK(classifier.classify("10.1.2.3"_ipv4) == C::kPrivate);
+        CHECK(classifier.classify("172.31.255.255"_ipv4) == C::kPrivate);
+        CHECK(classifier.classify("172.32.0.0"_ipv4) == 0);
+        CHECK(classifier.classify("127.0.0.1"_ipv4) == C::kLoopback);
+        CHECK(classifier.classify("169.254.10.1"_ipv4) == C::kLinkLocal);
+        CHECK(classifier.classify("100.64.0.1"_ipv4) == C::kCgnat);
+        CHECK(classifier.classify("100.128.0.1"_ipv4) == 0);
+        CHECK(classifier.classify("239.255.255.250"_ipv4) == C::kMulticast);
+        CHECK(classifier.classify("0.1.2.3"_ipv4) == C::kReserved);
+        CHECK(classifier.classify("255.255.255.255"_ipv4) == C::kReserved);
+        CHECK(classifier.classify("8.8.8.8"_ipv4) == 0);
+
+        // Same answers as the one-address predicates; half the samples get a
+        // first octet at a range boundary
+        constexpr uint32_t kFirstOctets[] = {0, 10, 100, 127, 169, 172, 192, 224, 240, 255};
+        std::mt19937 rng(21);
+        size_t mismatches = 0;
+        for (int i = 0; i < 100000; ++i) {
+            uint32_t ip = static_cast<uint32_t>(rng());
+            if (i % 2) ip = (ip & 0x00FFFFFF) | kFirstOctets[rng() % 10] << 24;
+            auto text = FastNetworkUtils::uint32_to_ipv4(ip);
+            uint32_t classes = classifier.classify(IPv4Address(ip));
+            bool is_private = (classes & (C::kPrivate | C::kLoopback | C::kLinkLocal)) != 0;
+            bool is_reserved = (classes & C::kReserved) != 0;
+            if (is_private != FastNetworkUtils::is_private_ip(text.view()) ||
+                is_reserved != FastNetworkUtils::is_reserved_ip(text.view())) {
+                ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("User ranges") {
+        AddressClassifier classifier;
+        size_t standard = classifier.size();
+        constexpr uint32_t kOffice = C::kFirstUserClass;
+        constexpr uint32_t kVpn = C::kFirstUserClass << 1;
+        CHECK(classifier.add_range("203.0.113.0/24"_cidr, kOffice));
+        CHECK(classifier.add_range("10.8.0.0/16", kVpn));
+        CHECK(classifier.add_range("10.8.0.0/16", kOffice));  // Merged into the same entry
+        CHECK(classifier.size() == standard + 2);
+        CHECK(classifier.add_range("10.8.0.1/16", kVpn) == false);
+        CHECK(classifier.add_range("bogus", kVpn) == false);
+        CHECK(classifier.add_range("192.0.2.0/24"_cidr, 0) == false);
+
+        CHECK(classifier.classify("203.0.113.9"_ipv4) == kOffice);
+        CHECK(classifier.classify("10.8.1.1"_ipv4) == (C::kPrivate | kVpn | kOffice));
+        CHECK(classifier.classify("10.9.1.1"_ipv4) == C::kPrivate);
+
+        classifier.clear();
+        CHECK(classifier.size() == 0);
+        CHECK(classifier.classify("10.1.1.1"_ipv4) == 0);
+        classifier.add_range("0.0.0.0/0"_cidr, kVpn);
+        CHECK(classifier.classify("1.2.3.4"_ipv4) == kVpn);
+    }
+
+    TEST_CASE("Batch classification matches scalar at every level") {
+        AddressClassifier classifier;
+        for (uint32_t i = 0; i < 20; ++i) {
+            classifier.add_range(Prefix(IPv4Address(0x0A000000 + (i << 16)), 16 + i % 8), C::kFirstUserClass << (i % 4));
+        }
+        std::mt19937 rng(121);
+        std::vector<uint32_t> addresses(10007);
+        for (auto& a : addresses) a = rng() % 2 ? static_cast<uint32_t>(rng()) : 0x0A000000 | (rng() & 0x1FFFFF);
+
+        std::vector<uint32_t> expected(addresses.size());
+        for (size_t i = 0; i < addresses.size(); ++i) expected[i] = classifier.classify(IPv4Address(addresses[i]));
+
+        for (auto level : {NetworkUtils::SimdLevel::Scalar, NetworkUtils::SimdLevel::SSSE3, NetworkUtils::SimdLevel::AVX2}) {
+            CAPTURE(static_cast<int>(level));
+            std::vector<uint32_t> classes(addresses.size(), 0xDEADBEEF);
+            classifier.classify_batch(addresses, classes, level);
+            CHECK(classes == expected);
+
+            // Short spans are all tail
+            std::vector<uint32_t> few(5, 0xDEADBEEF);
+            classifier.classify_batch(std::span(addresses).first(5), few, level);
+            CHECK(std::equal(few.begin(), few.end(), expected.begin()));
+        }
+    }
+}
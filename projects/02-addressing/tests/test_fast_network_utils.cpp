@@ -0,0 +1,229 @@
+/**
+ * Tests for FastNetworkUtils, the string_view / fixed-buffer counterpart of
+ * NetworkUtils: the same lecture examples, plus buffer handling and inputs
+ * that only a view can express (unterminated substrings).
+ */
+#include <doctest/doctest.h>
+#include "FastNetworkUtils.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using F = FastNetworkUtils;
+
+TEST_SUITE("Fast IPv4 Conversion") {
+    TEST_CASE("Parsing follows the is_valid_ipv4 rules") {
+        CHECK(F::ipv4_to_uint32("192.168.1.100") == 0xC0A80164u);
+        CHECK(F::ipv4_to_uint32("0.0.0.0") == 0u);
+        CHECK(F::ipv4_to_uint32("255.255.255.255") == 0xFFFFFFFFu);
+        CHECK(F::ipv4_to_uint32("010.001.000.007") == 0x0A010007u);
+
+        for (std::string_view bad : {"256.1.1.1", "192.168.1", "abc.def.ghi.jkl", "192.168.1.1.1", "",
+                                     "192.168.-1.1", "1.2.3.4 ", " 1.2.3.4", "1..2.3", "1.2.3.0004",
+                                     "+1.2.3.4", "1.2.3.", "99999999999.1.1.1"}) {
+            CAPTURE(bad);
+            CHECK(F::is_valid_ipv4(bad) == false);
+        }
+
+        // A view into a larger buffer: only the view is parsed
+        std::string_view line = "10.0.0.1 GET /index.html";
+        CHECK(F::ipv4_to_uint32(line.substr(0, line.find(' '))) == 0x0A000001u);
+        CHECK(F::is_valid_ipv4(line) == false);
+    }
+
+    TEST_CASE("Formatting into fixed storage and caller buffers") {
+        CHECK(F::uint32_to_ipv4(0xC0A80164) == "192.168.1.100");
+        CHECK(F::uint32_to_ipv4(0) == "0.0.0.0");
+        auto longest = F::uint32_to_ipv4(0xFFFFFFFF);
+        CHECK(longest == "255.255.255.255");
+        CHECK(longest.size() == F::kIPv4TextMax);
+        CHECK(std::string_view(longest.c_str()) == "255.255.255.255");
+
+        std::array<char, 16> buffer;
+        buffer.fill('x');
+        CHECK(F::uint32_to_ipv4(0x7F000001, buffer) == 9);
+        CHECK(std::string_view(buffer.data()) == "127.0.0.1");
+
+        // Exactly fits: no room for the NUL, which is then not written
+        std::array<char, 9> exact;
+        exact.fill('x');
+        CHECK(F::uint32_to_ipv4(0x7F000001, exact) == 9);
+        CHECK(std::string_view(exact.data(), 9) == "127.0.0.1");
+        std::array<char, 8> small;
+        CHECK(F::uint32_to_ipv4(0x7F000001, small) == 0);
+
+        CHECK(F::octet_to_binary(192) == "11000000");
+        CHECK(F::octet_to_binary(1) == "00000001");
+    }
+}
+
+TEST_SUITE("Fast Subnet Calculations") {
+    TEST_CASE("Masks and prefixes") {
+        CHECK(F::cidr_to_subnet_mask(0) == "0.0.0.0");
+        CHECK(F::cidr_to_subnet_mask(26) == "255.255.255.192");
+        CHECK(F::cidr_to_subnet_mask(32) == "255.255.255.255");
+        CHECK(F::cidr_to_subnet_mask(33).empty());
+
+        CHECK(F::subnet_mask_to_cidr("255.255.255.192") == uint8_t{26});
+        CHECK(F::subnet_mask_to_cidr("0.0.0.0") == uint8_t{0});
+        CHECK(F::subnet_mask_to_cidr("255.255.255.255") == uint8_t{32});
+        CHECK(F::subnet_mask_to_cidr("255.255.0.255").has_value() == false);
+        CHECK(F::subnet_mask_to_cidr("0.255.255.255").has_value() == false);
+
+        static_assert(F::prefix_to_mask(24) == 0xFFFFFF00);
+        static_assert(F::mask_to_prefix(0xFFFFF000) == 20);
+        static_assert(F::count_usable_hosts(24) == 254);
+        static_assert(F::count_usable_hosts(0) == 0xFFFFFFFE);
+    }
+
+    TEST_CASE("Network, broadcast and host range") {
+        CHECK(F::get_network_address("192.168.1.100", 26) == "192.168.1.64");
+        CHECK(F::get_network_address("172.16.0.50", 12) == "172.16.0.0");
+        CHECK(F::get_broadcast_address("10.0.0.0", 8) == "10.255.255.255");
+        CHECK(F::get_first_host("192.168.100.0", 26) == "192.168.100.1");
+        CHECK(F::get_last_host("192.168.100.0", 26) == "192.168.100.62");
+        CHECK(F::get_network_address("invalid", 24).empty());
+        CHECK(F::get_broadcast_address("10.0.0.0", 33).empty());
+
+        auto info = F::analyze_subnet("10.0.0.130", 25);
+        CHECK(info.network == "10.0.0.128");
+        CHECK(info.first_host == "10.0.0.129");
+        CHECK(info.last_host == "10.0.0.254");
+        CHECK(info.broadcast == "10.0.0.255");
+
+        // RFC 3021 point-to-point and host routes
+        auto p2p = F::analyze_subnet("10.1.1.1", 31);
+        CHECK(p2p.first_host == "10.1.1.0");
+        CHECK(p2p.last_host == "10.1.1.1");
+        auto host = F::analyze_subnet("10.1.1.1", 32);
+        CHECK(host.first_host == "10.1.1.1");
+        CHECK(host.last_host == "10.1.1.1");
+        CHECK(F::analyze_subnet("10.1.1", 24).network.empty());
+
+        CHECK(F::count_usable_hosts(31) == 2);
+        CHECK(F::count_usable_hosts(32) == 0);
+        CHECK(F::is_in_subnet("192.168.100.50", "192.168.100.0", 26) == true);
+        CHECK(F::is_in_subnet("192.168.100.100", "192.168.100.0", 26) == false);
+        CHECK(F::is_in_subnet("1.2.3.4", "0.0.0.0", 0) == true);
+        CHECK(F::is_in_subnet("1.2.3.4", "bogus", 0) == false);
+    }
+
+    TEST_CASE("Private and reserved ranges") {
+        for (std::string_view ip : {"10.20.30.40", "172.31.255.255", "192.168.0.0", "127.0.0.1", "169.254.1.1"}) {
+            CAPTURE(ip);
+            CHECK(F::is_private_ip(ip) == true);
+        }
+        CHECK(F::is_private_ip("172.32.0.1") == false);
+        CHECK(F::is_private_ip("8.8.8.8") == false);
+        CHECK(F::is_reserved_ip("0.1.2.3") == true);
+        CHECK(F::is_reserved_ip("240.0.0.1") == true);
+        CHECK(F::is_reserved_ip("255.255.255.255") == true);
+        CHECK(F::is_reserved_ip("8.8.8.8") == false);
+        CHECK(F::is_reserved_ip("not an ip") == false);
+    }
+}
+
+namespace {
+
+// The hostname rules written out label by label
+std::vector<std::string_view> reference_labels(std::string_view name) {
+    if (name.empty() || name.size() > 253) return {};
+    std::vector<std::string_view> labels;
+    size_t start = 0;
+    while (true) {
+        size_t dot = std::min(name.find('.', start), name.size());
+        std::string_view label = name.substr(start, dot - start);
+        if (label.empty() || label.size() > 63 || label.front() == '-' || label.back() == '-') return {};
+        for (char c : label) {
+            bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-';
+            if (!ok) return {};
+        }
+        labels.push_back(label);
+        if (dot == name.size()) break;
+        start = dot + 1;
+    }
+    if (labels.back().find_first_not_of("0123456789") == std::string_view::npos) return {};
+    return labels;
+}
+
+} // namespace
+
+TEST_SUITE("Fast FQDN Handling") {
+    TEST_CASE("Hostname validation follows the is_valid_hostname rules") {
+        for (std::string_view name : {"game.example.com", "api-v2.servers.example.org", "localhost", "a", "1.example.com",
+                                      "xn--bcher-kva.example", "EU-West-1.Matchmaking.Example.NET", "3com.net"}) {
+            CAPTURE(name);
+            CHECK(F::is_valid_hostname(name) == true);
+        }
+        for (std::string_view name : {"256.1.1.1", "-game.com", "game-.com", "", "game..com", ".game.com", "game.com.",
+                                      "game_1.example.com", "game.example.123", "gäme.com", "game com"}) {
+            CAPTURE(name);
+            CHECK(F::is_valid_hostname(name) == false);
+        }
+
+        std::string longest(63, 'a');
+        CHECK(F::is_valid_hostname(longest + ".com") == true);
+        CHECK(F::is_valid_hostname(longest + "a.com") == false);
+
+        // 253 characters is the limit, however the labels are split
+        std::string name;
+        for (int i = 0; i < 125; ++i) name += "a.";
+        name += "abc";
+        CHECK(name.size() == 253);
+        CHECK(F::is_valid_hostname(name) == true);
+        CHECK(F::is_valid_hostname(name + "c") == false);
+        CHECK(F::is_valid_hostname(std::string(254, 'a')) == false);
+    }
+
+    TEST_CASE("Label splitting") {
+        auto labels = F::parse_fqdn("auth.api.example.org");
+        REQUIRE(labels.size() == 4);
+        CHECK(labels[0] == "auth");
+        CHECK(labels[1] == "api");
+        CHECK(labels[2] == "example");
+        CHECK(labels[3] == "org");
+        CHECK(F::parse_fqdn("256.1.1.1").empty());
+
+        // Labels view the input, which need not be NUL-terminated
+        std::string_view sni = std::string_view("game.example.com:443").substr(0, 16);
+        CHECK(F::get_tld(sni) == "com");
+        CHECK(F::get_domain(sni) == "example");
+        CHECK(F::get_tld(sni).data() == sni.data() + 13);
+
+        CHECK(F::get_tld("localhost") == "localhost");
+        CHECK(F::get_domain("localhost").empty());
+        CHECK(F::get_domain("api.servers.example.org") == "example");
+        CHECK(F::get_tld("-bad.com").empty());
+
+        // As many labels as fit in 253 characters
+        std::string name;
+        for (size_t i = 0; i < F::kMaxLabels; ++i) name += i ? ".b" : "a";
+        auto many = F::parse_fqdn(name);
+        CHECK(many.size() == F::kMaxLabels);
+        CHECK(many[0] == "a");
+        CHECK(many[F::kMaxLabels - 1] == "b");
+    }
+
+    TEST_CASE("Random names match the label-by-label rules") {
+        // Short labels over a small alphabet, so every rule is hit often
+        constexpr std::string_view kAlphabet = "ab09-.Z_\xC3";
+        std::mt19937 rng(24);
+        size_t mismatches = 0, valid = 0;
+        for (int i = 0; i < 200000; ++i) {
+            std::string name(rng() % (i % 100 ? 40 : 300), 'a');
+            for (char& c : name) c = kAlphabet[rng() % kAlphabet.size()];
+            auto labels = F::parse_fqdn(name);
+            auto expected = reference_labels(name);
+            valid += !expected.empty();
+            bool same = labels.size() == expected.size();
+            for (size_t j = 0; same && j < labels.size(); ++j) same = labels[j] == expected[j];
+            mismatches += !same;
+        }
+        CHECK(mismatches == 0);
+        CHECK(valid > 1000);
+    }
+}
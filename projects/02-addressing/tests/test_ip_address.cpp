@@ -0,0 +1,141 @@
+/**
+ * Tests for the IPv4Address / IPv6Address / Prefix value types: the subnet
+ * math is checked at compile time with static_assert, then against the
+ * string-based results of FastNetworkUtils at run time.
+ */
+#include <doctest/doctest.h>
+#include "FastNetworkUtils.h"
+#include "IpAddress.h"
+#include "PrefixTable.h"
+
+#include <random>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<IPv4Address>);
+static_assert(std::is_trivially_copyable_v<IPv6Address>);
+static_assert(std::is_trivially_copyable_v<Prefix>);
+static_assert(std::is_trivially_copyable_v<IPv6Prefix>);
+static_assert(sizeof(IPv4Address) == 4);
+static_assert(sizeof(IPv6Address) == 16);
+
+// Lecture examples, evaluated by the compiler
+static_assert("192.168.1.100"_ipv4 == IPv4Address(0xC0A80164));
+static_assert(IPv4Address(192, 168, 1, 100).octet(3) == 100);
+static_assert(IPv4Address::mask(26) == "255.255.255.192"_ipv4);
+static_assert(Prefix("192.168.1.100"_ipv4, 26).network() == "192.168.1.64"_ipv4);
+static_assert("10.0.0.0/8"_cidr.broadcast() == "10.255.255.255"_ipv4);
+static_assert("192.168.100.0/26"_cidr.first_host() == "192.168.100.1"_ipv4);
+static_assert("192.168.100.0/26"_cidr.last_host() == "192.168.100.62"_ipv4);
+static_assert("192.168.100.0/26"_cidr.host_count() == 62);
+static_assert("172.16.0.0/12"_cidr.contains("172.31.255.255"_ipv4));
+static_assert(!"172.16.0.0/12"_cidr.contains("172.32.0.0"_ipv4));
+static_assert("10.0.0.0/8"_cidr.contains("10.1.0.0/16"_cidr));
+static_assert(!"10.1.0.0/16"_cidr.contains("10.0.0.0/8"_cidr));
+
+// A compile-time rule table
+constexpr Prefix kPrivate[] = {"10.0.0.0/8"_cidr, "172.16.0.0/12"_cidr, "192.168.0.0/16"_cidr,
+                               "127.0.0.0/8"_cidr, "169.254.0.0/16"_cidr};
+
+TEST_SUITE("Address Types") {
+    TEST_CASE("IPv4 parsing matches FastNetworkUtils") {
+        for (std::string_view text : {"192.168.1.100", "0.0.0.0", "255.255.255.255", "010.001.000.007",
+                                      "256.1.1.1", "192.168.1", "", "1.2.3.4 ", "1..2.3", "1.2.3.0004",
+                                      "+1.2.3.4", "1.2.3.", "99999999999.1.1.1"}) {
+            CAPTURE(text);
+            auto typed = IPv4Address::parse(text);
+            auto fast = FastNetworkUtils::ipv4_to_uint32(text);
+            CHECK(typed.has_value() == fast.has_value());
+            if (typed && fast) CHECK(typed->to_uint32() == *fast);
+        }
+    }
+
+    TEST_CASE("Prefix parsing") {
+        auto p = Prefix::parse("192.168.0.0/16");
+        REQUIRE(p.has_value());
+        CHECK(p->network() == "192.168.0.0"_ipv4);
+        CHECK(p->length() == 16);
+        CHECK(Prefix::parse("10.0.0.1")->length() == 32);
+        CHECK(Prefix::parse("0.0.0.0/0")->contains("8.8.8.8"_ipv4));
+
+        for (std::string_view bad : {"10.0.0.1/8", "10.0.0.0/33", "10.0.0.0/", "10.0.0.0/a", "10.0.0/8",
+                                     "10.0.0.0/0008", "/8"}) {
+            CAPTURE(bad);
+            CHECK(Prefix::parse(bad).has_value() == false);
+        }
+
+        // The constructor masks rather than rejects
+        CHECK(Prefix("10.0.0.1"_ipv4, 8) == "10.0.0.0/8"_cidr);
+        CHECK(Prefix("10.0.0.1"_ipv4, 40).length() == 32);
+    }
+
+    TEST_CASE("Subnet math agrees with the string functions") {
+        std::mt19937 rng(19);
+        size_t mismatches = 0;
+        for (int i = 0; i < 20000; ++i) {
+            IPv4Address ip(static_cast<uint32_t>(rng()));
+            auto length = static_cast<uint8_t>(rng() % 33);
+            auto text = FastNetworkUtils::uint32_to_ipv4(ip.to_uint32());
+            auto expected = FastNetworkUtils::analyze_subnet(text.view(), length);
+            auto info = Prefix(ip, length).analyze();
+            auto same = [](IPv4Address a, const FastNetworkUtils::IPv4Text& b) {
+                return FastNetworkUtils::uint32_to_ipv4(a.to_uint32()) == b.view();
+            };
+            if (!same(info.network, expected.network) || !same(info.first_host, expected.first_host) ||
+                !same(info.last_host, expected.last_host) || !same(info.broadcast, expected.broadcast)) {
+                ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+
+        // RFC 3021 point-to-point and host prefixes
+        auto p2p = Prefix("10.1.1.1"_ipv4, 31).analyze();
+        CHECK(p2p.first_host == "10.1.1.0"_ipv4);
+        CHECK(p2p.last_host == "10.1.1.1"_ipv4);
+        CHECK(Prefix("10.1.1.1"_ipv4, 31).host_count() == 2);
+        CHECK(Prefix("10.1.1.1"_ipv4, 32).host_count() == 0);
+        CHECK(Prefix().host_count() == 0xFFFFFFFEu);
+
+        int private_hits = 0;
+        for (const Prefix& p : kPrivate) private_hits += p.contains("172.20.1.1"_ipv4);
+        CHECK(private_hits == 1);
+    }
+
+    TEST_CASE("IPv6 prefixes") {
+        IPv6Address::Bytes bytes{0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0x12, 0x34, 0x56, 0x78};
+        auto address = IPv6Address::from_bytes(bytes);
+        CHECK(address.to_bytes() == bytes);
+        CHECK(address.group(0) == 0x2001);
+        CHECK(address.group(7) == 0x5678);
+
+        IPv6Prefix p(address, 32);
+        CHECK(p.network() == IPv6Address(0x20010DB800000000ULL, 0));
+        CHECK(p.broadcast() == IPv6Address(0x20010DB8FFFFFFFFULL, ~0ULL));
+        CHECK(p.first_host() == p.network());
+        CHECK(p.contains(address));
+        CHECK(p.contains(IPv6Prefix(address, 64)));
+        CHECK(IPv6Prefix(address, 96).network() == IPv6Address(0x20010DB800000000ULL, 0x0000000000000000ULL));
+        CHECK(IPv6Prefix(address, 112).network().low() == 0x12340000ULL);
+
+        // Increment carries across the halves
+        auto carried = IPv6Address(1, ~0ULL) + 1;
+        CHECK(carried == IPv6Address(2, 0));
+        CHECK(carried - 1 == IPv6Address(1, ~0ULL));
+
+        auto mapped = IPv6Address::mapped("192.0.2.1"_ipv4);
+        CHECK(mapped.is_v4_mapped());
+        CHECK(mapped.to_v4() == "192.0.2.1"_ipv4);
+    }
+
+    TEST_CASE("PrefixTable takes typed prefixes") {
+        PrefixTable table;
+        CHECK(table.insert("10.0.0.0/8"_cidr, 1));
+        CHECK(table.insert("10.1.0.0/16"_cidr, 2));
+        CHECK(table.lookup("10.1.2.3"_ipv4) == uint32_t{2});
+        CHECK(table.lookup("10.2.3.4"_ipv4) == uint32_t{1});
+        CHECK(table.lookup("11.0.0.0"_ipv4).has_value() == false);
+
+        IPv6Address network(0x20010DB800000000ULL, 0);
+        CHECK(table.insert(IPv6Prefix(network, 32), 3));
+        CHECK(table.lookup(network + 42) == uint32_t{3});
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * Tests for NetworkUtils::ipv4_to_uint32_batch / uint32_to_ipv4_batch: every
+ * SIMD level gives exactly the scalar results, on valid addresses, on every
+ * octet-length layout and on fuzzed near-misses.
+ */
+#include <doctest/doctest.h>
+#include "NetworkUtils.h"
+#include "FastNetworkUtils.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Level = NetworkUtils::SimdLevel;
+
+constexpr Level kLevels[] = {Level::Scalar, Level::SSSE3, Level::AVX2};
+
+// Valid addresses and mutations of them: dropped, doubled or swapped
+// characters, stray bytes, overflowing octets
+std::vector<std::string> fuzz_corpus(size_t count) {
+    std::mt19937 rng(18);
+    const std::string alphabet = "0123456789.......a /:";
+    std::vector<std::string> corpus;
+    for (size_t i = 0; i < count; ++i) {
+        std::string s = FastNetworkUtils::uint32_to_ipv4(static_cast<uint32_t>(rng())).c_str();
+        switch (rng() % 6) {
+            case 0: break;
+            case 1: s.erase(rng() % s.size(), 1); break;
+            case 2: s.insert(rng() % (s.size() + 1), 1, alphabet[rng() % alphabet.size()]); break;
+            case 3: s[rng() % s.size()] = alphabet[rng() % alphabet.size()]; break;
+            case 4: s = std::to_string(rng() % 1000) + "." + std::to_string(rng() % 300) + ".0." + std::to_string(rng() % 260); break;
+            default: s.resize(rng() % 18, '1'); break;
+        }
+        corpus.push_back(s);
+    }
+    return corpus;
+}
+
+} // namespace
+
+TEST_SUITE("IPv4 Batch Conversion") {
+    TEST_CASE("Batch parsing matches the scalar parser at every level") {
+        auto corpus = fuzz_corpus(20000);
+        // Every octet-length layout, at the octet value limits
+        for (const char* a : {"0", "10", "100", "255", "256", "999"}) {
+            for (const char* b : {"7", "42", "200"}) {
+                corpus.push_back(std::string(a) + "." + b + "." + b + "." + a);
+                corpus.push_back(std::string(b) + "." + a + "." + a + "." + b);
+            }
+        }
+        for (const char* s : {"", "1.2.3.4", "0.0.0.0", "255.255.255.255", "1.2.3", "1.2.3.4.", ".1.2.3.4",
+                              "1..2.3.4", "1.2.3.4.5", "001.002.003.004", "1.2.3.0004", "1.2.3.4\n",
+                              "-1.2.3.4", "1.2.3.4 "}) {
+            corpus.push_back(s);
+        }
+        std::vector<std::string_view> views(corpus.begin(), corpus.end());
+
+        std::vector<uint32_t> expected(views.size());
+        size_t expected_valid = 0;
+        for (size_t i = 0; i < views.size(); ++i) {
+            auto v = FastNetworkUtils::ipv4_to_uint32(views[i]);
+            expected[i] = v.value_or(0);
+            expected_valid += v.has_value();
+        }
+        CHECK(expected_valid > 5000);
+
+        for (Level level : kLevels) {
+            CAPTURE(static_cast<int>(level));
+            std::vector<uint32_t> values(views.size(), 0xDEADBEEF);
+            std::unique_ptr<bool[]> valid(new bool[views.size()]);
+            size_t count = NetworkUtils::ipv4_to_uint32_batch(views, values, {valid.get(), views.size()}, level);
+            CHECK(count == expected_valid);
+            size_t mismatches = 0;
+            for (size_t i = 0; i < views.size(); ++i) {
+                bool ok = FastNetworkUtils::is_valid_ipv4(views[i]);
+                if (values[i] != expected[i] || valid[i] != ok) {
+                    ++mismatches;
+                    MESSAGE("mismatch on '" << corpus[i] << "'");
+                }
+            }
+            CHECK(mismatches == 0);
+        }
+    }
+
+    TEST_CASE("Batch parsing reads only the view") {
+        std::string line = "10.0.0.1,192.168.100.200,300.1.1.1";
+        std::vector<std::string_view> views = {std::string_view(line).substr(0, 8),
+                                               std::string_view(line).substr(9, 15),
+                                               std::string_view(line).substr(25)};
+        for (Level level : kLevels) {
+            uint32_t values[3];
+            bool valid[3];
+            CHECK(NetworkUtils::ipv4_to_uint32_batch(views, values, valid, level) == 2);
+            CHECK(values[0] == 0x0A000001);
+            CHECK(values[1] == 0xC0A864C8);
+            CHECK(valid[2] == false);
+        }
+    }
+
+    TEST_CASE("Batch formatting matches the scalar formatter at every level") {
+        std::mt19937 rng(81);
+        std::vector<uint32_t> ips = {0, 0xFFFFFFFF, 0x0A000001, 0x64646464, 0x09630A00, 0xC0A80164};
+        for (int i = 0; i < 10001; ++i) {
+            // Mix octet widths evenly rather than mostly 3-digit values
+            uint32_t ip = 0;
+            for (int o = 0; o < 4; ++o) {
+                uint32_t width = rng() % 3;
+                uint32_t octet = width == 0 ? rng() % 10 : width == 1 ? 10 + rng() % 90 : 100 + rng() % 156;
+                ip = (ip << 8) | octet;
+            }
+            ips.push_back(ip);
+        }
+
+        for (Level level : kLevels) {
+            CAPTURE(static_cast<int>(level));
+            std::vector<std::array<char, 16>> out(ips.size());
+            std::vector<uint8_t> lengths(ips.size());
+            NetworkUtils::uint32_to_ipv4_batch(ips, out, lengths, level);
+            size_t mismatches = 0;
+            for (size_t i = 0; i < ips.size(); ++i) {
+                auto expected = FastNetworkUtils::uint32_to_ipv4(ips[i]);
+                std::string_view text(out[i].data());
+                if (text != expected.view() || lengths[i] != expected.size()) ++mismatches;
+            }
+            CHECK(mismatches == 0);
+
+            // Lengths are optional
+            std::vector<std::array<char, 16>> again(ips.size());
+            NetworkUtils::uint32_to_ipv4_batch(ips, again, {}, level);
+            CHECK(again == out);
+        }
+        CHECK(NetworkUtils::detect_simd_level() >= Level::Scalar);
+    }
+}
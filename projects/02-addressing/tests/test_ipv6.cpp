@@ -0,0 +1,119 @@
+/**
+ * Tests for the binary IPv6 functions: IPv6Address::parse, the RFC 5952
+ * canonical formatter and the IPv6 subnet functions of FastNetworkUtils.
+ * Random addresses round-trip through every text form.
+ */
+#include <doctest/doctest.h>
+#include "FastNetworkUtils.h"
+#include "IpAddress.h"
+
+#include <random>
+#include <string>
+
+using F = FastNetworkUtils;
+
+static_assert("2001:db8::1"_ipv6 == IPv6Address(0x20010DB800000000ULL, 1));
+static_assert("::ffff:192.0.2.1"_ipv6 == IPv6Address::mapped("192.0.2.1"_ipv4));
+static_assert("2001:db8::/32"_cidr6.contains("2001:db8:ffff::1"_ipv6));
+static_assert(!"2001:db8::/32"_cidr6.contains("2001:db9::"_ipv6));
+
+TEST_SUITE("IPv6 Binary Handling") {
+    TEST_CASE("Parsing") {
+        for (std::string_view good : {"::", "::1", "1::", "2001:db8:85a3::8a2e:370:7334",
+                                      "2001:0db8:85a3:0000:0000:8a2e:0370:7334", "::ffff:192.0.2.1",
+                                      "1:2:3:4:5:6:7::", "::2:3:4:5:6:7:8", "1:2:3:4:5:6:1.2.3.4",
+                                      "ABCD:EF01::", "::1.2.3.4", "ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255"}) {
+            CAPTURE(good);
+            CHECK(F::is_valid_ipv6(good) == true);
+        }
+        for (std::string_view bad : {"", ":", ":::", "gggg::1", "::1::2", "1:2:3:4:5:6:7:8:9", "1:2:3:4:5:6:7",
+                                     "12345::", ":1::", "1::2:", "1:2:3:4:5:6:7:8::", "::1:2:3:4:5:6:7:8",
+                                     "1.2.3.4", "1:2:3:4:5:6:7:1.2.3.4", "::1.2.3", "::1.2.3.4:1",
+                                     "::256.1.1.1", "fe80::1%eth0", "[::1]", " ::1", "::1 "}) {
+            CAPTURE(bad);
+            CHECK(F::is_valid_ipv6(bad) == false);
+        }
+
+        auto bytes = F::ipv6_to_bytes("2001:db8::8a2e:370:7334");
+        REQUIRE(bytes.has_value());
+        F::IPv6Bytes expected{0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0x8a, 0x2e, 0x03, 0x70, 0x73, 0x34};
+        CHECK(*bytes == expected);
+    }
+
+    TEST_CASE("RFC 5952 canonical text") {
+        // Examples from RFC 5952 section 4
+        CHECK(F::compress_ipv6("2001:0db8::0001") == "2001:db8::1");
+        CHECK(F::compress_ipv6("2001:db8:0:0:0:0:2:1") == "2001:db8::2:1");
+        CHECK(F::compress_ipv6("2001:db8:0:1:1:1:1:1") == "2001:db8:0:1:1:1:1:1");
+        CHECK(F::compress_ipv6("2001:db8:0:0:1:0:0:1") == "2001:db8::1:0:0:1");
+        CHECK(F::compress_ipv6("2001:0:0:1:0:0:0:1") == "2001:0:0:1::1");
+        CHECK(F::compress_ipv6("2001:DB8::AAAA") == "2001:db8::aaaa");
+        CHECK(F::compress_ipv6("0:0:0:0:0:0:0:0") == "::");
+        CHECK(F::compress_ipv6("0:0:0:0:0:0:0:1") == "::1");
+        CHECK(F::compress_ipv6("1:0:0:0:0:0:0:0") == "1::");
+        CHECK(F::compress_ipv6("0:0:0:0:0:ffff:c000:0201") == "::ffff:192.0.2.1");
+        CHECK(F::compress_ipv6("::1.2.3.4") == "::102:304");
+        CHECK(F::compress_ipv6("not an address").empty());
+
+        auto longest = F::compress_ipv6("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff");
+        CHECK(longest.size() == F::kIPv6TextMax);
+
+        CHECK(F::expand_ipv6("::1") == "0000:0000:0000:0000:0000:0000:0000:0001");
+        CHECK(F::expand_ipv6("2001:db8::1") == "2001:0db8:0000:0000:0000:0000:0000:0001");
+        CHECK(F::expand_ipv6("::1::2").empty());
+
+        std::array<char, 8> small;
+        CHECK(F::bytes_to_ipv6(IPv6Address(~0ULL, ~0ULL).to_bytes(), small) == 0);
+    }
+
+    TEST_CASE("Random addresses round-trip through every text form") {
+        std::mt19937_64 rng(20);
+        size_t mismatches = 0;
+        for (int i = 0; i < 50000; ++i) {
+            // Zero out random groups so compression has runs to find
+            uint64_t half[2] = {rng(), rng()};
+            uint64_t zeros = rng();
+            for (unsigned g = 0; g < 8; ++g) {
+                if (zeros >> (g * 2) & 1) half[g / 4] &= ~(uint64_t{0xFFFF} << (48 - 16 * (g % 4)));
+            }
+            IPv6Address address(half[0], half[1]);
+            if (i % 10 == 0) address = IPv6Address::mapped(IPv4Address(static_cast<uint32_t>(rng())));
+
+            auto canonical = F::bytes_to_ipv6(address.to_bytes());
+            auto expanded = F::expand_ipv6(canonical.view());
+            auto from_canonical = IPv6Address::parse(canonical.view());
+            auto from_expanded = IPv6Address::parse(expanded.view());
+            bool ok = from_canonical == address && from_expanded == address &&
+                      canonical.view().find(":::") == std::string_view::npos &&
+                      canonical.view().find("::") == canonical.view().rfind("::") &&
+                      F::compress_ipv6(expanded.view()) == canonical.view();
+            if (!ok) {
+                ++mismatches;
+                MESSAGE("round trip failed for " << canonical.c_str() << " / " << expanded.c_str());
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("Subnet functions") {
+        CHECK(F::get_network_address_v6("2001:db8:1:2::3", 48) == "2001:db8:1::");
+        CHECK(F::get_network_address_v6("2001:db8::1", 0) == "::");
+        CHECK(F::get_network_address_v6("2001:db8::1", 128) == "2001:db8::1");
+        CHECK(F::get_network_address_v6("2001:db8::1", 129).empty());
+        CHECK(F::get_network_address_v6("2001:db8:::1", 64).empty());
+
+        CHECK(F::is_in_subnet_v6("2001:db8::ff", "2001:db8::", 64) == true);
+        CHECK(F::is_in_subnet_v6("2001:db8:0:1::", "2001:db8::", 64) == false);
+        CHECK(F::is_in_subnet_v6("::ffff:10.1.2.3", "::ffff:10.0.0.0", 104) == true);
+        CHECK(F::is_in_subnet_v6("::1", "bogus", 0) == false);
+
+        auto info = F::analyze_subnet_v6("2001:db8::1", 64);
+        CHECK(info.network == "2001:db8::");
+        CHECK(info.first_host == "2001:db8::");
+        CHECK(info.last_host == "2001:db8::ffff:ffff:ffff:ffff");
+        auto odd = F::analyze_subnet_v6("2001:db8:abcd:1234::", 60);
+        CHECK(odd.network == "2001:db8:abcd:1230::");
+        CHECK(odd.last_host == "2001:db8:abcd:123f:ffff:ffff:ffff:ffff");
+        CHECK(F::analyze_subnet_v6("::", 200).network.empty());
+    }
+}
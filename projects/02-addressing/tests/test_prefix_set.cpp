@@ -0,0 +1,168 @@
+/**
+ * Tests for PrefixSet: set algebra checked address by address against a
+ * bitset over a small universe, aggregation to the minimal cover, the
+ * extremes of the address space, and the text stream round trip.
+ */
+#include <doctest/doctest.h>
+#include "PrefixSet.h"
+
+#include <bitset>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Random sets live inside 10.0.0.0/20 so they can be checked exhaustively
+constexpr uint32_t kBase = 0x0A000000;
+constexpr size_t kUniverse = 4096;
+using Bits = std::bitset<kUniverse>;
+
+std::vector<Prefix> random_prefixes(std::mt19937& rng, size_t count) {
+    std::vector<Prefix> prefixes;
+    for (size_t i = 0; i < count; ++i) {
+        unsigned length = 20 + rng() % 13;
+        prefixes.emplace_back(IPv4Address(kBase + rng() % kUniverse), length);
+    }
+    return prefixes;
+}
+
+Bits to_bits(const std::vector<Prefix>& prefixes) {
+    Bits bits;
+    for (const Prefix& p : prefixes) {
+        for (uint32_t a = p.network().to_uint32(); a <= p.broadcast().to_uint32(); ++a) bits.set(a - kBase);
+    }
+    return bits;
+}
+
+} // namespace
+
+TEST_SUITE("Prefix Set") {
+    TEST_CASE("Aggregation") {
+        std::vector<Prefix> prefixes = {"10.0.0.0/25"_cidr, "10.0.0.128/25"_cidr, "10.0.0.64/26"_cidr};
+        PrefixSet set(prefixes);
+        std::vector<Prefix> expected = {"10.0.0.0/24"_cidr};
+        CHECK(set.prefixes() == expected);
+        CHECK(set.address_count() == 256);
+
+        // Adjacent but unaligned ranges merge into one range, covered by two prefixes
+        prefixes = {"10.0.1.0/24"_cidr, "10.0.2.0/24"_cidr, "10.0.1.128/25"_cidr};
+        set = PrefixSet(prefixes);
+        CHECK(set.ranges().size() == 1);
+        expected = {"10.0.1.0/24"_cidr, "10.0.2.0/24"_cidr};
+        CHECK(set.prefixes() == expected);
+
+        CHECK(set.contains("10.0.2.255"_ipv4));
+        CHECK_FALSE(set.contains("10.0.3.0"_ipv4));
+        CHECK(set.contains("10.0.1.128/25"_cidr));
+        CHECK_FALSE(set.contains("10.0.0.0/22"_cidr));
+        CHECK(PrefixSet().empty());
+    }
+
+    TEST_CASE("Algebra matches a bitset") {
+        std::mt19937 rng(22);
+        for (int round = 0; round < 50; ++round) {
+            CAPTURE(round);
+            auto pa = random_prefixes(rng, 1 + rng() % 40);
+            auto pb = random_prefixes(rng, 1 + rng() % 40);
+            PrefixSet a(pa), b(pb);
+            Bits ba = to_bits(pa), bb = to_bits(pb);
+
+            auto check = [](const PrefixSet& set, const Bits& bits) {
+                // The cover is exact, minimal (no two prefixes could merge
+                // into their parent) and in address order
+                auto cover = set.prefixes();
+                CHECK(to_bits(cover) == bits);
+                size_t mergeable = 0, unordered = 0;
+                for (size_t i = 1; i < cover.size(); ++i) {
+                    if (cover[i].network() <= cover[i - 1].broadcast()) ++unordered;
+                    if (cover[i].length() == cover[i - 1].length() && cover[i].length() > 0 &&
+                        Prefix(cover[i].network(), cover[i].length() - 1).network() == cover[i - 1].network()) {
+                        ++mergeable;
+                    }
+                }
+                CHECK(mergeable == 0);
+                CHECK(unordered == 0);
+                CHECK(set.address_count() == bits.count());
+
+                size_t wrong = 0;
+                for (uint32_t i = 0; i < kUniverse; ++i) wrong += set.contains(IPv4Address(kBase + i)) != bits[i];
+                CHECK(wrong == 0);
+            };
+            check(a, ba);
+            check(a.unite(b), ba | bb);
+            check(a.intersect(b), ba & bb);
+            check(a.subtract(b), ba & ~bb);
+            check(b.subtract(a), bb & ~ba);
+            CHECK(a.unite(b) == b.unite(a));
+            CHECK(a.subtract(a).empty());
+        }
+    }
+
+    TEST_CASE("Whole address space") {
+        std::vector<Prefix> all = {"0.0.0.0/0"_cidr};
+        PrefixSet everything(all);
+        CHECK(everything.address_count() == (uint64_t{1} << 32));
+        CHECK(everything.contains("255.255.255.255"_ipv4));
+        CHECK(everything.prefixes() == all);
+
+        std::vector<Prefix> edges = {"0.0.0.0/32"_cidr, "255.255.255.255/32"_cidr};
+        PrefixSet rest = everything.subtract(PrefixSet(edges));
+        CHECK(rest.address_count() == (uint64_t{1} << 32) - 2);
+        CHECK_FALSE(rest.contains("255.255.255.255"_ipv4));
+        CHECK(rest.prefixes().size() == 62);
+        CHECK(rest.unite(PrefixSet(edges)) == everything);
+
+        std::vector<Prefix> top = {"255.255.255.254/31"_cidr, "255.255.255.255/32"_cidr};
+        PrefixSet high(top);
+        std::vector<Prefix> expected = {"255.255.255.254/31"_cidr};
+        CHECK(high.prefixes() == expected);
+        CHECK(high.intersect(everything) == high);
+    }
+
+    TEST_CASE("IPv6") {
+        std::vector<IPv6Prefix> prefixes = {"2001:db8::/33"_cidr6, "2001:db8:8000::/33"_cidr6, "2001:db8:1::/48"_cidr6};
+        IPv6PrefixSet set(prefixes);
+        std::vector<IPv6Prefix> expected = {"2001:db8::/32"_cidr6};
+        CHECK(set.prefixes() == expected);
+
+        std::vector<IPv6Prefix> hole = {"2001:db8:1::/48"_cidr6};
+        auto rest = set.subtract(IPv6PrefixSet(hole));
+        CHECK_FALSE(rest.contains("2001:db8:1::5"_ipv6));
+        CHECK(rest.contains("2001:db8:2::"_ipv6));
+        CHECK(rest.prefixes().size() == 16);
+        CHECK(rest.unite(IPv6PrefixSet(hole)) == set);
+
+        std::vector<IPv6Prefix> all = {"::/0"_cidr6};
+        IPv6PrefixSet everything(all);
+        CHECK(everything.contains("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"_ipv6));
+        CHECK(everything.prefixes() == all);
+    }
+
+    TEST_CASE("Text streams") {
+        std::istringstream in("# feed\n"
+                              "10.0.0.0/25\n"
+                              "  10.0.0.128/25\t\r\n"
+                              "\n"
+                              "192.0.2.7\n"
+                              "10.0.0.1/24\n"
+                              "not-a-prefix\n");
+        size_t rejected = 0;
+        auto set = PrefixSet::read(in, &rejected);
+        CHECK(rejected == 2);
+
+        std::ostringstream out;
+        set.write(out);
+        CHECK(out.str() == "10.0.0.0/24\n192.0.2.7/32\n");
+
+        std::istringstream back(out.str());
+        CHECK(PrefixSet::read(back) == set);
+
+        std::istringstream in6("2001:db8::/48\n2001:db8:1::/48\n::ffff:0:0/96\n");
+        auto set6 = IPv6PrefixSet::read(in6, &rejected);
+        CHECK(rejected == 0);
+        std::ostringstream out6;
+        set6.write(out6);
+        CHECK(out6.str() == "::ffff:0.0.0.0/96\n2001:db8::/47\n");
+    }
+}
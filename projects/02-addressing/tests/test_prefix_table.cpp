@@ -0,0 +1,204 @@
+/**
+ * Tests for PrefixTable: longest-prefix match over IPv4 and IPv6 CIDRs,
+ * insertion order independence and the batch lookups, checked against a
+ * linear scan over the same prefixes.
+ */
+#include <doctest/doctest.h>
+#include "PrefixTable.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Route {
+    uint32_t network;
+    uint8_t prefix;
+    uint32_t value;
+};
+
+// Reference answer: the longest matching route, by scanning all of them
+std::optional<uint32_t> linear_lookup(const std::vector<Route>& routes, uint32_t address) {
+    std::optional<uint32_t> best;
+    int best_len = -1;
+    for (const auto& r : routes) {
+        uint32_t mask = r.prefix == 0 ? 0 : 0xFFFFFFFFu << (32 - r.prefix);
+        if ((address & mask) == r.network && r.prefix > best_len) {
+            best = r.value;
+            best_len = r.prefix;
+        }
+    }
+    return best;
+}
+
+PrefixTable::IPv6Bytes v6(std::initializer_list<uint8_t> bytes) {
+    PrefixTable::IPv6Bytes out{};
+    std::copy(bytes.begin(), bytes.end(), out.begin());
+    return out;
+}
+
+} // namespace
+
+TEST_SUITE("Prefix Table") {
+    TEST_CASE("IPv4 longest-prefix match from CIDR strings") {
+        PrefixTable table;
+        CHECK(table.lookup(0x0A000001).has_value() == false);
+
+        CHECK(table.insert("10.0.0.0/8", 1));
+        CHECK(table.insert("10.1.0.0/16", 2));
+        CHECK(table.insert("10.1.2.0/24", 3));
+        CHECK(table.insert("10.1.2.128/25", 4));
+        CHECK(table.insert("10.1.2.200", 5));  // Host route
+        CHECK(table.size_v4() == 5);
+
+        CHECK(table.lookup(0x0A050505) == 1u);
+        CHECK(table.lookup(0x0A010505) == 2u);
+        CHECK(table.lookup(0x0A010205) == 3u);
+        CHECK(table.lookup(0x0A010281) == 4u);
+        CHECK(table.lookup(0x0A0102C8) == 5u);
+        CHECK(table.lookup(0x0A0102C9) == 4u);
+        CHECK(table.lookup(0x0B000000).has_value() == false);
+        CHECK(table.lookup("10.1.2.200") == 5u);
+        CHECK(table.lookup("not an address").has_value() == false);
+
+        // A shorter prefix inserted later does not override longer ones
+        CHECK(table.insert("0.0.0.0/0", 0));
+        CHECK(table.lookup(0x0B000000) == 0u);
+        CHECK(table.lookup(0x0A0102C8) == 5u);
+
+        // Re-inserting replaces the value
+        CHECK(table.insert("10.1.0.0/16", 20));
+        CHECK(table.lookup(0x0A010505) == 20u);
+        CHECK(table.lookup(0x0A010205) == 3u);
+        CHECK(table.size_v4() == 6);
+
+        table.clear();
+        CHECK(table.size_v4() == 0);
+        CHECK(table.lookup(0x0A010505).has_value() == false);
+    }
+
+    TEST_CASE("Malformed CIDRs are rejected") {
+        PrefixTable table;
+        CHECK(table.insert("10.0.0.1/8", 1) == false);  // Host bits set
+        CHECK(table.insert("10.0.0.0/33", 1) == false);
+        CHECK(table.insert("10.0.0.0/", 1) == false);
+        CHECK(table.insert("10.0.0/8", 1) == false);
+        CHECK(table.insert("256.0.0.0/8", 1) == false);
+        CHECK(table.insert("2001:db8::1/32", 1) == false);
+        CHECK(table.insert("2001:db8::/129", 1) == false);
+        CHECK(table.insert("2001:db8:::/32", 1) == false);
+        CHECK(table.insert("10.0.0.0/8", PrefixTable::kMaxValue + 1) == false);
+        CHECK(table.insert_v4(0x0A000000, 33, 1) == false);
+        CHECK(table.size_v4() == 0);
+        CHECK(table.size_v6() == 0);
+    }
+
+    TEST_CASE("IPv6 longest-prefix match") {
+        PrefixTable table;
+        CHECK(table.insert("2001:db8::/32", 1));
+        CHECK(table.insert("2001:db8:1::/48", 2));
+        CHECK(table.insert("2001:db8:1:2::/64", 3));
+        CHECK(table.insert("2001:db8:1:2::1", 4));
+        CHECK(table.insert("::ffff:10.0.0.0/104", 5));  // IPv4-mapped 10/8
+        CHECK(table.size_v6() == 5);
+        CHECK(table.size_v4() == 0);
+
+        CHECK(table.lookup(v6({0x20, 0x01, 0x0d, 0xb8, 0, 9})) == 1u);
+        CHECK(table.lookup(v6({0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 7})) == 2u);
+        CHECK(table.lookup(v6({0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 2, 0, 0, 0, 0, 0, 0, 0, 2})) == 3u);
+        CHECK(table.lookup(v6({0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 2, 0, 0, 0, 0, 0, 0, 0, 1})) == 4u);
+        CHECK(table.lookup(v6({0x20, 0x01, 0x0d, 0xb9})).has_value() == false);
+        CHECK(table.lookup("2001:db8:1:2::1") == 4u);
+        CHECK(table.lookup("::ffff:10.9.8.7") == 5u);
+        CHECK(table.lookup("::ffff:11.9.8.7").has_value() == false);
+
+        // IPv4 and IPv6 tables are independent
+        CHECK(table.lookup(0x0A090807).has_value() == false);
+
+        CHECK(table.insert("::/0", 0));
+        CHECK(table.lookup("fe80::1") == 0u);
+        CHECK(table.lookup("2001:db8:1::5") == 2u);
+    }
+
+    TEST_CASE("Random routes agree with a linear scan, in any insertion order") {
+        std::mt19937 rng(16);
+        std::vector<Route> routes;
+        for (uint32_t i = 0; i < 2000; ++i) {
+            // Cluster under a few /8s so prefixes nest deeply
+            uint8_t prefix = static_cast<uint8_t>(8 + rng() % 25);
+            uint32_t address = (static_cast<uint32_t>(rng() % 4 + 10) << 24) | (rng() & 0x00FFFFFF);
+            uint32_t mask = 0xFFFFFFFFu << (32 - prefix);
+            routes.push_back({address & mask, prefix, i});
+        }
+        // Keep the first value per distinct prefix so the reference is unambiguous
+        std::vector<Route> unique;
+        for (const auto& r : routes) {
+            bool seen = false;
+            for (const auto& u : unique) seen |= u.network == r.network && u.prefix == r.prefix;
+            if (!seen) unique.push_back(r);
+        }
+
+        PrefixTable forward, reverse;
+        for (const auto& r : unique) CHECK(forward.insert_v4(r.network, r.prefix, r.value));
+        for (auto it = unique.rbegin(); it != unique.rend(); ++it) reverse.insert_v4(it->network, it->prefix, it->value);
+        CHECK(forward.size_v4() == unique.size());
+
+        std::vector<uint32_t> addresses;
+        for (int i = 0; i < 20000; ++i) {
+            uint32_t a = rng();
+            if (i % 2) a = (static_cast<uint32_t>(rng() % 4 + 10) << 24) | (a & 0x00FFFFFF);
+            addresses.push_back(a);
+        }
+        // Exact network and broadcast addresses of every route
+        for (const auto& r : unique) {
+            addresses.push_back(r.network);
+            addresses.push_back(r.network | (r.prefix == 32 ? 0 : 0xFFFFFFFFu >> r.prefix));
+        }
+
+        std::vector<uint32_t> batch(addresses.size() - 1);  // Odd length: exercises the tail
+        forward.lookup_batch(std::span<const uint32_t>(addresses).first(batch.size()), batch);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            auto expected = linear_lookup(unique, addresses[i]);
+            if (forward.lookup(addresses[i]) != expected) ++mismatches;
+            if (reverse.lookup(addresses[i]) != expected) ++mismatches;
+            if (i < batch.size() && batch[i] != expected.value_or(PrefixTable::kNoMatch)) ++mismatches;
+        }
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("IPv6 batch lookup matches single lookups") {
+        PrefixTable table;
+        std::mt19937 rng(6);
+        std::vector<PrefixTable::IPv6Bytes> addresses;
+        for (uint32_t i = 0; i < 500; ++i) {
+            PrefixTable::IPv6Bytes network{0x20, 0x01, 0x0d, 0xb8};
+            for (size_t b = 4; b < 16; ++b) network[b] = static_cast<uint8_t>(rng() % 4);
+            uint8_t prefix = static_cast<uint8_t>(32 + rng() % 97);
+            for (size_t b = 0; b < 16; ++b) {
+                unsigned bit = static_cast<unsigned>(b) * 8;
+                if (prefix <= bit) network[b] = 0;
+                else if (prefix < bit + 8) network[b] &= static_cast<uint8_t>(0xFF << (bit + 8 - prefix));
+            }
+            CHECK(table.insert_v6(network, prefix, i));
+            addresses.push_back(network);
+        }
+        for (int i = 0; i < 1000; ++i) {
+            PrefixTable::IPv6Bytes a{0x20, 0x01, 0x0d, static_cast<uint8_t>(i % 3 ? 0xb8 : 0xb9)};
+            for (size_t b = 4; b < 16; ++b) a[b] = static_cast<uint8_t>(rng() % 4);
+            addresses.push_back(a);
+        }
+
+        std::vector<uint32_t> batch(addresses.size());
+        table.lookup_batch(addresses, batch);
+        size_t mismatches = 0, matched = 0;
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            auto single = table.lookup(addresses[i]);
+            if (batch[i] != single.value_or(PrefixTable::kNoMatch)) ++mismatches;
+            if (single) ++matched;
+        }
+        CHECK(mismatches == 0);
+        CHECK(matched >= 500);
+        CHECK(table.memory_bytes() > 0);
+    }
+}
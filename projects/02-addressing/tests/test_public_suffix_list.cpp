@@ -0,0 +1,114 @@
+/**
+ * Tests for PublicSuffixList: the test vectors published with the list
+ * (checkPublicSuffix) that the built-in rules cover, wildcards and
+ * exceptions, sections, and compiling a list from text.
+ */
+#include <doctest/doctest.h>
+#include "PublicSuffixList.h"
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+TEST_SUITE("Public Suffix List") {
+    TEST_CASE("Registrable domains") {
+        const auto& psl = PublicSuffixList::builtin();
+
+        // Listed and unlisted TLDs
+        CHECK(psl.registrable_domain("com") == "");
+        CHECK(psl.registrable_domain("example.com") == "example.com");
+        CHECK(psl.registrable_domain("b.example.com") == "example.com");
+        CHECK(psl.registrable_domain("a.b.example.com") == "example.com");
+        CHECK(psl.registrable_domain("example") == "");
+        CHECK(psl.registrable_domain("example.example") == "example.example");
+        CHECK(psl.registrable_domain("b.example.example") == "example.example");
+
+        // Two-level suffixes
+        CHECK(psl.registrable_domain("uk") == "");
+        CHECK(psl.registrable_domain("co.uk") == "");
+        CHECK(psl.registrable_domain("example.co.uk") == "example.co.uk");
+        CHECK(psl.registrable_domain("www.game.co.uk") == "game.co.uk");
+        CHECK(psl.registrable_domain("test.jp") == "test.jp");
+        CHECK(psl.registrable_domain("ac.jp") == "");
+        CHECK(psl.registrable_domain("www.test.ac.jp") == "test.ac.jp");
+        CHECK(psl.registrable_domain("test.kyoto.jp") == "test.kyoto.jp");
+        CHECK(psl.public_suffix("www.example.co.uk") == "co.uk");
+        CHECK(psl.public_suffix("example.example") == "example");
+
+        // Case is ignored; the result is a view of the input
+        std::string_view host = "WWW.Example.CO.UK";
+        CHECK(psl.registrable_domain(host) == "Example.CO.UK");
+        CHECK(psl.registrable_domain(host).data() == host.data() + 4);
+
+        // Not hostnames
+        CHECK(psl.registrable_domain("") == "");
+        CHECK(psl.registrable_domain(".com") == "");
+        CHECK(psl.registrable_domain("example.com.") == "");
+        CHECK(psl.registrable_domain("192.168.1.1") == "");
+        CHECK(psl.public_suffix("bad_name.com") == "");
+    }
+
+    TEST_CASE("Wildcards and exceptions") {
+        const auto& psl = PublicSuffixList::builtin();
+        CHECK(psl.registrable_domain("ck") == "");
+        CHECK(psl.registrable_domain("test.ck") == "");
+        CHECK(psl.registrable_domain("b.test.ck") == "b.test.ck");
+        CHECK(psl.registrable_domain("a.b.test.ck") == "b.test.ck");
+        CHECK(psl.registrable_domain("www.ck") == "www.ck");
+        CHECK(psl.registrable_domain("www.www.ck") == "www.ck");
+
+        CHECK(psl.registrable_domain("kobe.jp") == "kobe.jp");
+        CHECK(psl.registrable_domain("c.kobe.jp") == "");
+        CHECK(psl.registrable_domain("b.c.kobe.jp") == "b.c.kobe.jp");
+        CHECK(psl.registrable_domain("a.b.c.kobe.jp") == "b.c.kobe.jp");
+        CHECK(psl.registrable_domain("city.kobe.jp") == "city.kobe.jp");
+        CHECK(psl.registrable_domain("www.city.kobe.jp") == "city.kobe.jp");
+        CHECK(psl.public_suffix("a.b.c.kobe.jp") == "c.kobe.jp");
+    }
+
+    TEST_CASE("Private section") {
+        std::istringstream in(std::string("// ===BEGIN ICANN DOMAINS===\n"
+                                          "io\n"
+                                          "// ===END ICANN DOMAINS===\n"
+                                          "// ===BEGIN PRIVATE DOMAINS===\n"
+                                          "github.io\n"));
+        auto all = PublicSuffixList::load(in);
+        CHECK(all.rule_count() == 2);
+        CHECK(all.registrable_domain("player.github.io") == "player.github.io");
+        CHECK(PublicSuffixList::builtin().registrable_domain("cdn.player.github.io") == "player.github.io");
+
+        in.clear();
+        in.seekg(0);
+        auto icann = PublicSuffixList::load(in, PublicSuffixList::Sections::IcannOnly);
+        CHECK(icann.rule_count() == 1);
+        CHECK(icann.registrable_domain("player.github.io") == "github.io");
+    }
+
+    TEST_CASE("Compiling rules") {
+        size_t rejected = 0;
+        auto psl = PublicSuffixList::parse("// comment\n"
+                                           "\n"
+                                           "CO.Example  trailing text\r\n"
+                                           "co.example\n"
+                                           "*.wild.example\n"
+                                           "!keep.wild.example\n"
+                                           "a.*.example\n"
+                                           "!example\n"
+                                           "..example\n"
+                                           "example.\n"
+                                           "*\n",
+                                           PublicSuffixList::Sections::All, &rejected);
+        CHECK(rejected == 5);
+        CHECK(psl.rule_count() == 3);
+        CHECK(psl.registrable_domain("game.co.example") == "game.co.example");
+        CHECK(psl.registrable_domain("a.b.wild.example") == "a.b.wild.example");
+        CHECK(psl.registrable_domain("x.keep.wild.example") == "keep.wild.example");
+        CHECK(psl.registrable_domain("game.example") == "game.example");
+
+        PublicSuffixList empty;
+        CHECK(empty.rule_count() == 0);
+        CHECK(empty.registrable_domain("www.example.co.uk") == "co.uk");
+        CHECK(PublicSuffixList::builtin().rule_count() > 200);
+        CHECK(PublicSuffixList::builtin().memory_bytes() > 0);
+    }
+}
@@ -0,0 +1,188 @@
+/**
+ * Tests for SubnetAllocator: buddy splitting and merging, reservations,
+ * fragmentation, random allocate/release sequences checked against an
+ * address bitmap, and the serialization round trip.
+ */
+#include <doctest/doctest.h>
+#include "SubnetAllocator.h"
+
+#include <bitset>
+#include <random>
+#include <sstream>
+#include <vector>
+
+TEST_SUITE("Subnet Allocator") {
+    TEST_CASE("Split and merge") {
+        SubnetAllocator pool("10.0.0.0/24"_cidr);
+        CHECK(pool.free_addresses() == 256);
+        CHECK(pool.fragmentation() == 0.0);
+
+        auto a = pool.allocate(26);
+        auto b = pool.allocate(28);
+        auto c = pool.allocate(26);
+        REQUIRE(a);
+        REQUIRE(b);
+        REQUIRE(c);
+        CHECK(*a == "10.0.0.0/26"_cidr);
+        CHECK(*b == "10.0.0.64/28"_cidr);
+        CHECK(*c == "10.0.0.128/26"_cidr);
+        CHECK(pool.free_addresses() == 256 - 64 - 16 - 64);
+        CHECK(pool.largest_free_length() == 26u);  // 10.0.0.192/26
+
+        // Free: .80/28, .96/27, .192/26 → 1 - 64/112
+        CHECK(pool.fragmentation() == doctest::Approx(1.0 - 64.0 / 112.0));
+
+        // The /28's buddies merge back into .64/26
+        CHECK(pool.release(*b));
+        CHECK(pool.allocate(27) == "10.0.0.64/27"_cidr);
+        CHECK(pool.release("10.0.0.64/27"_cidr));
+
+        CHECK(pool.release(*a));
+        CHECK(pool.release(*c));
+        CHECK(pool.allocation_count() == 0);
+        CHECK(pool.largest_free_length() == 24u);
+        CHECK(pool.fragmentation() == 0.0);
+    }
+
+    TEST_CASE("Limits and invalid calls") {
+        SubnetAllocator pool("192.168.0.0/30"_cidr);
+        CHECK_FALSE(pool.allocate(29));
+        CHECK_FALSE(pool.allocate(33));
+        CHECK(pool.allocate(31) == "192.168.0.0/31"_cidr);
+        CHECK(pool.allocate(32) == "192.168.0.2/32"_cidr);
+        CHECK(pool.allocate(32) == "192.168.0.3/32"_cidr);
+        CHECK_FALSE(pool.allocate(32));
+        CHECK_FALSE(pool.largest_free_length());
+        CHECK(pool.fragmentation() == 0.0);
+
+        CHECK_FALSE(pool.release("192.168.0.0/32"_cidr));  // Wrong length
+        CHECK_FALSE(pool.release("10.0.0.0/31"_cidr));
+        CHECK(pool.release("192.168.0.0/31"_cidr));
+        CHECK_FALSE(pool.release("192.168.0.0/31"_cidr));  // Already free
+
+        SubnetAllocator everything("0.0.0.0/0"_cidr);
+        CHECK(everything.free_addresses() == (uint64_t{1} << 32));
+        CHECK(everything.allocate(1) == "0.0.0.0/1"_cidr);
+        CHECK(everything.allocate(32) == "128.0.0.0/32"_cidr);
+        CHECK(everything.release("0.0.0.0/1"_cidr));
+        CHECK(everything.release("128.0.0.0/32"_cidr));
+        CHECK(everything.largest_free_length() == 0u);
+    }
+
+    TEST_CASE("Reservations") {
+        SubnetAllocator pool("10.0.0.0/24"_cidr);
+        CHECK(pool.reserve("10.0.0.100/30"_cidr));
+        CHECK(pool.is_allocated("10.0.0.100/30"_cidr));
+        CHECK_FALSE(pool.reserve("10.0.0.96/27"_cidr));   // Holds the reservation
+        CHECK_FALSE(pool.reserve("10.0.0.102/32"_cidr));  // Inside it
+        CHECK_FALSE(pool.reserve("10.0.1.0/30"_cidr));    // Outside the pool
+
+        // Everything around the reservation is still free
+        CHECK(pool.allocate(25) == "10.0.0.128/25"_cidr);
+        CHECK(pool.allocate(26) == "10.0.0.0/26"_cidr);
+        CHECK(pool.allocate(30) == "10.0.0.96/30"_cidr);
+        CHECK(pool.free_addresses() == 256 - 4 - 128 - 64 - 4);
+
+        CHECK(pool.release("10.0.0.100/30"_cidr));
+        CHECK(pool.reserve("10.0.0.100/30"_cidr));
+    }
+
+    TEST_CASE("Random sequences match a bitmap") {
+        constexpr uint32_t kBase = 0x0A000000;
+        constexpr size_t kSize = 4096;
+        std::mt19937 rng(23);
+        SubnetAllocator pool(Prefix(IPv4Address(kBase), 20));
+        std::bitset<kSize> used;
+        std::vector<Prefix> live;
+        size_t overlaps = 0, misaligned = 0, refused = 0, miscounted = 0;
+
+        for (int step = 0; step < 20000; ++step) {
+            if (live.empty() || rng() % 3 != 0) {
+                unsigned length = 22 + rng() % 11;
+                auto block = pool.allocate(length);
+                if (!block) {
+                    // Only refused when no aligned block of that size is free
+                    size_t size = size_t{1} << (32 - length);
+                    for (size_t start = 0; start < kSize; start += size) {
+                        bool free = true;
+                        for (size_t i = start; i < start + size && free; ++i) free = !used[i];
+                        refused += free;
+                    }
+                    continue;
+                }
+                CHECK(block->length() == length);
+                if (!Prefix(IPv4Address(kBase), 20).contains(*block)) ++misaligned;
+                for (uint32_t a = block->network().to_uint32(); a <= block->broadcast().to_uint32(); ++a) {
+                    overlaps += used[a - kBase];
+                    used.set(a - kBase);
+                }
+                live.push_back(*block);
+            } else {
+                size_t i = rng() % live.size();
+                CHECK(pool.release(live[i]));
+                for (uint32_t a = live[i].network().to_uint32(); a <= live[i].broadcast().to_uint32(); ++a) {
+                    used.reset(a - kBase);
+                }
+                live[i] = live.back();
+                live.pop_back();
+            }
+            miscounted += pool.free_addresses() != kSize - used.count();
+        }
+        CHECK(overlaps == 0);
+        CHECK(misaligned == 0);
+        CHECK(refused == 0);
+        CHECK(miscounted == 0);
+        CHECK(pool.allocation_count() == live.size());
+
+        for (const Prefix& p : live) CHECK(pool.release(p));
+        CHECK(pool.largest_free_length() == 20u);
+    }
+
+    TEST_CASE("Serialization") {
+        std::mt19937 rng(123);
+        SubnetAllocator pool("172.16.0.0/16"_cidr);
+        std::vector<Prefix> live;
+        for (int i = 0; i < 500; ++i) {
+            if (auto block = pool.allocate(24 + rng() % 5)) live.push_back(*block);
+            if (i % 3 == 0 && !live.empty()) {
+                size_t j = rng() % live.size();
+                CHECK(pool.release(live[j]));
+                live[j] = live.back();
+                live.pop_back();
+            }
+        }
+
+        std::stringstream state;
+        pool.write(state);
+        auto restored = SubnetAllocator::read(state);
+        REQUIRE(restored);
+        CHECK(restored->pool() == pool.pool());
+        CHECK(restored->allocations() == pool.allocations());
+        CHECK(restored->free_addresses() == pool.free_addresses());
+        CHECK(restored->fragmentation() == pool.fragmentation());
+
+        // Same free lists, so the same future allocations
+        size_t diverged = 0;
+        for (int i = 0; i < 200; ++i) {
+            unsigned length = 24 + rng() % 5;
+            diverged += pool.allocate(length) != restored->allocate(length);
+        }
+        CHECK(diverged == 0);
+
+        std::istringstream text("# pool\n10.0.0.0/24\n\n10.0.0.64/26\n  10.0.0.8/29\n");
+        auto parsed = SubnetAllocator::read(text);
+        REQUIRE(parsed);
+        std::vector<Prefix> expected = {"10.0.0.8/29"_cidr, "10.0.0.64/26"_cidr};
+        CHECK(parsed->allocations() == expected);
+        std::ostringstream out;
+        parsed->write(out);
+        CHECK(out.str() == "10.0.0.0/24\n10.0.0.8/29\n10.0.0.64/26\n");
+
+        std::istringstream empty(""), overlap("10.0.0.0/24\n10.0.0.0/25\n10.0.0.0/26\n"),
+            outside("10.0.0.0/24\n10.0.1.0/26\n"), malformed("10.0.0.0/24\nbogus\n");
+        CHECK_FALSE(SubnetAllocator::read(empty));
+        CHECK_FALSE(SubnetAllocator::read(overlap));
+        CHECK_FALSE(SubnetAllocator::read(outside));
+        CHECK_FALSE(SubnetAllocator::read(malformed));
+    }
+}